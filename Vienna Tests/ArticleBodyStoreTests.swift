@@ -0,0 +1,47 @@
+//
+//  ArticleBodyStoreTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the compressed article bodies of the message_bodies table.
+class ArticleBodyStoreTests: DatabaseTestCase {
+
+    func testArticleBodiesAreStoredCompressed() throws {
+        let articles = makeArticles(count: 2, prefix: "body")
+        articles[1].body = nil
+        XCTAssertEqual(database.addArticles(articles, toFolder: 1), IndexSet(0..<2))
+        XCTAssertEqual(countOfRows("SELECT id FROM message_bodies WHERE length(body) < length(vna_inflate(body))"), 1)
+
+        let storedArticles: [Article] = database.arrayOfArticles(0, filterString: "")
+        let storedArticle = try XCTUnwrap(storedArticles.first { $0.guid == "body-0" })
+        XCTAssertNotNil(storedArticle.compressedBody)
+        XCTAssertEqual(storedArticle.body, articles[0].body)
+        XCTAssertNil(storedArticle.compressedBody)
+        XCTAssertNil(storedArticles.first { $0.guid == "body-1" }?.body)
+
+        let update = Article(guid: "body-0")
+        update.title = articles[0].title
+        update.body = "Updated body"
+        XCTAssertEqual(database.updateArticles([storedArticle], ofFolder: 1, withArticles: [update]), IndexSet([0]))
+        let updatedArticles: [Article] = database.arrayOfArticles(0, filterString: "Updated")
+        XCTAssertEqual(updatedArticles.map(\.body), ["Updated body"])
+    }
+
+}
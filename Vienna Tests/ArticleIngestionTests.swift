@@ -0,0 +1,37 @@
+//
+//  ArticleIngestionTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests adding the articles of a feed in one transaction.
+class ArticleIngestionTests: DatabaseTestCase {
+
+    func testAddArticlesSkipsArticlesThatCannotBeAdded() {
+        let articles = makeArticles(count: 3, prefix: "batch")
+        XCTAssertEqual(database.addArticles(articles, toFolder: 1), IndexSet(0..<3))
+        // The articles are already in the folder.
+        let moreArticles = [articles[1]] + makeArticles(count: 2, prefix: "more")
+        XCTAssertEqual(database.addArticles(moreArticles, toFolder: 1), IndexSet([1, 2]))
+        XCTAssertEqual(countOfRows("SELECT message_id FROM messages WHERE folder_id = 1"), 5)
+        XCTAssertEqual(countOfRows("SELECT message_id FROM rss_guids WHERE folder_id = 1"), 5)
+        XCTAssertEqual(database.guidHistory(forFolderId: 1), Set(["batch-0", "batch-1", "batch-2", "more-0", "more-1"]))
+    }
+
+}
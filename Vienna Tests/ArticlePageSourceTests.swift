@@ -0,0 +1,67 @@
+//
+//  ArticlePageSourceTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests loading the articles of a folder in pages.
+class ArticlePageSourceTests: DatabaseTestCase {
+
+    func loadAllPages(of source: VNAArticlePageSource) -> [Article] {
+        var articles: [Article] = []
+        while !source.isExhausted {
+            articles += source.nextPage()
+        }
+        return articles
+    }
+
+    func testArticlePagesFollowSortOrder() throws {
+        populateFeeds(feedCount: 3, articleCount: 20)
+        groupFeeds()
+
+        let dateKey = "articleData.\(MA_Field_LastUpdate)"
+        let byDate = try XCTUnwrap(VNAArticlePageSource(database: database, folderId: 1000, filterString: "",
+                                                        sortDescriptor: NSSortDescriptor(key: dateKey, ascending: false),
+                                                        pageSize: 7))
+        let articlesByDate = loadAllPages(of: byDate)
+        XCTAssertEqual(articlesByDate.count, 60)
+        XCTAssertEqual(Set(articlesByDate.map(\.guid)).count, 60)
+        let dates = articlesByDate.compactMap(\.lastUpdate)
+        XCTAssertEqual(dates, dates.sorted(by: >))
+
+        // Most articles have the same read flag, so the pages must not lose
+        // or repeat articles with equal sort values.
+        let byReadFlag = try XCTUnwrap(VNAArticlePageSource(database: database, folderId: 1000, filterString: "",
+                                                            sortDescriptor: NSSortDescriptor(key: "isRead", ascending: true),
+                                                            pageSize: 7))
+        let articlesByReadFlag = loadAllPages(of: byReadFlag)
+        XCTAssertEqual(Set(articlesByReadFlag.map(\.guid)).count, 60)
+        XCTAssertEqual(articlesByReadFlag.map(\.isRead), articlesByReadFlag.map(\.isRead).sorted { !$0 && $1 })
+
+        let filtered = try XCTUnwrap(VNAArticlePageSource(database: database, folderId: 1000, filterString: "keyword42 end",
+                                                          sortDescriptor: NSSortDescriptor(key: dateKey, ascending: true),
+                                                          pageSize: 7))
+        XCTAssertEqual(loadAllPages(of: filtered).map(\.guid), ["guid-42"])
+
+        XCTAssertNil(VNAArticlePageSource(database: database, folderId: 1000, filterString: "",
+                                          sortDescriptor: NSSortDescriptor(key: "containingFolder.name", ascending: true),
+                                          pageSize: 7))
+    }
+
+}
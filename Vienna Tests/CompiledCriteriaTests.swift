@@ -0,0 +1,54 @@
+//
+//  CompiledCriteriaTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the parameterized SQL of criteria against the articles of a
+/// database.
+class CompiledCriteriaTests: DatabaseTestCase {
+
+    func testCriteriaWithSameStructureShareSQL() throws {
+        populateFeeds(feedCount: 4, articleCount: 100)
+        _ = database.arrayOfAllFolders()
+        func criteria(feed: Int, title: String) -> CriteriaTree {
+            CriteriaTree(subtree: [
+                Criteria(field: MA_Field_Folder, operatorType: .equalTo, value: "Feed \(feed)"),
+                Criteria(field: MA_Field_Read, operatorType: .equalTo, value: "No"),
+                Criteria(field: MA_Field_Subject, operatorType: .equalTo, value: title),
+            ], condition: .any)
+        }
+
+        let first = criteria(feed: 1, title: "Article 1").compiledSQL(database: database)
+        let second = criteria(feed: 2, title: "Bob's article").compiledSQL(database: database)
+        XCTAssertEqual(first.sql, second.sql)
+        XCTAssertFalse(first.sql.contains("Article"))
+        XCTAssertEqual(second.arguments.last as? String, "Bob's article")
+        XCTAssertTrue(second.resolvedSQL.contains("'Bob''s article'"))
+
+        // The bound arguments select the same articles as the resolved SQL.
+        for tree in [criteria(feed: 1, title: "Article 1"), criteria(feed: 2, title: "Bob's article")] {
+            let folderId = database.addSmartFolder("Smart folder", underParent: VNAFolderType.root.rawValue, withQuery: tree)
+            let resolvedSQL = tree.compiledSQL(database: database).resolvedSQL
+            XCTAssertEqual(guidsOfArticles(inFolder: folderId).count, countOfRows("SELECT id FROM messages WHERE \(resolvedSQL)"))
+            XCTAssertTrue(database.deleteFolder(folderId))
+        }
+    }
+
+}
@@ -39,9 +39,11 @@ class CriteriaTests: XCTestCase {
 
         XCTAssertTrue(testCriteriaTree.criteriaTree.first is Criteria, "Pass")
 
-        let sqlString = testCriteriaTree.toSQL(database: database)
+        let compiledSQL = testCriteriaTree.compiledSQL(database: database)
 
-        XCTAssertEqual("\"\(flaggedField.sqlField!)\" = 1", sqlString, "Sql correct")
+        XCTAssertEqual("\"\(flaggedField.sqlField!)\" = ?", compiledSQL.sql, "Sql correct")
+        XCTAssertEqual(compiledSQL.arguments as? [Int], [1], "Arguments correct")
+        XCTAssertEqual("\"\(flaggedField.sqlField!)\" = 1", compiledSQL.resolvedSQL, "Resolved sql correct")
     }
 
     func testCriteriaTreeInitWithString2() {
@@ -65,7 +67,7 @@ class CriteriaTests: XCTestCase {
         let allCriteria = testCriteriaTree.criteriaTree
         XCTAssertGreaterThan(allCriteria.count, 1, "Pass")
 
-        let sqlString = testCriteriaTree.toSQL(database: database)
+        let sqlString = testCriteriaTree.compiledSQL(database: database).resolvedSQL
 
         XCTAssert(sqlString.contains("\"\(flaggedField.sqlField!)\" = 1"), "Sql \(sqlString) contains flagged criterion")
     }
@@ -93,11 +95,11 @@ class CriteriaTests: XCTestCase {
             fatalError("cannot happen")
         }
 
-        let sqlString = testCriteriaTree.toSQL(database: database)
+        let sqlString = testCriteriaTree.compiledSQL(database: database).resolvedSQL
 
         XCTAssertEqual(sqlString, "\"\(flaggedField.sqlField!)\" = 1 AND \"\(flaggedField.sqlField!)\" = 0 AND \"\(flaggedField.sqlField!)\" <> 1 AND \"\(flaggedField.sqlField!)\" <> 0", "Sql correct")
 
-        let sqlStringAfterPredicateConversion = CriteriaTree(predicate: testCriteriaTree.predicate)?.toSQL(database: database)
+        let sqlStringAfterPredicateConversion = CriteriaTree(predicate: testCriteriaTree.predicate)?.compiledSQL(database: database).resolvedSQL
 
         XCTAssertEqual(sqlStringAfterPredicateConversion, "\"\(flaggedField.sqlField!)\" = 1 AND \"\(flaggedField.sqlField!)\" = 0 AND \"\(flaggedField.sqlField!)\" = 0 AND \"\(flaggedField.sqlField!)\" = 1", "Canonicalization successful")
     }
@@ -155,7 +157,8 @@ class CriteriaTests: XCTestCase {
 
         let testCriteriaTree = genericConversionChecks(criteriaTreeString)
 
-        XCTAssertEqual(testCriteriaTree.toSQL(database: database), "\"\(subjectField.sqlField!)\" LIKE '%asdf%' AND ( \"\(flaggedField.sqlField!)\" = 1 OR \"\(flaggedField.sqlField!)\" = 0 )")
+        let subjectSQL = database.sqlFullTextScope(for: "asdf", column: subjectField.sqlField, flags: .inclusive) ?? "\"\(subjectField.sqlField!)\" LIKE '%' || 'asdf' || '%'"
+        XCTAssertEqual(testCriteriaTree.compiledSQL(database: database).resolvedSQL, "\(subjectSQL) AND ( \"\(flaggedField.sqlField!)\" = 1 OR \"\(flaggedField.sqlField!)\" = 0 )")
     }
 
     func testNestedNotCriteriaSQLConversion() {
@@ -180,7 +183,8 @@ class CriteriaTests: XCTestCase {
 
         let testCriteriaTree = genericConversionChecks(criteriaTreeString)
 
-        XCTAssertEqual(testCriteriaTree.toSQL(database: database), "\"\(subjectField.sqlField!)\" LIKE '%asdf%' AND ( NOT \"\(flaggedField.sqlField!)\" = 1 AND NOT \"\(flaggedField.sqlField!)\" = 0 )")
+        let subjectSQL = database.sqlFullTextScope(for: "asdf", column: subjectField.sqlField, flags: .inclusive) ?? "\"\(subjectField.sqlField!)\" LIKE '%' || 'asdf' || '%'"
+        XCTAssertEqual(testCriteriaTree.compiledSQL(database: database).resolvedSQL, "\(subjectSQL) AND ( NOT \"\(flaggedField.sqlField!)\" = 1 AND NOT \"\(flaggedField.sqlField!)\" = 0 )")
     }
 
     func testAllCriteriaConditions() {
@@ -249,6 +253,45 @@ class CriteriaTests: XCTestCase {
         genericConversionChecks(testCriteriaString)
     }
 
+    func testContainsMatchesStartOfWords() throws {
+        // The articles are added to a separate database.
+        let databaseURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathExtension("db")
+        let database = try XCTUnwrap(Database(path: databaseURL.path))
+        defer {
+            database.close()
+            for suffix in ["", "-wal", "-shm", ".folders"] {
+                try? FileManager.default.removeItem(atPath: databaseURL.path + suffix)
+            }
+        }
+        try XCTSkipUnless(database.isFullTextSearchAvailable, "The SQLite library lacks FTS5")
+        _ = database.arrayOfAllFolders()
+        let root = VNAFolderType.root.rawValue
+        let feed = database.addRSSFolder("Feed", underParent: root, afterChild: 0, subscriptionURL: "https://example.com/feed")
+        let article = Article(guid: "example")
+        article.title = "An example article"
+        article.body = "Examples of words"
+        XCTAssertEqual(database.addArticles([article], toFolder: feed), IndexSet([0]))
+
+        // With the full-text index, "contains" matches the words that start
+        // with the value rather than any substring.
+        let searches = [
+            (MA_Field_Subject, "exam", true),
+            (MA_Field_Subject, "example art", true),
+            (MA_Field_Subject, "ample", false),
+            (MA_Field_Text, "examples of", true),
+            (MA_Field_Text, "amples", false),
+        ]
+        for (field, value, matches) in searches {
+            let criteriaTree = CriteriaTree(subtree: [Criteria(field: field, operatorType: .contains, value: value)], condition: .all)
+            let folderId = database.addSmartFolder("\(field) contains \(value)", underParent: root, withQuery: criteriaTree)
+            let articles: [Article] = database.arrayOfArticles(folderId, filterString: "")
+            XCTAssertEqual(articles.map(\.guid), matches ? ["example"] : [], "\(field) contains \(value)")
+            XCTAssertTrue(database.deleteFolder(folderId))
+        }
+    }
+
     @discardableResult
     private func genericConversionChecks(_ criteriaTreeString: String) -> CriteriaTree {
         guard let testCriteriaTree = CriteriaTree(string: criteriaTreeString) else {
@@ -259,7 +302,8 @@ class CriteriaTests: XCTestCase {
         let treeStringUnformatted: String = criteriaTreeString.replacingOccurrences(of: "\n", with: "").replacingOccurrences(of: VNASubfolderIndentation, with: "")
         XCTAssertEqual(treeStringUnformatted, testCriteriaTree.string, "XML reproducible")
 
-        XCTAssertNotNil(testCriteriaTree.toSQL(database: getDatabase()))
+        let compiledSQL = testCriteriaTree.compiledSQL(database: getDatabase())
+        XCTAssertEqual(compiledSQL.sql.filter { $0 == "?" }.count, compiledSQL.arguments.count, "One argument per placeholder")
 
         XCTAssertEqual(CriteriaTree(predicate: testCriteriaTree.predicate)!.string, treeStringUnformatted, "Still same xml after converting to predicate and back")
 
@@ -0,0 +1,76 @@
+//
+//  DatabaseBackupTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the snapshots of the database and restoring them.
+class DatabaseBackupTests: DatabaseTestCase {
+
+    func testSnapshotsAreCheckedRotatedAndRestored() throws {
+        populateFeeds(feedCount: 2, articleCount: 30)
+        let backup = VNADatabaseBackup(database: database)
+        backup.directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        defer { try? FileManager.default.removeItem(at: backup.directoryURL) }
+        backup.pagesPerStep = 1
+        backup.pauseBetweenSteps = 0
+        backup.maximumCountOfSnapshots = 2
+
+        // Only the two newest of three snapshots are kept.
+        var snapshotURLs: [URL] = []
+        for _ in 1...3 {
+            snapshotURLs.append(try backup.takeSnapshot())
+            Thread.sleep(forTimeInterval: 0.01)
+        }
+        XCTAssertEqual(backup.snapshotURLs, snapshotURLs.suffix(2).reversed())
+        XCTAssertFalse(FileManager.default.fileExists(atPath: snapshotURLs[0].path))
+
+        // A snapshot is a single file with all articles.
+        var snapshot: OpaquePointer?
+        XCTAssertEqual(sqlite3_open(snapshotURLs[2].path, &snapshot), SQLITE_OK)
+        var statement: OpaquePointer?
+        XCTAssertEqual(sqlite3_prepare_v2(snapshot, "SELECT (SELECT COUNT(*) FROM messages), (SELECT journal_mode FROM pragma_journal_mode)", -1, &statement, nil), SQLITE_OK)
+        XCTAssertEqual(sqlite3_step(statement), SQLITE_ROW)
+        XCTAssertEqual(sqlite3_column_int(statement, 0), 60)
+        XCTAssertEqual(String(cString: sqlite3_column_text(statement, 1)), "delete")
+        sqlite3_finalize(statement)
+        sqlite3_close(snapshot)
+
+        // A damaged snapshot does not replace the database, the newest one
+        // brings back the deleted articles.
+        let damagedURL = snapshotURLs[1]
+        let handle = try FileHandle(forWritingTo: damagedURL)
+        try handle.seek(toOffset: 8192)
+        handle.write(Data(count: 4096))
+        try handle.close()
+
+        XCTAssertEqual(sqlite3_exec(connection, "DELETE FROM messages", nil, nil, nil), SQLITE_OK)
+        sqlite3_close(connection)
+        database.close()
+        XCTAssertThrowsError(try VNADatabaseBackup.restoreSnapshot(at: damagedURL, toDatabaseAtPath: databaseURL.path))
+        try VNADatabaseBackup.restoreSnapshot(at: snapshotURLs[2], toDatabaseAtPath: databaseURL.path)
+
+        database = Database(path: databaseURL.path)
+        XCTAssertNotNil(database)
+        XCTAssertEqual(sqlite3_open(databaseURL.path, &connection), SQLITE_OK)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages"), 60)
+    }
+
+}
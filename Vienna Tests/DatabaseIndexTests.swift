@@ -0,0 +1,63 @@
+//
+//  DatabaseIndexTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests that the statements that run per article or per folder refresh
+/// use the indexes of the messages table.
+class DatabaseIndexTests: DatabaseTestCase {
+
+    func testHotStatementsUseIndexes() {
+        populate(articleCount: 1000)
+        XCTAssertEqual(sqlite3_exec(connection, "ANALYZE", nil, nil, nil), SQLITE_OK)
+
+        // Statements of Database that run per article or per folder refresh.
+        let statements = [
+            "SELECT date, (SELECT body FROM message_bodies WHERE message_bodies.id = messages.id), enclosure FROM messages WHERE folder_id=? AND message_id=?",
+            "SELECT read_flag FROM messages WHERE folder_id=? AND message_id=?",
+            "SELECT message_id FROM messages WHERE folder_id=? AND read_flag=0",
+            "SELECT message_id, read_flag, marked_flag, deleted_flag, title, link, revised_flag FROM messages WHERE folder_id=?",
+            "SELECT deleted_flag FROM messages WHERE deleted_flag=1",
+            "UPDATE messages SET parent_id=?, sender=?, link=?, date=?, read_flag=0, title=?, revised_flag=?, enclosure=?, hasenclosure_flag=? WHERE folder_id=? AND message_id=?",
+            "UPDATE message_bodies SET body=? WHERE id=(SELECT id FROM messages WHERE folder_id=? AND message_id=?)",
+            "UPDATE messages SET read_flag=? WHERE folder_id=? AND message_id=?",
+            "UPDATE messages SET read_flag=1 WHERE folder_id=? AND read_flag=0",
+            "UPDATE messages SET read_flag=1 WHERE folder_id=1 AND read_flag=0 AND message_id NOT IN ('guid-1')",
+            "UPDATE messages SET read_flag=0 WHERE folder_id=1 AND read_flag=1 AND message_id IN ('guid-1')",
+            "UPDATE messages SET marked_flag=? WHERE folder_id=? AND message_id=?",
+            "UPDATE messages SET marked_flag=0 WHERE folder_id=? AND marked_flag=1",
+            "UPDATE messages SET marked_flag=1 WHERE folder_id=1 AND marked_flag=0 AND message_id IN ('guid-1')",
+            "UPDATE messages SET deleted_flag=? WHERE folder_id=? AND message_id=?",
+            "DELETE FROM messages WHERE folder_id=? AND message_id=?",
+            "DELETE FROM messages WHERE folder_id=?",
+            "DELETE FROM messages WHERE deleted_flag=1",
+        ]
+        for statement in statements {
+            let details = queryPlan(statement)
+            XCTAssertFalse(details.isEmpty, statement)
+            for detail in details {
+                XCTAssertFalse(detail.hasPrefix("SCAN messages") || detail.hasPrefix("SCAN TABLE messages"),
+                               "\(statement) uses a full scan: \(detail)")
+            }
+        }
+    }
+
+}
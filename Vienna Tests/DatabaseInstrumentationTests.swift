@@ -0,0 +1,63 @@
+//
+//  DatabaseInstrumentationTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the opt-in instrumentation of the statements of the database.
+class DatabaseInstrumentationTests: DatabaseTestCase {
+
+    func testNormalizedSQL() {
+        let sql = "SELECT id FROM messages\n   WHERE folder_id IN (2, 3,4) AND title = 'It''s 1' LIMIT 10"
+        XCTAssertEqual(VNADatabaseInstrumentation.normalizedSQL(sql), "SELECT id FROM messages WHERE folder_id IN (?) AND title = ? LIMIT ?")
+    }
+
+    func testInstrumentationRecordsStatementsAndBlocks() throws {
+        populateFeeds(feedCount: 2, articleCount: 10)
+        let instrumentation = VNADatabaseInstrumentation()
+        database.instrumentation = instrumentation
+
+        // A query of a reader connection, twice, and a transaction of the
+        // writer connection
+        XCTAssertEqual(database.countOfDeletedArticles, 0)
+        XCTAssertEqual(database.countOfDeletedArticles, 0)
+        database.markGuids(["guid-1", "guid-2"], seenInFolder: 2)
+
+        let statistics = instrumentation.statementStatistics
+        let count = try XCTUnwrap(statistics.first { $0["sql"] as? String == "SELECT COUNT(*) FROM messages WHERE deleted_flag=?" })
+        XCTAssertEqual(count["executions"] as? Int, 2)
+        XCTAssertEqual(count["rows"] as? Int, 2)
+        XCTAssertEqual(count["blocks"] as? Int, 2)
+        let update = try XCTUnwrap(statistics.first { ($0["sql"] as? String)?.hasPrefix("UPDATE rss_guids") == true })
+        XCTAssertEqual(update["executions"] as? Int, 2)
+        XCTAssertEqual(update["blocks"] as? Int, 1)
+        let holdTime = try XCTUnwrap(update["holdTime"] as? [String: Double])
+        XCTAssertGreaterThan(try XCTUnwrap(holdTime["total"]), 0)
+
+        let export = try JSONSerialization.jsonObject(with: instrumentation.jsonData()) as? [String: Any]
+        XCTAssertEqual((export?["statements"] as? [Any])?.count, statistics.count)
+
+        // Nothing is recorded once the instrumentation is removed.
+        database.instrumentation = nil
+        instrumentation.reset()
+        XCTAssertEqual(database.countOfDeletedArticles, 0)
+        XCTAssertTrue(instrumentation.statementStatistics.isEmpty)
+    }
+
+}
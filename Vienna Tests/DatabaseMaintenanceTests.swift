@@ -0,0 +1,51 @@
+//
+//  DatabaseMaintenanceTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the maintenance that releases the free pages of the database in steps.
+class DatabaseMaintenanceTests: DatabaseTestCase {
+
+    func testMaintenanceReleasesFreePages() throws {
+        XCTAssertTrue(database.isIncrementalVacuumEnabled)
+        populateFeeds(feedCount: 10, articleCount: 500)
+        XCTAssertEqual(sqlite3_exec(connection, "DELETE FROM messages WHERE id > 2500", nil, nil, nil), SQLITE_OK)
+        let statistics = database.storageStatistics
+        XCTAssertGreaterThan(statistics.freePageCount, 0)
+        XCTAssertTrue(database.tablesWithoutStatistics().contains("messages"))
+
+        let maintenance = VNADatabaseMaintenance(database: database)
+        maintenance.pauseBetweenSteps = 0
+        XCTAssertGreaterThan(maintenance.fragmentation, 0)
+
+        maintenance.idleCondition = { false }
+        XCTAssertFalse(maintenance.runSteps())
+        XCTAssertEqual(database.storageStatistics.freePageCount, statistics.freePageCount)
+
+        maintenance.idleCondition = nil
+        XCTAssertTrue(maintenance.runSteps())
+        XCTAssertEqual(maintenance.statistics.freePageCount, 0)
+        XCTAssertLessThan(maintenance.statistics.pageCount, statistics.pageCount)
+        XCTAssertEqual(maintenance.fragmentation, 0)
+        XCTAssertFalse(database.tablesWithoutStatistics().contains("messages"))
+    }
+
+}
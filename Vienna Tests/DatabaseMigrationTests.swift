@@ -0,0 +1,113 @@
+//
+//  DatabaseMigrationTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the schema migrations that run in resumable chunks.
+class DatabaseMigrationTests: DatabaseTestCase {
+
+    func testChunkedMigrationResumesAfterInterruption() throws {
+        populateFeeds(feedCount: 1, articleCount: 100)
+        let db = try XCTUnwrap(FMDatabase(url: databaseURL))
+        XCTAssertTrue(db.open())
+        defer { db.close() }
+        var chunks: [(afterRowId: Int64, lastRowId: Int64)] = []
+        func migrate(step: String, failingChunk: Int? = nil, stopping progress: Progress? = nil) -> Bool {
+            Database.migrateRows(ofTable: "messages", on: db, step: step, chunkSize: 30) { afterRowId, lastRowId in
+                chunks.append((afterRowId, lastRowId))
+                progress?.cancel()
+                return chunks.count != failingChunk &&
+                    db.executeUpdate("UPDATE messages SET revised_flag = 1 WHERE rowid > ? AND rowid <= ?",
+                                     withArgumentsIn: [afterRowId, lastRowId])
+            }
+        }
+
+        // The failed chunk is rolled back, the committed ones are recorded.
+        XCTAssertFalse(migrate(step: "revised", failingChunk: 3))
+        XCTAssertEqual(chunks.count, 3)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE revised_flag = 1"), 60)
+        let checkpoint = chunks[1].lastRowId
+        XCTAssertEqual(countOfRows("SELECT version FROM info WHERE migration_step = 'revised' AND migration_rowid = \(checkpoint)"), 1)
+
+        // The step resumes after the last committed chunk and clears the
+        // checkpoint when it is done.
+        chunks = []
+        XCTAssertTrue(migrate(step: "revised"))
+        XCTAssertEqual(chunks.first?.afterRowId, checkpoint)
+        XCTAssertEqual(chunks.count, 2)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE revised_flag = 1"), 100)
+        XCTAssertEqual(countOfRows("SELECT version FROM info WHERE migration_step IS NULL"), 1)
+
+        // A cancelled migration stops after the current chunk and reports the
+        // migrated rows to the current progress.
+        let progress = Progress(totalUnitCount: 1)
+        progress.becomeCurrent(withPendingUnitCount: 1)
+        chunks = []
+        XCTAssertFalse(migrate(step: "cancelled", stopping: progress))
+        progress.resignCurrent()
+        XCTAssertEqual(chunks.count, 1)
+        XCTAssertEqual(progress.fractionCompleted, 0.3, accuracy: 0.001)
+        XCTAssertEqual(countOfRows("SELECT version FROM info WHERE migration_step = 'cancelled'"), 1)
+    }
+
+    func testMessagesTableRebuildResumesAfterInterruption() throws {
+        // A messages table of version 28 with duplicates of guid-2, whose
+        // rebuild was interrupted after the first article was copied.
+        let url = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathExtension("db")
+        let db = try XCTUnwrap(FMDatabase(url: url))
+        XCTAssertTrue(db.open())
+        defer {
+            db.close()
+            try? FileManager.default.removeItem(at: url)
+        }
+        let columns = "message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender, link, createddate, date, text, revised_flag, enclosuredownloaded_flag, hasenclosure_flag, enclosure"
+        XCTAssertTrue(db.executeStatements("""
+            CREATE TABLE info (version, migration_step TEXT, migration_rowid INTEGER);
+            INSERT INTO info VALUES (28, 'messages_new', 1);
+            CREATE TABLE messages (\(columns));
+            CREATE INDEX messages_message_idx ON messages (message_id);
+            INSERT INTO messages (message_id, folder_id, title)
+            VALUES ('guid-1', 2, 'One'), ('guid-2', 2, 'Two'), ('guid-2', 2, 'Duplicate'), ('guid-2', 3, 'Other folder');
+            CREATE TABLE messages_new (id INTEGER PRIMARY KEY, \(columns));
+            INSERT INTO messages_new (id, message_id, folder_id, title) VALUES (1, 'guid-1', 2, 'One');
+            """))
+
+        func articles() throws -> [String] {
+            var rows: [String] = []
+            let results = try db.executeQuery("SELECT id, title FROM messages ORDER BY id", values: nil)
+            while results.next() {
+                rows.append("\(results.long(forColumnIndex: 0)) \(results.string(forColumnIndex: 1) ?? "")")
+            }
+            results.close()
+            return rows
+        }
+        XCTAssertTrue(Database.migrateDatabase(db, fromVersion: 28, toVersion: 29, progress: Progress()))
+        XCTAssertEqual(try articles(), ["1 One", "2 Two", "4 Other folder"])
+        XCTAssertFalse(db.tableExists("messages_new"))
+        XCTAssertEqual(db.userVersion, 29)
+
+        // Once the tables were swapped, the step has nothing left to do.
+        XCTAssertTrue(Database.migrateDatabase(db, fromVersion: 28, toVersion: 29, progress: Progress()))
+        XCTAssertEqual(try articles(), ["1 One", "2 Two", "4 Other folder"])
+    }
+
+}
@@ -0,0 +1,639 @@
+//
+//  DatabasePerformanceTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Reports the performance of the database with a synthetic database of
+/// production size. The benchmarks only run if the `VIENNA_RUN_BENCHMARKS`
+/// environment variable is set, because they take minutes to populate it.
+class DatabasePerformanceTests: DatabaseTestCase {
+
+    static let benchmarkEnvironmentKey = "VIENNA_RUN_BENCHMARKS"
+
+    var runsBenchmarks: Bool {
+        ProcessInfo.processInfo.environment[Self.benchmarkEnvironmentKey] != nil
+    }
+
+    // MARK: Helpers
+
+    /// Returns the value below which the given fraction of the values lie.
+    func percentile(_ fraction: Double, of values: [Double]) -> Double {
+        let sortedValues = values.sorted()
+        let index = Int((Double(sortedValues.count - 1) * fraction).rounded())
+        return sortedValues[index]
+    }
+
+    /// Returns the time that the block takes in milliseconds.
+    func milliseconds(of block: () throws -> Void) rethrows -> Double {
+        let start = DispatchTime.now()
+        try block()
+        return Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000_000
+    }
+
+    /// Keeps the report of a benchmark with the results of the test run,
+    /// where Xcode shows it with the test.
+    func attachReport(_ report: String) {
+        let attachment = XCTAttachment(string: report)
+        attachment.name = name
+        attachment.lifetime = .keepAlways
+        add(attachment)
+    }
+
+    // MARK: Concurrency
+
+    func testFolderOpenLatencyDuringRefresh() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+
+        // Create 500 feeds with 200 articles each.
+        let feedCount = 500
+        populateFeeds(feedCount: feedCount, articleCount: 200)
+
+        // Refresh every feed with 20 new articles, one transaction per
+        // article like the refresh code does, while opening folders.
+        let database = self.database!
+        let refresh = DispatchGroup()
+        DispatchQueue.global(qos: .utility).async(group: refresh) {
+            for folderId in 2...(feedCount + 1) {
+                for index in 0..<20 {
+                    let article = Article(guid: "refresh-\(folderId)-\(index)")
+                    article.title = "Refreshed article \(index)"
+                    article.author = "Sender"
+                    article.link = "https://example.com/\(folderId)/\(index)"
+                    article.body = String(repeating: "Lorem ipsum dolor sit amet. ", count: 100)
+                    XCTAssertTrue(database.addArticle(article, toFolder: folderId))
+                }
+            }
+        }
+
+        var latencies: [Double] = []
+        while refresh.wait(timeout: .now()) == .timedOut {
+            let folderId = 2 + latencies.count % feedCount
+            latencies.append(milliseconds {
+                _ = database.arrayOfArticles(folderId, filterString: "")
+            })
+        }
+
+        XCTAssertFalse(latencies.isEmpty)
+        let report = String(format: "Folder open latency during refresh: p50 %.2f ms, p99 %.2f ms (%d samples)",
+                            percentile(0.5, of: latencies), percentile(0.99, of: latencies), latencies.count)
+        attachReport(report)
+    }
+
+    // MARK: Article ingestion
+
+    /// Reports the throughput of adding 1,000 articles to a folder with the
+    /// given method.
+    func measureIngestion(_ name: String, ingest: @escaping ([Article]) -> Void) {
+        var iteration = 0
+        var durations: [Double] = []
+        measure {
+            let articles = makeArticles(count: 1000, prefix: "\(name)-\(iteration)")
+            iteration += 1
+            durations.append(milliseconds {
+                ingest(articles)
+            })
+        }
+        attachReport(String(format: "%@: %.0f articles/s", name, 1_000_000 / percentile(0.5, of: durations)))
+    }
+
+    func testAddArticlePerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        let database = self.database!
+        measureIngestion("One transaction per article") { articles in
+            for article in articles {
+                _ = database.addArticle(article, toFolder: 1)
+            }
+        }
+    }
+
+    func testAddArticlesPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        let database = self.database!
+        measureIngestion("One transaction per feed") { articles in
+            _ = database.addArticles(articles, toFolder: 1)
+        }
+    }
+
+    // MARK: Full-text search
+
+    func testPatternSearchPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populate(articleCount: 1_000_000)
+
+        measure {
+            _ = countOfRows("SELECT rowid FROM messages WHERE title LIKE '%keyword42 end%' OR rowid IN (SELECT id FROM message_bodies WHERE vna_inflate(body) LIKE '%keyword42 end%')")
+        }
+    }
+
+    func testFullTextSearchPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        try XCTSkipUnless(database.isFullTextSearchAvailable, "The SQLite library lacks FTS5")
+        populate(articleCount: 1_000_000)
+
+        let scope = try XCTUnwrap(database.sqlFullTextScope(for: "keyword42 end", column: nil, flags: .inclusive))
+        measure {
+            _ = countOfRows("SELECT rowid FROM messages WHERE \(scope)")
+        }
+    }
+
+    // MARK: Body store
+
+    /// Returns the time to read the articles of each folder with the columns
+    /// that a folder is opened with, reading the bodies with the given
+    /// expression.
+    func folderOpenLatencies(of db: FMDatabase, folderIds: ClosedRange<Int>, bodyColumn: String) throws -> [Double] {
+        let sql = """
+            SELECT message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender,
+                   link, createddate, date, \(bodyColumn), revised_flag, hasenclosure_flag, enclosure
+            FROM messages WHERE folder_id = ?
+            """
+        return try folderIds.map { folderId in
+            try milliseconds {
+                let results = try db.executeQuery(sql, values: [folderId])
+                while results.next() {
+                    _ = results.data(forColumnIndex: 11)
+                }
+                results.close()
+            }
+        }
+    }
+
+    /// Reports the size of the database and how long it takes to open a
+    /// folder, against the same articles in a database of version 29, which
+    /// stored the bodies uncompressed in the text column of the messages
+    /// table and had no full-text index.
+    func testBodyStoreSizeAndFolderOpenLatency() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+
+        // Feed articles are HTML, which compresses better than this text.
+        let feedCount = 200
+        populateFeeds(feedCount: feedCount, articleCount: 1000)
+        let sql = """
+            UPDATE message_bodies SET body = vna_deflate(
+                '<p>' || vna_inflate(body) || '</p>' || replace(printf('%.100c', '_'), '_', '<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p>'));
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+
+        var statement: OpaquePointer?
+        XCTAssertEqual(sqlite3_prepare_v2(connection, "SELECT SUM(length(body)), SUM(length(vna_inflate(body))) FROM message_bodies", -1, &statement, nil), SQLITE_OK)
+        XCTAssertEqual(sqlite3_step(statement), SQLITE_ROW)
+        let compressedSize = sqlite3_column_int64(statement, 0)
+        let uncompressedSize = sqlite3_column_int64(statement, 1)
+        sqlite3_finalize(statement)
+
+        // The same articles in a messages table of version 28, migrated to
+        // version 29 like the database of a user was.
+        let legacyURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathExtension("db")
+        defer {
+            try? FileManager.default.removeItem(at: legacyURL)
+        }
+        let columns = "message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender, link, createddate, date, text, revised_flag, enclosuredownloaded_flag, hasenclosure_flag, enclosure"
+        let legacySQL = """
+            ATTACH DATABASE '\(legacyURL.path)' AS legacy;
+            CREATE TABLE legacy.info (version);
+            INSERT INTO legacy.info VALUES (28);
+            CREATE TABLE legacy.messages (\(columns));
+            INSERT INTO legacy.messages (\(columns))
+            SELECT message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender, link, createddate, date,
+                   vna_inflate(message_bodies.body), revised_flag, enclosuredownloaded_flag, hasenclosure_flag, enclosure
+            FROM messages LEFT JOIN message_bodies ON message_bodies.id = messages.id
+            ORDER BY messages.id;
+            DETACH DATABASE legacy;
+            """
+        XCTAssertEqual(sqlite3_exec(connection, legacySQL, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        let legacy = try XCTUnwrap(FMDatabase(url: legacyURL))
+        XCTAssertTrue(legacy.open())
+        defer { legacy.close() }
+        XCTAssertTrue(Database.migrateDatabase(legacy, fromVersion: 28, toVersion: 29, progress: Progress()))
+
+        // Neither database keeps the pages that the fixture freed.
+        XCTAssertTrue(legacy.executeStatements("VACUUM"))
+        XCTAssertEqual(sqlite3_exec(connection, "VACUUM; PRAGMA wal_checkpoint(TRUNCATE)", nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        func fileSize(_ url: URL) throws -> Int64 {
+            try XCTUnwrap((FileManager.default.attributesOfItem(atPath: url.path)[.size] as? NSNumber)?.int64Value)
+        }
+        let size = try fileSize(databaseURL)
+        let legacySize = try fileSize(legacyURL)
+
+        let current = try XCTUnwrap(FMDatabase(url: databaseURL))
+        XCTAssertTrue(current.open())
+        defer { current.close() }
+        let folderIds = 2...(feedCount + 1)
+        let latencies = try folderOpenLatencies(of: current, folderIds: folderIds,
+                                                bodyColumn: "(SELECT body FROM message_bodies WHERE message_bodies.id = messages.id)")
+        let legacyLatencies = try folderOpenLatencies(of: legacy, folderIds: folderIds, bodyColumn: "text")
+
+        let formatter = ByteCountFormatter()
+        let report = String(format: "Database size %@ against %@ with version 29, bodies %@ compressed from %@. Folder open latency: p50 %.2f ms, p99 %.2f ms against p50 %.2f ms, p99 %.2f ms with version 29",
+                            formatter.string(fromByteCount: size),
+                            formatter.string(fromByteCount: legacySize),
+                            formatter.string(fromByteCount: compressedSize),
+                            formatter.string(fromByteCount: uncompressedSize),
+                            percentile(0.5, of: latencies), percentile(0.99, of: latencies),
+                            percentile(0.5, of: legacyLatencies), percentile(0.99, of: legacyLatencies))
+        attachReport(report)
+    }
+
+    // MARK: Article pages
+
+    func testTimeToFirstRow() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 5000)
+        groupFeeds()
+        let database = self.database!
+        _ = database.arrayOfAllFolders()
+
+        let sortDescriptor = NSSortDescriptor(key: "articleData.\(MA_Field_LastUpdate)", ascending: false)
+        let allArticles = milliseconds {
+            _ = (database.arrayOfArticles(1000, filterString: "") as NSArray).sortedArray(using: [sortDescriptor])
+        }
+        var pageSource: VNAArticlePageSource?
+        let firstPage = milliseconds {
+            pageSource = VNAArticlePageSource(database: database, folderId: 1000, filterString: "",
+                                              sortDescriptor: sortDescriptor, pageSize: 500)
+            XCTAssertEqual(pageSource?.nextPage().count, 500)
+        }
+        let nextPage = milliseconds {
+            XCTAssertEqual(pageSource?.nextPage().count, 500)
+        }
+
+        let report = String(format: "Time to first row of 500,000 articles: %.0f ms for all articles, %.0f ms for the first page, %.0f ms for the next page",
+                            allArticles, firstPage, nextPage)
+        attachReport(report)
+    }
+
+    // MARK: Folder tree
+
+    /// Reports the time to count and to load the first page of the articles
+    /// of a group of 300 feeds, when the group is expanded into a condition
+    /// per feed as before and when it is joined with the folder tree.
+    func testGroupScopeAgainstFolderConditions() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 300, articleCount: 1700)
+        groupFeeds()
+        _ = database.arrayOfAllFolders()
+        let group = try XCTUnwrap(database.folder(fromID: 1000))
+
+        let folderConditions = "(" + ([1000] + (2...301)).map { "folder_id=\($0)" }.joined(separator: " or ") + ")"
+        let folderTree = database.sqlScope(for: group, flags: [.subFolders, .inclusive], field: "folder_id")
+        func duration(of scope: String) -> (count: Double, page: Double) {
+            (milliseconds { _ = countOfRows("SELECT COUNT(*) FROM messages WHERE \(scope) AND read_flag = 0") },
+             milliseconds { _ = countOfRows("SELECT id FROM messages WHERE \(scope) ORDER BY date DESC, id DESC LIMIT 500") })
+        }
+        // Warm up the page cache first.
+        _ = duration(of: folderConditions)
+        let conditions = duration(of: folderConditions)
+        let tree = duration(of: folderTree)
+
+        let report = String(format: "Group of 300 feeds with 510,000 articles: %.1f ms to count the unread articles and %.1f ms for the first page with a condition per feed, %.1f ms and %.1f ms with the folder tree",
+                            conditions.count, conditions.page, tree.count, tree.page)
+        attachReport(report)
+    }
+
+    // MARK: Folder lookups
+
+    /// Reports the time to look up each of 3,000 feeds by its feed URL and by
+    /// its name, as the synchronization with an Open Reader server does, with
+    /// the indexes and with a scan of all folders as before.
+    func testFolderLookupPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 3000, articleCount: 1)
+        let folders = database.arrayOfAllFolders().compactMap { $0 as? Folder }
+        let feedURLs = (2...3001).map { "https://example.com/feed/\($0)" }
+        let names = (1...3000).map { "Feed \($0)" }
+
+        let indexed = milliseconds {
+            for (feedURL, name) in zip(feedURLs, names) {
+                XCTAssertNotNil(database.folder(fromFeedURL: feedURL))
+                XCTAssertNotNil(database.folder(fromName: name))
+            }
+        }
+        let scanned = milliseconds {
+            for (feedURL, name) in zip(feedURLs, names) {
+                XCTAssertNotNil(folders.first { $0.feedURL == feedURL })
+                XCTAssertNotNil(folders.first { $0.name == name })
+            }
+        }
+
+        let report = String(format: "Looking up 3,000 feeds by feed URL and name: %.1f ms with the indexes, %.1f ms with a scan of all folders",
+                            indexed, scanned)
+        attachReport(report)
+    }
+
+    // MARK: Smart folders
+
+    /// Reports the time to load the first page of 40 smart folders when their
+    /// criteria are evaluated, when their members are computed and when their
+    /// members are stored.
+    func testSwitchingSmartFolders() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 5000)
+        _ = database.arrayOfAllFolders()
+
+        let folderIds = (0..<40).map { index in
+            let criteria = CriteriaTree(subtree: [
+                Criteria(field: MA_Field_Flagged, operatorType: .equalTo, value: "Yes"),
+                Criteria(field: MA_Field_Read, operatorType: .equalTo, value: "No"),
+                Criteria(field: MA_Field_Folder, operatorType: .notEqualTo, value: "Feed \(index + 1)"),
+            ], condition: .all)
+            return database.addSmartFolder("Smart folder \(index)", underParent: VNAFolderType.root.rawValue, withQuery: criteria)
+        }
+        let sortDescriptor = NSSortDescriptor(key: "articleData.\(MA_Field_LastUpdate)", ascending: false)
+        func switchThroughFolders() -> Double {
+            milliseconds {
+                for folderId in folderIds {
+                    let source = VNAArticlePageSource(database: database, folderId: folderId, filterString: "",
+                                                      sortDescriptor: sortDescriptor, pageSize: 500)
+                    _ = source?.nextPage()
+                }
+            } / Double(folderIds.count)
+        }
+        func countOfFoldersWithStoredMembers() -> Int {
+            countOfRows("SELECT folder_id FROM smart_folders WHERE member_sql IS NOT NULL")
+        }
+
+        // Without stored members or recorded changes, and with a database
+        // that was just opened, the first read of a folder evaluates its
+        // criteria. The second read computes the members and the third reads
+        // the stored members.
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE smart_folders SET member_sql = NULL; DELETE FROM smart_folder_members; DELETE FROM smart_folder_changes", nil, nil, nil), SQLITE_OK)
+        database.close()
+        database = Database(path: databaseURL.path)
+        _ = database.arrayOfAllFolders()
+
+        let evaluated = switchThroughFolders()
+        XCTAssertEqual(countOfFoldersWithStoredMembers(), 0)
+        XCTAssertEqual(countOfRows("SELECT id FROM smart_folder_members"), 0)
+        let computed = switchThroughFolders()
+        XCTAssertEqual(countOfFoldersWithStoredMembers(), folderIds.count)
+        let stored = switchThroughFolders()
+        XCTAssertEqual(countOfFoldersWithStoredMembers(), folderIds.count)
+
+        // The stored members are only checked again for the changed articles.
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE messages SET read_flag = 1 WHERE id % 100 = 0", nil, nil, nil), SQLITE_OK)
+        let updated = switchThroughFolders()
+        XCTAssertEqual(countOfFoldersWithStoredMembers(), folderIds.count)
+        XCTAssertEqual(countOfRows("SELECT id FROM smart_folder_changes"), 0)
+
+        let report = String(format: "First page of a smart folder over 500,000 articles: %.1f ms with the criteria, %.1f ms computing the members, %.1f ms with stored members, %.1f ms after marking 5,000 articles read",
+                            evaluated, computed, stored, updated)
+        attachReport(report)
+    }
+
+    // MARK: Criteria SQL
+
+    /// Reports the time to read the first page of a smart folder when 40
+    /// smart folders with criteria of the same structure are read in turn,
+    /// once with the cache of compiled templates emptied before every read
+    /// and once with the cached template.
+    func testRepeatedSmartFolderQueries() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 200)
+        _ = database.arrayOfAllFolders()
+        let folderIds = (1...40).map { feed in
+            let criteria = CriteriaTree(subtree: [
+                Criteria(field: MA_Field_Folder, operatorType: .equalTo, value: "Feed \(feed)"),
+                Criteria(field: MA_Field_Read, operatorType: .equalTo, value: "No"),
+                Criteria(field: MA_Field_LastUpdate, operatorType: .after, value: "1 \(DateUnit.days.rawValue)"),
+            ], condition: .any)
+            return database.addSmartFolder("Smart folder \(feed)", underParent: VNAFolderType.root.rawValue, withQuery: criteria)
+        }
+        let repetitions = 25
+        let queryCount = Double(repetitions * folderIds.count)
+        func readThroughFolders(emptyingCache: Bool) -> Double {
+            milliseconds {
+                for _ in 0..<repetitions {
+                    for folderId in folderIds {
+                        if emptyingCache {
+                            CriteriaTree.removeCachedSQLTemplates()
+                        }
+                        let articles = database.arrayOfArticles(folderId, filterString: "", sortColumn: "date",
+                                                                ascending: false, position: nil, limit: 100)
+                        XCTAssertEqual(articles.count, 100)
+                    }
+                }
+            } / queryCount
+        }
+
+        let cold = readThroughFolders(emptyingCache: true)
+        let warm = readThroughFolders(emptyingCache: false)
+
+        let report = String(format: "First page of a smart folder over 20,000 articles: %.3f ms compiling the criteria for every read, %.3f ms with the cached template",
+                            cold, warm)
+        attachReport(report)
+    }
+
+    // MARK: Synchronization
+
+    /// Reports the time to reconcile the read flags of a feed of 50,000
+    /// articles with a list of 1,000 unread articles from the server.
+    func testReconciliationPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 1, articleCount: 50_000)
+        _ = database.arrayOfAllFolders()
+        let folder = try XCTUnwrap(database.folder(fromID: 2))
+
+        let unreadGuids = (1...1000).map { "guid-\($0 * 7)" }
+        var changedGuids: [String] = []
+        let changed = milliseconds {
+            changedGuids = database.markUnreadArticlesFromFolder(folder, guidArray: unreadGuids)
+        }
+        let unchanged = milliseconds {
+            XCTAssertEqual(database.markUnreadArticlesFromFolder(folder, guidArray: unreadGuids), [])
+        }
+
+        let report = String(format: "Reconciling 1,000 unread articles with a feed of 50,000 articles: %.1f ms changing %d articles, %.1f ms without changes",
+                            changed, changedGuids.count, unchanged)
+        attachReport(report)
+    }
+
+    // MARK: Maintenance
+
+    /// Reports the longest step of the maintenance after the newer half of the
+    /// articles of a database of 200,000 articles were deleted, against the
+    /// time that VACUUM holds the database.
+    func testMaintenanceStepDuration() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 2000)
+        XCTAssertEqual(sqlite3_exec(connection, "DELETE FROM messages WHERE id > 100000", nil, nil, nil), SQLITE_OK)
+        let freePageCount = database.storageStatistics.freePageCount
+
+        var stepDurations: [Double] = []
+        var lastStep = DispatchTime.now()
+        let maintenance = VNADatabaseMaintenance(database: database)
+        maintenance.pauseBetweenSteps = 0
+        maintenance.idleCondition = {
+            let now = DispatchTime.now()
+            stepDurations.append(Double(now.uptimeNanoseconds - lastStep.uptimeNanoseconds) / 1_000_000)
+            lastStep = now
+            return true
+        }
+        let maintenanceDuration = milliseconds {
+            XCTAssertTrue(maintenance.runSteps())
+        }
+        XCTAssertEqual(maintenance.statistics.freePageCount, 0)
+
+        let vacuumDuration = milliseconds {
+            XCTAssertEqual(sqlite3_exec(connection, "VACUUM", nil, nil, nil), SQLITE_OK)
+        }
+
+        let report = String(format: "Releasing %d free pages: %d steps in %.1f ms, the longest %.1f ms (p50 %.1f ms); VACUUM of the remaining database: %.1f ms",
+                            freePageCount, stepDurations.count - 1, maintenanceDuration,
+                            stepDurations.dropFirst().max() ?? 0, percentile(0.5, of: Array(stepDurations.dropFirst())),
+                            vacuumDuration)
+        attachReport(report)
+    }
+
+    // MARK: Retention
+
+    /// Reports the time to expire the read articles beyond the 100 most recent
+    /// of each feed of a database of 200,000 articles, and the longest batch
+    /// of deleting them from the trash.
+    func testRetentionBatchDuration() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 2000)
+
+        let engine = VNARetentionEngine(database: database, defaultPolicy: VNARetentionPolicy(maximumAge: 0, maximumCount: 100, guidHistoryHorizon: 0))
+        var countOfExpired = 0
+        let expiryDuration = milliseconds {
+            countOfExpired = engine.expireArticles()
+        }
+
+        var batchDurations: [Double] = []
+        var lastBatch = DispatchTime.now()
+        engine.progressHandler = { _, _, _, _ in
+            let now = DispatchTime.now()
+            batchDurations.append(Double(now.uptimeNanoseconds - lastBatch.uptimeNanoseconds) / 1_000_000)
+            lastBatch = now
+        }
+        let purgeDuration = milliseconds {
+            XCTAssertEqual(engine.purgeDeletedArticles(), countOfExpired)
+        }
+
+        let report = String(format: "Expiring %d of 200,000 articles: %.1f ms; purging them: %d batches in %.1f ms, the longest %.1f ms (p50 %.1f ms)",
+                            countOfExpired, expiryDuration, batchDurations.count, purgeDuration,
+                            batchDurations.max() ?? 0, percentile(0.5, of: batchDurations))
+        attachReport(report)
+    }
+
+    // MARK: Instrumentation
+
+    /// Reports the statements that took the most time while opening each of
+    /// 100 feeds of a database of 200,000 articles, as a baseline for
+    /// regressions.
+    func testInstrumentedFolderSwitching() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 2000)
+        _ = database.arrayOfAllFolders()
+        let instrumentation = VNADatabaseInstrumentation()
+        database.instrumentation = instrumentation
+
+        for folderId in 2...101 {
+            _ = database.arrayOfArticles(folderId, filterString: "")
+        }
+
+        let report = instrumentation.statementStatistics.prefix(5).map { statement in
+            let executionTime = statement["executionTime"] as? [String: Double] ?? [:]
+            return String(format: "%@: %d executions, %.1f ms total, p99 %.2f ms",
+                          statement["sql"] as? String ?? "", statement["executions"] as? Int ?? 0,
+                          executionTime["total"] ?? 0, executionTime["p99"] ?? 0)
+        }.joined(separator: "\n")
+        attachReport(report)
+        let attachment = XCTAttachment(data: try instrumentation.jsonData(), uniformTypeIdentifier: "public.json")
+        attachment.lifetime = .keepAlways
+        add(attachment)
+    }
+
+    // MARK: Backup
+
+    /// Reports the time to take a snapshot of a database of 200,000 articles,
+    /// and the latency of the writes that run meanwhile.
+    func testSnapshotWriteLatency() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 100, articleCount: 2000)
+        let backup = VNADatabaseBackup(database: database)
+        backup.directoryURL = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        defer { try? FileManager.default.removeItem(at: backup.directoryURL) }
+
+        let finished = expectation(description: "Snapshot taken")
+        var snapshotDuration = 0.0
+        DispatchQueue.global().async {
+            snapshotDuration = self.milliseconds {
+                XCTAssertNoThrow(try backup.takeSnapshot())
+            }
+            finished.fulfill()
+        }
+
+        var latencies: [Double] = []
+        var iteration = 0
+        while XCTWaiter.wait(for: [finished], timeout: 0.001) == .timedOut {
+            iteration += 1
+            latencies.append(milliseconds {
+                database.markGuids(["guid-\(iteration)"], seenInFolder: 2)
+            })
+        }
+
+        let report = String(format: "Snapshot of 200,000 articles: %.1f ms; %d writes meanwhile, p50 %.2f ms, p99 %.2f ms, the longest %.2f ms",
+                            snapshotDuration, latencies.count, percentile(0.5, of: latencies),
+                            percentile(0.99, of: latencies), latencies.max() ?? 0)
+        attachReport(report)
+    }
+
+    // MARK: Row decoding
+
+    /// Returns the number of memory blocks that are currently allocated.
+    func allocatedBlockCount() -> Int {
+        var statistics = malloc_statistics_t()
+        malloc_zone_statistics(nil, &statistics)
+        return Int(statistics.blocks_in_use)
+    }
+
+    /// Reports the number of memory allocations per row that Database decodes,
+    /// including the articles that it returns. The autorelease pool is only
+    /// drained after counting, so temporary objects are counted as well.
+    func testRowDecodingAllocations() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+        populateFeeds(feedCount: 10, articleCount: 1000)
+
+        let database = self.database!
+        let decoders: [(String, () -> [Any])] = [
+            ("minimalCacheForFolder", { database.minimalCache(forFolder: 2) }),
+            ("arrayOfArticles", { database.arrayOfArticles(2, filterString: "") }),
+        ]
+        var reports: [String] = []
+        for (name, decode) in decoders {
+            // Load the folders and warm up the statement caches first.
+            _ = decode()
+            autoreleasepool {
+                let blockCount = allocatedBlockCount()
+                let rows = decode()
+                let allocations = Double(allocatedBlockCount() - blockCount)
+                reports.append(String(format: "%@: %.1f allocations per row (%d rows)",
+                                      name, allocations / Double(rows.count), rows.count))
+            }
+        }
+
+        attachReport(reports.joined(separator: "\n"))
+    }
+
+}
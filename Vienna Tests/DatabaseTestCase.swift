@@ -0,0 +1,176 @@
+//
+//  DatabaseTestCase.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Runs tests against a synthetic database that is separate from the one of
+/// the user. The database is created anew for each test, and the tests can
+/// query it through `connection` as well.
+class DatabaseTestCase: XCTestCase {
+
+    var databaseURL: URL!
+    var database: Database!
+    var connection: OpaquePointer?
+
+    override func setUpWithError() throws {
+        databaseURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathExtension("db")
+        database = Database(path: databaseURL.path)
+        XCTAssertNotNil(database)
+        XCTAssertEqual(sqlite3_open(databaseURL.path, &connection), SQLITE_OK)
+        registerFunctions()
+    }
+
+    override func tearDownWithError() throws {
+        sqlite3_close(connection)
+        database.close()
+        try FileManager.default.removeItem(at: databaseURL)
+        for suffix in ["-wal", "-shm", ".folders"] {
+            try? FileManager.default.removeItem(atPath: databaseURL.path + suffix)
+        }
+    }
+
+    // MARK: Helpers
+
+    /// Registers the SQL functions that Database registers on its own
+    /// connections, because the triggers of the full-text index call them.
+    func registerFunctions() {
+        sqlite3_create_function_v2(connection, "vna_inflate", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nil, { context, _, values in
+            guard let value = values?[0], sqlite3_value_type(value) != SQLITE_NULL else {
+                sqlite3_result_null(context)
+                return
+            }
+            var data = Data()
+            if let bytes = sqlite3_value_blob(value) {
+                data = Data(bytes: bytes, count: Int(sqlite3_value_bytes(value)))
+            }
+            guard let string = (data as NSData).decompressedString else {
+                sqlite3_result_null(context)
+                return
+            }
+            sqlite3_result_text(context, string, -1, unsafeBitCast(-1, to: sqlite3_destructor_type.self))
+        }, nil, nil, nil)
+        sqlite3_create_function_v2(connection, "vna_deflate", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nil, { context, _, values in
+            guard let value = values?[0], let text = sqlite3_value_text(value) else {
+                sqlite3_result_null(context)
+                return
+            }
+            guard let data = NSData.compressedData(with: String(cString: text)) else {
+                sqlite3_result_error(context, "Failed to compress text", -1)
+                return
+            }
+            data.withUnsafeBytes { buffer in
+                sqlite3_result_blob(context, buffer.baseAddress, Int32(buffer.count), unsafeBitCast(-1, to: sqlite3_destructor_type.self))
+            }
+        }, nil, nil, nil)
+    }
+
+    /// Inserts articles with a distinct title and a text that contains one of
+    /// a thousand keywords, e.g. "keyword42 end".
+    func populate(articleCount: Int, folderCount: Int = 100) {
+        let sql = """
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < \(articleCount))
+            INSERT INTO messages (message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag,
+                                  title, sender, link, createddate, date, revised_flag,
+                                  enclosuredownloaded_flag, hasenclosure_flag, enclosure)
+            SELECT 'guid-' || i, i % \(folderCount) + 1, 0, i % 3 = 0, i % 50 = 0, 0,
+                   'Article ' || i, 'Sender', 'https://example.com/' || i, i, i,
+                   0, 0, 0, ''
+            FROM n;
+            INSERT INTO message_bodies (id, body)
+            SELECT id, vna_deflate('Lorem ipsum dolor sit amet, keyword' || (CAST(substr(message_id, 6) AS INTEGER) % 1000)
+                                   || ' end of article ' || substr(message_id, 6) || '.')
+            FROM messages WHERE message_id LIKE 'guid-%';
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+    }
+
+    /// Creates feeds with the folder ids 2 and up, because folder 1 is the
+    /// trash folder, and populates each of them with articles.
+    func populateFeeds(feedCount: Int, articleCount: Int) {
+        // The folder type 4 is VNAFolderTypeRSS.
+        let sql = """
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < \(feedCount))
+            INSERT INTO folders (folder_id, parent_id, foldername, unread_count, last_update, type, flags, next_sibling, first_child)
+            SELECT i + 1, -1, 'Feed ' || i, 0, 0, 4, 0, 0, 0 FROM n;
+            INSERT INTO rss_folders (folder_id, feed_url, username, last_update_string, description, home_page, bloglines_id)
+            SELECT folder_id, 'https://example.com/feed/' || folder_id, '', '', '', '', 0 FROM folders WHERE type = 4;
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        populate(articleCount: feedCount * articleCount, folderCount: feedCount)
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE messages SET folder_id = folder_id + 1", nil, nil, nil), SQLITE_OK)
+    }
+
+    func countOfRows(_ sql: String) -> Int {
+        var statement: OpaquePointer?
+        XCTAssertEqual(sqlite3_prepare_v2(connection, sql, -1, &statement, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        defer { sqlite3_finalize(statement) }
+        var count = 0
+        while sqlite3_step(statement) == SQLITE_ROW {
+            count += 1
+        }
+        return count
+    }
+
+    /// Returns the details of the query plan, e.g. "SEARCH messages USING
+    /// INDEX messages_folder_message_idx (folder_id=? AND message_id=?)".
+    func queryPlan(_ sql: String) -> [String] {
+        var statement: OpaquePointer?
+        XCTAssertEqual(sqlite3_prepare_v2(connection, "EXPLAIN QUERY PLAN \(sql)", -1, &statement, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        defer { sqlite3_finalize(statement) }
+        var details: [String] = []
+        while sqlite3_step(statement) == SQLITE_ROW {
+            details.append(String(cString: sqlite3_column_text(statement, 3)))
+        }
+        return details
+    }
+
+    /// Returns articles that are not stored yet, with the guids "prefix-0",
+    /// "prefix-1" and so on.
+    func makeArticles(count: Int, prefix: String) -> [Article] {
+        (0..<count).map { index in
+            let article = Article(guid: "\(prefix)-\(index)")
+            article.title = "Article \(index)"
+            article.author = "Sender"
+            article.link = "https://example.com/\(prefix)/\(index)"
+            article.body = String(repeating: "Lorem ipsum dolor sit amet. ", count: 100)
+            return article
+        }
+    }
+
+    /// Puts all feeds into a group folder with the id 1000.
+    func groupFeeds() {
+        // The folder type 3 is VNAFolderTypeGroup.
+        let sql = """
+            INSERT INTO folders (folder_id, parent_id, foldername, unread_count, last_update, type, flags, next_sibling, first_child)
+            VALUES (1000, -1, 'Group', 0, 0, 3, 0, 0, 0);
+            UPDATE folders SET parent_id = 1000 WHERE type = 4;
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+    }
+
+    func guidsOfArticles(inFolder folderId: Int) -> Set<String> {
+        let articles: [Article] = database.arrayOfArticles(folderId, filterString: "")
+        return Set(articles.map(\.guid))
+    }
+
+}
@@ -0,0 +1,181 @@
+//
+//  FeedEntityTagTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Stands in for the HTTP server of a feed that validates its responses with
+/// an ETag. It answers a request whose If-None-Match matches the current
+/// entity tag with HTTP status 304, and any other request with the feed.
+class EntityTagURLProtocol: URLProtocol {
+
+    static let feedData = Data("""
+        <?xml version="1.0" encoding="utf-8"?>
+        <rss version="2.0"><channel><title>Feed 1</title></channel></rss>
+        """.utf8)
+
+    private static let lock = NSLock()
+    private static var _entityTag = ""
+    private static var _requests: [URLRequest] = []
+
+    static var entityTag: String {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return _entityTag
+        }
+        set {
+            lock.lock()
+            _entityTag = newValue
+            lock.unlock()
+        }
+    }
+
+    static var requests: [URLRequest] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _requests
+    }
+
+    static func reset(entityTag: String) {
+        lock.lock()
+        _entityTag = entityTag
+        _requests = []
+        lock.unlock()
+    }
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        request
+    }
+
+    override func startLoading() {
+        Self.lock.lock()
+        Self._requests.append(request)
+        let entityTag = Self._entityTag
+        Self.lock.unlock()
+
+        guard let url = request.url else {
+            return
+        }
+        let isUnmodified = request.value(forHTTPHeaderField: "If-None-Match") == entityTag
+        let response = HTTPURLResponse(
+            url: url,
+            statusCode: isUnmodified ? 304 : 200,
+            httpVersion: "HTTP/1.1",
+            headerFields: ["ETag": entityTag, "Content-Type": "application/rss+xml"]
+        )
+        if let response {
+            client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+        }
+        if !isUnmodified {
+            client?.urlProtocol(self, didLoad: Self.feedData)
+        }
+        client?.urlProtocolDidFinishLoading(self)
+    }
+
+    override func stopLoading() {}
+
+}
+
+/// Tests the entity tags that are stored with the feeds for conditional
+/// requests.
+class FeedEntityTagTests: DatabaseTestCase {
+
+    func testEntityTagIsStoredWithFeed() throws {
+        populateFeeds(feedCount: 2, articleCount: 1)
+        XCTAssertEqual(database.folder(fromID: 2)?.entityTag, "")
+        database.setEntityTag("W/\"5f2a\"", forFolder: 2)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM rss_folders WHERE etag = 'W/\"5f2a\"'"), 1)
+
+        database.close()
+        database = Database(path: databaseURL.path)
+        XCTAssertEqual(database.folder(fromID: 2)?.entityTag, "W/\"5f2a\"")
+        XCTAssertEqual(database.folder(fromID: 3)?.entityTag, "")
+    }
+
+    func testContentSizeIsStoredWithFeed() throws {
+        populateFeeds(feedCount: 1, articleCount: 1)
+        XCTAssertEqual(database.folder(fromID: 2)?.contentSize, 0)
+        database.setContentSize(1234, forFolder: 2)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM rss_folders WHERE content_size = 1234"), 1)
+
+        database.close()
+        database = Database(path: databaseURL.path)
+        XCTAssertEqual(database.folder(fromID: 2)?.contentSize, 1234)
+    }
+
+    /// The refresh sends both validators of the stored response, and counts
+    /// the feed as not modified or downloaded depending on the answer.
+    func testConditionalRequestsOfRefresh() throws {
+        populateFeeds(feedCount: 1, articleCount: 1)
+        let lastModified = "Sat, 17 Oct 2026 08:00:00 GMT"
+        database.setEntityTag("\"v1\"", forFolder: 2)
+        database.setLastUpdateString(lastModified, forFolder: 2)
+        database.setContentSize(1234, forFolder: 2)
+
+        // The size of the last download is known after a restart as well.
+        database.close()
+        database = Database(path: databaseURL.path)
+
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [EntityTagURLProtocol.self]
+        let manager = RefreshManager(database: database, sessionConfiguration: configuration)
+
+        // The server still has the stored response.
+        EntityTagURLProtocol.reset(entityTag: "\"v1\"")
+        try refresh(folderId: 2, with: manager)
+
+        let request = try XCTUnwrap(EntityTagURLProtocol.requests.first)
+        XCTAssertEqual(request.value(forHTTPHeaderField: "If-None-Match"), "\"v1\"")
+        XCTAssertEqual(request.value(forHTTPHeaderField: "If-Modified-Since"), lastModified)
+        XCTAssertEqual(manager.countOfUnmodifiedFeeds, 1)
+        XCTAssertEqual(manager.countOfDownloadedFeeds, 0)
+        XCTAssertEqual(manager.countOfBytesSaved, 1234)
+
+        // The feed changed on the server.
+        EntityTagURLProtocol.reset(entityTag: "\"v2\"")
+        try refresh(folderId: 2, with: manager)
+
+        XCTAssertEqual(EntityTagURLProtocol.requests.count, 1)
+        XCTAssertEqual(manager.countOfUnmodifiedFeeds, 0)
+        XCTAssertEqual(manager.countOfDownloadedFeeds, 1)
+        XCTAssertEqual(manager.countOfBytesSaved, 0)
+        XCTAssertEqual(database.folder(fromID: 2)?.entityTag, "\"v2\"")
+        XCTAssertEqual(database.folder(fromID: 2)?.contentSize, UInt64(EntityTagURLProtocol.feedData.count))
+    }
+
+    // MARK: Helpers
+
+    /// Refreshes a feed and waits until the refresh is completed.
+    func refresh(folderId: Int, with manager: RefreshManager) throws {
+        let folder = try XCTUnwrap(database.folder(fromID: folderId))
+        manager.refreshSubscriptions([folder], ignoringSubscriptionStatus: false)
+        // The status is posted when the refresh starts, which happened
+        // already, and when it is completed.
+        let completion = expectation(forNotification: Notification.Name("MA_Notify_RefreshStatus"), object: nil) { _ in
+            !manager.isConnecting
+        }
+        wait(for: [completion], timeout: 10)
+    }
+
+}
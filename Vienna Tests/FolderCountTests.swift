@@ -0,0 +1,71 @@
+//
+//  FolderCountTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the unread, flagged and deleted counts that triggers maintain per
+/// folder.
+class FolderCountTests: DatabaseTestCase {
+
+    func testFolderCountsFollowArticles() {
+        populateFeeds(feedCount: 2, articleCount: 20)
+        let sql = """
+            UPDATE messages SET read_flag = 1 WHERE message_id IN ('guid-1', 'guid-2');
+            UPDATE messages SET read_flag = 0 WHERE message_id = 'guid-3';
+            UPDATE messages SET marked_flag = 1, deleted_flag = 1 WHERE message_id = 'guid-4';
+            UPDATE messages SET folder_id = 3 WHERE message_id = 'guid-6';
+            DELETE FROM messages WHERE message_id IN ('guid-7', 'guid-50');
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+
+        let mismatches = """
+            SELECT folder_id FROM folders
+            WHERE unread_count IS NOT (SELECT COUNT(*) FROM messages WHERE messages.folder_id = folders.folder_id AND read_flag IS NOT 1)
+            OR flagged_count IS NOT (SELECT COUNT(*) FROM messages WHERE messages.folder_id = folders.folder_id AND marked_flag IS 1)
+            OR deleted_count IS NOT (SELECT COUNT(*) FROM messages WHERE messages.folder_id = folders.folder_id AND deleted_flag IS 1)
+            """
+        XCTAssertEqual(countOfRows(mismatches), 0)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM folders WHERE unread_count > 0"), 2)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM folders WHERE deleted_count > 0"), 1)
+    }
+
+    func testUnreadCountsAreAppliedToFolders() throws {
+        // Of the articles guid-1 to guid-3, only guid-3 is read.
+        populateFeeds(feedCount: 1, articleCount: 3)
+        _ = database.arrayOfAllFolders()
+        let folder = try XCTUnwrap(database.folder(fromID: 2))
+        XCTAssertEqual(folder.unreadCount, 2)
+        XCTAssertEqual(database.countOfUnread, 2)
+
+        database.markArticleRead(2, guid: "guid-1", isRead: true)
+        database.markArticleRead(2, guid: "guid-1", isRead: true)
+        XCTAssertEqual(folder.unreadCount, 1)
+        XCTAssertEqual(database.countOfUnread, 1)
+
+        database.markArticleRead(2, guid: "guid-3", isRead: false)
+        XCTAssertEqual(folder.unreadCount, 2)
+
+        XCTAssertTrue(database.markFolderRead(2))
+        XCTAssertEqual(folder.unreadCount, 0)
+        XCTAssertEqual(database.countOfUnread, 0)
+    }
+
+}
@@ -0,0 +1,70 @@
+//
+//  FolderLookupTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the indexes of the cached folders by name, feed URL, remote id and
+/// parent.
+class FolderLookupTests: DatabaseTestCase {
+
+    func testFolderLookupsFollowFolderChanges() throws {
+        _ = database.arrayOfAllFolders()
+        let root = VNAFolderType.root.rawValue
+        let group = database.addFolder(root, afterChild: 0, folderName: "Group", type: VNAFolderType.group.rawValue, canAppendIndex: false)
+        let feed = database.addRSSFolder("Feed", underParent: group, afterChild: 0, subscriptionURL: "https://example.com/feed")
+        let remoteFeed = database.addOpenReaderFolder("Remote feed", underParent: group, afterChild: 0,
+                                                      subscriptionURL: "https://example.org/feed", remoteId: "feed/1")
+        func childIds(of parentId: Int) -> Set<Int> {
+            Set(database.arrayOfFolders(parentId).compactMap { ($0 as? Folder)?.itemId })
+        }
+        XCTAssertEqual(database.folder(fromName: "Feed")?.itemId, feed)
+        XCTAssertEqual(database.folder(fromFeedURL: "https://example.org/feed")?.itemId, remoteFeed)
+        XCTAssertEqual(database.folder(fromRemoteId: "feed/1")?.itemId, remoteFeed)
+        XCTAssertEqual(childIds(of: group), [feed, remoteFeed])
+
+        XCTAssertTrue(database.setName("Renamed feed", forFolder: feed))
+        XCTAssertTrue(database.setFeedURL("https://example.com/renamed", forFolder: feed))
+        XCTAssertTrue(database.setRemoteId("feed/2", forFolder: remoteFeed))
+        XCTAssertTrue(database.setParent(root, forFolder: remoteFeed))
+        XCTAssertNil(database.folder(fromName: "Feed"))
+        XCTAssertEqual(database.folder(fromName: "Renamed feed")?.itemId, feed)
+        XCTAssertNil(database.folder(fromFeedURL: "https://example.com/feed"))
+        XCTAssertEqual(database.folder(fromFeedURL: "https://example.com/renamed")?.itemId, feed)
+        XCTAssertNil(database.folder(fromRemoteId: "feed/1"))
+        XCTAssertEqual(database.folder(fromRemoteId: "feed/2")?.itemId, remoteFeed)
+        XCTAssertEqual(childIds(of: group), [feed])
+        XCTAssertTrue(childIds(of: root).isSuperset(of: [group, remoteFeed]))
+
+        XCTAssertTrue(database.deleteFolder(group))
+        XCTAssertNil(database.folder(fromName: "Renamed feed"))
+        XCTAssertNil(database.folder(fromFeedURL: "https://example.com/renamed"))
+        XCTAssertTrue(childIds(of: group).isEmpty)
+        XCTAssertFalse(childIds(of: root).contains(group))
+
+        // The indexes are built anew when the folders are loaded.
+        database.close()
+        database = Database(path: databaseURL.path)
+        _ = database.arrayOfAllFolders()
+        XCTAssertEqual(database.folder(fromName: "Remote feed")?.itemId, remoteFeed)
+        XCTAssertEqual(database.folder(fromRemoteId: "feed/2")?.itemId, remoteFeed)
+        XCTAssertTrue(childIds(of: root).contains(remoteFeed))
+    }
+
+}
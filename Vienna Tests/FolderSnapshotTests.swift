@@ -0,0 +1,66 @@
+//
+//  FolderSnapshotTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the snapshot of the folders that stands in for the folders of the
+/// database at launch.
+class FolderSnapshotTests: DatabaseTestCase {
+
+    func testFolderSnapshotStandsInUntilDatabaseChanges() throws {
+        populateFeeds(feedCount: 3, articleCount: 2)
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE folders SET unread_count = folder_id WHERE type = 4", nil, nil, nil), SQLITE_OK)
+        sqlite3_close(connection)
+        connection = nil
+        let folders = database.arrayOfAllFolders().compactMap { $0 as? Folder }
+        let countOfUnread = database.countOfUnread
+        database.saveFolderSnapshotAndClose()
+        let snapshotPath = databaseURL.path + ".folders"
+        XCTAssertTrue(FileManager.default.fileExists(atPath: snapshotPath))
+
+        // The folders of the snapshot are used while the database is unchanged.
+        database = Database(path: databaseURL.path)
+        XCTAssertTrue(database.loadFolderSnapshot())
+        XCTAssertEqual(database.countOfUnread, countOfUnread)
+        for folder in folders {
+            let cached = try XCTUnwrap(database.folder(fromID: folder.itemId))
+            XCTAssertFalse(cached === folder)
+            XCTAssertEqual(cached.name, folder.name)
+            XCTAssertEqual(cached.type, folder.type)
+            XCTAssertEqual(cached.parentId, folder.parentId)
+            XCTAssertEqual(cached.feedURL, folder.feedURL)
+            XCTAssertEqual(cached.unreadCount, folder.unreadCount)
+        }
+        XCTAssertEqual(database.folder(fromFeedURL: "https://example.com/feed/3")?.itemId, 3)
+
+        // A snapshot is not used again once the database was changed without it.
+        database.saveFolderSnapshotAndClose()
+        XCTAssertEqual(sqlite3_open(databaseURL.path, &connection), SQLITE_OK)
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE folders SET foldername = 'Renamed' WHERE folder_id = 2", nil, nil, nil), SQLITE_OK)
+        sqlite3_close(connection)
+        database = Database(path: databaseURL.path)
+        XCTAssertFalse(database.loadFolderSnapshot())
+        XCTAssertFalse(FileManager.default.fileExists(atPath: snapshotPath))
+        XCTAssertEqual(database.folder(fromID: 2)?.name, "Renamed")
+        XCTAssertEqual(sqlite3_open(databaseURL.path, &connection), SQLITE_OK)
+    }
+
+}
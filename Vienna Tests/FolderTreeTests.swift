@@ -0,0 +1,66 @@
+//
+//  FolderTreeTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the closure table of the folder tree and the scopes that use it.
+class FolderTreeTests: DatabaseTestCase {
+
+    func testFolderTreeFollowsFolders() throws {
+        _ = database.arrayOfAllFolders()
+        let root = VNAFolderType.root.rawValue
+        let group = database.addFolder(root, afterChild: 0, folderName: "Group", type: VNAFolderType.group.rawValue, canAppendIndex: false)
+        let subgroup = database.addFolder(group, afterChild: 0, folderName: "Subgroup", type: VNAFolderType.group.rawValue, canAppendIndex: false)
+        let feed = database.addFolder(subgroup, afterChild: 0, folderName: "Feed", type: VNAFolderType.RSS.rawValue, canAppendIndex: false)
+        let otherFeed = database.addFolder(group, afterChild: 0, folderName: "Other feed", type: VNAFolderType.RSS.rawValue, canAppendIndex: false)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM folder_tree WHERE ancestor_id = \(group)"), 4)
+
+        XCTAssertTrue(database.setParent(root, forFolder: subgroup))
+        XCTAssertTrue(database.setParent(subgroup, forFolder: otherFeed))
+        XCTAssertTrue(database.setParent(group, forFolder: subgroup))
+        XCTAssertTrue(database.deleteFolder(feed))
+
+        let tree = """
+            WITH RECURSIVE tree (ancestor_id, folder_id) AS (
+                SELECT folder_id, folder_id FROM folders
+                UNION SELECT tree.ancestor_id, folders.folder_id FROM folders JOIN tree ON folders.parent_id = tree.folder_id)
+            SELECT ancestor_id, folder_id FROM tree
+            """
+        XCTAssertEqual(countOfRows("\(tree) EXCEPT SELECT ancestor_id, folder_id FROM folder_tree"), 0)
+        XCTAssertEqual(countOfRows("SELECT ancestor_id, folder_id FROM folder_tree EXCEPT \(tree)"), 0)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM folder_tree WHERE ancestor_id = \(group)"), 3)
+    }
+
+    func testGroupScopeUsesFolderTree() throws {
+        populateFeeds(feedCount: 3, articleCount: 10)
+        groupFeeds()
+        _ = database.arrayOfAllFolders()
+        let group = try XCTUnwrap(database.folder(fromID: 1000))
+
+        let scope = database.sqlScope(for: group, flags: [.subFolders, .inclusive], field: "folder_id")
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE \(scope)"), 30)
+        let excludingScope = database.sqlScope(for: group, flags: .subFolders, field: "folder_id")
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE \(excludingScope)"), 0)
+        for detail in queryPlan("SELECT id FROM messages WHERE \(scope)") {
+            XCTAssertFalse(detail.hasPrefix("SCAN"), "The group scope uses a full scan: \(detail)")
+        }
+    }
+
+}
@@ -0,0 +1,71 @@
+//
+//  FullTextSearchTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the full-text index of the titles and texts of articles.
+class FullTextSearchTests: DatabaseTestCase {
+
+    func testFullTextSearchMatchesPatternSearch() throws {
+        try XCTSkipUnless(database.isFullTextSearchAvailable, "The SQLite library lacks FTS5")
+        populate(articleCount: 5000)
+
+        let fullTextScope = try XCTUnwrap(database.sqlFullTextScope(for: "keyword42 end", column: nil, flags: .inclusive))
+        let fullTextCount = countOfRows("SELECT rowid FROM messages WHERE \(fullTextScope)")
+        let patternCount = countOfRows("SELECT rowid FROM messages WHERE title LIKE '%keyword42 end%' OR rowid IN (SELECT id FROM message_bodies WHERE vna_inflate(body) LIKE '%keyword42 end%')")
+        XCTAssertEqual(fullTextCount, 5)
+        XCTAssertEqual(fullTextCount, patternCount)
+
+        let excludingScope = try XCTUnwrap(database.sqlFullTextScope(for: "keyword42 end", column: nil, flags: []))
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(excludingScope)"), 4995)
+    }
+
+    func testFullTextIndexFollowsUpdatesAndDeletes() throws {
+        try XCTSkipUnless(database.isFullTextSearchAvailable, "The SQLite library lacks FTS5")
+        populate(articleCount: 10)
+
+        let scope = try XCTUnwrap(database.sqlFullTextScope(for: "Zanzibar", column: "title", flags: .inclusive))
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(scope)"), 0)
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE messages SET title = 'Zanzibar' WHERE message_id = 'guid-1'", nil, nil, nil), SQLITE_OK)
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(scope)"), 1)
+
+        let bodyScope = try XCTUnwrap(database.sqlFullTextScope(for: "Kumquat", column: nil, flags: .inclusive))
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(bodyScope)"), 0)
+        XCTAssertEqual(sqlite3_exec(connection, "UPDATE message_bodies SET body = vna_deflate('Kumquat') WHERE id = (SELECT id FROM messages WHERE message_id = 'guid-1')", nil, nil, nil), SQLITE_OK)
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(bodyScope)"), 1)
+
+        XCTAssertEqual(sqlite3_exec(connection, "DELETE FROM messages WHERE message_id = 'guid-1'", nil, nil, nil), SQLITE_OK)
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(scope)"), 0)
+        XCTAssertEqual(countOfRows("SELECT rowid FROM messages WHERE \(bodyScope)"), 0)
+        XCTAssertEqual(countOfRows("SELECT id FROM message_bodies"), 9)
+    }
+
+    /// Strings whose punctuation the index would drop are left to a pattern
+    /// search.
+    func testFullTextQueryOfDegenerateStrings() {
+        XCTAssertEqual(database.fullTextQuery(for: " apple pi ", column: nil), "\"apple pi\"*")
+        XCTAssertEqual(database.fullTextQuery(for: "e-mail", column: "title"), "title : \"e-mail\"*")
+        for string in ["", "  ", "!!!", "-", "c++", "c#", "apple !"] {
+            XCTAssertNil(database.fullTextQuery(for: string, column: nil), string)
+        }
+    }
+
+}
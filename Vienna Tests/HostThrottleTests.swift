@@ -0,0 +1,228 @@
+//
+//  HostThrottleTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import XCTest
+
+/// Stands in for the HTTP servers of the feeds. It answers every request
+/// after a short delay and records when each request arrived and finished.
+class RecordingURLProtocol: URLProtocol {
+
+    struct Record {
+        var host: String
+        var start: Date
+        var end: Date
+    }
+
+    static let responseDelay: TimeInterval = 0.1
+
+    private static let lock = NSLock()
+    private static var _records: [Record] = []
+
+    static var records: [Record] {
+        lock.lock()
+        defer { lock.unlock() }
+        return _records
+    }
+
+    static func reset() {
+        lock.lock()
+        _records = []
+        lock.unlock()
+    }
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        request
+    }
+
+    override func startLoading() {
+        let start = Date()
+        DispatchQueue.global().asyncAfter(deadline: .now() + Self.responseDelay) {
+            guard let url = self.request.url, let host = url.host else {
+                return
+            }
+            Self.lock.lock()
+            Self._records.append(Record(host: host, start: start, end: Date()))
+            Self.lock.unlock()
+
+            let response = HTTPURLResponse(
+                url: url, statusCode: 200, httpVersion: "HTTP/1.1", headerFields: [:]
+            )
+            if let response {
+                self.client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+            }
+            self.client?.urlProtocol(self, didLoad: Data())
+            self.client?.urlProtocolDidFinishLoading(self)
+        }
+    }
+
+    override func stopLoading() {}
+
+}
+
+class HostThrottleTests: XCTestCase {
+
+    var session: URLSession!
+    var operationQueue: OperationQueue!
+    var throttle: VNAHostThrottle!
+
+    override func setUp() {
+        RecordingURLProtocol.reset()
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [RecordingURLProtocol.self]
+        session = URLSession(configuration: configuration)
+        operationQueue = OperationQueue()
+        operationQueue.maxConcurrentOperationCount = 4
+        throttle = VNAHostThrottle(operationQueue: operationQueue)
+        throttle.maximumConcurrentOperationsPerHost = 2
+        throttle.minimumIntervalPerHost = 0.05
+    }
+
+    override func tearDown() {
+        operationQueue.cancelAllOperations()
+        session.invalidateAndCancel()
+    }
+
+    // MARK: Test methods
+
+    func testRequestsPerHostAreLimitedAndSpaced() {
+        for index in 0..<6 {
+            addRequest(to: "busy.test", path: "/feed\(index)")
+        }
+        operationQueue.waitUntilAllOperationsAreFinished()
+
+        let records = RecordingURLProtocol.records
+        XCTAssertEqual(records.count, 6)
+        XCTAssertLessThanOrEqual(maximumOverlap(of: records), 2)
+
+        let starts = records.map(\.start).sorted()
+        for (earlier, later) in zip(starts, starts.dropFirst()) {
+            // Allow for the time between the admission and the arrival.
+            XCTAssertGreaterThanOrEqual(later.timeIntervalSince(earlier), 0.04)
+        }
+    }
+
+    func testHostsTakeTurns() {
+        for index in 0..<8 {
+            addRequest(to: "busy.test", path: "/feed\(index)")
+        }
+        for index in 0..<2 {
+            addRequest(to: "quiet.test", path: "/feed\(index)")
+        }
+        operationQueue.waitUntilAllOperationsAreFinished()
+
+        let records = RecordingURLProtocol.records
+        XCTAssertEqual(records.count, 10)
+        let busyRecords = records.filter { $0.host == "busy.test" }
+        let quietRecords = records.filter { $0.host == "quiet.test" }
+        XCTAssertLessThanOrEqual(maximumOverlap(of: busyRecords), 2)
+
+        // The requests to the quiet host do not wait for those to the busy
+        // host, even though they were added last.
+        let lastBusyStart = busyRecords.map(\.start).max() ?? .distantPast
+        for record in quietRecords {
+            XCTAssertLessThan(record.start, lastBusyStart)
+        }
+    }
+
+    func testRetryAfterHoldsBackHost() throws {
+        let url = try XCTUnwrap(URL(string: "http://busy.test/feed"))
+        let response = try XCTUnwrap(HTTPURLResponse(
+            url: url, statusCode: 429, httpVersion: nil, headerFields: ["Retry-After": "120"]
+        ))
+        throttle.backOff(for: response)
+
+        let retryDate = try XCTUnwrap(throttle.retryDate(ofHost: "busy.test"))
+        XCTAssertEqual(retryDate.timeIntervalSinceNow, 120, accuracy: 5)
+        XCTAssertNil(throttle.retryDate(ofHost: "quiet.test"))
+
+        // The request to the busy host does not wait in the queue.
+        let operation = addRequest(to: "busy.test", path: "/feed")
+        addRequest(to: "quiet.test", path: "/feed")
+        operationQueue.waitUntilAllOperationsAreFinished()
+        XCTAssertEqual(operation?.isCancelled, true)
+        XCTAssertEqual(RecordingURLProtocol.records.map(\.host), ["quiet.test"])
+    }
+
+    func testRetryAfterCancelsWaitingOperations() throws {
+        let operations = (0..<4).compactMap { index in
+            addRequest(to: "busy.test", path: "/feed\(index)")
+        }
+        let url = try XCTUnwrap(URL(string: "http://busy.test/feed"))
+        let response = try XCTUnwrap(HTTPURLResponse(
+            url: url, statusCode: 503, httpVersion: nil, headerFields: ["Retry-After": "120"]
+        ))
+        throttle.backOff(for: response)
+        operationQueue.waitUntilAllOperationsAreFinished()
+
+        // Only the requests that were admitted before were sent.
+        let countOfCancelledOperations = operations.filter(\.isCancelled).count
+        XCTAssertGreaterThanOrEqual(countOfCancelledOperations, 2)
+        XCTAssertEqual(RecordingURLProtocol.records.count + countOfCancelledOperations, 4)
+    }
+
+    func testRetryIntervalOfResponse() throws {
+        XCTAssertEqual(try retryInterval(["Retry-After": "30"]), 30)
+        XCTAssertEqual(try retryInterval([
+            "Retry-After": "Thu, 01 Jan 1970 00:05:00 GMT",
+            "Date": "Thu, 01 Jan 1970 00:00:00 GMT",
+        ]), 300)
+        XCTAssertEqual(try retryInterval(["Retry-After": "soon"]), 0)
+        XCTAssertEqual(try retryInterval([:]), 0)
+    }
+
+    // MARK: Test utilities
+
+    @discardableResult
+    func addRequest(to host: String, path: String) -> Operation? {
+        guard let url = URL(string: "http://\(host)\(path)") else {
+            XCTFail("Invalid URL")
+            return nil
+        }
+        let session = self.session!
+        let operation = BlockOperation {
+            let semaphore = DispatchSemaphore(value: 0)
+            session.dataTask(with: url) { _, _, _ in
+                semaphore.signal()
+            }.resume()
+            semaphore.wait()
+        }
+        throttle.addOperation(operation, forHost: host)
+        return operation
+    }
+
+    /// Returns the largest number of requests that were in flight at once.
+    func maximumOverlap(of records: [RecordingURLProtocol.Record]) -> Int {
+        records.map { record in
+            records.filter { $0.start <= record.start && $0.end > record.start }.count
+        }.max() ?? 0
+    }
+
+    func retryInterval(_ headerFields: [String: String]) throws -> TimeInterval {
+        let url = try XCTUnwrap(URL(string: "http://busy.test/feed"))
+        let response = try XCTUnwrap(HTTPURLResponse(
+            url: url, statusCode: 429, httpVersion: nil, headerFields: headerFields
+        ))
+        return VNAHostThrottle.retryInterval(of: response)
+    }
+
+}
@@ -70,6 +70,25 @@ class RSSFeedTests: XCTestCase {
         }
     }
 
+    func testParsingTimeToLiveElement() throws {
+        let fileData = try data(forResource: "RSSFeedWithTimeToLive", withExtension: "rss")
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: fileData)
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        XCTAssertEqual(rssFeed.timeToLive, 90 * 60)
+    }
+
+    /// Validate the syndication module elements of an RSS 1.0 feed whose
+    /// prefix differs from the usual one.
+    func testParsingSyndicationElements() throws {
+        let fileData = try data(forResource: "RSSFeedWithSyndicationElements", withExtension: "rss")
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: fileData)
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        XCTAssertEqual(rssFeed.timeToLive, 6 * 60 * 60)
+        XCTAssert(rssFeed.items.count == 1)
+    }
+
     // MARK: Test utilities
 
     func data(forResource name: String, withExtension ext: String) throws -> Data {
@@ -0,0 +1,141 @@
+//
+//  RefreshPipelineTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import XCTest
+
+class RefreshPipelineTests: XCTestCase {
+
+    var commitQueue: DispatchQueue!
+    var pipeline: VNARefreshPipeline!
+
+    override func setUp() {
+        commitQueue = DispatchQueue(label: "RefreshPipelineTests")
+        pipeline = VNARefreshPipeline(commitQueue: commitQueue)
+        pipeline.maximumConcurrentTasks = 4
+    }
+
+    // MARK: Test methods
+
+    /// Later tasks are processed faster, but committed after earlier tasks
+    /// with the same key.
+    func testTasksWithSameKeyAreCommittedInOrder() {
+        let count = 12
+        var committedIndexes: [Int] = []
+        let expectation = expectation(description: "Tasks committed")
+        expectation.expectedFulfillmentCount = count
+
+        for index in 0..<count {
+            pipeline.addTask(forKey: NSNumber(value: 1)) {
+                Thread.sleep(forTimeInterval: Double(count - index) * 0.01)
+                return NSNumber(value: index)
+            } commit: { result in
+                committedIndexes.append((result as? NSNumber)?.intValue ?? -1)
+                expectation.fulfill()
+            }
+        }
+
+        wait(for: [expectation], timeout: 10)
+        XCTAssertEqual(committedIndexes, Array(0..<count))
+        XCTAssertEqual(pipeline.countOfPendingTasks, 0)
+    }
+
+    func testTasksAreProcessedConcurrentlyAndCommittedSerially() {
+        let lock = NSLock()
+        var countOfProcessingTasks = 0
+        var maximumCountOfProcessingTasks = 0
+        let commitQueue = self.commitQueue!
+        let expectation = expectation(description: "Tasks committed")
+        expectation.expectedFulfillmentCount = 16
+
+        for index in 0..<16 {
+            pipeline.addTask(forKey: NSNumber(value: index)) {
+                lock.lock()
+                countOfProcessingTasks += 1
+                maximumCountOfProcessingTasks = max(maximumCountOfProcessingTasks, countOfProcessingTasks)
+                lock.unlock()
+                Thread.sleep(forTimeInterval: 0.05)
+                lock.lock()
+                countOfProcessingTasks -= 1
+                lock.unlock()
+                return nil
+            } commit: { _ in
+                dispatchPrecondition(condition: .onQueue(commitQueue))
+                expectation.fulfill()
+            }
+        }
+
+        wait(for: [expectation], timeout: 10)
+        XCTAssertGreaterThan(maximumCountOfProcessingTasks, 1)
+        XCTAssertLessThanOrEqual(maximumCountOfProcessingTasks, 4)
+    }
+
+    /// The pipeline is backlogged while the commit stage is held up, and
+    /// catches up once it resumes.
+    func testBacklogHandler() {
+        var backlogStates: [Bool] = []
+        let backlogged = expectation(description: "Backlogged")
+        let caughtUp = expectation(description: "Caught up")
+        pipeline.maximumPendingTasks = 4
+        pipeline.backlogHandler = { isBacklogged in
+            dispatchPrecondition(condition: .onQueue(.main))
+            backlogStates.append(isBacklogged)
+            (isBacklogged ? backlogged : caughtUp).fulfill()
+        }
+
+        commitQueue.suspend()
+        for index in 0..<4 {
+            pipeline.addTask(forKey: NSNumber(value: index)) {
+                nil
+            } commit: { _ in }
+        }
+        wait(for: [backlogged], timeout: 5)
+        XCTAssertEqual(pipeline.countOfPendingTasks, 4)
+
+        commitQueue.resume()
+        wait(for: [caughtUp], timeout: 5)
+        XCTAssertEqual(backlogStates, [true, false])
+    }
+
+    /// The drain handler is called once the last task is committed, not
+    /// when the first tasks are.
+    func testDrainHandler() {
+        var countOfCommittedTasks = 0
+        let drained = expectation(description: "Drained")
+        pipeline.drainHandler = { [pipeline] in
+            dispatchPrecondition(condition: .onQueue(.main))
+            XCTAssertEqual(pipeline?.countOfPendingTasks, 0)
+            drained.fulfill()
+        }
+
+        commitQueue.suspend()
+        for index in 0..<4 {
+            pipeline.addTask(forKey: NSNumber(value: index)) {
+                Thread.sleep(forTimeInterval: Double(index) * 0.01)
+                return nil
+            } commit: { _ in
+                countOfCommittedTasks += 1
+            }
+        }
+        commitQueue.resume()
+
+        wait(for: [drained], timeout: 5)
+        XCTAssertEqual(countOfCommittedTasks, 4)
+    }
+
+}
@@ -0,0 +1,181 @@
+//
+//  RefreshSchedulerTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import XCTest
+
+class RefreshSchedulerTests: XCTestCase {
+
+    static let hour: TimeInterval = 60 * 60
+    static let day: TimeInterval = 24 * hour
+
+    var databaseURL: URL!
+    var database: Database!
+    var scheduler: VNARefreshScheduler!
+
+    override func setUpWithError() throws {
+        databaseURL = FileManager.default.temporaryDirectory
+            .appendingPathComponent(UUID().uuidString)
+            .appendingPathExtension("db")
+        database = Database(path: databaseURL.path)
+        XCTAssertNotNil(database)
+        scheduler = VNARefreshScheduler(database: database, baseInterval: Self.hour)
+    }
+
+    override func tearDownWithError() throws {
+        scheduler.cancel()
+        database.close()
+        try FileManager.default.removeItem(at: databaseURL)
+        for suffix in ["-wal", "-shm", ".folders"] {
+            try? FileManager.default.removeItem(atPath: databaseURL.path + suffix)
+        }
+    }
+
+    // MARK: Test methods
+
+    func testRefreshIntervalFollowsPublicationInterval() {
+        // A feed that publishes every 10 minutes is refreshed at the base
+        // interval, one that publishes every 8 hours twice in that time.
+        XCTAssertEqual(interval(publicationInterval: 10 * 60), Self.hour)
+        XCTAssertEqual(interval(publicationInterval: 8 * Self.hour), 4 * Self.hour)
+        // A feed that has not published anything in a month is refreshed
+        // at the maximum interval.
+        XCTAssertEqual(interval(publicationInterval: 30 * Self.day), Self.day)
+    }
+
+    func testRefreshIntervalRespectsFreshnessAndTimeToLive() {
+        XCTAssertEqual(interval(freshnessLifetime: 3 * Self.hour), 3 * Self.hour)
+        XCTAssertEqual(interval(timeToLive: 2 * Self.hour), 2 * Self.hour)
+        XCTAssertEqual(interval(timeToLive: 7 * Self.day), Self.day)
+    }
+
+    func testRefreshIntervalBacksOffAfterFailures() {
+        XCTAssertEqual(interval(countOfFailures: 1), 2 * Self.hour)
+        XCTAssertEqual(interval(countOfFailures: 3), 8 * Self.hour)
+        XCTAssertEqual(interval(countOfFailures: 20), Self.day)
+    }
+
+    func testFreshnessLifetimeOfResponse() throws {
+        XCTAssertEqual(try freshnessLifetime(["Cache-Control": "public, max-age=600"]), 600)
+        XCTAssertEqual(try freshnessLifetime(["Cache-Control": "no-cache"]), 0)
+        XCTAssertEqual(try freshnessLifetime([
+            "Cache-Control": "max-age=60",
+            "Expires": "Thu, 01 Jan 1970 02:00:00 GMT",
+            "Date": "Thu, 01 Jan 1970 00:00:00 GMT",
+        ]), 60)
+        XCTAssertEqual(try freshnessLifetime([
+            "Expires": "Thu, 01 Jan 1970 02:00:00 GMT",
+            "Date": "Thu, 01 Jan 1970 00:00:00 GMT",
+        ]), 2 * Self.hour)
+        XCTAssertEqual(try freshnessLifetime(["Expires": "0"]), 0)
+        XCTAssertEqual(try freshnessLifetime([:]), 0)
+    }
+
+    func testScheduledFeedsAreDueWithinTheirInterval() throws {
+        let folderId = database.addRSSFolder(
+            "Feed", underParent: VNAFolderTypeRoot.rawValue, afterChild: 0,
+            subscriptionURL: "http://localhost/feed"
+        )
+        let folder = try XCTUnwrap(database.folder(fromID: folderId))
+        scheduler.scheduleFeeds([folder])
+
+        let dueDate = try XCTUnwrap(scheduler.dueDate(ofFeed: folderId))
+        XCTAssertLessThanOrEqual(dueDate.timeIntervalSinceNow, Self.day)
+
+        scheduler.feedDidFail(toRefresh: folderId)
+        let backedOffDueDate = try XCTUnwrap(scheduler.dueDate(ofFeed: folderId))
+        XCTAssertGreaterThan(backedOffDueDate.timeIntervalSinceNow, 0.9 * Self.day)
+    }
+
+    func testDeferredFeedIsDueAtRetryDate() throws {
+        let folderId = database.addRSSFolder(
+            "Feed", underParent: VNAFolderTypeRoot.rawValue, afterChild: 0,
+            subscriptionURL: "http://localhost/feed"
+        )
+        let folder = try XCTUnwrap(database.folder(fromID: folderId))
+        scheduler.scheduleFeeds([folder])
+
+        let retryDate = Date(timeIntervalSinceNow: 10 * 60)
+        scheduler.deferRefresh(ofFeed: folderId, until: retryDate)
+        XCTAssertEqual(scheduler.dueDate(ofFeed: folderId), retryDate)
+    }
+
+    /// The publication interval is the average interval between the first
+    /// and the last article of the last 30 days.
+    func testPublicationIntervalOfFolder() {
+        _ = database.arrayOfAllFolders()
+        let folderId = database.addRSSFolder(
+            "Feed", underParent: VNAFolderTypeRoot.rawValue, afterChild: 0,
+            subscriptionURL: "http://localhost/feed"
+        )
+        XCTAssertEqual(database.publicationInterval(ofFolder: folderId), 30 * Self.day)
+
+        let articles = [1.0, 3.0, 5.0].map { hours in
+            let article = Article(guid: "article-\(hours)")
+            article.title = "Article"
+            article.lastUpdate = Date(timeIntervalSinceNow: -hours * Self.hour)
+            return article
+        }
+        XCTAssertEqual(database.addArticles([articles[0]], toFolder: folderId).count, 1)
+        XCTAssertEqual(database.publicationInterval(ofFolder: folderId), 30 * Self.day)
+
+        XCTAssertEqual(database.addArticles(Array(articles[1...]), toFolder: folderId).count, 2)
+        XCTAssertEqual(database.publicationInterval(ofFolder: folderId), 2 * Self.hour, accuracy: 1)
+    }
+
+    /// A feed that is refreshed once a day keeps its due date when the base
+    /// interval changes, since its interval does not change.
+    func testBaseIntervalChangeKeepsElapsedTime() throws {
+        let folderId = database.addRSSFolder(
+            "Feed", underParent: VNAFolderTypeRoot.rawValue, afterChild: 0,
+            subscriptionURL: "http://localhost/feed"
+        )
+        let folder = try XCTUnwrap(database.folder(fromID: folderId))
+        scheduler.scheduleFeeds([folder])
+        scheduler.deferRefresh(ofFeed: folderId, until: Date(timeIntervalSinceNow: Self.hour))
+
+        scheduler.baseInterval = 2 * Self.hour
+        let dueDate = try XCTUnwrap(scheduler.dueDate(ofFeed: folderId))
+        XCTAssertEqual(dueDate.timeIntervalSinceNow, Self.hour, accuracy: 60)
+    }
+
+    // MARK: Test utilities
+
+    func interval(
+        publicationInterval: TimeInterval = 0,
+        freshnessLifetime: TimeInterval = 0,
+        timeToLive: TimeInterval = 0,
+        countOfFailures: UInt = 0
+    ) -> TimeInterval {
+        scheduler.refreshInterval(
+            withPublicationInterval: publicationInterval,
+            freshnessLifetime: freshnessLifetime,
+            timeToLive: timeToLive,
+            countOfFailures: countOfFailures
+        )
+    }
+
+    func freshnessLifetime(_ headerFields: [String: String]) throws -> TimeInterval {
+        let url = try XCTUnwrap(URL(string: "http://localhost/feed"))
+        let response = try XCTUnwrap(HTTPURLResponse(
+            url: url, statusCode: 200, httpVersion: nil, headerFields: headerFields
+        ))
+        return VNARefreshScheduler.freshnessLifetime(of: response)
+    }
+
+}
@@ -0,0 +1,87 @@
+//
+//  RetentionEngineTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the retention policies of folders and the engine that applies them.
+class RetentionEngineTests: DatabaseTestCase {
+
+    func testRetentionPoliciesExpireAndPurgeInBatches() throws {
+        // Folder 2 holds the even and folder 3 the odd articles of guid-1 to
+        // guid-60, which are dated by their number. Every third is read.
+        populateFeeds(feedCount: 2, articleCount: 30)
+        XCTAssertTrue(database.setRetentionPolicy(VNARetentionPolicy(maximumAge: 0, maximumCount: 5, guidHistoryHorizon: 0), forFolder: 3))
+        XCTAssertEqual(database.retentionPolicy(forFolder: 3)?.maximumCount, 5)
+        XCTAssertNil(database.retentionPolicy(forFolder: 2))
+
+        let engine = VNARetentionEngine(database: database, defaultPolicy: VNARetentionPolicy.unlimited)
+        engine.batchSize = 3
+        var progress: [[Int]] = []
+        engine.progressHandler = { stage, completedCount, totalCount, _ in
+            progress.append([stage.rawValue, Int(completedCount), Int(totalCount)])
+        }
+
+        // The articles before guid-51, the oldest of the five most recent
+        // articles of folder 3, expire if they are read.
+        XCTAssertEqual(engine.expireArticles(), 8)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE deleted_flag = 1 AND folder_id = 3 AND date < 51 AND read_flag = 1"), 8)
+        XCTAssertEqual(database.countOfDeletedArticles, 8)
+        XCTAssertEqual(progress, [[VNARetentionStage.expiry.rawValue, 1, 2], [VNARetentionStage.expiry.rawValue, 2, 2]])
+
+        progress = []
+        XCTAssertEqual(engine.purgeDeletedArticles(), 8)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages"), 52)
+        XCTAssertEqual(progress.map { $0[1] }, [3, 6, 8])
+        XCTAssertTrue(progress.allSatisfy { $0[0] == VNARetentionStage.purge.rawValue && $0[2] == 8 })
+
+        // Deleting the folder deletes its policy.
+        XCTAssertTrue(database.deleteFolder(3))
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM retention_policies"), 0)
+    }
+
+    func testGuidHistoryIsPrunedBeyondHorizon() throws {
+        // The feed last listed guid-n on day n, and the articles up to
+        // guid-22 were deleted.
+        populateFeeds(feedCount: 1, articleCount: 30)
+        let sql = """
+            INSERT INTO rss_guids (message_id, folder_id, last_seen)
+            SELECT message_id, folder_id, date * 86400 FROM messages;
+            DELETE FROM messages WHERE date <= 22;
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+
+        // Of the guids of deleted articles, those not listed within ten days
+        // of day 30 are forgotten.
+        XCTAssertTrue(database.setRetentionPolicy(VNARetentionPolicy(maximumAge: 0, maximumCount: 0, guidHistoryHorizon: 10), forFolder: 2))
+        let engine = VNARetentionEngine(database: database, defaultPolicy: VNARetentionPolicy.unlimited)
+        engine.batchSize = 4
+        XCTAssertEqual(engine.pruneGuidHistory(), 19)
+        XCTAssertEqual(database.guidHistory(forFolderId: 2), Set((20...30).map { "guid-\($0)" }))
+
+        // A guid that the feed lists today is kept, while the other guids of
+        // deleted articles are now beyond the horizon.
+        database.markGuids(["guid-21"], seenInFolder: 2)
+        XCTAssertEqual(countOfRows("SELECT message_id FROM rss_guids WHERE message_id = 'guid-21' AND last_seen > 30 * 86400"), 1)
+        XCTAssertEqual(engine.pruneGuidHistory(), 2)
+        XCTAssertEqual(database.guidHistory(forFolderId: 2), Set(([21] + Array(23...30)).map { "guid-\($0)" }))
+    }
+
+}
@@ -0,0 +1,37 @@
+//
+//  RowDecodingTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests the typed columns of the database.
+class RowDecodingTests: DatabaseTestCase {
+
+    func testNumbersAreStoredAsNumbers() {
+        let articles = makeArticles(count: 1, prefix: "typed")
+        articles[0].isFlagged = true
+        XCTAssertEqual(database.addArticles(articles, toFolder: 1), IndexSet([0]))
+        XCTAssertEqual(countOfRows("""
+            SELECT id FROM messages WHERE typeof(folder_id) = 'integer' AND typeof(read_flag) = 'integer'
+            AND typeof(marked_flag) = 'integer' AND marked_flag = 1 AND typeof(date) = 'real' AND typeof(createddate) = 'real'
+            """), 1)
+        XCTAssertEqual(countOfRows("SELECT folder_id FROM folders WHERE typeof(type) = 'integer' AND typeof(unread_count) = 'integer'"), 1)
+    }
+
+}
@@ -0,0 +1,65 @@
+//
+//  SmartFolderMembersTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import SQLite3
+@testable import Vienna
+import XCTest
+
+/// Tests the stored members of smart folders.
+class SmartFolderMembersTests: DatabaseTestCase {
+
+    func testSmartFolderMembersFollowArticles() throws {
+        // Of the articles guid-1 to guid-200, every 50th is flagged.
+        populateFeeds(feedCount: 2, articleCount: 100)
+        _ = database.arrayOfAllFolders()
+        let flagged = CriteriaTree(subtree: [Criteria(field: MA_Field_Flagged, operatorType: .equalTo, value: "Yes")], condition: .all)
+        let folderId = database.addSmartFolder("Flagged", underParent: VNAFolderType.root.rawValue, withQuery: flagged)
+        let members = "SELECT id FROM smart_folder_members WHERE folder_id = \(folderId)"
+
+        // The members are stored once the criteria were read twice.
+        let flaggedGuids: Set = ["guid-50", "guid-100", "guid-150", "guid-200"]
+        XCTAssertEqual(guidsOfArticles(inFolder: folderId), flaggedGuids)
+        XCTAssertEqual(countOfRows(members), 0)
+        XCTAssertEqual(guidsOfArticles(inFolder: folderId), flaggedGuids)
+        XCTAssertEqual(countOfRows(members), 4)
+
+        let sql = """
+            UPDATE messages SET marked_flag = 1 WHERE message_id = 'guid-1';
+            UPDATE messages SET read_flag = 1 WHERE message_id = 'guid-2';
+            DELETE FROM messages WHERE message_id = 'guid-50';
+            """
+        XCTAssertEqual(sqlite3_exec(connection, sql, nil, nil, nil), SQLITE_OK, String(cString: sqlite3_errmsg(connection)))
+        XCTAssertEqual(countOfRows("SELECT id FROM smart_folder_changes"), 3)
+        XCTAssertEqual(guidsOfArticles(inFolder: folderId), ["guid-1", "guid-100", "guid-150", "guid-200"])
+        XCTAssertEqual(countOfRows(members), 4)
+        XCTAssertEqual(countOfRows("SELECT id FROM smart_folder_changes"), 0)
+
+        // Editing the criteria drops the members.
+        let unflagged = CriteriaTree(subtree: [Criteria(field: MA_Field_Flagged, operatorType: .equalTo, value: "No")], condition: .all)
+        database.updateSearchFolder(folderId, withFolder: "Unflagged", withQuery: unflagged)
+        XCTAssertEqual(countOfRows(members), 0)
+        XCTAssertEqual(guidsOfArticles(inFolder: folderId).count, 195)
+        XCTAssertEqual(guidsOfArticles(inFolder: folderId).count, 195)
+        XCTAssertEqual(countOfRows(members), 195)
+
+        XCTAssertTrue(database.deleteFolder(folderId))
+        XCTAssertEqual(countOfRows(members), 0)
+    }
+
+}
@@ -0,0 +1,45 @@
+//
+//  SyncReconciliationTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@testable import Vienna
+import XCTest
+
+/// Tests reconciling the read and starred flags of articles with the lists
+/// of an Open Reader server.
+class SyncReconciliationTests: DatabaseTestCase {
+
+    func testReconciliationReturnsChangedArticles() throws {
+        // Of the articles guid-1 to guid-30, every third is read.
+        populateFeeds(feedCount: 1, articleCount: 30)
+        _ = database.arrayOfAllFolders()
+        let folder = try XCTUnwrap(database.folder(fromID: 2))
+
+        let unreadGuids = ["guid-1", "guid-3", "guid-4", "guid-4", "guid-1000"]
+        let expectedGuids = Set((1...30).filter { $0 % 3 != 0 && $0 != 1 && $0 != 4 }.map { "guid-\($0)" } + ["guid-3"])
+        XCTAssertEqual(Set(database.markUnreadArticlesFromFolder(folder, guidArray: unreadGuids)), expectedGuids)
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE read_flag = 0"), 3)
+        XCTAssertEqual(folder.unreadCount, 3)
+        XCTAssertEqual(database.markUnreadArticlesFromFolder(folder, guidArray: unreadGuids), [])
+
+        XCTAssertEqual(Set(database.markStarredArticlesFromFolder(folder, guidArray: ["guid-2", "guid-5"])), ["guid-2", "guid-5"])
+        XCTAssertEqual(database.markStarredArticlesFromFolder(folder, guidArray: []), ["guid-2", "guid-5"])
+        XCTAssertEqual(countOfRows("SELECT id FROM messages WHERE marked_flag = 1"), 0)
+    }
+
+}
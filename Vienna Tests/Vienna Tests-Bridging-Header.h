@@ -3,13 +3,24 @@
 //
 #import "Vienna-Bridging-Header.h"
 
+#import "ArticlePageSource.h"
+#import "AtomFeed.h"
 #import "Database.h"
+#import "Database+Migration.h"
+#import "DatabaseBackup.h"
+#import "DatabaseInstrumentation.h"
+#import "DatabaseMaintenance.h"
 #import "DownloadItem.h"
 #import "Export.h"
 #import "Field.h"
 #import "FoldersTree.h"
+#import "HostThrottle.h"
+#import "NSData+Compression.h"
 #import "NSFileManager+Paths.h"
 #import "RSSFeed.h"
+#import "RefreshPipeline.h"
+#import "RefreshScheduler.h"
+#import "RetentionEngine.h"
 #import "SearchMethod.h"
 #import "SubscriptionModel.h"
 #import "XMLFeedParser.h"
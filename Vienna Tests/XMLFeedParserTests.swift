@@ -0,0 +1,194 @@
+//
+//  XMLFeedParserTests.swift
+//  Vienna Tests
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import XCTest
+
+class XMLFeedParserTests: XCTestCase {
+
+    static let benchmarkEnvironmentKey = "VIENNA_RUN_BENCHMARKS"
+
+    var runsBenchmarks: Bool {
+        ProcessInfo.processInfo.environment[Self.benchmarkEnvironmentKey] != nil
+    }
+
+    // MARK: Test methods
+
+    func testParsingAtomFeed() throws {
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: Data("""
+            <?xml version="1.0" encoding="utf-8"?>
+            <feed xmlns="http://www.w3.org/2005/Atom">
+              <title>Feed title</title>
+              <link href="https://example.org/"/>
+              <author><name>Feed author</name></author>
+              <entry>
+                <id>entry1</id>
+                <title>Entry title</title>
+                <link href="https://example.org/entry1"/>
+                <content type="html">&lt;p&gt;Entry content&lt;/p&gt;</content>
+              </entry>
+            </feed>
+            """.utf8))
+        let atomFeed = try XCTUnwrap(feedData as? AtomFeed)
+        let feedItem = try XCTUnwrap(atomFeed.items.first)
+
+        XCTAssertEqual(atomFeed.title, "Feed title")
+        XCTAssertEqual(atomFeed.items.count, 1)
+        XCTAssertEqual(feedItem.guid, "entry1")
+        XCTAssertEqual(feedItem.authors, "Feed author")
+        XCTAssertEqual(feedItem.url, "https://example.org/entry1")
+        XCTAssertEqual(feedItem.content, "<p>Entry content</p>")
+    }
+
+    /// HTML entities are not defined in XML, but feeds use them anyway.
+    func testParsingUndefinedEntities() throws {
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: rssData(
+            channelTitle: "Caf&eacute; Feed",
+            items: ["<item><guid>item1</guid><title>Read more&hellip;</title></item>"]
+        ))
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        XCTAssertEqual(rssFeed.title, "Café Feed")
+        XCTAssertEqual(rssFeed.items.first?.title, "Read more…")
+    }
+
+    /// Unknown entities are kept as they are written, and do not make the
+    /// parser drop the entities that follow.
+    func testParsingUnknownEntities() throws {
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: rssData(
+            items: ["<item><guid>item1</guid><title>&product; &amp; &eacute;clair</title></item>"]
+        ))
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        let title = try XCTUnwrap(rssFeed.items.first?.title)
+
+        XCTAssert(title.hasPrefix("&product;"), title)
+        XCTAssert(title.hasSuffix("éclair"), title)
+    }
+
+    /// The link of the channel applies to the items without a link, and to
+    /// the relative URLs in their content, even if it follows them.
+    func testParsingChannelLinkAfterItems() throws {
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: Data("""
+            <?xml version="1.0" encoding="utf-8"?>
+            <rss version="2.0">
+              <channel>
+                <title>Feed title</title>
+                <item>
+                  <guid>item1</guid>
+                  <description>&lt;img src="images/photo.jpg"&gt;</description>
+                </item>
+                <link>https://example.org/blog/</link>
+              </channel>
+            </rss>
+            """.utf8))
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+        let feedItem = try XCTUnwrap(rssFeed.items.first)
+
+        XCTAssertEqual(feedItem.url, "https://example.org/blog/")
+        XCTAssert(feedItem.content.contains("https://example.org/blog/images/photo.jpg"), feedItem.content)
+    }
+
+    func testParsingWhitespaceBeforeDeclaration() throws {
+        let xmlData = Data("\n  ".utf8) + rssData(items: ["<item><guid>item1</guid></item>"])
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: xmlData)
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        XCTAssertEqual(rssFeed.items.count, 1)
+    }
+
+    /// The items before and after a malformed item are read.
+    func testParsingMalformedItem() throws {
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: rssData(items: [
+            "<item><guid>item1</guid></item>",
+            "<item><guid>item2</guid><title>Unclosed <b>tag</title></item>",
+            "<item><guid>item3</guid></item>",
+        ]))
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+        let guids = rssFeed.items.map(\.guid)
+
+        XCTAssert(guids.contains("item1"))
+        XCTAssert(guids.contains("item3"))
+    }
+
+    func testParsingTruncatedFeed() throws {
+        var xmlData = rssData(items: [
+            "<item><guid>item1</guid></item>",
+            "<item><guid>item2</guid></item>",
+        ])
+        xmlData.removeLast(40)
+        let feedData = try VNAXMLFeedParser().feed(withXMLData: xmlData)
+        let rssFeed = try XCTUnwrap(feedData as? RSSFeed)
+
+        XCTAssertEqual(rssFeed.items.first?.guid, "item1")
+    }
+
+    func testParsingEmptyDocument() {
+        XCTAssertThrowsError(try VNAXMLFeedParser().feed(withXMLData: Data(" \n".utf8))) { error in
+            XCTAssertEqual((error as NSError).code, XMLParser.ErrorCode.emptyDocumentError.rawValue)
+        }
+    }
+
+    func testParsingHTMLDocument() {
+        let htmlData = Data("<html><head><title>Page</title></head><body></body></html>".utf8)
+        XCTAssertThrowsError(try VNAXMLFeedParser().feed(withXMLData: htmlData))
+    }
+
+    // MARK: Benchmarks
+
+    /// Measures the time and the peak memory of parsing a large feed of
+    /// synthesized items.
+    func testParsingPerformance() throws {
+        try XCTSkipUnless(runsBenchmarks, "Set \(Self.benchmarkEnvironmentKey) to run benchmarks")
+
+        let body = String(repeating: "<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p>", count: 50)
+        let items = (0..<10_000).map { index in
+            """
+            <item>
+              <guid>item\(index)</guid>
+              <title>Item \(index)</title>
+              <link>https://example.org/items/\(index)</link>
+              <pubDate>Sat, 13 Dec 2008 18:45:15 +0300</pubDate>
+              <description><![CDATA[\(body)]]></description>
+            </item>
+            """
+        }
+        let xmlData = rssData(items: items)
+
+        measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+            let feedData = try? VNAXMLFeedParser().feed(withXMLData: xmlData)
+            XCTAssertEqual(feedData?.items.count, items.count)
+        }
+    }
+
+    // MARK: Test utilities
+
+    func rssData(channelTitle: String = "Feed title", items: [String]) -> Data {
+        Data("""
+            <?xml version="1.0" encoding="utf-8"?>
+            <rss version="2.0">
+              <channel>
+                <title>\(channelTitle)</title>
+                <link>https://example.org/</link>
+                \(items.joined(separator: "\n"))
+              </channel>
+            </rss>
+            """.utf8)
+    }
+
+}
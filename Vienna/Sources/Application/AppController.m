@@ -27,6 +27,7 @@
 #import "Import.h"
 #import "Export.h"
 #import "RefreshManager.h"
+#import "RefreshScheduler.h"
 #import "StringExtensions.h"
 #import "SmartFolder.h"
 #import "NewSubscription.h"
@@ -43,6 +44,10 @@
 #import "SearchMethod.h"
 #import "OpenReader.h"
 #import "Database.h"
+#import "DatabaseBackup.h"
+#import "DatabaseInstrumentation.h"
+#import "DatabaseMaintenance.h"
+#import "RetentionEngine.h"
 #import "NSURL+CaminoExtensions.h"
 #import "PluginManager.h"
 #import "ArticleController.h"
@@ -62,6 +67,12 @@ static NSStoryboardSegueIdentifier const VNAOrderFrontActivityPanelSegueIdentifi
 
 static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
 
+// The refresh scheduler hands feeds over in small batches, each of which
+// completes a refresh. The work that follows a refresh is spread out by
+// these intervals.
+static NSTimeInterval const VNARefreshMaintenanceInterval = 60.0 * 60.0;
+static NSTimeInterval const VNANewArticlesNotificationInterval = 10.0 * 60.0;
+
 @interface AppController () <InfoPanelControllerDelegate, ActivityPanelControllerDelegate, NSMenuItemValidation, NSToolbarItemValidation>
 
 -(void)installScriptsFolderWatcher;
@@ -83,7 +94,13 @@ static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
 -(void)updateCloseCommands;
 -(IBAction)cancelAllRefreshesToolbar:(id)sender;
 
-@property (nonatomic) VNADispatchTimer *refreshTimer;
+@property (nonatomic) VNARefreshScheduler *refreshScheduler;
+@property (nonatomic) NSDate *lastSubscriptionsLoad;
+@property (nonatomic) NSDate *lastRefreshMaintenance;
+@property (nonatomic) NSDate *lastNewArticlesNotification;
+@property (nonatomic) NSInteger countOfUnnotifiedArticles;
+@property (nonatomic) VNADatabaseMaintenance *databaseMaintenance;
+@property (nonatomic) VNADatabaseBackup *databaseBackup;
 
 @property (nonatomic) VNAMainWindowController *mainWindowController;
 @property (nonatomic) ArticleController *articleController;
@@ -184,7 +201,8 @@ static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
         } else if (prefs.refreshOnStartup) {
             [self refreshAllSubscriptions];
         }
-		
+
+        [self scheduleDatabaseMaintenance];
 	}
 	didCompleteInitialisation = YES;
 }
@@ -231,6 +249,10 @@ static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
         [NSApp terminate:nil];
         return;
     }
+    if ([[Preferences standardPreferences] boolForKey:MAPref_DatabaseInstrumentation]) {
+        db.instrumentation = [VNADatabaseInstrumentation new];
+        [self addDatabaseDebugMenu];
+    }
 
     self.mainWindowController = VNAMainWindowController.sharedWindowController;
 	self.mainWindow = self.mainWindowController.window;
@@ -256,6 +278,7 @@ static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
 	[nc addObserver:self selector:@selector(handleDidBecomeKeyWindow:) name:NSWindowDidBecomeKeyNotification object:nil];
 	[nc addObserver:self selector:@selector(handleShowAppInStatusBar:) name:MA_Notify_ShowAppInStatusBarChanged object:nil];
 	[nc addObserver:self selector:@selector(handleUpdateUnreadCount:) name:MA_Notify_FoldersUpdated object:nil];
+	[nc addObserver:self selector:@selector(handleUpdateUnreadCount:) name:VNADatabaseDidReloadFoldersNotification object:nil];
 	//Open Reader Notifications
     [nc addObserver:self selector:@selector(handleOpenReaderAuthFailed:) name:MA_Notify_OpenReaderAuthFailed object:nil];
 
@@ -462,8 +485,11 @@ static void *VNAAppControllerObserverContext = &VNAAppControllerObserverContext;
 		
         [[NSNotificationCenter defaultCenter]  removeObserver:self];
 	}
+	[self.databaseMaintenance cancel];
+	[self.databaseBackup cancel];
 	[db optimizeDatabase];
-	[db close];
+	[self saveDatabaseStatistics];
+	[db saveFolderSnapshotAndClose];
 }
 
 /* applicationSupportsSecureRestorableState [delegate]
@@ -1469,7 +1495,8 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
         [self scheduleRefreshWithFrequency:frequency refreshImmediately:NO];
     } else {
         // The user disabled the automatic refresh.
-        self.refreshTimer = nil;
+        [self.refreshScheduler cancel];
+        self.refreshScheduler = nil;
     }
 }
 
@@ -1543,63 +1570,128 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
 		item.action = @selector(cancelAllRefreshesToolbar:);
         item.state = NSControlStateValueOn;
 	} else {
-		// Run the auto-expire now
-		Preferences * prefs = [Preferences standardPreferences];
-		[db purgeArticlesOlderThanTag:prefs.autoExpireDuration];
+		[self performRefreshMaintenance];
 
 		// Toggle the refresh button
 		item.action = @selector(refreshAllSubscriptions:);
         item.state = NSControlStateValueOff;
 
 		[self showUnreadCountOnApplicationIconAndWindowTitle];
-		
-		// Bounce the dock icon for 1 second if the bounce method has been selected.
+
 		NSInteger newUnread = [RefreshManager sharedManager].countOfNewArticles + [OpenReader sharedManager].countOfNewArticles;
-		if (newUnread > 0 && ((prefs.newArticlesNotification & VNANewArticlesNotificationBounce) != 0)) {
-			[NSApp requestUserAttention:NSInformationalRequest];
+		if (newUnread > 0) {
+			self.countOfUnnotifiedArticles += newUnread;
+			[self scheduleNewArticlesNotification];
 		}
+	}
+}
 
-        // User notification
-        if (newUnread > 0) {
-            VNAUserNotificationCenter *center = VNAUserNotificationCenter.current;
-            [center getNotificationSettingsWithCompletionHandler:^(VNAUserNotificationSettings *settings) {
-                VNAUserNotificationAuthorizationStatus status = settings.authorizationStatus;
-                if (status == VNAUserNotificationAuthorizationStatusDenied) {
-                    return;
-                }
+/* performRefreshMaintenance
+ * Runs the auto-expire, forgets the guids that the feeds no longer list and
+ * backs up the database, at most once per VNARefreshMaintenanceInterval.
+ * The retention engine runs in the background, since it may go through
+ * every folder, and the backup follows it.
+ */
+-(void)performRefreshMaintenance
+{
+	if (self.lastRefreshMaintenance != nil &&
+		-self.lastRefreshMaintenance.timeIntervalSinceNow < VNARefreshMaintenanceInterval) {
+		return;
+	}
+	self.lastRefreshMaintenance = [NSDate date];
+
+	Preferences * prefs = [Preferences standardPreferences];
+	VNARetentionPolicy * policy = [[VNARetentionPolicy alloc] initWithMaximumAge:(NSUInteger)prefs.autoExpireDuration
+	                                                                maximumCount:0
+	                                                          guidHistoryHorizon:(NSUInteger)[prefs integerForKey:MAPref_GuidHistoryHorizon]];
+	VNARetentionEngine * retentionEngine = [[VNARetentionEngine alloc] initWithDatabase:db defaultPolicy:policy];
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		NSInteger countOfExpired = [retentionEngine expireArticles];
+		[retentionEngine pruneGuidHistory];
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if (countOfExpired > 0) {
+				// The unread counts of the folders and of the trash changed.
+				[[NSNotificationCenter defaultCenter] postNotificationName:MA_Notify_FoldersUpdated object:nil];
+			}
+			[self backUpDatabase];
+		});
+	});
+}
+
+/* scheduleNewArticlesNotification
+ * Announces the new articles of the refreshes at most once per
+ * VNANewArticlesNotificationInterval. The articles of the refreshes in
+ * between are added up and announced together.
+ */
+-(void)scheduleNewArticlesNotification
+{
+	[NSObject cancelPreviousPerformRequestsWithTarget:self
+	                                         selector:@selector(deliverNewArticlesNotification)
+	                                           object:nil];
+	NSTimeInterval delay = 0;
+	if (self.lastNewArticlesNotification != nil) {
+		delay = MAX(0, VNANewArticlesNotificationInterval + self.lastNewArticlesNotification.timeIntervalSinceNow);
+	}
+	[self performSelector:@selector(deliverNewArticlesNotification) withObject:nil afterDelay:delay];
+}
 
-                void (^deliverNotification)(void) = ^{
-                    NSString *identifier = UserNotificationContextFetchCompleted;
-                    NSString *title = NSLocalizedString(@"New articles retrieved",
-                                                        @"Notification title");
-                    NSString *body = [NSString stringWithFormat:NSLocalizedString(@"%d new unread articles retrieved",
-                                                                                  @"Notification body"),
-                                      (int)newUnread];
-                    VNAUserNotificationRequest *request =
-                        [[VNAUserNotificationRequest alloc] initWithIdentifier:identifier
-                                                                         title:title];
-                    request.body = body;
-                    request.playSound = settings.isSoundEnabled;
-                    request.userInfo = @{
-                        UserNotificationContextKey: UserNotificationContextFetchCompleted
-                    };
-                    [center addNotificationRequest:request
-                             withCompletionHandler:nil];
-                };
-
-                if (status == VNAUserNotificationAuthorizationStatusProvisional ||
-                    status == VNAUserNotificationAuthorizationStatusAuthorized) {
+/* deliverNewArticlesNotification
+ * Bounces the dock icon and posts a user notification for the new articles
+ * that have not been announced yet.
+ */
+-(void)deliverNewArticlesNotification
+{
+	NSInteger newUnread = self.countOfUnnotifiedArticles;
+	if (newUnread <= 0) {
+		return;
+	}
+	self.countOfUnnotifiedArticles = 0;
+	self.lastNewArticlesNotification = [NSDate date];
+
+	// Bounce the dock icon for 1 second if the bounce method has been selected.
+	Preferences * prefs = [Preferences standardPreferences];
+	if ((prefs.newArticlesNotification & VNANewArticlesNotificationBounce) != 0) {
+		[NSApp requestUserAttention:NSInformationalRequest];
+	}
+
+    // User notification
+    VNAUserNotificationCenter *center = VNAUserNotificationCenter.current;
+    [center getNotificationSettingsWithCompletionHandler:^(VNAUserNotificationSettings *settings) {
+        VNAUserNotificationAuthorizationStatus status = settings.authorizationStatus;
+        if (status == VNAUserNotificationAuthorizationStatusDenied) {
+            return;
+        }
+
+        void (^deliverNotification)(void) = ^{
+            NSString *identifier = UserNotificationContextFetchCompleted;
+            NSString *title = NSLocalizedString(@"New articles retrieved",
+                                                @"Notification title");
+            NSString *body = [NSString stringWithFormat:NSLocalizedString(@"%d new unread articles retrieved",
+                                                                          @"Notification body"),
+                              (int)newUnread];
+            VNAUserNotificationRequest *request =
+                [[VNAUserNotificationRequest alloc] initWithIdentifier:identifier
+                                                                 title:title];
+            request.body = body;
+            request.playSound = settings.isSoundEnabled;
+            request.userInfo = @{
+                UserNotificationContextKey: UserNotificationContextFetchCompleted
+            };
+            [center addNotificationRequest:request
+                     withCompletionHandler:nil];
+        };
+
+        if (status == VNAUserNotificationAuthorizationStatusProvisional ||
+            status == VNAUserNotificationAuthorizationStatusAuthorized) {
+            deliverNotification();
+        } else if (status == VNAUserNotificationAuthorizationStatusNotDetermined) {
+            [center requestAuthorizationWithCompletionHandler:^(BOOL granted) {
+                if (granted) {
                     deliverNotification();
-                } else if (status == VNAUserNotificationAuthorizationStatusNotDetermined) {
-                    [center requestAuthorizationWithCompletionHandler:^(BOOL granted) {
-                        if (granted) {
-                            deliverNotification();
-                        }
-                    }];
                 }
             }];
         }
-	}
+    }];
 }
 
 - (IBAction)openStylesPage:(id)sender
@@ -2439,6 +2531,119 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
 	}
 }
 
+#pragma mark Database Maintenance
+
+/* scheduleDatabaseMaintenance
+ * Releases the free pages of the database and refreshes its statistics every
+ * quarter of an hour, provided that no subscriptions are being refreshed and
+ * the user has not used the computer for a minute.
+ */
+-(void)scheduleDatabaseMaintenance
+{
+    if (db.readOnly) {
+        return;
+    }
+    self.databaseMaintenance = [[VNADatabaseMaintenance alloc] initWithDatabase:db];
+    NSInteger budget = [[Preferences standardPreferences] integerForKey:MAPref_DatabaseMaintenanceBudget];
+    self.databaseMaintenance.writeBudget = budget / 1000.0;
+    self.databaseMaintenance.idleCondition = ^BOOL{
+        CFTimeInterval idleTime = CGEventSourceSecondsSinceLastEventType(kCGEventSourceStateCombinedSessionState,
+                                                                         kCGAnyInputEventType);
+        return !RefreshManager.sharedManager.connecting && idleTime >= 60.0;
+    };
+    [self.databaseMaintenance scheduleWithInterval:15 * 60];
+}
+
+#pragma mark Database Backup
+
+/* backUpDatabase
+ * Takes a snapshot of the database in the background after the subscriptions
+ * have been refreshed, unless the last one is more recent than the hidden
+ * DatabaseBackupInterval preference.
+ */
+-(void)backUpDatabase
+{
+    if (db.readOnly) {
+        return;
+    }
+    Preferences * prefs = [Preferences standardPreferences];
+    if (self.databaseBackup == nil) {
+        self.databaseBackup = [[VNADatabaseBackup alloc] initWithDatabase:db];
+    }
+    self.databaseBackup.maximumCountOfSnapshots = (NSUInteger)MAX([prefs integerForKey:MAPref_DatabaseBackupCount], 1);
+    self.databaseBackup.minimumInterval = [prefs integerForKey:MAPref_DatabaseBackupInterval] * 60.0;
+    [self.databaseBackup scheduleSnapshot];
+}
+
+#pragma mark Database Instrumentation
+
+/* addDatabaseDebugMenu
+ * Adds a menu to export and reset the statistics of the database statements.
+ * The menu is only shown if the hidden DatabaseInstrumentation preference is
+ * set, so it is not localized.
+ */
+-(void)addDatabaseDebugMenu
+{
+    NSMenu * debugMenu = [[NSMenu alloc] initWithTitle:@"Debug"];
+    [debugMenu addItemWithTitle:@"Export Database Statistics…"
+                         action:@selector(exportDatabaseStatistics:)
+                  keyEquivalent:@""];
+    [debugMenu addItemWithTitle:@"Reset Database Statistics"
+                         action:@selector(resetDatabaseStatistics:)
+                  keyEquivalent:@""];
+
+    NSMenuItem * debugMenuItem = [[NSMenuItem alloc] initWithTitle:@"Debug" action:NULL keyEquivalent:@""];
+    debugMenuItem.submenu = debugMenu;
+    NSInteger helpMenuIndex = NSApp.mainMenu.numberOfItems - 1;
+    [NSApp.mainMenu insertItem:debugMenuItem atIndex:helpMenuIndex];
+}
+
+/* exportDatabaseStatistics
+ * Saves the statistics of the database statements as JSON where the user
+ * chooses.
+ */
+-(IBAction)exportDatabaseStatistics:(id)sender
+{
+    NSSavePanel * panel = [NSSavePanel savePanel];
+    panel.nameFieldStringValue = @"DatabaseStatistics.json";
+    [panel beginSheetModalForWindow:self.mainWindow completionHandler:^(NSModalResponse returnCode) {
+        if (returnCode != NSModalResponseOK) {
+            return;
+        }
+        NSError * error = nil;
+        if (![self->db.instrumentation writeJSONToURL:panel.URL error:&error]) {
+            [NSApp presentError:error];
+        }
+    }];
+}
+
+/* resetDatabaseStatistics
+ * Discards the statistics of the database statements, e.g. before a
+ * measurement.
+ */
+-(IBAction)resetDatabaseStatistics:(id)sender
+{
+    [db.instrumentation reset];
+}
+
+/* saveDatabaseStatistics
+ * Leaves the statistics of the database statements of the session next to
+ * the database, so that they are available without the debug menu.
+ */
+-(void)saveDatabaseStatistics
+{
+    if (db.instrumentation == nil) {
+        return;
+    }
+    NSString * databaseFolder = [Preferences standardPreferences].defaultDatabase.stringByExpandingTildeInPath.stringByDeletingLastPathComponent;
+    NSURL * url = [NSURL fileURLWithPath:[databaseFolder stringByAppendingPathComponent:@"DatabaseStatistics.json"]];
+    NSError * error = nil;
+    if (![db.instrumentation writeJSONToURL:url error:&error]) {
+        os_log_error(VNA_LOG, "Could not save the database statistics. Reason: %{public}@",
+                     error.localizedDescription);
+    }
+}
+
 #pragma mark Refresh Subscriptions
 
 // This method is run as a result of -applicationDidFinishLaunching: or by way
@@ -2447,28 +2652,49 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
                   refreshImmediately:(BOOL)refreshImmediately
 {
     NSTimeInterval interval = (NSTimeInterval)frequency;
-    if (self.refreshTimer) {
-        [self.refreshTimer rescheduleWithInterval:interval
-                                  fireImmediately:refreshImmediately];
+    if (self.refreshScheduler) {
+        self.refreshScheduler.baseInterval = interval;
     } else {
-        self.refreshTimer =
-            [[VNADispatchTimer alloc] initWithInterval:interval
-                                       fireImmediately:refreshImmediately
-                                         dispatchQueue:dispatch_get_main_queue()
-                                          eventHandler:^{
-                if (VNANetworkIsReachable()) {
-                    [self refreshAllSubscriptions];
-                } else {
-                    // the time offset is for allowing network reactivation
-                    // after wakeup from sleep
-                    [self performSelector:@selector(refreshAllSubscriptions)
-                               withObject:nil
-                               afterDelay:20.0];
-                }
-            }];
+        // The refresh frequency is the shortest interval. Each feed is
+        // refreshed when it is due, which depends on how often it publishes.
+        self.refreshScheduler =
+            [[VNARefreshScheduler alloc] initWithDatabase:db
+                                             baseInterval:interval];
+        __weak typeof(self) weakSelf = self;
+        self.refreshScheduler.refreshHandler = ^BOOL(NSArray<Folder *> *folders) {
+            return [weakSelf refreshScheduledSubscriptions:folders];
+        };
+        RefreshManager.sharedManager.scheduler = self.refreshScheduler;
+        [self.refreshScheduler scheduleFeeds:[self.foldersTree folders:0]];
+    }
+    if (refreshImmediately) {
+        [self refreshAllSubscriptions];
     }
 }
 
+// Called by the refresh scheduler when feeds are due. Returns NO if the feeds
+// should be handed over again later, e.g. while the network is reactivated
+// after wakeup from sleep.
+- (BOOL)refreshScheduledSubscriptions:(NSArray<Folder *> *)folders
+{
+    if (!VNANetworkIsReachable()) {
+        return NO;
+    }
+
+    // Pick up feeds that were added since the last call.
+    [self.refreshScheduler scheduleFeeds:[self.foldersTree folders:0]];
+
+    if (Preferences.standardPreferences.syncOpenReader &&
+        (!self.lastSubscriptionsLoad ||
+         -self.lastSubscriptionsLoad.timeIntervalSinceNow >= self.refreshScheduler.baseInterval)) {
+        self.lastSubscriptionsLoad = [NSDate date];
+        [OpenReader.sharedManager loadSubscriptions];
+    }
+    [RefreshManager.sharedManager refreshSubscriptions:folders
+                            ignoringSubscriptionStatus:NO];
+    return YES;
+}
+
 - (void)refreshAllSubscriptions
 {
     if (self.connecting) {
@@ -2476,6 +2702,7 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
     }
 
     if (Preferences.standardPreferences.syncOpenReader) {
+        self.lastSubscriptionsLoad = [NSDate date];
         [OpenReader.sharedManager loadSubscriptions];
     }
     [RefreshManager.sharedManager refreshSubscriptions:[self.foldersTree folders:0]
@@ -2498,11 +2725,7 @@ withReplyEvent:(NSAppleEventDescriptor *)replyEvent
  */
 -(IBAction)refreshAllSubscriptions:(id)sender
 {
-    if (self.refreshTimer) {
-        [self.refreshTimer fire];
-    } else {
-        [self refreshAllSubscriptions];
-    }
+    [self refreshAllSubscriptions];
 }
 
 -(IBAction)forceRefreshSelectedSubscriptions:(id)sender {
@@ -21,13 +21,135 @@ import Foundation
 
 @objc
 protocol SQLConversion {
-    @objc(toSQLForDatabase:)
-    func toSQL(database: Database) -> String
+    /// Compiles the criteria into SQL with a placeholder for each value. The
+    /// values, including dates relative to the current time, are resolved
+    /// anew by every call.
+    @objc(compiledSQLForDatabase:)
+    func compiledSQL(database: Database) -> CriteriaSQL
+
+    /// The SQL fields that the SQL of the criteria refers to.
+    @objc(sqlFieldsForDatabase:)
+    func sqlFields(database: Database) -> Set<String>
+}
+
+/// An SQL expression compiled from criteria, together with the values for
+/// its placeholders. Criteria with the same structure compile to the same
+/// SQL, so that SQLite can reuse the prepared statement for all of them.
+@objc(VNACriteriaSQL)
+final class CriteriaSQL: NSObject {
+
+    /// The SQL expression, with a `?` placeholder for each argument.
+    @objc let sql: String
+
+    /// The values to bind to the placeholders, in order.
+    @objc let arguments: [Any]
+
+    @objc
+    init(sql: String, arguments: [Any]) {
+        self.sql = sql
+        self.arguments = arguments
+    }
+
+    /// The SQL expression with the arguments written as literals in place of
+    /// the placeholders. Two compilations of criteria select the same
+    /// articles if their resolved SQL is equal.
+    @objc var resolvedSQL: String {
+        var resolvedSQL = ""
+        var remainingArguments = arguments[...]
+        for character in sql {
+            // The compiled SQL has no string literals with a question mark.
+            guard character == "?", let argument = remainingArguments.popFirst() else {
+                resolvedSQL.append(character)
+                continue
+            }
+            if let number = argument as? NSNumber {
+                resolvedSQL += number.stringValue
+            } else {
+                resolvedSQL += "'" + "\(argument)".replacingOccurrences(of: "'", with: "''") + "'"
+            }
+        }
+        return resolvedSQL
+    }
+}
+
+/// The SQL of a structure of criteria and how to obtain the value of each
+/// placeholder from the criteria of a tree with that structure.
+private final class CriteriaSQLTemplate {
+
+    typealias Parameter = (criteriaIndex: Int, value: Criteria.ParameterValue)
+
+    let sql: String
+    let parameters: [Parameter]
+
+    init(sql: String, parameters: [Parameter]) {
+        self.sql = sql
+        self.parameters = parameters
+    }
+
+    /// The templates of the structures that were compiled before. The SQL of
+    /// the fields does not change while the application runs.
+    static let cache = NSCache<NSString, CriteriaSQLTemplate>()
 }
 
 @objc
 extension CriteriaTree: SQLConversion {
-    func toSQL(database: Database) -> String {
+    func compiledSQL(database: Database) -> CriteriaSQL {
+        let criteria = leafCriteria()
+        let key = structuralKey(database: database) as NSString
+        let template: CriteriaSQLTemplate
+        if let cachedTemplate = CriteriaSQLTemplate.cache.object(forKey: key) {
+            template = cachedTemplate
+        } else {
+            var parameters: [CriteriaSQLTemplate.Parameter] = []
+            var criteriaCount = 0
+            let sql = templateSQL(database: database, parameters: &parameters, criteriaCount: &criteriaCount)
+            template = CriteriaSQLTemplate(sql: sql, parameters: parameters)
+            CriteriaSQLTemplate.cache.setObject(template, forKey: key)
+        }
+        let arguments = template.parameters.map { parameter in
+            parameter.value(criteria[parameter.criteriaIndex], database)
+        }
+        return CriteriaSQL(sql: template.sql, arguments: arguments)
+    }
+
+    func sqlFields(database: Database) -> Set<String> {
+        return traverse(treeConversion: { _, subresult in
+            subresult.reduce(into: Set<String>()) { $0.formUnion($1) }
+        }, criteriaConversion: { crit in
+            crit.sqlFields(database: database)
+        })
+    }
+}
+
+extension CriteriaTree {
+
+    /// Forgets the templates of the structures that were compiled before, so
+    /// that the next trees are compiled anew.
+    static func removeCachedSQLTemplates() {
+        CriteriaSQLTemplate.cache.removeAllObjects()
+    }
+
+    /// The criteria of the tree in the order of the placeholders.
+    func leafCriteria() -> [Criteria] {
+        return traverse(treeConversion: { _, subresult in
+            subresult.flatMap { $0 }
+        }, criteriaConversion: { crit in
+            [crit]
+        })
+    }
+
+    /// A key that is equal for trees that compile to the same SQL.
+    func structuralKey(database: Database) -> String {
+        return traverse(treeConversion: { tree, subresult in
+            "\(tree.condition.rawValue)(\(subresult.joined(separator: ",")))"
+        }, criteriaConversion: { crit in
+            crit.structuralKey(database: database)
+        })
+    }
+
+    /// Returns the SQL of the tree. The parameters are numbered by the index
+    /// of their criteria among the leaf criteria of the tree.
+    fileprivate func templateSQL(database: Database, parameters: inout [CriteriaSQLTemplate.Parameter], criteriaCount: inout Int) -> String {
 
         let sqlOperator: String
         let noneConditionPrefix: String
@@ -45,9 +167,13 @@ extension CriteriaTree: SQLConversion {
 
         return noneConditionPrefix + criteriaTree.map { crit in
             if let crit = crit as? CriteriaTree {
-                return "( \(crit.toSQL(database: database)) )"
+                return "( \(crit.templateSQL(database: database, parameters: &parameters, criteriaCount: &criteriaCount)) )"
             } else if let crit = crit as? Criteria {
-                return crit.toSQL(database: database)
+                let criteriaIndex = criteriaCount
+                criteriaCount += 1
+                let (sql, values) = crit.templateSQL(database: database)
+                parameters += values.map { (criteriaIndex, $0) }
+                return sql
             } else {
                 fatalError("faulty criteria type \(type(of: crit))")
             }
@@ -57,7 +183,36 @@ extension CriteriaTree: SQLConversion {
 
 @objc
 extension Criteria: SQLConversion {
-    func toSQL(database: Database) -> String {
+    func compiledSQL(database: Database) -> CriteriaSQL {
+        return CriteriaTree(subtree: [self], condition: .all).compiledSQL(database: database)
+    }
+
+    func sqlFields(database: Database) -> Set<String> {
+        guard let sqlField = database.field(byName: field)?.sqlField else {
+            return []
+        }
+        // The text criteria also search the title, see templateSQL(database:).
+        if field == MA_Field_Text, let subjectField = database.field(byName: MA_Field_Subject)?.sqlField {
+            return [sqlField, subjectField]
+        }
+        return [sqlField]
+    }
+}
+
+extension Criteria {
+
+    /// The value of a placeholder in the SQL of criteria.
+    typealias ParameterValue = (Criteria, Database) -> Any
+
+    /// A key that is equal for criteria that compile to the same SQL.
+    func structuralKey(database: Database) -> String {
+        let variant = fullTextColumn(database: database) != nil ? "fts" : "sql"
+        return "\(field):\(operatorType.rawValue):\(variant)"
+    }
+
+    /// Returns the SQL of the criteria and a function for the value of each
+    /// placeholder. The SQL may only depend on the structural key.
+    func templateSQL(database: Database) -> (String, [ParameterValue]) {
         guard let databaseField = database.field(byName: field), let sqlField = databaseField.sqlField else {
             fatalError("Criteria field \(field) does not have an associated database field")
         }
@@ -69,14 +224,23 @@ extension Criteria: SQLConversion {
         case .date:
             return dateSqlString(sqlFieldName: sqlFieldName)
         case .folder:
-            return folderSqlString(sqlFieldName: sqlFieldName, database: database)
+            return folderSqlString(sqlFieldName: sqlFieldName)
         case .integer:
             return integerSqlString(sqlFieldName: sqlFieldName)
         case .string:
-            if databaseField.name == MA_Field_Text {
+            if let column = fullTextColumn(database: database) {
+                return fullTextSqlString(column: column)
+            } else if databaseField.name == MA_Field_Text {
                 // Special case for searching the text field: We always include the title field in the search
                 // TODO: decide how to migrate this now that we allow nested criteria
-                return "(\(stringSqlString(sqlFieldName: sqlFieldName)) OR \(Criteria(field: MA_Field_Subject, operatorType: operatorType, value: value).toSQL(database: database)))"
+                // The text is stored compressed in a separate table.
+                let bodySqlExpression = "vna_inflate((SELECT body FROM message_bodies WHERE message_bodies.id = messages.id))"
+                guard let subjectField = database.field(byName: MA_Field_Subject)?.sqlField else {
+                    fatalError("Subject field does not have an associated database field")
+                }
+                let (bodySql, bodyValues) = stringSqlString(sqlFieldName: bodySqlExpression)
+                let (subjectSql, subjectValues) = stringSqlString(sqlFieldName: "\"\(subjectField)\"")
+                return ("(\(bodySql) OR \(subjectSql))", bodyValues + subjectValues)
             } else {
                 return stringSqlString(sqlFieldName: sqlFieldName)
             }
@@ -85,7 +249,9 @@ extension Criteria: SQLConversion {
         }
     }
 
-    func dateSqlString(sqlFieldName: String) -> String {
+    /// The first and the last second of the day or time span that the value
+    /// of a date criteria refers to, relative to the current time.
+    func dateRange() -> (start: Int64, end: Int64) {
         let startOfToday = Calendar.current.startOfDay(for: Date())
 
         let startDate: Date?
@@ -119,71 +285,117 @@ extension Criteria: SQLConversion {
             fatalError("Start of day or end of day date calculation for \(value) failed")
         }
 
-        let endOfDayInterval = Int64(endOfDay.timeIntervalSince1970)
-        let startOfDayInterval = Int64(startOfDay.timeIntervalSince1970)
+        return (Int64(startOfDay.timeIntervalSince1970), Int64(endOfDay.timeIntervalSince1970))
+    }
+
+    func dateSqlString(sqlFieldName: String) -> (String, [ParameterValue]) {
+        let start: ParameterValue = { crit, _ in crit.dateRange().start }
+        let end: ParameterValue = { crit, _ in crit.dateRange().end }
 
         switch operatorType {
         case .equalTo:
-            return "\(sqlFieldName) >= \(startOfDayInterval) AND \(sqlFieldName) <= \(endOfDayInterval)"
+            return ("\(sqlFieldName) >= ? AND \(sqlFieldName) <= ?", [start, end])
         case .before:
-            return "\(sqlFieldName) < \(startOfDayInterval)"
+            return ("\(sqlFieldName) < ?", [start])
         case .after:
-            return "\(sqlFieldName) > \(endOfDayInterval)"
+            return ("\(sqlFieldName) > ?", [end])
         case .onOrBefore:
-            return "\(sqlFieldName) <= \(endOfDayInterval)"
+            return ("\(sqlFieldName) <= ?", [end])
         case .onOrAfter:
-            return "\(sqlFieldName) >= \(startOfDayInterval)"
+            return ("\(sqlFieldName) >= ?", [start])
         default:
             fatalError("Illegal operator \(operatorType) for date field")
         }
     }
 
-    func flagSqlString(sqlFieldName: String) -> String {
+    func flagSqlString(sqlFieldName: String) -> (String, [ParameterValue]) {
         guard operatorType == .equalTo || operatorType == .notEqualTo else {
             fatalError("Operator type \(operatorType) not applicable to flag field \(sqlFieldName)")
         }
-        let sqlValue: String
-        if value == "Yes" { sqlValue = "1" } else { sqlValue = "0" }
         let sqlOperator = standardSqlOperator()
-        return "\(sqlFieldName) \(sqlOperator) \(sqlValue)"
+        let value: ParameterValue = { crit, _ in crit.value == "Yes" ? 1 : 0 }
+        return ("\(sqlFieldName) \(sqlOperator) ?", [value])
     }
 
-    func folderSqlString(sqlFieldName: String, database: Database) -> String {
-        // trim extra spaces added by predicate editor's formatting
-        let cleanedValue = String(value.drop { $0 == " " })
-        let folder = database.folder(fromName: cleanedValue)
-        let scope: QueryScope
+    /// Selects the articles of a folder, or of a folder and its subfolders,
+    /// from the folder tree. A group folder always includes its subfolders.
+    /// The folder is looked up by name when the criteria are compiled, so
+    /// that renamed and moved folders are taken into account.
+    func folderSqlString(sqlFieldName: String) -> (String, [ParameterValue]) {
+        let folder: (Criteria, Database) -> Folder? = { crit, database in
+            // trim extra spaces added by predicate editor's formatting
+            let cleanedValue = String(crit.value.drop { $0 == " " })
+            return database.folder(fromName: cleanedValue)
+        }
+        let folderId: ParameterValue = { crit, database in folder(crit, database)?.itemId ?? 0 }
+        let isGroup: ParameterValue = { crit, database in folder(crit, database)?.type == .group ? 1 : 0 }
+
+        let folderTree = "SELECT folder_id FROM folder_tree WHERE ancestor_id = ?"
+        let folderOrGroupTree = "\(folderTree) AND (folder_id = ancestor_id OR ?)"
         switch operatorType {
         case .under:
-            scope = [.subFolders, .inclusive]
+            return ("\(sqlFieldName) IN (\(folderTree))", [folderId])
         case .notUnder:
-            scope = .subFolders
+            return ("\(sqlFieldName) NOT IN (\(folderTree))", [folderId])
         case .equalTo:
-            scope = .inclusive
+            return ("\(sqlFieldName) IN (\(folderOrGroupTree))", [folderId, isGroup])
         case .notEqualTo:
-            scope = []
+            return ("\(sqlFieldName) NOT IN (\(folderOrGroupTree))", [folderId, isGroup])
         default:
             fatalError("Operator type \(operatorType) not applicable to folder field \(sqlFieldName)")
         }
-        return database.sqlScope(for: folder, flags: scope, field: sqlFieldName)
     }
 
-    func integerSqlString(sqlFieldName: String) -> String {
-        return "\(sqlFieldName) \(standardSqlOperator()) \(value)"
+    func integerSqlString(sqlFieldName: String) -> (String, [ParameterValue]) {
+        let value: ParameterValue = { crit, _ in
+            if let number = Int(crit.value) {
+                return number
+            }
+            return crit.value
+        }
+        return ("\(sqlFieldName) \(standardSqlOperator()) ?", [value])
+    }
+
+    /// Returns the column of the full-text index that serves searches in the
+    /// title and text of articles, an empty string for both, or nil if the
+    /// index cannot serve the criteria. The index matches the words that
+    /// start with the value, so "exam" matches "example" but "ample" does not.
+    func fullTextColumn(database: Database) -> String? {
+        guard operatorType == .contains || operatorType == .containsNot,
+              database.isFullTextSearchAvailable,
+              database.fullTextQuery(for: value, column: nil) != nil
+        else {
+            return nil
+        }
+        if field == MA_Field_Text {
+            return ""
+        } else if field == MA_Field_Subject {
+            return database.field(byName: field)?.sqlField
+        } else {
+            return nil
+        }
+    }
+
+    func fullTextSqlString(column: String) -> (String, [ParameterValue]) {
+        let sqlOperator = operatorType == .contains ? "IN" : "NOT IN"
+        let query: ParameterValue = { crit, database in
+            database.fullTextQuery(for: crit.value, column: column.isEmpty ? nil : column) ?? ""
+        }
+        return ("rowid \(sqlOperator) (SELECT rowid FROM messages_fts WHERE messages_fts MATCH ?)", [query])
     }
 
-    func stringSqlString(sqlFieldName: String) -> String {
+    func stringSqlString(sqlFieldName: String) -> (String, [ParameterValue]) {
         let sqlOperator: String
         switch operatorType {
         case .contains:
-            sqlOperator = "LIKE '%%%@%%'"
+            sqlOperator = "LIKE '%' || ? || '%'"
         case .containsNot:
-            sqlOperator = "NOT LIKE '%%%@%%'"
+            sqlOperator = "NOT LIKE '%' || ? || '%'"
         default:
-            sqlOperator = "\(standardSqlOperator()) '%@'"
+            sqlOperator = "\(standardSqlOperator()) ?"
         }
-        let formattedOperator = String(format: sqlOperator, value)
-        return "\(sqlFieldName) \(formattedOperator)"
+        let value: ParameterValue = { crit, _ in crit.value }
+        return ("\(sqlFieldName) \(sqlOperator)", [value])
     }
 
     func standardSqlOperator() -> String {
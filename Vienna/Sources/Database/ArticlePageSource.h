@@ -0,0 +1,62 @@
+//
+//  ArticlePageSource.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+@class Article;
+@class Database;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Loads the articles of a folder in pages, in the order of a sort
+/// descriptor of the article list. Each page continues after the last
+/// article of the previous one, so a page costs the same however many pages
+/// were loaded before. Pages must be requested one at a time, but not
+/// necessarily on the main thread.
+@interface VNAArticlePageSource : NSObject
+
+/// Creates a page source, unless the sort descriptor cannot be expressed in
+/// SQL, e.g. if it sorts by the name of the folder.
+/// @param database The database to load the articles from.
+/// @param folderId The identifier of the folder.
+/// @param filterString The text that the articles must contain, or an empty
+///   string.
+/// @param sortDescriptor A sort descriptor of the article list.
+/// @param pageSize The maximum number of articles of a page.
+- (nullable instancetype)initWithDatabase:(Database *)database
+                                 folderId:(NSInteger)folderId
+                             filterString:(NSString *)filterString
+                           sortDescriptor:(NSSortDescriptor *)sortDescriptor
+                                 pageSize:(NSUInteger)pageSize NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (readonly, nonatomic) NSInteger folderId;
+@property (readonly, nonatomic) NSSortDescriptor *sortDescriptor;
+
+/// Whether all articles of the folder have been loaded.
+@property (readonly, getter=isExhausted) BOOL exhausted;
+
+/// Loads the next page of articles. The page is only empty if the source is
+/// exhausted.
+- (NSArray<Article *> *)nextPage;
+
+@end
+
+NS_ASSUME_NONNULL_END
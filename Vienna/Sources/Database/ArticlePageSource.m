@@ -0,0 +1,113 @@
+//
+//  ArticlePageSource.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ArticlePageSource.h"
+
+#import "Article.h"
+#import "Database.h"
+
+@interface VNAArticlePageSource ()
+
+@property (nonatomic) Database *database;
+@property (copy, nonatomic) NSString *filterString;
+@property (copy, nonatomic) NSString *sortColumn;
+@property (nonatomic) NSUInteger pageSize;
+@property (nullable, nonatomic) NSArray *position;
+@property (readwrite, getter=isExhausted) BOOL exhausted;
+
+@end
+
+@implementation VNAArticlePageSource
+
+/* sortColumnForKey
+ * Returns the SQL expression over the messages table that sorts like the
+ * given key path of the article list. Missing strings sort as empty strings,
+ * because NULL values cannot be compared with the position of a page. The
+ * strings are compared case-insensitively, but numbers in titles are not
+ * compared numerically as in the article list.
+ */
++ (nullable NSString *)sortColumnForKey:(NSString *)key
+{
+    static NSDictionary<NSString *, NSString *> *sortColumns;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *prefix = @"articleData.";
+        sortColumns = @{
+            @"isRead": @"IFNULL(read_flag, 0)",
+            @"isFlagged": @"IFNULL(marked_flag, 0)",
+            @"hasEnclosure": @"IFNULL(hasenclosure_flag, 0)",
+            @"enclosure": @"IFNULL(enclosure, '') COLLATE NOCASE",
+            [prefix stringByAppendingString:MA_Field_LastUpdate]: @"date",
+            [prefix stringByAppendingString:MA_Field_PublicationDate]: @"createddate",
+            [prefix stringByAppendingString:MA_Field_Author]: @"IFNULL(sender, '') COLLATE NOCASE",
+            [prefix stringByAppendingString:MA_Field_Subject]: @"IFNULL(title, '') COLLATE NOCASE",
+            [prefix stringByAppendingString:MA_Field_Link]: @"IFNULL(link, '') COLLATE NOCASE",
+        };
+    });
+    return sortColumns[key];
+}
+
+- (instancetype)initWithDatabase:(Database *)database
+                        folderId:(NSInteger)folderId
+                    filterString:(NSString *)filterString
+                  sortDescriptor:(NSSortDescriptor *)sortDescriptor
+                        pageSize:(NSUInteger)pageSize
+{
+    NSString *sortColumn = [VNAArticlePageSource sortColumnForKey:sortDescriptor.key];
+    if (sortColumn == nil || pageSize == 0) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        _database = database;
+        _folderId = folderId;
+        _filterString = [filterString copy];
+        _sortDescriptor = sortDescriptor;
+        _sortColumn = sortColumn;
+        _pageSize = pageSize;
+    }
+    return self;
+}
+
+- (NSArray<Article *> *)nextPage
+{
+    // Articles that the folder hides, like deleted ones, do not count towards
+    // the page size, so a page may come back empty before the end.
+    while (!self.exhausted) {
+        NSArray *position = self.position;
+        NSArray<Article *> *articles =
+            [self.database arrayOfArticles:self.folderId
+                              filterString:self.filterString
+                                sortColumn:self.sortColumn
+                                 ascending:self.sortDescriptor.ascending
+                                  position:&position
+                                     limit:self.pageSize];
+        if (articles == nil || position == nil || [position isEqualToArray:self.position]) {
+            self.exhausted = YES;
+        }
+        self.position = position;
+        if (articles.count > 0) {
+            return articles;
+        }
+    }
+    return @[];
+}
+
+@end
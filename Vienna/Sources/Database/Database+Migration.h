@@ -23,10 +23,89 @@
 
 @interface Database (Migration)
 
-/// Migrates the Vienna database schema.
+/// Migrates the Vienna database schema one version after the other. Every
+/// version is committed on its own, and the migrations that update many rows
+/// commit them in chunks, so that an interrupted migration resumes where it
+/// stopped.
 /// @param database The database to migrate.
 /// @param previousVersion The version to migrate from.
-+ (void)migrateDatabase:(FMDatabase *)database
-            fromVersion:(NSInteger)previousVersion;
+/// @param currentVersion The version to migrate to.
+/// @param progress Counts the versions and the chunks that were migrated. The
+///   migration stops after the current chunk if it is cancelled.
+/// @return `YES` if the database was migrated to the current version.
++ (BOOL)migrateDatabase:(FMDatabase *)database
+            fromVersion:(NSInteger)previousVersion
+              toVersion:(NSInteger)currentVersion
+               progress:(NSProgress *)progress;
+
+/// Runs a migration step over the rows of a table in chunks of rowids, each
+/// in its own transaction. The step and the last rowid of the chunk are
+/// recorded in the info table with every chunk, so that a step that was
+/// interrupted resumes after the last chunk that was committed. The progress
+/// of the step is a child of the current progress. This must not be called
+/// within a transaction.
+/// @param tableName The table whose rows are migrated.
+/// @param database The database to migrate.
+/// @param step A name of the step that is unique among all migrations.
+/// @param chunkSize The maximum number of rows of a chunk.
+/// @param block Migrates the rows with rowids greater than `afterRowId` and up
+///   to `lastRowId`, and returns whether it succeeded.
+/// @return `YES` if all rows were migrated, `NO` if a chunk failed or the
+///   progress was cancelled.
++ (BOOL)migrateRowsOfTable:(NSString *)tableName
+                onDatabase:(FMDatabase *)database
+                      step:(NSString *)step
+                 chunkSize:(NSInteger)chunkSize
+                usingBlock:(BOOL (^)(long long afterRowId, long long lastRowId))block;
+
+/// Creates the message_bodies table, which stores the compressed article
+/// bodies by the id of their row in the messages table, and the trigger that
+/// deletes a body together with its article.
+/// @param database The database to create the table in.
+/// @return `YES` if the table was created or already existed.
++ (BOOL)createArticleBodyStoreOnDatabase:(FMDatabase *)database;
+
+/// Creates the triggers that keep the unread_count, flagged_count and
+/// deleted_count columns of the folders table in step with the articles
+/// of each folder.
+/// @param database The database to create the triggers in.
+/// @return `YES` if the triggers were created or already existed.
++ (BOOL)createFolderCountTriggersOnDatabase:(FMDatabase *)database;
+
+/// Creates the smart_folder_members table, which holds the articles of each
+/// smart folder, and the smart_folder_changes table with its triggers, which
+/// record the articles and columns that changed since the members were last
+/// brought up to date. Changes are only recorded while the members of at
+/// least one smart folder are stored.
+/// @param database The database to create the tables in.
+/// @return `YES` if the tables were created or already existed.
++ (BOOL)createSmartFolderMembersOnDatabase:(FMDatabase *)database;
+
+/// Creates the folder_tree closure table, which relates every folder to
+/// itself and to each of its descendants, and the triggers that maintain it
+/// when folders are added, deleted or moved. Moving a folder also records
+/// its articles as changed for the members of smart folders, so the
+/// smart_folder_changes table must exist.
+/// @param database The database to create the table in.
+/// @return `YES` if the table was created or already existed.
++ (BOOL)createFolderTreeOnDatabase:(FMDatabase *)database;
+
+/// Creates the retention_policies table, which holds the maximum age, the
+/// maximum number of articles and the horizon of the guid history of the
+/// folders that do not follow the default policy, and the trigger that
+/// deletes the policy of a folder together with the folder.
+/// @param database The database to create the table in.
+/// @return `YES` if the table was created or already existed.
++ (BOOL)createRetentionPoliciesOnDatabase:(FMDatabase *)database;
+
+/// Creates the FTS5 full-text index over the titles and the decompressed
+/// bodies of the articles, together with the triggers that keep it in sync.
+/// The `vna_inflate` SQL function must be registered on the database.
+/// @param database The database to create the index in.
+/// The index, the triggers and the contents are created together or not at
+/// all; if they could not be created, the reason is logged.
+/// @return `YES` if the index was created, `NO` if it could not be created,
+///   for example because the SQLite library lacks the FTS5 extension.
++ (BOOL)createFullTextIndexOnDatabase:(FMDatabase *)database;
 
 @end
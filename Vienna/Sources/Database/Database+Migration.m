@@ -22,26 +22,73 @@
 #import "Preferences.h"
 #import "Vienna-Swift.h"
 
+// The number of article bodies that are compressed in one transaction
+static NSInteger const VNAArticleBodyMigrationChunkSize = 500;
+
+// The number of rows that are updated in one transaction by the migrations
+// that set the value of a column
+static NSInteger const VNAColumnMigrationChunkSize = 5000;
+
+// The number of rows that are copied in one transaction by the migrations
+// that rebuild a table
+static NSInteger const VNATableMigrationChunkSize = 2000;
+
+// The number of folders whose articles are counted in one transaction
+static NSInteger const VNAFolderCountMigrationChunkSize = 50;
+
 @implementation Database (Migration)
 
-+ (void)migrateDatabase:(FMDatabase *)database
++ (BOOL)migrateDatabase:(FMDatabase *)database
             fromVersion:(NSInteger)previousVersion
+              toVersion:(NSInteger)currentVersion
+               progress:(NSProgress *)progress
+{
+    // Every version is one unit of the progress. The migrations that run in
+    // chunks report their progress within that unit.
+    progress.totalUnitCount = currentVersion - previousVersion;
+    for (NSInteger version = previousVersion + 1; version <= currentVersion; version++) {
+        [progress becomeCurrentWithPendingUnitCount:1];
+        BOOL success = [Database migrateDatabase:database toVersion:version];
+        [progress resignCurrent];
+        if (!success) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
++ (BOOL)migrateDatabase:(FMDatabase *)database
+              toVersion:(NSInteger)version
 {
-    switch (previousVersion + 1) {
+    switch (version) {
         case 13: {
             // Add createddate field to the messages table and initialise it to
             // a date in the past. Create an index on the message_id column.
 
-            [database executeUpdate:@"ALTER TABLE messages "
-                                     "ADD COLUMN createddate"];
+            if (![database columnExists:@"createddate" inTableWithName:@"messages"]) {
+                [database executeUpdate:@"ALTER TABLE messages "
+                                         "ADD COLUMN createddate"];
+            }
             NSTimeInterval interval = NSDate.distantPast.timeIntervalSince1970;
-            [database executeUpdate:@"UPDATE messages SET createddate = ?",
-                                    @(interval)];
+            BOOL success =
+                [Database migrateRowsOfTable:@"messages"
+                                  onDatabase:database
+                                        step:@"messages.createddate"
+                                   chunkSize:VNAColumnMigrationChunkSize
+                                  usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+                    return [database executeUpdate:@"UPDATE messages SET createddate = ? "
+                                                    "WHERE rowid > ? AND rowid <= ?",
+                                                   @(interval), @(afterRowId), @(lastRowId)];
+                }];
+            if (!success) {
+                return NO;
+            }
             [database executeUpdate:@"CREATE INDEX messages_message_idx "
                                      "ON messages (message_id)"];
             database.userVersion = (uint32_t)13;
 
             NSLog(@"Updated database schema to version 13.");
+            return YES;
         }
         case 14: {
             // Add next_sibling and next_child columns to folders table and
@@ -82,6 +129,7 @@
             database.userVersion = (uint32_t)14;
 
             NSLog(@"Updated database schema to version 14.");
+            return YES;
         }
         case 15: {
             // Move the folders tree sort method preference to the database, so
@@ -96,36 +144,63 @@
             database.userVersion = (uint32_t)15;
 
             NSLog(@"Updated database schema to version 15.");
+            return YES;
         }
         case 16: {
             // Add revised_flag to messages table, and initialize all values to
             // 0.
 
-            [database executeUpdate:@"ALTER TABLE messages "
-                                     "ADD COLUMN revised_flag"];
-            [database executeUpdate:@"UPDATE messages SET revised_flag = 0"];
+            if (![database columnExists:@"revised_flag" inTableWithName:@"messages"]) {
+                [database executeUpdate:@"ALTER TABLE messages "
+                                         "ADD COLUMN revised_flag"];
+            }
+            BOOL success =
+                [Database migrateRowsOfTable:@"messages"
+                                  onDatabase:database
+                                        step:@"messages.revised_flag"
+                                   chunkSize:VNAColumnMigrationChunkSize
+                                  usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+                    return [database executeUpdate:@"UPDATE messages SET revised_flag = 0 "
+                                                    "WHERE rowid > ? AND rowid <= ?",
+                                                   @(afterRowId), @(lastRowId)];
+                }];
+            if (!success) {
+                return NO;
+            }
             database.userVersion = (uint32_t)16;
 
             NSLog(@"Updated database schema to version 16.");
+            return YES;
         }
         case 17: {
             // Add hasenclosure_flag, enclosuredownloaded_flag and enclosure to
             // messages table, and initialize stuff.
 
-            [database executeUpdate:@"ALTER TABLE messages "
-                                     "ADD COLUMN hasenclosure_flag"];
-            [database executeUpdate:@"UPDATE messages "
-                                     "SET hasenclosure_flag = 0"];
-            [database executeUpdate:@"ALTER TABLE messages "
-                                     "ADD COLUMN enclosure"];
-            [database executeUpdate:@"UPDATE messages SET enclosure = ''"];
-            [database executeUpdate:@"ALTER TABLE messages "
-                                     "ADD COLUMN enclosuredownloaded_flag"];
-            [database executeUpdate:@"UPDATE messages "
-                                     "SET enclosuredownloaded_flag = 0"];
+            for (NSString *column in @[@"hasenclosure_flag", @"enclosure", @"enclosuredownloaded_flag"]) {
+                if (![database columnExists:column inTableWithName:@"messages"]) {
+                    [database executeUpdate:[NSString stringWithFormat:@"ALTER TABLE messages "
+                                                                        "ADD COLUMN %@", column]];
+                }
+            }
+            BOOL success =
+                [Database migrateRowsOfTable:@"messages"
+                                  onDatabase:database
+                                        step:@"messages.enclosure"
+                                   chunkSize:VNAColumnMigrationChunkSize
+                                  usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+                    return [database executeUpdate:@"UPDATE messages "
+                                                    "SET hasenclosure_flag = 0, enclosure = '', "
+                                                    "enclosuredownloaded_flag = 0 "
+                                                    "WHERE rowid > ? AND rowid <= ?",
+                                                   @(afterRowId), @(lastRowId)];
+                }];
+            if (!success) {
+                return NO;
+            }
             database.userVersion = (uint32_t)17;
 
             NSLog(@"Updated database schema to version 17.");
+            return YES;
         }
         case 18: {
             // Add table all message guids.
@@ -138,6 +213,7 @@
             database.userVersion = (uint32_t)18;
 
             NSLog(@"Updated database schema to version 18.");
+            return YES;
         }
         case 19: {
             // Update the Vienna Developer's blog RSS URL after we changed from
@@ -161,6 +237,7 @@
             [results close];
             database.userVersion = (uint32_t)19;
             NSLog(@"Updated database schema to version 19.");
+            return YES;
         }
         case 20: {
             // Update the Vienna Developer's blog RSS URL after moved to github
@@ -183,6 +260,7 @@
             [results close];
             database.userVersion = (uint32_t)20;
             NSLog(@"Updated database schema to version 20.");
+            return YES;
         }
         case 21: {
             // Removes line-breaks and tabs from author strings.
@@ -233,6 +311,7 @@
 
             database.userVersion = (uint32_t)21;
             NSLog(@"Updated database schema to version 21.");
+            return YES;
         }
         case 22: {
             // Enables auto-vacuum mode on the database. Enabling this requires
@@ -241,6 +320,7 @@
 
             database.userVersion = (uint32_t)22;
             NSLog(@"Updated database schema to version 22.");
+            return YES;
         }
         case 23: {
             // Create indexes for unread and non deleted messages
@@ -249,15 +329,31 @@
 
             database.userVersion = (uint32_t)23;
             NSLog(@"Updated database schema to version 23.");
+            return YES;
         }
         case 24:
         case 25:
+            // The migration to version 26 covers these versions.
+            return YES;
         case 26: {
             //correct articles that were saved with updatedDate is 1.1.1970 00:00
-            [database executeStatements:@"UPDATE messages SET date = createddate WHERE date = 0"];
+            BOOL success =
+                [Database migrateRowsOfTable:@"messages"
+                                  onDatabase:database
+                                        step:@"messages.date"
+                                   chunkSize:VNAColumnMigrationChunkSize
+                                  usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+                    return [database executeUpdate:@"UPDATE messages SET date = createddate "
+                                                    "WHERE date = 0 AND rowid > ? AND rowid <= ?",
+                                                   @(afterRowId), @(lastRowId)];
+                }];
+            if (!success) {
+                return NO;
+            }
 
             database.userVersion = (uint32_t)26;
             NSLog(@"Updated database schema to version 26.");
+            return YES;
         }
         case 27: {
             // Fix default smart folders with missing search string.
@@ -304,8 +400,926 @@
             }
             database.userVersion = (uint32_t)27;
             NSLog(@"Updated database schema to version 27.");
+            return YES;
+        }
+        case 28: {
+            // Add a full-text index for the title and text columns. If FTS5
+            // is not available, searches fall back to LIKE patterns.
+            if (![Database createVersion28FullTextIndexOnDatabase:database]) {
+                NSLog(@"Full-text index could not be created: %@",
+                      database.lastErrorMessage);
+            }
+
+            database.userVersion = (uint32_t)28;
+            NSLog(@"Updated database schema to version 28.");
+            return YES;
+        }
+        case 29: {
+            // Rebuild the messages table with an INTEGER PRIMARY KEY and
+            // composite indexes for the per-folder queries. A folder must not
+            // contain the same article twice, so duplicates are dropped.
+            if (![Database rebuildMessagesTableOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 29: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)29;
+            NSLog(@"Updated database schema to version 29.");
+            return YES;
+        }
+        case 30: {
+            // Move the article bodies to a separate table that stores them
+            // compressed. The text column of the messages table is cleared
+            // rather than dropped, because ALTER TABLE DROP COLUMN requires
+            // SQLite 3.35.
+            if (![Database moveArticleBodiesOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 30: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)30;
+            NSLog(@"Updated database schema to version 30.");
+            return YES;
+        }
+        case 31: {
+            // Declare the types of the columns of the messages and folders
+            // tables, so that numbers are stored and read as numbers. The
+            // text column of the messages table is dropped on the way.
+            if (![Database rebuildTablesWithTypedColumnsOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 31: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)31;
+            NSLog(@"Updated database schema to version 31.");
+            return YES;
+        }
+        case 32: {
+            // Count the unread, flagged and deleted articles of every folder
+            // with triggers on the messages table.
+            if (![Database addFolderCountsOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 32: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)32;
+            NSLog(@"Updated database schema to version 32.");
+            return YES;
+        }
+        case 33: {
+            // Index the articles by date, so that the article list can load
+            // the newest articles of large folders page by page without
+            // sorting all of them first.
+            BOOL success =
+                [database executeStatements:@"CREATE INDEX IF NOT EXISTS "
+                                             "messages_date_idx ON messages (date); "
+                                             "CREATE INDEX IF NOT EXISTS "
+                                             "messages_folder_date_idx "
+                                             "ON messages (folder_id, date)"];
+            if (!success) {
+                NSLog(@"Failed to update database schema to version 33: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)33;
+            NSLog(@"Updated database schema to version 33.");
+            return YES;
+        }
+        case 34: {
+            // Store the articles of smart folders, so that switching between
+            // them does not evaluate their criteria over all articles.
+            if (![Database addSmartFolderMembersOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 34: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)34;
+            NSLog(@"Updated database schema to version 34.");
+            return YES;
+        }
+        case 35: {
+            // Relate group folders to all of their descendants in a table,
+            // so that a folder and its subfolders are selected with a join
+            // instead of a condition for each folder.
+            if (![Database addFolderTreeOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 35: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)35;
+            NSLog(@"Updated database schema to version 35.");
+            return YES;
+        }
+        case 36: {
+            // Switches auto-vacuum from full to incremental mode. Instead of
+            // moving pages at every commit that frees some, the free pages
+            // are returned to the file system in small steps while the
+            // application is idle. This does not require a VACUUM, unless
+            // auto-vacuum was never enabled, in which case the mode takes
+            // effect when the database is compacted.
+            [database executeStatements:@"PRAGMA auto_vacuum = INCREMENTAL"];
+
+            database.userVersion = (uint32_t)36;
+            NSLog(@"Updated database schema to version 36.");
+            return YES;
+        }
+        case 37: {
+            // Record when a feed last listed each guid, so that the guid
+            // history can be pruned without admitting old articles again,
+            // and store the retention policies of individual folders.
+            if (![Database addRetentionOnDatabase:database]) {
+                NSLog(@"Failed to update database schema to version 37: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)37;
+            NSLog(@"Updated database schema to version 37.");
+            return YES;
+        }
+        case 38: {
+            // Count the sessions that opened the database, so that a snapshot
+            // of the folders is only used with the database it was taken
+            // from.
+            if (![database columnExists:@"generation" inTableWithName:@"info"] &&
+                ![database executeUpdate:@"ALTER TABLE info ADD COLUMN generation INTEGER NOT NULL DEFAULT 0"]) {
+                NSLog(@"Failed to update database schema to version 38: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)38;
+            NSLog(@"Updated database schema to version 38.");
+            return YES;
+        }
+        case 39: {
+            // Store the ETag of the last response of every feed, so that it
+            // can be sent with If-None-Match.
+            if (![database columnExists:@"etag" inTableWithName:@"rss_folders"] &&
+                ![database executeUpdate:@"ALTER TABLE rss_folders ADD COLUMN etag TEXT NOT NULL DEFAULT ''"]) {
+                NSLog(@"Failed to update database schema to version 39: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)39;
+            NSLog(@"Updated database schema to version 39.");
+            return YES;
+        }
+        case 40: {
+            // Store the size of the last download of every feed, so that the
+            // data that a response with HTTP status 304 saves is known after
+            // a restart as well.
+            if (![database columnExists:@"content_size" inTableWithName:@"rss_folders"] &&
+                ![database executeUpdate:@"ALTER TABLE rss_folders ADD COLUMN content_size INTEGER NOT NULL DEFAULT 0"]) {
+                NSLog(@"Failed to update database schema to version 40: %@",
+                      database.lastErrorMessage);
+                return NO;
+            }
+
+            database.userVersion = (uint32_t)40;
+            NSLog(@"Updated database schema to version 40.");
+            return YES;
+        }
+        default:
+            NSLog(@"No migration to database schema version %ld", (long)version);
+            return NO;
+    }
+}
+
++ (BOOL)migrateRowsOfTable:(NSString *)tableName
+                onDatabase:(FMDatabase *)database
+                      step:(NSString *)step
+                 chunkSize:(NSInteger)chunkSize
+                usingBlock:(BOOL (^)(long long afterRowId, long long lastRowId))block
+{
+    // The columns that hold the checkpoint are only needed while a migration
+    // runs, so they are added by the first migration that needs them.
+    if (![database columnExists:@"migration_step" inTableWithName:@"info"]) {
+        BOOL success =
+            [database executeStatements:@"ALTER TABLE info ADD COLUMN migration_step TEXT; "
+                                         "ALTER TABLE info ADD COLUMN migration_rowid INTEGER"];
+        if (!success) {
+            return NO;
         }
     }
+
+    // Resume after the last chunk that an interrupted run of the step
+    // committed.
+    long long lastRowId = 0;
+    FMResultSet *results = [database executeQuery:@"SELECT migration_rowid FROM info "
+                                                   "WHERE migration_step = ?",
+                                                  step];
+    if ([results next]) {
+        lastRowId = [results longLongIntForColumnIndex:0];
+    }
+    [results close];
+
+    NSString *chunkQuery =
+        [NSString stringWithFormat:@"SELECT MAX(rowid), COUNT(*) FROM ("
+                                    "SELECT rowid FROM %@ WHERE rowid > ? "
+                                    "ORDER BY rowid LIMIT ?)",
+                                   tableName];
+    NSString *countQuery =
+        [NSString stringWithFormat:@"SELECT COUNT(*) FROM %@ WHERE rowid > ?",
+                                   tableName];
+    NSProgress *progress =
+        [NSProgress progressWithTotalUnitCount:[database longForQuery:countQuery, @(lastRowId)]];
+
+    while (YES) {
+        if (progress.isCancelled) {
+            NSLog(@"Migration step %@ stopped after row %lld", step, lastRowId);
+            return NO;
+        }
+
+        long long chunkEndRowId = 0;
+        long long chunkRowCount = 0;
+        results = [database executeQuery:chunkQuery, @(lastRowId), @(chunkSize)];
+        if ([results next]) {
+            chunkEndRowId = [results longLongIntForColumnIndex:0];
+            chunkRowCount = [results longLongIntForColumnIndex:1];
+        }
+        [results close];
+        if (chunkRowCount == 0) {
+            break;
+        }
+
+        // The checkpoint is committed together with the chunk.
+        [database beginTransaction];
+        BOOL success =
+            block(lastRowId, chunkEndRowId) &&
+            [database executeUpdate:@"UPDATE info "
+                                     "SET migration_step = ?, migration_rowid = ?",
+                                    step, @(chunkEndRowId)];
+        if (!success) {
+            [database rollback];
+            return NO;
+        }
+        if (![database commit]) {
+            return NO;
+        }
+        lastRowId = chunkEndRowId;
+        progress.completedUnitCount += chunkRowCount;
+    }
+
+    return [database executeUpdate:@"UPDATE info "
+                                    "SET migration_step = NULL, migration_rowid = NULL"];
+}
+
++ (BOOL)rebuildMessagesTableOnDatabase:(FMDatabase *)database
+{
+    // The messages table has an id column once a previous run swapped the
+    // tables.
+    if ([database columnExists:@"id" inTableWithName:@"messages"]) {
+        return YES;
+    }
+
+    // The articles are copied to the new table in chunks, so that an
+    // interrupted migration resumes after the last chunk. The existing
+    // rowids are kept as the ids. Of the duplicates of an article in a
+    // folder, the first one is kept.
+    BOOL success =
+        [database executeUpdate:@"CREATE TABLE IF NOT EXISTS messages_new ("
+                                 "id INTEGER PRIMARY KEY, message_id, "
+                                 "folder_id, parent_id, read_flag, "
+                                 "marked_flag, deleted_flag, title, "
+                                 "sender, link, createddate, date, text, "
+                                 "revised_flag, enclosuredownloaded_flag, "
+                                 "hasenclosure_flag, enclosure)"] &&
+        [Database migrateRowsOfTable:@"messages"
+                          onDatabase:database
+                                step:@"messages_new"
+                           chunkSize:VNATableMigrationChunkSize
+                          usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+            return [database executeUpdate:@"INSERT OR IGNORE INTO messages_new (id, "
+                                            "message_id, folder_id, parent_id, "
+                                            "read_flag, marked_flag, deleted_flag, "
+                                            "title, sender, link, createddate, date, "
+                                            "text, revised_flag, "
+                                            "enclosuredownloaded_flag, "
+                                            "hasenclosure_flag, enclosure) "
+                                            "SELECT rowid, message_id, folder_id, "
+                                            "parent_id, read_flag, marked_flag, "
+                                            "deleted_flag, title, sender, link, "
+                                            "createddate, date, text, revised_flag, "
+                                            "enclosuredownloaded_flag, "
+                                            "hasenclosure_flag, enclosure "
+                                            "FROM messages "
+                                            "WHERE rowid > ? AND rowid <= ? "
+                                            "AND NOT EXISTS (SELECT 1 FROM messages AS earlier "
+                                            "WHERE earlier.message_id = messages.message_id "
+                                            "AND earlier.folder_id = messages.folder_id "
+                                            "AND earlier.rowid < messages.rowid)",
+                                           @(afterRowId), @(lastRowId)];
+        }];
+    if (!success) {
+        return NO;
+    }
+
+    // The tables are swapped in one transaction. The full-text index of
+    // version 28 is dropped rather than rebuilt, because the migration to
+    // version 30 replaces it with an index of the compressed bodies.
+    [database beginTransaction];
+    success =
+        [database executeStatements:@"DROP TRIGGER IF EXISTS messages_fts_insert; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_delete; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_update; "
+                                     "DROP TABLE IF EXISTS messages_fts; "
+                                     "DROP TABLE messages; "
+                                     "ALTER TABLE messages_new "
+                                     "RENAME TO messages; "
+                                     "CREATE UNIQUE INDEX "
+                                     "messages_folder_message_idx "
+                                     "ON messages (folder_id, message_id); "
+                                     "CREATE INDEX messages_folder_read_idx "
+                                     "ON messages (folder_id, read_flag, "
+                                     "message_id); "
+                                     "CREATE INDEX messages_folder_marked_idx "
+                                     "ON messages (folder_id, marked_flag, "
+                                     "message_id); "
+                                     "CREATE INDEX messages_deleted_idx "
+                                     "ON messages (deleted_flag, folder_id)"];
+    if (success) {
+        return [database commit];
+    } else {
+        [database rollback];
+        return NO;
+    }
+}
+
++ (BOOL)moveArticleBodiesOnDatabase:(FMDatabase *)database
+{
+    // The full-text index is recreated once the bodies have been moved.
+    // Until then, its triggers would remove the cleared text from it. An
+    // interrupted run may already have created the new index, so its view
+    // and triggers are dropped as well.
+    BOOL success =
+        [database executeStatements:@"DROP TRIGGER IF EXISTS messages_fts_insert; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_delete; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_update; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_update_title; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_update_body; "
+                                     "DROP VIEW IF EXISTS messages_search; "
+                                     "DROP TABLE IF EXISTS messages_fts"] &&
+        [Database createArticleBodyStoreOnDatabase:database];
+    if (!success) {
+        return NO;
+    }
+
+    // Every chunk is committed on its own to keep the transactions small.
+    // If the migration is interrupted, it resumes after the last chunk.
+    success =
+        [Database migrateRowsOfTable:@"messages"
+                          onDatabase:database
+                                step:@"message_bodies"
+                           chunkSize:VNAArticleBodyMigrationChunkSize
+                          usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+            return [database executeUpdate:@"INSERT OR IGNORE INTO message_bodies "
+                                            "(id, body) SELECT id, vna_deflate(text) "
+                                            "FROM messages WHERE id > ? AND id <= ?",
+                                           @(afterRowId), @(lastRowId)] &&
+                   [database executeUpdate:@"UPDATE messages SET text = NULL "
+                                            "WHERE id > ? AND id <= ? "
+                                            "AND text IS NOT NULL",
+                                           @(afterRowId), @(lastRowId)];
+        }];
+    if (!success) {
+        return NO;
+    }
+
+    // Searches fall back to LIKE patterns if the full-text index is missing.
+    [Database createFullTextIndexOnDatabase:database];
+    return YES;
+}
+
++ (BOOL)rebuildTablesWithTypedColumnsOnDatabase:(FMDatabase *)database
+{
+    // The text column of the messages table is gone once a previous run
+    // swapped the tables.
+    if (![database columnExists:@"text" inTableWithName:@"messages"]) {
+        return YES;
+    }
+
+    BOOL hasFullTextIndex = [database tableExists:@"messages_fts"];
+
+    // The rows are copied to the new tables in chunks, so that an interrupted
+    // migration resumes after the last chunk. The ids are kept, because the
+    // full-text index and the bodies refer to them.
+    BOOL success =
+        [database executeStatements:@"CREATE TABLE IF NOT EXISTS messages_new ("
+                                     "id INTEGER PRIMARY KEY, message_id TEXT, "
+                                     "folder_id INTEGER, parent_id INTEGER, "
+                                     "read_flag INTEGER, marked_flag INTEGER, "
+                                     "deleted_flag INTEGER, title TEXT, "
+                                     "sender TEXT, link TEXT, "
+                                     "createddate REAL, date REAL, "
+                                     "revised_flag INTEGER, "
+                                     "enclosuredownloaded_flag INTEGER, "
+                                     "hasenclosure_flag INTEGER, "
+                                     "enclosure TEXT); "
+                                     "CREATE TABLE IF NOT EXISTS folders_new ("
+                                     "folder_id INTEGER PRIMARY KEY, "
+                                     "parent_id INTEGER, foldername TEXT, "
+                                     "unread_count INTEGER, last_update REAL, "
+                                     "type INTEGER, flags INTEGER, "
+                                     "next_sibling INTEGER, "
+                                     "first_child INTEGER)"] &&
+        [Database migrateRowsOfTable:@"messages"
+                          onDatabase:database
+                                step:@"messages_typed"
+                           chunkSize:VNATableMigrationChunkSize
+                          usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+            return [database executeUpdate:@"INSERT OR IGNORE INTO messages_new (id, "
+                                            "message_id, folder_id, parent_id, "
+                                            "read_flag, marked_flag, deleted_flag, "
+                                            "title, sender, link, createddate, date, "
+                                            "revised_flag, enclosuredownloaded_flag, "
+                                            "hasenclosure_flag, enclosure) "
+                                            "SELECT id, message_id, "
+                                            "CAST(folder_id AS INTEGER), "
+                                            "CAST(parent_id AS INTEGER), "
+                                            "CAST(read_flag AS INTEGER), "
+                                            "CAST(marked_flag AS INTEGER), "
+                                            "CAST(deleted_flag AS INTEGER), "
+                                            "title, sender, link, "
+                                            "CAST(createddate AS REAL), "
+                                            "CAST(date AS REAL), "
+                                            "CAST(revised_flag AS INTEGER), "
+                                            "CAST(enclosuredownloaded_flag AS INTEGER), "
+                                            "CAST(hasenclosure_flag AS INTEGER), "
+                                            "enclosure FROM messages "
+                                            "WHERE id > ? AND id <= ?",
+                                           @(afterRowId), @(lastRowId)];
+        }] &&
+        [Database migrateRowsOfTable:@"folders"
+                          onDatabase:database
+                                step:@"folders_typed"
+                           chunkSize:VNATableMigrationChunkSize
+                          usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+            return [database executeUpdate:@"INSERT OR IGNORE INTO folders_new (folder_id, "
+                                            "parent_id, foldername, unread_count, "
+                                            "last_update, type, flags, next_sibling, "
+                                            "first_child) "
+                                            "SELECT folder_id, "
+                                            "CAST(parent_id AS INTEGER), foldername, "
+                                            "CAST(unread_count AS INTEGER), "
+                                            "CAST(last_update AS REAL), "
+                                            "CAST(type AS INTEGER), "
+                                            "CAST(flags AS INTEGER), "
+                                            "CAST(next_sibling AS INTEGER), "
+                                            "CAST(first_child AS INTEGER) "
+                                            "FROM folders "
+                                            "WHERE folder_id > ? AND folder_id <= ?",
+                                           @(afterRowId), @(lastRowId)];
+        }];
+    if (!success) {
+        return NO;
+    }
+
+    // The tables are swapped in one transaction. Renaming a table fails while
+    // views or triggers refer to a table that does not exist, so everything
+    // that refers to the messages table is dropped first.
+    [database beginTransaction];
+    success =
+        [database executeStatements:@"DROP VIEW IF EXISTS messages_search; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_insert; "
+                                     "DROP TRIGGER IF EXISTS messages_fts_update_body; "
+                                     "DROP TABLE messages; "
+                                     "ALTER TABLE messages_new "
+                                     "RENAME TO messages; "
+                                     "CREATE UNIQUE INDEX "
+                                     "messages_folder_message_idx "
+                                     "ON messages (folder_id, message_id); "
+                                     "CREATE INDEX messages_folder_read_idx "
+                                     "ON messages (folder_id, read_flag, "
+                                     "message_id); "
+                                     "CREATE INDEX messages_folder_marked_idx "
+                                     "ON messages (folder_id, marked_flag, "
+                                     "message_id); "
+                                     "CREATE INDEX messages_deleted_idx "
+                                     "ON messages (deleted_flag, folder_id); "
+                                     "DROP TABLE folders; "
+                                     "ALTER TABLE folders_new "
+                                     "RENAME TO folders"] &&
+        [Database createArticleBodyStoreOnDatabase:database];
+
+    // The full-text index itself still matches the articles.
+    if (success && hasFullTextIndex) {
+        success = [Database createFullTextTriggersOnDatabase:database];
+    }
+
+    if (success) {
+        return [database commit];
+    } else {
+        [database rollback];
+        return NO;
+    }
+}
+
++ (BOOL)addFolderCountsOnDatabase:(FMDatabase *)database
+{
+    BOOL success =
+        ([database columnExists:@"flagged_count" inTableWithName:@"folders"] ||
+         [database executeUpdate:@"ALTER TABLE folders ADD COLUMN "
+                                  "flagged_count INTEGER NOT NULL DEFAULT 0"]) &&
+        ([database columnExists:@"deleted_count" inTableWithName:@"folders"] ||
+         [database executeUpdate:@"ALTER TABLE folders ADD COLUMN "
+                                  "deleted_count INTEGER NOT NULL DEFAULT 0"]);
+    if (!success) {
+        return NO;
+    }
+
+    // The stored unread counts were maintained by the application and may
+    // have drifted, so all counts are computed from the articles, a few
+    // folders at a time. The triggers take over once every folder is counted.
+    return
+        [Database migrateRowsOfTable:@"folders"
+                          onDatabase:database
+                                step:@"folders.counts"
+                           chunkSize:VNAFolderCountMigrationChunkSize
+                          usingBlock:^BOOL(long long afterRowId, long long lastRowId) {
+            return [database executeUpdate:@"UPDATE folders SET "
+                                            "unread_count = (SELECT COUNT(*) FROM messages "
+                                            "WHERE messages.folder_id = folders.folder_id "
+                                            "AND read_flag IS NOT 1), "
+                                            "flagged_count = (SELECT COUNT(*) FROM messages "
+                                            "WHERE messages.folder_id = folders.folder_id "
+                                            "AND marked_flag IS 1), "
+                                            "deleted_count = (SELECT COUNT(*) FROM messages "
+                                            "WHERE messages.folder_id = folders.folder_id "
+                                            "AND deleted_flag IS 1) "
+                                            "WHERE folder_id > ? AND folder_id <= ?",
+                                           @(afterRowId), @(lastRowId)];
+        }] &&
+        [Database createFolderCountTriggersOnDatabase:database];
+}
+
++ (BOOL)createFolderCountTriggersOnDatabase:(FMDatabase *)database
+{
+    // A boolean expression is 1 or 0 in SQLite, so every trigger adds or
+    // subtracts the flags of one article in a single UPDATE per folder.
+    // Articles without a read flag count as unread, like in the application.
+    return
+        [database executeStatements:@"CREATE TRIGGER IF NOT EXISTS folders_count_insert "
+                                     "AFTER INSERT ON messages BEGIN "
+                                     "UPDATE folders SET "
+                                     "unread_count = unread_count + (new.read_flag IS NOT 1), "
+                                     "flagged_count = flagged_count + (new.marked_flag IS 1), "
+                                     "deleted_count = deleted_count + (new.deleted_flag IS 1) "
+                                     "WHERE folder_id = new.folder_id; "
+                                     "END; "
+                                     "CREATE TRIGGER IF NOT EXISTS folders_count_delete "
+                                     "AFTER DELETE ON messages BEGIN "
+                                     "UPDATE folders SET "
+                                     "unread_count = unread_count - (old.read_flag IS NOT 1), "
+                                     "flagged_count = flagged_count - (old.marked_flag IS 1), "
+                                     "deleted_count = deleted_count - (old.deleted_flag IS 1) "
+                                     "WHERE folder_id = old.folder_id; "
+                                     "END; "
+                                     "CREATE TRIGGER IF NOT EXISTS folders_count_update "
+                                     "AFTER UPDATE OF folder_id, read_flag, marked_flag, "
+                                     "deleted_flag ON messages "
+                                     "WHEN old.folder_id IS NOT new.folder_id "
+                                     "OR (old.read_flag IS 1) IS NOT (new.read_flag IS 1) "
+                                     "OR (old.marked_flag IS 1) IS NOT (new.marked_flag IS 1) "
+                                     "OR (old.deleted_flag IS 1) IS NOT (new.deleted_flag IS 1) "
+                                     "BEGIN "
+                                     "UPDATE folders SET "
+                                     "unread_count = unread_count - (old.read_flag IS NOT 1), "
+                                     "flagged_count = flagged_count - (old.marked_flag IS 1), "
+                                     "deleted_count = deleted_count - (old.deleted_flag IS 1) "
+                                     "WHERE folder_id = old.folder_id; "
+                                     "UPDATE folders SET "
+                                     "unread_count = unread_count + (new.read_flag IS NOT 1), "
+                                     "flagged_count = flagged_count + (new.marked_flag IS 1), "
+                                     "deleted_count = deleted_count + (new.deleted_flag IS 1) "
+                                     "WHERE folder_id = new.folder_id; "
+                                     "END"];
+}
+
++ (BOOL)addSmartFolderMembersOnDatabase:(FMDatabase *)database
+{
+    [database beginTransaction];
+
+    // The member_sql column holds the SQL of the criteria that the members
+    // of a smart folder were computed with, or NULL if they are not stored.
+    BOOL success =
+        [database executeUpdate:@"ALTER TABLE smart_folders "
+                                 "ADD COLUMN member_sql TEXT"] &&
+        [Database createSmartFolderMembersOnDatabase:database];
+
+    if (success) {
+        return [database commit];
+    } else {
+        [database rollback];
+        return NO;
+    }
+}
+
++ (BOOL)createSmartFolderMembersOnDatabase:(FMDatabase *)database
+{
+    NSString *isTracking = @"EXISTS (SELECT 1 FROM smart_folders "
+                            "WHERE member_sql IS NOT NULL)";
+    NSMutableString *statements = [NSMutableString stringWithFormat:
+        @"CREATE TABLE IF NOT EXISTS smart_folder_members "
+         "(folder_id INTEGER NOT NULL, id INTEGER NOT NULL, "
+         "PRIMARY KEY (folder_id, id)) WITHOUT ROWID; "
+         "CREATE TABLE IF NOT EXISTS smart_folder_changes "
+         "(id INTEGER NOT NULL, field TEXT NOT NULL, "
+         "PRIMARY KEY (id, field)) WITHOUT ROWID; "
+         "CREATE TRIGGER IF NOT EXISTS smart_folder_members_delete "
+         "AFTER DELETE ON smart_folders BEGIN "
+         "DELETE FROM smart_folder_members WHERE folder_id = old.folder_id; "
+         "END; "
+         "CREATE TRIGGER IF NOT EXISTS smart_folder_changes_insert "
+         "AFTER INSERT ON messages WHEN %1$@ BEGIN "
+         "INSERT OR IGNORE INTO smart_folder_changes VALUES (new.id, '*'); "
+         "END; "
+         "CREATE TRIGGER IF NOT EXISTS smart_folder_changes_delete "
+         "AFTER DELETE ON messages WHEN %1$@ BEGIN "
+         "INSERT OR IGNORE INTO smart_folder_changes VALUES (old.id, '*'); "
+         "END; "
+         "CREATE TRIGGER IF NOT EXISTS smart_folder_changes_body_insert "
+         "AFTER INSERT ON message_bodies WHEN %1$@ BEGIN "
+         "INSERT OR IGNORE INTO smart_folder_changes VALUES (new.id, 'text'); "
+         "END; "
+         "CREATE TRIGGER IF NOT EXISTS smart_folder_changes_body_update "
+         "AFTER UPDATE OF body ON message_bodies WHEN %1$@ BEGIN "
+         "INSERT OR IGNORE INTO smart_folder_changes VALUES (new.id, 'text'); "
+         "END; ",
+        isTracking];
+
+    // An inserted or deleted article is recorded with the field '*', an
+    // updated one with the name of each column whose value changed. The body
+    // is recorded as 'text', the SQL field of the text criteria.
+    NSArray<NSString *> *columns = @[
+        @"message_id", @"folder_id", @"parent_id", @"read_flag",
+        @"marked_flag", @"deleted_flag", @"title", @"sender", @"link",
+        @"createddate", @"date", @"revised_flag",
+        @"enclosuredownloaded_flag", @"hasenclosure_flag", @"enclosure"
+    ];
+    for (NSString *column in columns) {
+        [statements appendFormat:@"CREATE TRIGGER IF NOT EXISTS "
+                                  "smart_folder_changes_%1$@ "
+                                  "AFTER UPDATE OF %1$@ ON messages "
+                                  "WHEN old.%1$@ IS NOT new.%1$@ AND %2$@ BEGIN "
+                                  "INSERT OR IGNORE INTO smart_folder_changes "
+                                  "VALUES (new.id, '%1$@'); "
+                                  "END; ",
+                                 column, isTracking];
+    }
+    return [database executeStatements:statements];
+}
+
++ (BOOL)addFolderTreeOnDatabase:(FMDatabase *)database
+{
+    [database beginTransaction];
+
+    // The UNION stops at folders that were already visited, in case the
+    // parent_id column of an old database forms a cycle.
+    BOOL success =
+        [Database createFolderTreeOnDatabase:database] &&
+        [database executeUpdate:@"INSERT OR IGNORE INTO folder_tree "
+                                 "(ancestor_id, folder_id) "
+                                 "WITH RECURSIVE tree (ancestor_id, folder_id) AS ("
+                                 "SELECT folder_id, folder_id FROM folders "
+                                 "UNION SELECT tree.ancestor_id, folders.folder_id "
+                                 "FROM folders JOIN tree "
+                                 "ON folders.parent_id = tree.folder_id) "
+                                 "SELECT ancestor_id, folder_id FROM tree"];
+
+    if (success) {
+        return [database commit];
+    } else {
+        [database rollback];
+        return NO;
+    }
+}
+
++ (BOOL)createFolderTreeOnDatabase:(FMDatabase *)database
+{
+    // When a folder moves, its subtree loses the ancestors outside of the
+    // subtree and gains every ancestor of the new parent. Folders at the
+    // root have the parent -1, which has no rows.
+    return
+        [database executeStatements:@"CREATE TABLE IF NOT EXISTS folder_tree "
+                                     "(ancestor_id INTEGER NOT NULL, "
+                                     "folder_id INTEGER NOT NULL, "
+                                     "PRIMARY KEY (ancestor_id, folder_id)) "
+                                     "WITHOUT ROWID; "
+                                     "CREATE INDEX IF NOT EXISTS folder_tree_folder_idx "
+                                     "ON folder_tree (folder_id); "
+                                     "CREATE TRIGGER IF NOT EXISTS folder_tree_insert "
+                                     "AFTER INSERT ON folders BEGIN "
+                                     "INSERT OR IGNORE INTO folder_tree (ancestor_id, folder_id) "
+                                     "SELECT ancestor_id, new.folder_id FROM folder_tree "
+                                     "WHERE folder_id = new.parent_id "
+                                     "UNION ALL SELECT new.folder_id, new.folder_id; "
+                                     "END; "
+                                     "CREATE TRIGGER IF NOT EXISTS folder_tree_delete "
+                                     "AFTER DELETE ON folders BEGIN "
+                                     "DELETE FROM folder_tree "
+                                     "WHERE folder_id = old.folder_id "
+                                     "OR ancestor_id = old.folder_id; "
+                                     "END; "
+                                     "CREATE TRIGGER IF NOT EXISTS folder_tree_update "
+                                     "AFTER UPDATE OF parent_id ON folders "
+                                     "WHEN old.parent_id IS NOT new.parent_id BEGIN "
+                                     "INSERT OR IGNORE INTO smart_folder_changes "
+                                     "SELECT id, 'folder_id' FROM messages "
+                                     "WHERE folder_id IN (SELECT folder_id FROM folder_tree "
+                                     "WHERE ancestor_id = new.folder_id) "
+                                     "AND EXISTS (SELECT 1 FROM smart_folders "
+                                     "WHERE member_sql IS NOT NULL); "
+                                     "DELETE FROM folder_tree "
+                                     "WHERE folder_id IN (SELECT folder_id FROM folder_tree "
+                                     "WHERE ancestor_id = new.folder_id) "
+                                     "AND ancestor_id NOT IN (SELECT folder_id FROM folder_tree "
+                                     "WHERE ancestor_id = new.folder_id); "
+                                     "INSERT OR IGNORE INTO folder_tree (ancestor_id, folder_id) "
+                                     "SELECT ancestors.ancestor_id, descendants.folder_id "
+                                     "FROM folder_tree AS ancestors, folder_tree AS descendants "
+                                     "WHERE ancestors.folder_id = new.parent_id "
+                                     "AND descendants.ancestor_id = new.folder_id; "
+                                     "END"];
+}
+
++ (BOOL)addRetentionOnDatabase:(FMDatabase *)database
+{
+    [database beginTransaction];
+
+    // The existing guids count as listed now, since it is not known when
+    // their feeds listed them last. The composite index replaces the index
+    // on folder_id alone.
+    BOOL success =
+        [database executeStatements:@"ALTER TABLE rss_guids ADD COLUMN last_seen REAL; "
+                                     "DROP INDEX IF EXISTS rss_guids_idx; "
+                                     "CREATE INDEX IF NOT EXISTS rss_guids_folder_message_idx "
+                                     "ON rss_guids (folder_id, message_id)"] &&
+        [database executeUpdate:@"UPDATE rss_guids SET last_seen=?",
+                                @([NSDate date].timeIntervalSince1970)] &&
+        [Database createRetentionPoliciesOnDatabase:database];
+
+    if (success) {
+        return [database commit];
+    } else {
+        [database rollback];
+        return NO;
+    }
+}
+
++ (BOOL)createRetentionPoliciesOnDatabase:(FMDatabase *)database
+{
+    return
+        [database executeStatements:@"CREATE TABLE IF NOT EXISTS retention_policies "
+                                     "(folder_id INTEGER PRIMARY KEY, "
+                                     "max_age INTEGER NOT NULL DEFAULT 0, "
+                                     "max_count INTEGER NOT NULL DEFAULT 0, "
+                                     "guid_horizon INTEGER NOT NULL DEFAULT 0); "
+                                     "CREATE TRIGGER IF NOT EXISTS retention_policies_delete "
+                                     "AFTER DELETE ON folders BEGIN "
+                                     "DELETE FROM retention_policies WHERE folder_id = old.folder_id; "
+                                     "END"];
+}
+
++ (BOOL)createArticleBodyStoreOnDatabase:(FMDatabase *)database
+{
+    return
+        [database executeStatements:@"CREATE TABLE IF NOT EXISTS message_bodies "
+                                     "(id INTEGER PRIMARY KEY, body BLOB); "
+                                     "CREATE TRIGGER IF NOT EXISTS message_bodies_delete "
+                                     "AFTER DELETE ON messages BEGIN "
+                                     "DELETE FROM message_bodies WHERE id = old.id; "
+                                     "END"];
+}
+
++ (BOOL)createFullTextIndexOnDatabase:(FMDatabase *)database
+{
+    // The index, its triggers and its contents are created together, so that
+    // an interrupted migration never leaves an empty index behind. A savepoint
+    // works whether or not the caller has begun a transaction.
+    if (![database startSavePointWithName:@"fts" error:nil]) {
+        return NO;
+    }
+
+    // The index is an external content table: it does not store a copy of the
+    // article text, but reads it through a view that decompresses the bodies.
+    BOOL success =
+        [database executeStatements:@"CREATE VIRTUAL TABLE messages_fts "
+                                     "USING fts5(title, text, "
+                                     "content='messages_search', "
+                                     "content_rowid='id', "
+                                     "tokenize='unicode61 remove_diacritics 2')"] &&
+        [Database createFullTextTriggersOnDatabase:database] &&
+        // Index the articles that already exist.
+        [database executeUpdate:@"INSERT INTO messages_fts (messages_fts) "
+                                 "VALUES ('rebuild')"];
+
+    if (!success) {
+        NSString *errorMessage = database.lastErrorMessage;
+        [database rollbackToSavePointWithName:@"fts" error:nil];
+        [database releaseSavePointWithName:@"fts" error:nil];
+        NSLog(@"Full-text index was not created: %@", errorMessage);
+        return NO;
+    }
+    return [database releaseSavePointWithName:@"fts" error:nil];
+}
+
++ (BOOL)createFullTextTriggersOnDatabase:(FMDatabase *)database
+{
+    // An article is indexed once its body has been stored, which happens
+    // right after the article was inserted. The entry of a deleted article
+    // is removed before the delete, because the body is deleted with it.
+    return
+        [database executeStatements:@"CREATE VIEW messages_search AS "
+                                     "SELECT messages.id AS id, "
+                                     "messages.title AS title, "
+                                     "vna_inflate(message_bodies.body) AS text "
+                                     "FROM messages LEFT JOIN message_bodies "
+                                     "ON message_bodies.id = messages.id; "
+                                     "CREATE TRIGGER messages_fts_insert "
+                                     "AFTER INSERT ON message_bodies BEGIN "
+                                     "INSERT INTO messages_fts (rowid, title, text) "
+                                     "SELECT new.id, title, vna_inflate(new.body) "
+                                     "FROM messages WHERE id = new.id; "
+                                     "END; "
+                                     "CREATE TRIGGER messages_fts_delete "
+                                     "BEFORE DELETE ON messages BEGIN "
+                                     "INSERT INTO messages_fts (messages_fts, rowid, title, text) "
+                                     "SELECT 'delete', old.id, old.title, vna_inflate(body) "
+                                     "FROM message_bodies WHERE id = old.id; "
+                                     "END; "
+                                     "CREATE TRIGGER messages_fts_update_title "
+                                     "AFTER UPDATE OF title ON messages BEGIN "
+                                     "INSERT INTO messages_fts (messages_fts, rowid, title, text) "
+                                     "SELECT 'delete', old.id, old.title, vna_inflate(body) "
+                                     "FROM message_bodies WHERE id = old.id; "
+                                     "INSERT INTO messages_fts (rowid, title, text) "
+                                     "SELECT new.id, new.title, vna_inflate(body) "
+                                     "FROM message_bodies WHERE id = new.id; "
+                                     "END; "
+                                     "CREATE TRIGGER messages_fts_update_body "
+                                     "AFTER UPDATE OF body ON message_bodies BEGIN "
+                                     "INSERT INTO messages_fts (messages_fts, rowid, title, text) "
+                                     "SELECT 'delete', old.id, title, vna_inflate(old.body) "
+                                     "FROM messages WHERE id = old.id; "
+                                     "INSERT INTO messages_fts (rowid, title, text) "
+                                     "SELECT new.id, title, vna_inflate(new.body) "
+                                     "FROM messages WHERE id = new.id; "
+                                     "END"];
+}
+
++ (BOOL)createVersion28FullTextIndexOnDatabase:(FMDatabase *)database
+{
+    // This index refers to the text column of the messages table, which is
+    // no longer used since version 30.
+    BOOL success =
+        [database executeStatements:@"CREATE VIRTUAL TABLE messages_fts "
+                                     "USING fts5(title, text, "
+                                     "content='messages', "
+                                     "content_rowid='rowid', "
+                                     "tokenize='unicode61 remove_diacritics 2')"];
+    if (!success) {
+        return NO;
+    }
+
+    success = [Database createVersion28FullTextTriggersOnDatabase:database];
+    if (!success) {
+        return NO;
+    }
+
+    // Index the articles that already exist.
+    return [database executeUpdate:@"INSERT INTO messages_fts (messages_fts) "
+                                    "VALUES ('rebuild')"];
+}
+
++ (BOOL)createVersion28FullTextTriggersOnDatabase:(FMDatabase *)database
+{
+    return
+        [database executeStatements:@"CREATE TRIGGER messages_fts_insert "
+                                     "AFTER INSERT ON messages BEGIN "
+                                     "INSERT INTO messages_fts (rowid, title, text) "
+                                     "VALUES (new.rowid, new.title, new.text); "
+                                     "END; "
+                                     "CREATE TRIGGER messages_fts_delete "
+                                     "AFTER DELETE ON messages BEGIN "
+                                     "INSERT INTO messages_fts (messages_fts, rowid, title, text) "
+                                     "VALUES ('delete', old.rowid, old.title, old.text); "
+                                     "END; "
+                                     "CREATE TRIGGER messages_fts_update "
+                                     "AFTER UPDATE OF title, text ON messages BEGIN "
+                                     "INSERT INTO messages_fts (messages_fts, rowid, title, text) "
+                                     "VALUES ('delete', old.rowid, old.title, old.text); "
+                                     "INSERT INTO messages_fts (rowid, title, text) "
+                                     "VALUES (new.rowid, new.title, new.text); "
+                                     "END"];
 }
 
 @end
@@ -25,14 +25,24 @@
 @class Article;
 @class ArticleReference;
 @class CriteriaTree;
+@class VNARetentionPolicy;
+@class VNADatabaseInstrumentation;
 
 typedef NS_OPTIONS(NSInteger, VNAQueryScope) {
     VNAQueryScopeInclusive = 1,
     VNAQueryScopeSubFolders = 2
 } NS_SWIFT_NAME(QueryScope);
 
+/// The use of the pages of the database file.
+typedef struct {
+    NSInteger pageSize;
+    NSInteger pageCount;
+    NSInteger freePageCount;
+} VNADatabaseStorageStatistics NS_SWIFT_NAME(DatabaseStorageStatistics);
+
 extern NSNotificationName const VNADatabaseWillDeleteFolderNotification;
 extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
+extern NSNotificationName const VNADatabaseDidReloadFoldersNotification;
 
 @interface Database : NSObject
 
@@ -41,14 +51,31 @@ extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
 
 @property (class, readonly, nonatomic) Database *sharedManager NS_SWIFT_NAME(shared);
 
+/**
+ Opens the database at the given path without user interaction.
+
+ A database that does not exist yet is created with the current schema. This
+ is meant for tests and benchmarks that need a database apart from the one of
+ the user.
+ @param path The path of the database file.
+ @return The database or `nil` if the database could not be opened or if its
+   version is not the current one.
+ */
+- (instancetype)initWithPath:(NSString *)path;
+
 /**
  Loads the database store.
 
  This method performs these operations in order:
   1. Retrieve and create if necessary the database path.
   2. Load the database queue and ask if necessary to relocate the database.
-  3. Perform a SQLite3 `quick_check` and alert if issues are found.
-  4. Depending on the database version:
+  3. Load the snapshot of the folders from the last session if it is still
+     valid, in which case the remaining operations are skipped and the
+     folders and the integrity of the database are checked in the
+     background.
+  4. Perform a SQLite3 `quick_check` and alert if issues are found, offering
+     to restore the last backup if there is one.
+  5. Depending on the database version:
      - perform a database migration,
      - alert that the database is too old or
      - set up an initial database.
@@ -68,8 +95,33 @@ extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
 @property (nonatomic, readonly) NSInteger countOfUnread;
 @property (nonatomic, readonly) NSInteger databaseVersion;
 @property (nonatomic, readonly) BOOL readOnly;
+@property (nonatomic, readonly, getter=isFullTextSearchAvailable) BOOL fullTextSearchAvailable;
 -(void)close;
 
+// Maintenance functions, see VNADatabaseMaintenance
+@property (nonatomic, readonly) VNADatabaseStorageStatistics storageStatistics;
+@property (nonatomic, readonly, getter=isIncrementalVacuumEnabled) BOOL incrementalVacuumEnabled;
+-(NSInteger)incrementalVacuum:(NSInteger)pageCount;
+-(NSArray<NSString *> *)tablesWithoutStatistics;
+-(BOOL)analyzeTable:(NSString *)tableName;
+
+// Snapshot functions, see VNAFolderSnapshot
+/// Caches the folders of the snapshot that was written when the database was
+/// last closed, provided that the database has not changed since.
+-(BOOL)loadFolderSnapshot;
+/// Closes the database and writes a snapshot of the folders for the next
+/// launch.
+-(void)saveFolderSnapshotAndClose;
+
+// Backup functions, see VNADatabaseBackup
+@property (nonatomic, readonly) NSString *path;
+-(void)inWriterConnection:(void (^)(struct sqlite3 *connection))block;
+
+/// Records the statements of the writer and of the reader connections while
+/// it is set. It should be set before the database is used from several
+/// threads.
+@property (nonatomic) VNADatabaseInstrumentation *instrumentation;
+
 // Fields functions
 @property (readonly, nonatomic) NSArray<Field *> *fields;
 -(Field *)fieldByName:(NSString *)name;
@@ -109,6 +161,8 @@ extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
  */
 - (Folder *)folderForPredicateFormat:(NSString *)predicateFormat;
 -(NSString *)sqlScopeForFolder:(Folder *)folder flags:(VNAQueryScope)scopeFlags field:(NSString *)field;
+-(NSString *)fullTextQueryForString:(NSString *)string column:(NSString *)column NS_SWIFT_NAME(fullTextQuery(for:column:));
+-(NSString *)sqlFullTextScopeForString:(NSString *)string column:(NSString *)column flags:(VNAQueryScope)scopeFlags NS_SWIFT_NAME(sqlFullTextScope(for:column:flags:));
 -(NSInteger)addFolder:(NSInteger)parentId afterChild:(NSInteger)predecessorId folderName:(NSString *)name type:(NSInteger)type canAppendIndex:(BOOL)canAppendIndex;
 -(BOOL)deleteFolder:(NSInteger)folderId;
 -(BOOL)setName:(NSString *)newName forFolder:(NSInteger)folderId;
@@ -122,9 +176,11 @@ extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
 -(BOOL)markFolderRead:(NSInteger)folderId;
 -(void)clearFlag:(NSUInteger)flag forFolder:(NSInteger)folderId;
 -(void)setFlag:(NSUInteger)flag forFolder:(NSInteger)folderId;
--(void)setFolderUnreadCount:(Folder *)folder adjustment:(NSInteger)adjustment;
 -(void)setLastUpdate:(NSDate *)lastUpdate forFolder:(NSInteger)folderId;
 -(void)setLastUpdateString:(NSString *)lastUpdateString forFolder:(NSInteger)folderId;
+-(void)setEntityTag:(NSString *)entityTag forFolder:(NSInteger)folderId;
+-(void)setContentSize:(unsigned long long)contentSize forFolder:(NSInteger)folderId;
+-(NSTimeInterval)publicationIntervalOfFolder:(NSInteger)folderId;
 -(BOOL)setParent:(NSInteger)newParentID forFolder:(NSInteger)folderId;
 -(BOOL)setFirstChild:(NSInteger)childId forFolder:(NSInteger)folderId;
 -(BOOL)setNextSibling:(NSUInteger)nextSiblingId forFolder:(NSInteger)folderId;
@@ -147,14 +203,68 @@ extern NSNotificationName const VNADatabaseDidDeleteFolderNotification;
 // Article functions
 -(BOOL)addArticle:(Article *)article toFolder:(NSInteger)folderID;
 -(BOOL)updateArticle:(Article *)existingArticle ofFolder:(NSInteger)folderID withArticle:(Article *)article;
+-(NSIndexSet *)addArticles:(NSArray<Article *> *)articles toFolder:(NSInteger)folderID;
+-(NSIndexSet *)updateArticles:(NSArray<Article *> *)existingArticles ofFolder:(NSInteger)folderID withArticles:(NSArray<Article *> *)articleUpdates;
 -(BOOL)deleteArticle:(Article *)article;
 -(NSArray<ArticleReference *> *)arrayOfUnreadArticlesRefs:(NSInteger)folderId;
 -(NSArray<Article *> *)arrayOfArticles:(NSInteger)folderId filterString:(NSString *)filterString;
+-(NSArray<Article *> *)arrayOfArticles:(NSInteger)folderId
+                          filterString:(NSString *)filterString
+                            sortColumn:(NSString *)sortColumn
+                             ascending:(BOOL)ascending
+                              position:(NSArray **)position
+                                 limit:(NSUInteger)limit;
 -(void)markArticleRead:(NSInteger)folderId guid:(NSString *)guid isRead:(BOOL)isRead;
 -(void)markArticleFlagged:(NSInteger)folderId guid:(NSString *)guid isFlagged:(BOOL)isFlagged;
 -(void)markArticleDeleted:(NSInteger)folderId guid:(NSString *)guid isDeleted:(BOOL)isDeleted;
--(void)markUnreadArticlesFromFolder:(Folder *)folder guidArray:(NSArray *)guidArray;
--(void)markStarredArticlesFromFolder:(Folder *)folder guidArray:(NSArray *)guidArray;
+-(NSArray<NSString *> *)markUnreadArticlesFromFolder:(Folder *)folder guidArray:(NSArray<NSString *> *)guidArray;
+-(NSArray<NSString *> *)markStarredArticlesFromFolder:(Folder *)folder guidArray:(NSArray<NSString *> *)guidArray;
 @property (nonatomic, getter=isTrashEmpty, readonly) BOOL trashEmpty;
--(NSArray *)guidHistoryForFolderId:(NSInteger)folderId;
+-(NSSet<NSString *> *)guidHistoryForFolderId:(NSInteger)folderId;
+-(void)markGuids:(NSArray<NSString *> *)guids seenInFolder:(NSInteger)folderId;
+
+// Retention functions
+-(VNARetentionPolicy *)retentionPolicyForFolder:(NSInteger)folderId;
+-(BOOL)setRetentionPolicy:(VNARetentionPolicy *)policy forFolder:(NSInteger)folderId;
+
+/**
+ Moves read and unflagged articles of a folder to the trash, at most as many
+ as the limit, so that large expiries can be split into short transactions.
+ @param folderId The folder of the articles.
+ @param date The date before which articles expire, or `nil`.
+ @param count The number of most recent articles to keep, or 0 to keep
+   articles regardless of their number.
+ @param limit The maximum number of articles to move to the trash.
+ @return The number of articles moved to the trash or -1 on error.
+ */
+-(NSInteger)expireArticlesOfFolder:(NSInteger)folderId
+                        beforeDate:(NSDate *)date
+                     keepingNewest:(NSUInteger)count
+                             limit:(NSUInteger)limit;
+@property (nonatomic, readonly) NSInteger countOfDeletedArticles;
+
+/**
+ Permanently deletes articles that are in the trash, at most as many as the
+ limit.
+ @param limit The maximum number of articles to delete.
+ @param folderIds A set to which the folders of the deleted articles are
+   added.
+ @return The number of deleted articles or -1 on error.
+ */
+-(NSInteger)purgeDeletedArticlesWithLimit:(NSUInteger)limit
+                                folderIds:(NSMutableIndexSet *)folderIds;
+
+/**
+ Forgets the guids of a folder that its feed did not list for the given
+ time after it last listed any guid, at most as many as the limit. Guids of
+ articles that are still in the database are kept. A feed that is not
+ refreshed does not lose any guid.
+ @param folderId The folder of the guids.
+ @param horizon The time for which unlisted guids are kept.
+ @param limit The maximum number of guids to forget.
+ @return The number of guids forgotten or -1 on error.
+ */
+-(NSInteger)pruneGuidHistoryOfFolder:(NSInteger)folderId
+                          unseenFor:(NSTimeInterval)horizon
+                              limit:(NSUInteger)limit;
 @end
@@ -22,8 +22,13 @@
 
 @import FMDB;
 @import os.log;
+@import SQLite3;
 
 #import "Database+Migration.h"
+#import "DatabaseBackup.h"
+#import "DatabaseInstrumentation.h"
+#import "FolderSnapshot.h"
+#import "InstrumentedDatabaseQueue.h"
 #import "Preferences.h"
 #import "StringExtensions.h"
 #import "Constants.h"
@@ -32,6 +37,8 @@
 #import "Article.h"
 #import "Folder.h"
 #import "Field.h"
+#import "NSData+Compression.h"
+#import "RetentionEngine.h"
 #import "Vienna-Swift.h"
 
 #define VNA_LOG os_log_create("--", "Database")
@@ -42,13 +49,39 @@
 @property (readwrite, nonatomic) NSArray<Field *> *fields;
 @property (nonatomic) NSDictionary<NSString *, Field *> *fieldsByName;
 @property (nonatomic) NSMutableDictionary *foldersDict;
-@property (nonatomic) FMDatabaseQueue *databaseQueue;
+// Indexes of the folders in foldersDict, which the functions that change
+// folders keep up to date. Names, feed URLs and remote ids are not
+// necessarily unique, so a key maps to all folders that share it.
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableArray<Folder *> *> *foldersByName;
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableArray<Folder *> *> *foldersByFeedURL;
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableArray<Folder *> *> *foldersByRemoteId;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSMutableArray<Folder *> *> *foldersByParentId;
+@property (nonatomic) VNAInstrumentedDatabaseQueue *databaseQueue;
+@property (nonatomic) FMDatabasePool *readerPool;
+@property (nonatomic) dispatch_semaphore_t readerSemaphore;
 @property (nonatomic) NSMutableDictionary<NSNumber *, CriteriaTree *> *smartfoldersDict;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSString *> *smartFolderMemberSQL;
+@property (nonatomic) NSMutableDictionary<NSNumber *, NSString *> *smartFolderCandidateSQL;
 @property (readwrite, nonatomic) BOOL readOnly;
 @property (readwrite, nonatomic) NSInteger countOfUnread;
+@property (nonatomic) NSNumber *fullTextSearchAvailability;
+@property (nonatomic) VNAFolderSnapshot *folderSnapshot;
+@property (nonatomic) dispatch_group_t backgroundCheckGroup;
+@property (nonatomic) BOOL integrityCheckFailed;
+@property (nonatomic) NSProgress *migrationProgress;
 
 - (NSString *)relocateLockedDatabase:(NSString *)path;
+- (void)registerFunctions;
++ (void)registerFunctionsOnDatabase:(FMDatabase *)db;
+- (void)enableWriteAheadLogging;
+- (void)inReaderDatabase:(void (^)(FMDatabase *db))block;
+- (BOOL)insertArticle:(Article *)article inFolder:(NSInteger)folderID database:(FMDatabase *)db;
+- (BOOL)updateArticle:(Article *)existingArticle ofFolder:(NSInteger)folderID withArticle:(Article *)articleUpdate database:(FMDatabase *)db;
+- (void)applyFolderCountChanges;
+- (NSArray<NSString *> *)reconcileFlag:(NSString *)flagColumn ofFolder:(NSInteger)folderId withGuids:(NSArray<NSString *> *)guidArray listedValue:(BOOL)listedValue;
 - (CriteriaTree *)criteriaForFolder:(NSInteger)folderId;
+- (VNACriteriaSQL *)sqlScopeForSmartFolderMembers:(NSInteger)folderId;
+- (BOOL)applySmartFolderChangesWithCriteriaSQL:(NSDictionary<NSNumber *, VNACriteriaSQL *> *)criteriaSQL fields:(NSDictionary<NSNumber *, NSSet<NSString *> *> *)criteriaFields database:(FMDatabase *)db;
 - (NSArray *)arrayOfSubFolders:(Folder *)folder;
 - (void)createInitialSmartFolder:(NSString *)folderName withCriteria:(Criteria *)criteria;
 - (NSInteger)createFolderOnDatabase:(NSString *)name underParent:(NSInteger)parentId withType:(NSInteger)type;
@@ -58,12 +91,104 @@
 
 // The current database version number
 static NSInteger const VNAMinimumSupportedDatabaseVersion = 12;
-static NSInteger const VNACurrentDatabaseVersion = 27;
+static NSInteger const VNACurrentDatabaseVersion = 40;
+
+// The maximum number of read-only connections to the database
+static NSInteger const VNAMaximumReaderConnections = 4;
+
+// The number of changed articles above which the members of smart folders
+// are computed anew instead of checking every changed article
+static NSInteger const VNASmartFolderChangeLimit = 10000;
+
+// The number of rows of each index that ANALYZE samples, which bounds the time
+// it takes on large tables
+static NSInteger const VNAAnalysisLimit = 1000;
+
+/* VNAInflateFunction
+ * Implements the SQL function vna_inflate(body), which decompresses an
+ * article body of the message_bodies table.
+ */
+static void VNAInflateFunction(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    @autoreleasepool {
+        const void *bytes = sqlite3_value_blob(argv[0]);
+        NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes
+                                            length:sqlite3_value_bytes(argv[0])
+                                      freeWhenDone:NO];
+        NSString *string = data.vna_decompressedString;
+        if (string) {
+            sqlite3_result_text(context, string.UTF8String, -1, SQLITE_TRANSIENT);
+        } else {
+            sqlite3_result_null(context);
+        }
+    }
+}
+
+/* VNADeflateFunction
+ * Implements the SQL function vna_deflate(text), which compresses a text
+ * the same way as article bodies are stored.
+ */
+static void VNADeflateFunction(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    @autoreleasepool {
+        const unsigned char *text = sqlite3_value_text(argv[0]);
+        NSString *string = [[NSString alloc] initWithBytes:text
+                                                    length:sqlite3_value_bytes(argv[0])
+                                                  encoding:NSUTF8StringEncoding];
+        NSData *data = [NSData vna_compressedDataWithString:string ?: @""];
+        if (data) {
+            sqlite3_result_blob(context, data.bytes, (int)data.length, SQLITE_TRANSIENT);
+        } else {
+            sqlite3_result_error(context, "Failed to compress text", -1);
+        }
+    }
+}
+
+/* VNAAddFolderToIndex
+ * Adds a folder to the folders that share a key of one of the folder indexes.
+ */
+static void VNAAddFolderToIndex(NSMutableDictionary *index, id<NSCopying> key, Folder *folder)
+{
+    if (key == nil || folder == nil) {
+        return;
+    }
+    NSMutableArray<Folder *> *folders = index[key];
+    if (folders == nil) {
+        index[key] = [NSMutableArray arrayWithObject:folder];
+    } else if ([folders indexOfObjectIdenticalTo:folder] == NSNotFound) {
+        [folders addObject:folder];
+    }
+}
+
+/* VNARemoveFolderFromIndex
+ * Removes a folder from the folders that share a key of one of the folder
+ * indexes.
+ */
+static void VNARemoveFolderFromIndex(NSMutableDictionary *index, id<NSCopying> key, Folder *folder)
+{
+    if (key == nil || folder == nil) {
+        return;
+    }
+    NSMutableArray<Folder *> *folders = index[key];
+    [folders removeObjectIdenticalTo:folder];
+    if (folders.count == 0) {
+        [index removeObjectForKey:key];
+    }
+}
 
 @implementation Database
 
 NSNotificationName const VNADatabaseWillDeleteFolderNotification = @"Database Will Delete Folder";
 NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did Delete Folder";
+NSNotificationName const VNADatabaseDidReloadFoldersNotification = @"Database Did Reload Folders";
 
 - (instancetype)init
 {
@@ -75,6 +200,59 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         _searchFolder = nil;
         _searchString = @"";
         _foldersDict = [[NSMutableDictionary alloc] init];
+        _foldersByName = [[NSMutableDictionary alloc] init];
+        _foldersByFeedURL = [[NSMutableDictionary alloc] init];
+        _foldersByRemoteId = [[NSMutableDictionary alloc] init];
+        _foldersByParentId = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+/* initWithPath
+ * Opens the database at the specified path without involving the user or
+ * the preferences. A new database is created with the trash folder as its
+ * only folder. Returns nil if the database needs to be migrated first.
+ */
+- (instancetype)initWithPath:(NSString *)path
+{
+    self = [super init];
+    if (self) {
+        _initializedfoldersDict = NO;
+        _countOfUnread = 0;
+        _searchString = @"";
+        _foldersDict = [[NSMutableDictionary alloc] init];
+        _foldersByName = [[NSMutableDictionary alloc] init];
+        _foldersByFeedURL = [[NSMutableDictionary alloc] init];
+        _foldersByRemoteId = [[NSMutableDictionary alloc] init];
+        _foldersByParentId = [[NSMutableDictionary alloc] init];
+        _databaseQueue = [[VNAInstrumentedDatabaseQueue alloc] initWithPath:path];
+        if (!_databaseQueue) {
+            return nil;
+        }
+        [self registerFunctions];
+        [self enableWriteAheadLogging];
+
+        NSInteger databaseVersion = self.databaseVersion;
+        if (databaseVersion == 0) {
+            __block BOOL success = NO;
+            [_databaseQueue inDatabase:^(FMDatabase *db) {
+                success = [self createTablesOnDatabase:db];
+                if (success) {
+                    [db executeUpdate:@"INSERT INTO folders (parent_id, foldername, unread_count, last_update, type, flags, next_sibling, first_child) VALUES (-1, ?, 0, 0, ?, 0, 0, 0)",
+                     NSLocalizedString(@"Trash", nil), @(VNAFolderTypeTrash)];
+                    [db executeUpdate:@"INSERT INTO info (first_folder, folder_sort) VALUES (?, ?)",
+                     @(db.lastInsertRowId), @(VNAFolderSortManual)];
+                    db.userVersion = (uint32_t)VNACurrentDatabaseVersion;
+                }
+            }];
+            if (!success) {
+                return nil;
+            }
+        } else if (databaseVersion != VNACurrentDatabaseVersion) {
+            // Migrations may require user interaction, which is only offered
+            // by -loadDatabaseStore.
+            return nil;
+        }
     }
     return self;
 }
@@ -96,44 +274,59 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         return NO;
     }
 
-    FMDatabaseQueue *databaseQueue = [[FMDatabaseQueue alloc] initWithPath:path];
+    VNAInstrumentedDatabaseQueue *databaseQueue = [[VNAInstrumentedDatabaseQueue alloc] initWithPath:path];
     // If we did not succeed getting read/write+create status,
     // then we need to prompt the user for a different location.
     if (!databaseQueue) {
         NSString *relocatedPath = [self relocateLockedDatabase:path];
         if (relocatedPath) {
-            databaseQueue = [[FMDatabaseQueue alloc] initWithPath:relocatedPath];
+            databaseQueue = [[VNAInstrumentedDatabaseQueue alloc] initWithPath:relocatedPath];
             if (!databaseQueue) {
                 return NO;
             }
         }
     }
     self.databaseQueue = databaseQueue;
+    [self registerFunctions];
+    [self enableWriteAheadLogging];
+
+    // The folders of the last session stand in until they are loaded from
+    // the database, and the database is checked in the background.
+    if ([self loadFolderSnapshot]) {
+        [self checkDatabaseInBackground];
+        return YES;
+    }
 
     __block BOOL success = NO;
     [databaseQueue inDatabase:^(FMDatabase *db) {
         success = [db executeStatements:@"PRAGMA quick_check;"];
     }];
     if (!success) {
-        NSAlert * alert = [NSAlert new];
-        alert.alertStyle = NSAlertStyleCritical;
-        alert.messageText = NSLocalizedString(@"Vienna's database seems to be corrupted. Would you like to quit Vienna or continue anyway?",
-                                              @"Title of an alert");
-        alert.informativeText =
-            [NSString stringWithFormat:NSLocalizedString(
-                 @"Vienna may not work as expected if the database is corrupted. We recommend you quit Vienna and either restore the database (%@) from a backup or attempt a sqlite3 recovery.",
-                 @"Informative text of an alert"),
-             databaseQueue.path.lastPathComponent];
-        [alert addButtonWithTitle:NSLocalizedStringWithDefaultValue(@"quitVienna.button",
-                                                                    nil,
-                                                                    NSBundle.mainBundle,
-                                                                    @"Quit Vienna",
-                                                                    @"Button to quit Vienna after a database check")];
-        [alert addButtonWithTitle:NSLocalizedString(@"Continue Anyway",
-                                                    @"Button to continue running Vienna despite an unsuccessful check")];
+        NSAlert * alert = self.corruptedDatabaseAlert;
+        NSURL *snapshotURL = [[VNADatabaseBackup alloc] initWithDatabase:self].snapshotURLs.firstObject;
+        if (snapshotURL) {
+            [alert addButtonWithTitle:NSLocalizedString(@"Restore Last Backup",
+                                                        @"Button to replace the database with the last backup after an unsuccessful check")];
+        }
         NSInteger modalReturn = [alert runModal];
         if (modalReturn == NSAlertFirstButtonReturn) {
             return NO;
+        } else if (modalReturn == NSAlertThirdButtonReturn) {
+            NSString *databasePath = databaseQueue.path;
+            [self.readerPool releaseAllDatabases];
+            [databaseQueue close];
+            NSError *error = nil;
+            if (![VNADatabaseBackup restoreSnapshotAtURL:snapshotURL toDatabaseAtPath:databasePath error:&error]) {
+                [[NSAlert alertWithError:error] runModal];
+                return NO;
+            }
+            databaseQueue = [[VNAInstrumentedDatabaseQueue alloc] initWithPath:databasePath];
+            if (!databaseQueue) {
+                return NO;
+            }
+            self.databaseQueue = databaseQueue;
+            [self registerFunctions];
+            [self enableWriteAheadLogging];
         } else {
             [self backupDatabase];
         }
@@ -163,12 +356,11 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 
         [self backupDatabase];
 
-        [databaseQueue inDatabase:^(FMDatabase *db) {
-            // Migrate the database to the newest version
-            // TODO: move this into transaction so we can rollback on failure
-            [Database migrateDatabase:db fromVersion:databaseVersion];
-        }];
-        
+        // Migrate the database to the newest version
+        if (![self migrateDatabaseFromVersion:databaseVersion]) {
+            return NO;
+        }
+
         // Confirm the database is now at the correct version
         if (self.databaseVersion == VNACurrentDatabaseVersion) {
             return YES;
@@ -192,21 +384,167 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
     return NO;
 }
 
+/* corruptedDatabaseAlert
+ * Returns an alert that asks whether to quit or to continue after the
+ * integrity check of the database failed.
+ */
+-(NSAlert *)corruptedDatabaseAlert
+{
+    NSAlert * alert = [NSAlert new];
+    alert.alertStyle = NSAlertStyleCritical;
+    alert.messageText = NSLocalizedString(@"Vienna's database seems to be corrupted. Would you like to quit Vienna or continue anyway?",
+                                          @"Title of an alert");
+    alert.informativeText =
+        [NSString stringWithFormat:NSLocalizedString(
+             @"Vienna may not work as expected if the database is corrupted. We recommend you quit Vienna and either restore the database (%@) from a backup or attempt a sqlite3 recovery.",
+             @"Informative text of an alert"),
+         self.path.lastPathComponent];
+    [alert addButtonWithTitle:NSLocalizedStringWithDefaultValue(@"quitVienna.button",
+                                                                nil,
+                                                                NSBundle.mainBundle,
+                                                                @"Quit Vienna",
+                                                                @"Button to quit Vienna after a database check")];
+    [alert addButtonWithTitle:NSLocalizedString(@"Continue Anyway",
+                                                @"Button to continue running Vienna despite an unsuccessful check")];
+    return alert;
+}
+
+/* migrateDatabaseFromVersion
+ * Migrates the database on a background queue while a panel shows the
+ * progress. The migration can be stopped to quit, in which case it resumes
+ * at the next launch.
+ */
+-(BOOL)migrateDatabaseFromVersion:(NSInteger)databaseVersion
+{
+    NSProgress * progress = [NSProgress discreteProgressWithTotalUnitCount:1];
+    self.migrationProgress = progress;
+
+    NSPanel * panel = [[NSPanel alloc] initWithContentRect:NSMakeRect(0, 0, 420, 112)
+                                                 styleMask:NSWindowStyleMaskTitled
+                                                   backing:NSBackingStoreBuffered
+                                                     defer:NO];
+    panel.title = NSLocalizedString(@"Database Upgrade", nil);
+    NSTextField * label = [NSTextField labelWithString:NSLocalizedString(@"Upgrading the database…",
+                                                                         @"Label of the progress of a database upgrade")];
+    label.frame = NSMakeRect(20, 76, 380, 17);
+    NSProgressIndicator * indicator = [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(20, 50, 380, 20)];
+    indicator.indeterminate = NO;
+    indicator.minValue = 0.0;
+    indicator.maxValue = 1.0;
+    NSButton * quitButton = [NSButton buttonWithTitle:NSLocalizedStringWithDefaultValue(@"quitVienna.button",
+                                                                                       nil,
+                                                                                       NSBundle.mainBundle,
+                                                                                       @"Quit Vienna",
+                                                                                       @"Button to quit Vienna after a database check")
+                                               target:self
+                                               action:@selector(stopMigration:)];
+    [quitButton sizeToFit];
+    [quitButton setFrameOrigin:NSMakePoint(400 - NSWidth(quitButton.frame), 12)];
+    [panel.contentView addSubview:label];
+    [panel.contentView addSubview:indicator];
+    [panel.contentView addSubview:quitButton];
+    [panel center];
+
+    __block BOOL success = NO;
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [self.databaseQueue inDatabase:^(FMDatabase *db) {
+            success = [Database migrateDatabase:db
+                                    fromVersion:databaseVersion
+                                      toVersion:VNACurrentDatabaseVersion
+                                       progress:progress];
+        }];
+        dispatch_semaphore_signal(finished);
+    });
+
+    // Keep the panel responsive while the migration runs.
+    NSModalSession session = [NSApp beginModalSessionForWindow:panel];
+    while (dispatch_semaphore_wait(finished, dispatch_time(DISPATCH_TIME_NOW, 50 * NSEC_PER_MSEC)) != 0) {
+        [NSApp runModalSession:session];
+        indicator.doubleValue = progress.fractionCompleted;
+    }
+    [NSApp endModalSession:session];
+    [panel orderOut:nil];
+    self.migrationProgress = nil;
+
+    if (progress.isCancelled) {
+        os_log_info(VNA_LOG, "The database upgrade was stopped and resumes at the next launch");
+    }
+    return success;
+}
+
+/* stopMigration
+ * Stops the migration after the current chunk.
+ */
+-(IBAction)stopMigration:(id)sender
+{
+    [sender setEnabled:NO];
+    [self.migrationProgress cancel];
+}
+
+/* checkDatabaseInBackground
+ * Loads the folders on a read-only connection while the folders of the
+ * snapshot stand in for them, and replaces them if they differ. Then checks
+ * the integrity of the database and warns if it failed.
+ */
+-(void)checkDatabaseInBackground
+{
+    VNAFolderSnapshot * snapshot = self.folderSnapshot;
+    dispatch_group_t group = dispatch_group_create();
+    self.backgroundCheckGroup = group;
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        __block NSArray<Folder *> * folders = nil;
+        [self inReaderDatabase:^(FMDatabase *db) {
+            folders = [self foldersFromDatabase:db];
+        }];
+        if (folders && ![snapshot hasSameFoldersAsSnapshot:[[VNAFolderSnapshot alloc] initWithFolders:folders generation:snapshot.generation]]) {
+            os_log_info(VNA_LOG, "The folder snapshot is out of date, reloading the folders");
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self reloadFolders];
+            });
+        }
+
+        __block BOOL success = NO;
+        [self inReaderDatabase:^(FMDatabase *db) {
+            success = [db executeStatements:@"PRAGMA quick_check;"];
+        }];
+        if (!success) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                // Without a snapshot, the next launch checks the database
+                // before it is used and offers to restore a backup.
+                self.integrityCheckFailed = YES;
+                if ([self.corruptedDatabaseAlert runModal] == NSAlertFirstButtonReturn) {
+                    [NSApp terminate:nil];
+                } else {
+                    [self backupDatabase];
+                }
+            });
+        }
+    });
+}
+
+/* reloadFolders
+ * Loads the folders from the database again and notifies the folder tree.
+ */
+-(void)reloadFolders
+{
+    self.initializedfoldersDict = NO;
+    [self initFolderArray];
+    [[NSNotificationCenter defaultCenter] postNotificationName:VNADatabaseDidReloadFoldersNotification
+                                                        object:nil];
+}
+
 -(void)backupDatabase {
-    // Back up the database (before any upgrade or if an anomaly has been detected).
-    NSFileManager *fileManager = NSFileManager.defaultManager;
-    NSString *databaseBackupPath = [[Database databasePath] stringByAppendingPathExtension:@"bak"];
+    // Back up the database (before any upgrade or if an anomaly has been
+    // detected). Nothing else uses the database yet, so the copy does not
+    // pause between its steps.
+    VNADatabaseBackup *backup = [[VNADatabaseBackup alloc] initWithDatabase:self];
+    backup.pauseBetweenSteps = 0.0;
+    NSURL *databaseBackupURL = [NSURL fileURLWithPath:[self.path stringByAppendingPathExtension:@"bak"]];
     NSError *error = nil;
-    if ([fileManager fileExistsAtPath:databaseBackupPath]) {
-        [fileManager removeItemAtPath:databaseBackupPath
-                                error:&error];
-    }
-    [fileManager copyItemAtPath:[Database databasePath]
-                         toPath:databaseBackupPath
-                          error:&error];
 
     // Log the error if the backup creation failed, but continue regardless.
-    if (error) {
+    if (![backup copyDatabaseToURL:databaseBackupURL error:&error]) {
         NSLog(@"Database backup could not created: %@", error.localizedDescription);
     }
 }
@@ -291,28 +629,37 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 
 
 -(BOOL)createTablesOnDatabase:(FMDatabase *)db {
-    // Enable FULL auto-vacuum mode before creating tables.
-    [db executeUpdate:@"PRAGMA auto_vacuum = 1"];
+    // Enable INCREMENTAL auto-vacuum mode before creating tables.
+    [db executeUpdate:@"PRAGMA auto_vacuum = 2"];
 
     // Create the tables. We use the first table as a test whether we can
     // setup at the specified location
-    [db executeUpdate:@"CREATE TABLE info (version, last_opened, first_folder, folder_sort)"];
+    [db executeUpdate:@"CREATE TABLE info (version, last_opened, first_folder, folder_sort, generation INTEGER NOT NULL DEFAULT 0)"];
     if ([db hadError]) {
         return NO;
     }
-    [db executeUpdate:@"CREATE TABLE folders (folder_id integer primary key, parent_id, foldername, unread_count, last_update, type, flags, next_sibling, first_child)"];
-    [db executeUpdate:@"CREATE TABLE messages (message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender, link, createddate, date, text, revised_flag, enclosuredownloaded_flag, hasenclosure_flag, enclosure)"];
-    [db executeUpdate:@"CREATE TABLE smart_folders (folder_id, search_string)"];
-    [db executeUpdate:@"CREATE TABLE rss_folders (folder_id, feed_url, username, last_update_string, description, home_page, bloglines_id)"];
-    [db executeUpdate:@"CREATE TABLE rss_guids (message_id, folder_id)"];
-    [db executeUpdate:@"CREATE INDEX messages_folder_idx ON messages (folder_id)"];
-    [db executeUpdate:@"CREATE INDEX messages_message_idx ON messages (message_id)"];
-    [db executeUpdate:@"CREATE INDEX rss_guids_idx ON rss_guids (folder_id)"];
-    [db executeUpdate:@"CREATE INDEX messages_read_flag ON messages(read_flag)"];
-    [db executeUpdate:@"CREATE INDEX messages_deleted_flag ON messages(deleted_flag)"];
-    if ([db hadError]) {
+    [db executeUpdate:@"CREATE TABLE folders (folder_id INTEGER PRIMARY KEY, parent_id INTEGER, foldername TEXT, unread_count INTEGER, last_update REAL, type INTEGER, flags INTEGER, next_sibling INTEGER, first_child INTEGER, flagged_count INTEGER NOT NULL DEFAULT 0, deleted_count INTEGER NOT NULL DEFAULT 0)"];
+    [db executeUpdate:@"CREATE TABLE messages (id INTEGER PRIMARY KEY, message_id TEXT, folder_id INTEGER, parent_id INTEGER, read_flag INTEGER, marked_flag INTEGER, deleted_flag INTEGER, title TEXT, sender TEXT, link TEXT, createddate REAL, date REAL, revised_flag INTEGER, enclosuredownloaded_flag INTEGER, hasenclosure_flag INTEGER, enclosure TEXT)"];
+    [db executeUpdate:@"CREATE TABLE smart_folders (folder_id, search_string, member_sql TEXT)"];
+    [db executeUpdate:@"CREATE TABLE rss_folders (folder_id, feed_url, username, last_update_string, description, home_page, bloglines_id, etag TEXT NOT NULL DEFAULT '', content_size INTEGER NOT NULL DEFAULT 0)"];
+    [db executeUpdate:@"CREATE TABLE rss_guids (message_id, folder_id, last_seen REAL)"];
+    [db executeUpdate:@"CREATE UNIQUE INDEX messages_folder_message_idx ON messages (folder_id, message_id)"];
+    [db executeUpdate:@"CREATE INDEX messages_folder_read_idx ON messages (folder_id, read_flag, message_id)"];
+    [db executeUpdate:@"CREATE INDEX messages_folder_marked_idx ON messages (folder_id, marked_flag, message_id)"];
+    [db executeUpdate:@"CREATE INDEX messages_deleted_idx ON messages (deleted_flag, folder_id)"];
+    [db executeUpdate:@"CREATE INDEX messages_date_idx ON messages (date)"];
+    [db executeUpdate:@"CREATE INDEX messages_folder_date_idx ON messages (folder_id, date)"];
+    [db executeUpdate:@"CREATE INDEX rss_guids_folder_message_idx ON rss_guids (folder_id, message_id)"];
+    if ([db hadError] || ![Database createArticleBodyStoreOnDatabase:db] ||
+        ![Database createFolderCountTriggersOnDatabase:db] ||
+        ![Database createSmartFolderMembersOnDatabase:db] ||
+        ![Database createFolderTreeOnDatabase:db] ||
+        ![Database createRetentionPoliciesOnDatabase:db]) {
         return NO;
     }
+
+    // Searches fall back to LIKE patterns if the full-text index is missing.
+    [Database createFullTextIndexOnDatabase:db];
     return YES;
 }
 
@@ -606,16 +953,210 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
     return dbVersion;
 }
 
+/* registerFunctions
+ * Registers the SQL functions that compress and decompress article bodies
+ * on the database queue. The full-text index and the migrations use them.
+ */
+-(void)registerFunctions
+{
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        [Database registerFunctionsOnDatabase:db];
+    }];
+}
+
+/* registerFunctionsOnDatabase
+ * Registers the SQL functions on a single connection.
+ */
++(void)registerFunctionsOnDatabase:(FMDatabase *)db
+{
+    sqlite3_create_function_v2(db.sqliteHandle, "vna_inflate", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                               NULL, VNAInflateFunction, NULL, NULL, NULL);
+    sqlite3_create_function_v2(db.sqliteHandle, "vna_deflate", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                               NULL, VNADeflateFunction, NULL, NULL, NULL);
+}
+
+/* databasePool:didAddDatabase:
+ * Delegate method of the reader pool. The read-only connections need the
+ * SQL functions for searches that cannot use the full-text index. They keep
+ * their prepared statements, which the criteria of folders compile to the
+ * same SQL for every query.
+ */
+-(void)databasePool:(FMDatabasePool *)pool didAddDatabase:(FMDatabase *)database
+{
+    [Database registerFunctionsOnDatabase:database];
+    database.shouldCacheStatements = YES;
+    [self.instrumentation attachToDatabase:database];
+}
+
+/* setInstrumentation
+ * Starts or stops recording the statements of the connections. The readers
+ * that are not in use are closed, so that the pool opens them again with
+ * the new instrumentation.
+ */
+-(void)setInstrumentation:(VNADatabaseInstrumentation *)instrumentation
+{
+    _instrumentation = instrumentation;
+    self.databaseQueue.instrumentation = nil;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        if (instrumentation != nil) {
+            [instrumentation attachToDatabase:db];
+        } else {
+            [VNADatabaseInstrumentation detachFromDatabase:db];
+        }
+    }];
+    self.databaseQueue.instrumentation = instrumentation;
+    [self.readerPool releaseAllDatabases];
+}
+
+/* enableWriteAheadLogging
+ * Switches the database to write-ahead logging and prepares a pool of
+ * read-only connections. In this mode, readers see the last committed state
+ * of the database and neither wait for the writer nor block it. If the
+ * journal mode cannot be changed, for example on some network volumes, all
+ * queries go through the database queue.
+ */
+-(void)enableWriteAheadLogging
+{
+    __block NSString * journalMode = nil;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        journalMode = [db stringForQuery:@"PRAGMA journal_mode = WAL"];
+        if ([journalMode.lowercaseString isEqualToString:@"wal"]) {
+            // In WAL mode, this does not risk corruption, but the last
+            // transactions may be rolled back after a power loss.
+            [db executeStatements:@"PRAGMA synchronous = NORMAL"];
+        }
+    }];
+
+    if ([journalMode.lowercaseString isEqualToString:@"wal"]) {
+        FMDatabasePool * pool = [FMDatabasePool databasePoolWithPath:self.databaseQueue.path
+                                                                flags:SQLITE_OPEN_READONLY];
+        pool.maximumNumberOfDatabasesToCreate = VNAMaximumReaderConnections;
+        pool.delegate = self;
+        self.readerPool = pool;
+        self.readerSemaphore = dispatch_semaphore_create(VNAMaximumReaderConnections);
+    } else {
+        os_log_info(VNA_LOG, "Write-ahead logging is not available (journal mode: %{public}@)", journalMode);
+        self.readerPool = nil;
+    }
+}
+
+/* inReaderDatabase
+ * Runs a block that only reads from the database on one of the read-only
+ * connections, or on the database queue if there are none. The block must
+ * not write to the database.
+ */
+-(void)inReaderDatabase:(void (^)(FMDatabase *db))block
+{
+    FMDatabasePool * pool = self.readerPool;
+    if (pool) {
+        VNADatabaseInstrumentation * instrumentation = self.instrumentation;
+        uint64_t requestTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+        // The pool hands out nil once all of its connections are in use, so
+        // wait for one to be returned instead.
+        dispatch_semaphore_wait(self.readerSemaphore, DISPATCH_TIME_FOREVER);
+        if (instrumentation != nil) {
+            [pool inDatabase:^(FMDatabase *db) {
+                [instrumentation recordBlockRequestedAt:requestTime usingBlock:^{
+                    block(db);
+                }];
+            }];
+        } else {
+            [pool inDatabase:block];
+        }
+        dispatch_semaphore_signal(self.readerSemaphore);
+    } else {
+        [self.databaseQueue inDatabase:block];
+    }
+}
+
 /* compactDatabase
- * Compact the database using the vacuum command.
+ * Compact the database using the vacuum command. This also enables
+ * incremental auto-vacuum on databases that were created without it.
  */
 -(void)compactDatabase
 {
     if (!self.readOnly) {
         [self.databaseQueue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"VACUUM"];
+            [db executeStatements:@"PRAGMA auto_vacuum = INCREMENTAL; VACUUM"];
+        }];
+    }
+}
+
+/* isFullTextSearchAvailable
+ * Returns whether the full-text index of the articles, its content view and
+ * its triggers exist. Older SQLite libraries might lack the FTS5 extension.
+ */
+-(BOOL)isFullTextSearchAvailable
+{
+    if (self.fullTextSearchAvailability == nil) {
+        __block BOOL available = NO;
+        [self.databaseQueue inDatabase:^(FMDatabase *db) {
+            FMResultSet *results = [db executeQuery:@"SELECT COUNT(*) FROM sqlite_master WHERE name IN "
+                                                     "('messages_fts', 'messages_search', 'messages_fts_insert', 'messages_fts_delete', "
+                                                     "'messages_fts_update_title', 'messages_fts_update_body')"];
+            if ([results next]) {
+                available = [results intForColumnIndex:0] == 6;
+            }
+            [results close];
         }];
+        self.fullTextSearchAvailability = @(available);
+    }
+    return self.fullTextSearchAvailability.boolValue;
+}
+
+/* fullTextQueryForString
+ * Converts a search string into an FTS5 query that matches the string as a
+ * phrase whose last word may be incomplete, e.g. "apple pi" matches
+ * "Apple pie". If column is not nil, the query is restricted to that column.
+ * Returns nil if the string is blank, or if one of its words starts or ends
+ * with punctuation or symbols, e.g. "c++" or "!!!". The index drops those,
+ * so the query would match other words, or nothing at all, and the caller
+ * should fall back to a pattern search.
+ */
+-(NSString *)fullTextQueryForString:(NSString *)string column:(NSString *)column
+{
+    NSString *trimmedString = string.vna_trimmed;
+    if (trimmedString.length == 0) {
+        return nil;
+    }
+    NSCharacterSet *alphanumerics = NSCharacterSet.alphanumericCharacterSet;
+    for (NSString *word in [trimmedString componentsSeparatedByCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet]) {
+        if (word.length == 0) {
+            continue;
+        }
+        if (![alphanumerics characterIsMember:[word characterAtIndex:0]] ||
+            ![alphanumerics characterIsMember:[word characterAtIndex:word.length - 1]]) {
+            return nil;
+        }
+    }
+    NSString *phrase = [trimmedString stringByReplacingOccurrencesOfString:@"\""
+                                                                withString:@"\"\""];
+    if (column) {
+        return [NSString stringWithFormat:@"%@ : \"%@\"*", column, phrase];
+    } else {
+        return [NSString stringWithFormat:@"\"%@\"*", phrase];
+    }
+}
+
+/* sqlFullTextScopeForString
+ * Create a SQL 'where' clause that scopes to the articles whose title and
+ * text, or only the specified column, contain or do not contain the string.
+ * Returns nil if the full-text index is not available or the string is blank.
+ */
+-(NSString *)sqlFullTextScopeForString:(NSString *)string column:(NSString *)column flags:(VNAQueryScope)scopeFlags
+{
+    if (!self.fullTextSearchAvailable) {
+        return nil;
     }
+    NSString *query = [self fullTextQueryForString:string column:column];
+    if (!query) {
+        return nil;
+    }
+    NSString *operatorString = (scopeFlags & VNAQueryScopeInclusive) ? @"IN" : @"NOT IN";
+    NSString *escapedQuery = [query stringByReplacingOccurrencesOfString:@"'" withString:@"''"];
+    return [NSString stringWithFormat:@"rowid %@ (SELECT rowid FROM messages_fts WHERE messages_fts MATCH '%@')",
+            operatorString, escapedQuery];
 }
 
 /* reindexDatabase
@@ -631,17 +1172,132 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 }
 
 /* optimizeDatabase
- * Optimize the database before closing
+ * Optimize the database before closing, or while the application is idle.
+ * Tables are only analyzed if their statistics are out of date, and only a
+ * sample of their rows if the SQLite library supports the analysis limit.
  */
 -(void)optimizeDatabase
 {
     if (!self.readOnly) {
         [self.databaseQueue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"PRAGMA optimize"];
+            [db executeStatements:[NSString stringWithFormat:@"PRAGMA analysis_limit = %ld; PRAGMA optimize",
+                                   (long)VNAAnalysisLimit]];
         }];
     }
 }
 
+/* storageStatistics
+ * Returns the size of the pages of the database file, the number of pages and
+ * the number of free pages, which incremental vacuum can return to the file
+ * system.
+ */
+-(VNADatabaseStorageStatistics)storageStatistics
+{
+    __block VNADatabaseStorageStatistics statistics = {0, 0, 0};
+    [self inReaderDatabase:^(FMDatabase *db) {
+        statistics.pageSize = [db longForQuery:@"PRAGMA page_size"];
+        statistics.pageCount = [db longForQuery:@"PRAGMA page_count"];
+        statistics.freePageCount = [db longForQuery:@"PRAGMA freelist_count"];
+    }];
+    return statistics;
+}
+
+/* isIncrementalVacuumEnabled
+ * Returns whether free pages stay in the database file until they are
+ * released with -incrementalVacuum:.
+ */
+-(BOOL)isIncrementalVacuumEnabled
+{
+    __block BOOL enabled = NO;
+    [self inReaderDatabase:^(FMDatabase *db) {
+        enabled = [db longForQuery:@"PRAGMA auto_vacuum"] == 2;
+    }];
+    return enabled;
+}
+
+/* incrementalVacuum
+ * Returns at most pageCount free pages to the file system. Returns the number
+ * of free pages that remain, or -1 if the pages could not be released.
+ */
+-(NSInteger)incrementalVacuum:(NSInteger)pageCount
+{
+    if (self.readOnly) {
+        return -1;
+    }
+    __block NSInteger freePageCount = -1;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        // The pragma must be stepped to completion, which executeUpdate
+        // does not do.
+        NSString * statement = [NSString stringWithFormat:@"PRAGMA incremental_vacuum(%ld)", (long)pageCount];
+        if ([db executeStatements:statement]) {
+            freePageCount = [db longForQuery:@"PRAGMA freelist_count"];
+        } else {
+            NSLog(@"%s: failed to release free pages: %@", __FUNCTION__, db.lastErrorMessage);
+        }
+    }];
+    return freePageCount;
+}
+
+/* tablesWithoutStatistics
+ * Returns the tables that have never been analyzed, e.g. because they were
+ * created by a migration. The query planner then has to guess how selective
+ * their indexes are.
+ */
+-(NSArray<NSString *> *)tablesWithoutStatistics
+{
+    NSMutableArray<NSString *> * tables = [NSMutableArray array];
+    [self inReaderDatabase:^(FMDatabase *db) {
+        NSString * query = @"SELECT name FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%' "
+                           @"AND sql NOT LIKE 'CREATE VIRTUAL TABLE%'";
+        if ([db tableExists:@"sqlite_stat1"]) {
+            query = [query stringByAppendingString:@" AND name NOT IN (SELECT tbl FROM sqlite_stat1)"];
+        }
+        FMResultSet * results = [db executeQuery:query];
+        while ([results next]) {
+            [tables addObject:[results stringForColumnIndex:0]];
+        }
+        [results close];
+    }];
+    return [tables copy];
+}
+
+/* analyzeTable
+ * Gathers the statistics of the indexes of a table for the query planner.
+ */
+-(BOOL)analyzeTable:(NSString *)tableName
+{
+    if (self.readOnly) {
+        return NO;
+    }
+    __block BOOL success = NO;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        NSString * escapedName = [tableName stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""];
+        success = [db executeStatements:[NSString stringWithFormat:@"PRAGMA analysis_limit = %ld; ANALYZE \"%@\"",
+                                         (long)VNAAnalysisLimit, escapedName]];
+    }];
+    return success;
+}
+
+/* path
+ * Returns the path of the database file.
+ */
+-(NSString *)path
+{
+    return self.databaseQueue.path;
+}
+
+/* inWriterConnection
+ * Runs a block with the SQLite handle of the writer connection on the queue
+ * of the database, for the functions of SQLite that FMDB does not wrap, such
+ * as the online backup.
+ */
+-(void)inWriterConnection:(void (^)(struct sqlite3 *connection))block
+{
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        block(db.sqliteHandle);
+    }];
+}
+
 /**
  *  Clears a specified flag for the specified folder
  *
@@ -746,41 +1402,128 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 }
 
 /**
- *  Change the URL of the feed on the specified RSS folder subscription.
+ *  Sets the entity tag for the folder.
  *
- *  @param feed_url the URL to set the folder's feed to
- *  @param folderId the ID of the folder whose URL we are changing
- *
- *  @return YES on success
+ *  @param entityTag The new entity tag
+ *  @param folderId  The ID of the folder being updated
  */
--(BOOL)setFeedURL:(NSString *)feed_url forFolder:(NSInteger)folderId
+-(void)setEntityTag:(NSString *)entityTag forFolder:(NSInteger)folderId
 {
 	// Exit now if we're read-only
     if (self.readOnly) {
-		return NO;
+		return;
     }
-	
+	// If no change to entity tag, do nothing
 	Folder * folder = [self folderFromID:folderId];
-	if (folder != nil && ![folder.feedURL isEqualToString:feed_url]) {
-		folder.feedURL = feed_url;
+	if (folder != nil && folder.type == VNAFolderTypeRSS) {
+		if ([folder.entityTag isEqualToString:entityTag]) {
+			return;
+		}
+
+		folder.entityTag = entityTag;
         FMDatabaseQueue *queue = self.databaseQueue;
         [queue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"UPDATE rss_folders SET feed_url=? WHERE folder_id=?", feed_url, @(folderId)];
-            [[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folderId)];
+            [db executeUpdate:@"UPDATE rss_folders SET etag=? WHERE folder_id=?",
+             folder.entityTag, @(folderId)];
         }];
 	}
-	return YES;
 }
 
 /**
- *  Sets the identifier of the feed to a value which is returned by the OpenReader server.
- *  Identifiers format vary with servers :
- *  - most common form is URL-based :                         feed/https://www.lemonde.fr/rss/une.xml
- *  - TheOldReader identifiers are based on hex data :        feed/5bdadad8c70bc2e3ae000e3a
- *  - FreshRSS ones are based on decimal sequences per user : feed/16
- *
- *  @param remoteId the identifier to set the folder's feed to
- *  @param folderId the ID of the folder whose remote identifier we are setting
+ *  Sets the size of the last download of the folder.
+ *
+ *  @param contentSize The size of the feed data in bytes
+ *  @param folderId    The ID of the folder being updated
+ */
+-(void)setContentSize:(unsigned long long)contentSize forFolder:(NSInteger)folderId
+{
+	// Exit now if we're read-only
+    if (self.readOnly) {
+		return;
+    }
+	// If no change to the size, do nothing
+	Folder * folder = [self folderFromID:folderId];
+	if (folder != nil && folder.type == VNAFolderTypeRSS) {
+		if (folder.contentSize == contentSize) {
+			return;
+		}
+
+		folder.contentSize = contentSize;
+        FMDatabaseQueue *queue = self.databaseQueue;
+        [queue inDatabase:^(FMDatabase *db) {
+            [db executeUpdate:@"UPDATE rss_folders SET content_size=? WHERE folder_id=?",
+             @(folder.contentSize), @(folderId)];
+        }];
+	}
+}
+
+/**
+ *  Returns the average interval between the articles that a feed published
+ *  in the last 30 days, measured between the first and the last of them.
+ *  A feed that published a single article in that time returns the whole
+ *  period, as does a feed that published nothing.
+ *
+ *  @param folderId The ID of the feed
+ *
+ *  @return The average publication interval in seconds
+ */
+-(NSTimeInterval)publicationIntervalOfFolder:(NSInteger)folderId
+{
+    NSTimeInterval period = 30 * 24 * 60 * 60;
+    NSTimeInterval now = [NSDate date].timeIntervalSince1970;
+    __block NSTimeInterval interval = period;
+    [self inReaderDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:@"SELECT COUNT(*), MIN(date), MAX(date) FROM messages WHERE folder_id=? AND date>? AND date<=?",
+                                @(folderId), @(now - period), @(now)];
+        if ([results next]) {
+            int count = [results intForColumnIndex:0];
+            if (count > 1) {
+                interval = ([results doubleForColumnIndex:2] - [results doubleForColumnIndex:1]) / (count - 1);
+            }
+        }
+        [results close];
+    }];
+    return interval;
+}
+
+/**
+ *  Change the URL of the feed on the specified RSS folder subscription.
+ *
+ *  @param feed_url the URL to set the folder's feed to
+ *  @param folderId the ID of the folder whose URL we are changing
+ *
+ *  @return YES on success
+ */
+-(BOOL)setFeedURL:(NSString *)feed_url forFolder:(NSInteger)folderId
+{
+	// Exit now if we're read-only
+    if (self.readOnly) {
+		return NO;
+    }
+	
+	Folder * folder = [self folderFromID:folderId];
+	if (folder != nil && ![folder.feedURL isEqualToString:feed_url]) {
+		VNARemoveFolderFromIndex(self.foldersByFeedURL, folder.feedURL, folder);
+		folder.feedURL = feed_url;
+		VNAAddFolderToIndex(self.foldersByFeedURL, feed_url, folder);
+        FMDatabaseQueue *queue = self.databaseQueue;
+        [queue inDatabase:^(FMDatabase *db) {
+            [db executeUpdate:@"UPDATE rss_folders SET feed_url=? WHERE folder_id=?", feed_url, @(folderId)];
+            [[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folderId)];
+        }];
+	}
+	return YES;
+}
+
+/**
+ *  Sets the identifier of the feed to a value which is returned by the OpenReader server.
+ *  Identifiers format vary with servers :
+ *  - most common form is URL-based :                         feed/https://www.lemonde.fr/rss/une.xml
+ *  - TheOldReader identifiers are based on hex data :        feed/5bdadad8c70bc2e3ae000e3a
+ *  - FreshRSS ones are based on decimal sequences per user : feed/16
+ *
+ *  @param remoteId the identifier to set the folder's feed to
+ *  @param folderId the ID of the folder whose remote identifier we are setting
  *
  *  @return YES on success
  */
@@ -793,7 +1536,9 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 
 	Folder * folder = [self folderFromID:folderId];
 	if (folder != nil && ![folder.remoteId isEqualToString:remoteId]) {
+		VNARemoveFolderFromIndex(self.foldersByRemoteId, folder.remoteId, folder);
 		folder.remoteId = remoteId;
+		VNAAddFolderToIndex(self.foldersByRemoteId, remoteId, folder);
         FMDatabaseQueue *queue = self.databaseQueue;
         [queue inDatabase:^(FMDatabase *db) {
             [db executeUpdate:@"UPDATE rss_folders SET bloglines_id=? WHERE folder_id=?", remoteId, @(folderId)];
@@ -841,6 +1586,8 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         folder.feedDescription = feedName;
         folder.feedURL = feed_url;
         folder.remoteId = remoteId;
+        VNAAddFolderToIndex(self.foldersByFeedURL, feed_url, folder);
+        VNAAddFolderToIndex(self.foldersByRemoteId, remoteId, folder);
     }
     return folderId;
 } /* addOpenReaderFolder */
@@ -875,6 +1622,7 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		// Add this new folder to our internal cache
 		Folder * folder = [self folderFromID:folderId];
 		folder.feedURL = feed_url;
+		VNAAddFolderToIndex(self.foldersByFeedURL, feed_url, folder);
 	}
 	return folderId;
 }
@@ -959,7 +1707,7 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		if ((type == VNAFolderTypeRSS)||(type == VNAFolderTypeOpenReader)) {
 			[folder setFlag:VNAFolderFlagCheckForImage];
 		}
-		self.foldersDict[@(newItemId)] = folder;
+		[self addFolderToCache:folder];
 		
 		if (manualSort) {
 			if (nextSibling > 0) {
@@ -1119,7 +1867,7 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 	// Remove from the folders array. Do this after we send the notification
 	// so that the notification handlers don't fail if they try to dereference the
 	// folder.
-	[self.foldersDict removeObjectForKey:@(folderId)];
+	[self removeFolderFromCache:folder];
 	return YES;
 }
 
@@ -1197,7 +1945,9 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		return NO;
     }
 
+	VNARemoveFolderFromIndex(self.foldersByName, folder.name, folder);
 	folder.name = newName;
+	VNAAddFolderToIndex(self.foldersByName, newName, folder);
 
 	// Rename in the database
     FMDatabaseQueue *queue = self.databaseQueue;
@@ -1374,7 +2124,9 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 	}
 	
 	// Do the re-parent
+    VNARemoveFolderFromIndex(self.foldersByParentId, @(folder.parentId), folder);
     folder.parentId = newParentID;
+    VNAAddFolderToIndex(self.foldersByParentId, @(newParentID), folder);
 	
 	// In addition to reparenting the child, we also need to fix up the unread count for all
 	// precedent parents.
@@ -1521,37 +2273,53 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
  */
 -(Folder *)folderFromName:(NSString *)wantedName
 {
-	Folder * folder;
-	for (folder in [self.foldersDict objectEnumerator]) {
-		if ([folder.name isEqualToString:wantedName]) {
-			break;
-		}
-	}
-	return folder;
+	return self.foldersByName[wantedName].firstObject;
 }
 
 -(Folder *)folderFromFeedURL:(NSString *)wantedFeedURL
 {
-	Folder * folder;
-	
-	for (folder in [self.foldersDict objectEnumerator]) {
-		if ([folder.feedURL isEqualToString:wantedFeedURL]) {
-			break;
-		}
-	}
-	return folder;
+	return self.foldersByFeedURL[wantedFeedURL].firstObject;
 }
 
 -(Folder *)folderFromRemoteId:(NSString *)wantedRemoteId
 {
-	Folder * folder;
+	return self.foldersByRemoteId[wantedRemoteId].firstObject;
+}
 
-	for (folder in [self.foldersDict objectEnumerator]) {
-		if ([folder.remoteId isEqualToString:wantedRemoteId]) {
-			break;
-		}
-	}
-	return folder;
+/* addFolderToCache
+ * Adds a folder to the folders array and to its indexes.
+ */
+-(void)addFolderToCache:(Folder *)folder
+{
+	self.foldersDict[@(folder.itemId)] = folder;
+	VNAAddFolderToIndex(self.foldersByName, folder.name, folder);
+	VNAAddFolderToIndex(self.foldersByFeedURL, folder.feedURL, folder);
+	VNAAddFolderToIndex(self.foldersByRemoteId, folder.remoteId, folder);
+	VNAAddFolderToIndex(self.foldersByParentId, @(folder.parentId), folder);
+}
+
+/* removeFolderFromCache
+ * Removes a folder from the folders array and from its indexes.
+ */
+-(void)removeFolderFromCache:(Folder *)folder
+{
+	[self.foldersDict removeObjectForKey:@(folder.itemId)];
+	VNARemoveFolderFromIndex(self.foldersByName, folder.name, folder);
+	VNARemoveFolderFromIndex(self.foldersByFeedURL, folder.feedURL, folder);
+	VNARemoveFolderFromIndex(self.foldersByRemoteId, folder.remoteId, folder);
+	VNARemoveFolderFromIndex(self.foldersByParentId, @(folder.parentId), folder);
+}
+
+/* removeAllFoldersFromCache
+ * Empties the folders array and its indexes.
+ */
+-(void)removeAllFoldersFromCache
+{
+	[self.foldersDict removeAllObjects];
+	[self.foldersByName removeAllObjects];
+	[self.foldersByFeedURL removeAllObjects];
+	[self.foldersByRemoteId removeAllObjects];
+	[self.foldersByParentId removeAllObjects];
 }
 
 - (Folder *)folderForPredicateFormat:(NSString *)predicateFormat
@@ -1591,13 +2359,49 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
  */
 -(BOOL)addArticle:(Article *)article toFolder:(NSInteger)folderID
 {
-    FMDatabaseQueue *queue = self.databaseQueue;
+    return [self addArticles:@[article] toFolder:folderID].count > 0;
+}
+
+/* addArticles
+ * Adds articles in the specified folder within a single transaction.
+ * Returns the indexes of the articles that were added. An article that
+ * could not be added does not prevent the others from being added.
+ */
+-(NSIndexSet *)addArticles:(NSArray<Article *> *)articles toFolder:(NSInteger)folderID
+{
+    NSMutableIndexSet * addedIndexes = [NSMutableIndexSet indexSet];
 
     // Exit now if we're read-only
-	if (self.readOnly) {
-		return NO;
+	if (self.readOnly || articles.count == 0) {
+		return addedIndexes;
 	}
 
+    [self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        // Reuse the prepared INSERT statements for every article. The writer
+        // only keeps them for this batch: its statement cache is unbounded,
+        // and it runs SQL that embeds lists of articles.
+        db.shouldCacheStatements = YES;
+        [articles enumerateObjectsUsingBlock:^(Article *article, NSUInteger index, BOOL *stop) {
+            [db startSavePointWithName:@"article" error:nil];
+            if ([self insertArticle:article inFolder:folderID database:db]) {
+                [addedIndexes addIndex:index];
+            } else {
+                [db rollbackToSavePointWithName:@"article" error:nil];
+            }
+            [db releaseSavePointWithName:@"article" error:nil];
+        }];
+        db.shouldCacheStatements = NO;
+    }];
+    [self applyFolderCountChanges];
+	return [addedIndexes copy];
+}
+
+/* insertArticle
+ * Inserts an article in the messages and the rss_guids tables and stores
+ * its compressed body. This must be called within a transaction.
+ */
+-(BOOL)insertArticle:(Article *)article inFolder:(NSInteger)folderID database:(FMDatabase *)db
+{
     // Extract the article data from the dictionary.
     NSString * articleBody = article.body;
     NSString * articleTitle = article.title;
@@ -1645,40 +2449,44 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         articleTitle = [NSString vna_stringByRemovingHTML:articleBody].vna_firstNonBlankLine;
     }
 
-    __block BOOL success;
-    [queue inTransaction:^(FMDatabase *db,  BOOL *rollback) {
-        success = [db executeUpdate:@"INSERT INTO messages (message_id, parent_id, folder_id, sender, link, date, createddate, read_flag, marked_flag, deleted_flag, title, text, revised_flag, enclosure, hasenclosure_flag) "
-         @"VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
-         articleGuid,
-         @(parentId),
-         @(folderID),
-         userName,
-         articleLink,
-         @(lastUpdateIntervalSince1970),
-         @(publicationIntervalSince1970),
-         @(read_flag),
-         @(marked_flag),
-         @(deleted_flag),
-         articleTitle,
-         articleBody,
-         @(revised_flag),
-         articleEnclosure,
-         @(hasenclosure_flag)];
-        if (!success) {
-            NSLog(@"error = %@", [db lastErrorMessage]);
-            *rollback = YES;
-            return;
-         }
-        
-        success = [db executeUpdate:@"INSERT INTO rss_guids (message_id, folder_id) VALUES (?, ?)", articleGuid, @(folderID)];
-        if (!success) {
-            NSLog(@"error = %@", [db lastErrorMessage]);
-            *rollback = YES;
-            return;
-        }
+    BOOL success = [db executeUpdate:@"INSERT INTO messages (message_id, parent_id, folder_id, sender, link, date, createddate, read_flag, marked_flag, deleted_flag, title, revised_flag, enclosure, hasenclosure_flag) "
+     @"VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+     articleGuid,
+     @(parentId),
+     @(folderID),
+     userName,
+     articleLink,
+     @(lastUpdateIntervalSince1970),
+     @(publicationIntervalSince1970),
+     @(read_flag),
+     @(marked_flag),
+     @(deleted_flag),
+     articleTitle,
+     @(revised_flag),
+     articleEnclosure,
+     @(hasenclosure_flag)];
+    if (!success) {
+        NSLog(@"error = %@", [db lastErrorMessage]);
+        return NO;
+    }
 
-    }];
-	return (success);
+    // The body is always stored, even if it is empty, because inserting it
+    // adds the article to the full-text index.
+    NSData * compressedBody = articleBody ? [NSData vna_compressedDataWithString:articleBody] : nil;
+    success = [db executeUpdate:@"INSERT INTO message_bodies (id, body) VALUES (?, ?)",
+               @(db.lastInsertRowId), compressedBody ?: [NSNull null]];
+    if (!success) {
+        NSLog(@"error = %@", [db lastErrorMessage]);
+        return NO;
+    }
+
+    success = [db executeUpdate:@"INSERT INTO rss_guids (message_id, folder_id, last_seen) VALUES (?, ?, ?)",
+               articleGuid, @(folderID), @(currentDate.timeIntervalSince1970)];
+    if (!success) {
+        NSLog(@"error = %@", [db lastErrorMessage]);
+        return NO;
+    }
+	return YES;
 }
 
 /* updateArticle
@@ -1688,13 +2496,46 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
  */
 -(BOOL)updateArticle:(Article *)existingArticle ofFolder:(NSInteger)folderID withArticle:(Article *)articleUpdate
 {
+    return [self updateArticles:@[existingArticle] ofFolder:folderID withArticles:@[articleUpdate]].count > 0;
+}
+
+/* updateArticles
+ * Updates articles in the specified folder within a single transaction.
+ * Each of the existing articles is updated with the article at the same
+ * index of articleUpdates. Returns the indexes of the articles that were
+ * updated.
+ */
+-(NSIndexSet *)updateArticles:(NSArray<Article *> *)existingArticles ofFolder:(NSInteger)folderID withArticles:(NSArray<Article *> *)articleUpdates
+{
+    NSAssert(existingArticles.count == articleUpdates.count, @"Every existing article needs an update");
+    NSMutableIndexSet * updatedIndexes = [NSMutableIndexSet indexSet];
+
     // Exit now if we're read-only
-	if (self.readOnly) {
-		return NO;
+	if (self.readOnly || existingArticles.count == 0) {
+		return updatedIndexes;
 	}
 
-	FMDatabaseQueue *queue = self.databaseQueue;
+    [self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        // As when adding articles, the UPDATE statements are prepared once
+        // for the batch and released with it.
+        db.shouldCacheStatements = YES;
+        [existingArticles enumerateObjectsUsingBlock:^(Article *existingArticle, NSUInteger index, BOOL *stop) {
+            if ([self updateArticle:existingArticle ofFolder:folderID withArticle:articleUpdates[index] database:db]) {
+                [updatedIndexes addIndex:index];
+            }
+        }];
+        db.shouldCacheStatements = NO;
+    }];
+    [self applyFolderCountChanges];
+	return [updatedIndexes copy];
+}
 
+/* updateArticle
+ * Writes the update of an article to the messages table if the article
+ * was revised. This must be called within a transaction.
+ */
+-(BOOL)updateArticle:(Article *)existingArticle ofFolder:(NSInteger)folderID withArticle:(Article *)articleUpdate database:(FMDatabase *)db
+{
     // Extract the data from the new state of article
     NSString * articleBody = articleUpdate.body;
     NSString * articleTitle = articleUpdate.title;
@@ -1721,26 +2562,25 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 
     NSString * existingTitle = existingArticle.title;
     BOOL isArticleRevised = ![existingTitle isEqualToString:articleTitle];
-    __block NSString * existingBody = existingArticle.body;
-    __block NSString * existingEnclosure = existingArticle.enclosure;
-    __block NSDate * existingLastUpdate;
+    NSString * existingBody = existingArticle.body;
+    NSString * existingEnclosure = existingArticle.enclosure;
+    NSDate * existingLastUpdate;
     if (!isArticleRevised) {
         // the article text may not have been loaded yet, for instance if the folder is not displayed
         if (existingBody == nil) {
-            [queue inDatabase:^(FMDatabase *db) {
-                FMResultSet * results = [db executeQuery:@"SELECT date, text, enclosure FROM messages WHERE folder_id=? AND message_id=?",
-                                         @(folderID), articleGuid];
-                if ([results next]) {
-                        existingLastUpdate = [NSDate dateWithTimeIntervalSince1970:[results stringForColumnIndex:0].doubleValue];
-                        existingBody = [results stringForColumnIndex:1];
-                        existingEnclosure = [results stringForColumnIndex:2];
-                } else {  // should never occur; set sensible fallbacks anyway
-                        existingLastUpdate = articleUpdate.publicationDate;
-                        existingBody = @"";
-                        existingEnclosure = @"";
-                }
-                [results close];
-            }];
+            FMResultSet * results = [db executeQuery:@"SELECT date, (SELECT body FROM message_bodies WHERE message_bodies.id = messages.id), enclosure "
+                                     @"FROM messages WHERE folder_id=? AND message_id=?",
+                                     @(folderID), articleGuid];
+            if ([results next]) {
+                    existingLastUpdate = [NSDate dateWithTimeIntervalSince1970:[results doubleForColumnIndex:0]];
+                    existingBody = [results dataForColumnIndex:1].vna_decompressedString;
+                    existingEnclosure = [results stringForColumnIndex:2];
+            } else {  // should never occur; set sensible fallbacks anyway
+                    existingLastUpdate = articleUpdate.publicationDate;
+                    existingBody = @"";
+                    existingEnclosure = @"";
+            }
+            [results close];
         }
         isArticleRevised = ![existingBody isEqualToString:articleBody]
                            || (articleEnclosure != nil && ![existingEnclosure isEqualToString:articleEnclosure]);
@@ -1770,25 +2610,28 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         }
 
         // Note: we never change the publication date
-        __block BOOL success;
-        [queue inDatabase:^(FMDatabase *db) {
-            success = [db executeUpdate:@"UPDATE messages SET parent_id=?, sender=?, link=?, date=?, "
-             @"read_flag=0, title=?, text=?, revised_flag=?, enclosure=?, hasenclosure_flag=? "
-             @"WHERE folder_id=? AND message_id=?",
-             @(parentId),
-             userName,
-             articleLink,
-             @(lastUpdateIntervalSince1970),
-             articleTitle,
-             articleBody,
-             @(revised_flag),
-             articleEnclosure,
-             @(hasenclosure_flag),
-             @(folderID),
-             articleGuid];
+        BOOL success = [db executeUpdate:@"UPDATE messages SET parent_id=?, sender=?, link=?, date=?, "
+         @"read_flag=0, title=?, revised_flag=?, enclosure=?, hasenclosure_flag=? "
+         @"WHERE folder_id=? AND message_id=?",
+         @(parentId),
+         userName,
+         articleLink,
+         @(lastUpdateIntervalSince1970),
+         articleTitle,
+         @(revised_flag),
+         articleEnclosure,
+         @(hasenclosure_flag),
+         @(folderID),
+         articleGuid];
+        if (success) {
+            NSData * compressedBody = articleBody ? [NSData vna_compressedDataWithString:articleBody] : nil;
+            success = [db executeUpdate:@"UPDATE message_bodies SET body=? "
+                       @"WHERE id=(SELECT id FROM messages WHERE folder_id=? AND message_id=?)",
+                       compressedBody ?: [NSNull null],
+                       @(folderID),
+                       articleGuid];
+        }
 
-        }];
-        
         if (!success) {
             return NO;
         } else {
@@ -1810,49 +2653,127 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 }
 
 /* purgeArticlesOlderThanTag
- * Deletes all non-flagged articles from the messages list that are older than the 
- * specification. Cf. comments about autoExpireDuration in Preferences.m :
+ * Moves to the trash the read and non-flagged articles that are older than
+ * the specification, unless their folder has a retention policy of its own.
+ * Cf. comments about autoExpireDuration in Preferences.m :
  *   A zero value disables auto-expire.
  *   Increments of 1000 specify months, so 1000 = 1 month, 1001 = 1 month and 1 day
  */
 -(void)purgeArticlesOlderThanTag:(NSUInteger)tag
 {
-    if (tag > 0) {
-        NSUInteger months = tag / 1000;
-        NSUInteger days = tag%1000;
-        NSDate *date = [[NSCalendar currentCalendar] dateByAddingUnit:NSCalendarUnitMonth
-                                                                value:-months
-                                                               toDate:[NSDate date]
-                                                              options:0];
-        date = [[NSCalendar currentCalendar] dateByAddingUnit:NSCalendarUnitDay
-                                                        value:-days
-                                                        toDate:date
-                                                        options:0];
-        NSTimeInterval timeDiff = date.timeIntervalSince1970;
-
-        [self.databaseQueue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"UPDATE messages SET deleted_flag=1 WHERE deleted_flag=0 AND marked_flag=0 AND read_flag=1 AND date < ?", @(timeDiff)];
-        }];
-    }
+    VNARetentionPolicy *policy = [[VNARetentionPolicy alloc] initWithMaximumAge:tag
+                                                                   maximumCount:0
+                                                             guidHistoryHorizon:0];
+    VNARetentionEngine *engine = [[VNARetentionEngine alloc] initWithDatabase:self
+                                                                defaultPolicy:policy];
+    [engine expireArticles];
 }
 
 /* purgeDeletedArticles
- * Remove from the database all articles which have the deleted_flag field set to YES. This
- * also requires that we remove the same articles from all folder caches.
+ * Remove from the database all articles which have the deleted_flag field set to YES,
+ * in batches, and empty the caches of the folders that they belonged to.
  */
 -(void)purgeDeletedArticles
 {
-    __block BOOL success;
-	[self.databaseQueue inDatabase:^(FMDatabase *db) {
-		success = [db executeUpdate:@"DELETE FROM messages WHERE deleted_flag=1"];
-	}];
+    VNARetentionEngine *engine = [[VNARetentionEngine alloc] initWithDatabase:self
+                                                                defaultPolicy:VNARetentionPolicy.unlimitedPolicy];
+    [engine purgeDeletedArticles];
+}
 
-	if (success) {
-		for (Folder * folder in [self.foldersDict objectEnumerator])
-			[folder clearCache];
+/* expireArticlesOfFolder
+ * Moves to the trash the read and non-flagged articles of the folder that
+ * are older than the date or than the oldest of the most recent articles to
+ * keep, at most limit articles.
+ */
+-(NSInteger)expireArticlesOfFolder:(NSInteger)folderId
+                        beforeDate:(NSDate *)date
+                     keepingNewest:(NSUInteger)count
+                             limit:(NSUInteger)limit
+{
+    if (date == nil && count == 0) {
+        return 0;
+    }
 
-		[[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(self.trashFolderId)];
-	}
+    __block NSInteger countOfExpired = 0;
+    [self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        NSTimeInterval cutoff = date.timeIntervalSince1970;
+        if (count > 0) {
+            FMResultSet *results = [db executeQuery:@"SELECT date FROM messages WHERE folder_id=? AND deleted_flag=0 "
+                                                     "ORDER BY date DESC LIMIT 1 OFFSET ?",
+                                                    @(folderId), @(count - 1)];
+            if ([results next]) {
+                cutoff = MAX(cutoff, [results doubleForColumnIndex:0]);
+            }
+            [results close];
+        }
+
+        BOOL success = [db executeUpdate:@"UPDATE messages SET deleted_flag=1 WHERE id IN "
+                                          "(SELECT id FROM messages WHERE folder_id=? AND deleted_flag=0 "
+                                          "AND marked_flag=0 AND read_flag=1 AND date < ? LIMIT ?)",
+                                         @(folderId), @(cutoff), @(limit)];
+        if (!success) {
+            NSLog(@"error = %@", db.lastErrorMessage);
+            countOfExpired = -1;
+            *rollback = YES;
+            return;
+        }
+        countOfExpired = db.changes;
+    }];
+
+    if (countOfExpired > 0) {
+        [self applyFolderCountChanges];
+    }
+    return countOfExpired;
+}
+
+/* countOfDeletedArticles
+ * Returns the number of articles in the trash.
+ */
+-(NSInteger)countOfDeletedArticles
+{
+    __block NSInteger count = 0;
+    [self inReaderDatabase:^(FMDatabase *db) {
+        count = [db longForQuery:@"SELECT COUNT(*) FROM messages WHERE deleted_flag=1"];
+    }];
+    return count;
+}
+
+/* purgeDeletedArticlesWithLimit
+ * Deletes at most limit articles from the trash and adds their folders to
+ * folderIds. Both statements visit the articles in the order of the index
+ * on deleted_flag and folder_id, so they see the same articles.
+ */
+-(NSInteger)purgeDeletedArticlesWithLimit:(NSUInteger)limit
+                                folderIds:(NSMutableIndexSet *)folderIds
+{
+    __block NSInteger countOfPurged = 0;
+    [self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        FMResultSet *results = [db executeQuery:@"SELECT DISTINCT folder_id FROM "
+                                                 "(SELECT folder_id FROM messages WHERE deleted_flag=1 "
+                                                 "ORDER BY folder_id, id LIMIT ?)",
+                                                @(limit)];
+        while ([results next]) {
+            [folderIds addIndex:(NSUInteger)[results longForColumnIndex:0]];
+        }
+        [results close];
+
+        BOOL success = [db executeUpdate:@"DELETE FROM messages WHERE id IN "
+                                          "(SELECT id FROM messages WHERE deleted_flag=1 "
+                                          "ORDER BY folder_id, id LIMIT ?)",
+                                         @(limit)];
+        if (!success) {
+            NSLog(@"error = %@", db.lastErrorMessage);
+            countOfPurged = -1;
+            *rollback = YES;
+            return;
+        }
+        countOfPurged = db.changes;
+    }];
+
+    if (countOfPurged > 0) {
+        [self applyFolderCountChanges];
+    }
+    return countOfPurged;
 }
 
 /* deleteArticle
@@ -1872,9 +2793,7 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         }];
 
         if (success) {
-            if (!article.isRead) {
-                [self setFolderUnreadCount:folder adjustment:-1];
-            }
+            [self applyFolderCountChanges];
             if (folder.countOfCachedArticles > 0) {
                 [folder removeArticleFromCache:guid];
             }
@@ -1888,6 +2807,8 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 {
     if (!_smartfoldersDict) {
         _smartfoldersDict = [[NSMutableDictionary alloc] init];
+        _smartFolderMemberSQL = [[NSMutableDictionary alloc] init];
+        _smartFolderCandidateSQL = [[NSMutableDictionary alloc] init];
 
         // Preload all the smart folders into the dictionary.
         FMDatabaseQueue *queue = self.databaseQueue;
@@ -1895,13 +2816,14 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		NSAssert(queue, @"Database queue not assigned for this item");
 		
 		[queue inDatabase:^(FMDatabase *db) {
-			FMResultSet * results = [db executeQuery:@"SELECT folder_id, search_string FROM smart_folders"];
+			FMResultSet * results = [db executeQuery:@"SELECT folder_id, search_string, member_sql FROM smart_folders"];
 			while ([results next]) {
-				NSInteger folderId = [results stringForColumnIndex:0].integerValue;
+				NSInteger folderId = [results longForColumnIndex:0];
 				NSString * search_string = [results stringForColumnIndex:1];
 				
 				CriteriaTree * criteriaTree = [[CriteriaTree alloc] initWithString:search_string];
 				_smartfoldersDict[@(folderId)] = criteriaTree;
+				_smartFolderMemberSQL[@(folderId)] = [results stringForColumnIndex:2];
 			}
 			[results close];
 		}];
@@ -1948,12 +2870,15 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         [self setName:folderName forFolder:folderId];
     }
 
-	// Update the smart folder string
+	// Update the smart folder string. The stored members no longer match
+	// the criteria, so they are computed anew when the folder is read.
     FMDatabaseQueue *queue = self.databaseQueue;
-    [queue inDatabase:^(FMDatabase *db) {
-        [db executeUpdate:@"UPDATE smart_folders SET search_string=? WHERE folder_id=?",
+    [queue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        [db executeUpdate:@"UPDATE smart_folders SET search_string=?, member_sql=NULL WHERE folder_id=?",
          criteriaTree.string,
          @(folderId)];
+        [db executeUpdate:@"DELETE FROM smart_folder_members WHERE folder_id=?", @(folderId)];
+        [self.smartFolderMemberSQL removeObjectForKey:@(folderId)];
     }];
 
 	self.smartfoldersDict[@(folderId)] = criteriaTree;
@@ -1972,99 +2897,138 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		// Make sure we have a database.
 		NSAssert(self.databaseQueue, @"Database not assigned for this item");
 		
-		// Keep running count of total unread articles
-		__block NSInteger countOfUnread = 0;
-        
+        __block NSArray<Folder *> * folders = nil;
         FMDatabaseQueue *queue = self.databaseQueue;
         
         [queue inExclusiveTransaction:^(FMDatabase *db, BOOL *rollback) {
-             FMResultSet * results = [db executeQuery:@"SELECT folder_id, parent_id, foldername, unread_count, last_update,"
-                @" type, flags, next_sibling, first_child FROM folders ORDER BY folder_id"];
-            if (!results) {
-                NSLog(@"%s: executeQuery error: %@", __FUNCTION__, [db lastErrorMessage]);
+            [self createFolderChangesTableOnDatabase:db];
+            folders = [self foldersFromDatabase:db];
+            if (!folders) {
                 *rollback = YES;
-                return;
             }
-            
-            while ([results next]) {
-                NSInteger newItemId = [results stringForColumnIndex:0].integerValue;
-                NSInteger newParentId = [results stringForColumnIndex:1].integerValue;
-                NSString * name = [results stringForColumnIndex:2];
-                if (name == nil) { // Paranoid check because of https://github.com/ViennaRSS/vienna-rss/issues/877
-                    name = [Database untitledFeedFolderName];
-                }
-                NSInteger unreadCount = [results stringForColumnIndex:3].integerValue;
-                NSDate * lastUpdate = [NSDate dateWithTimeIntervalSince1970:[results stringForColumnIndex:4].doubleValue];
-                NSInteger type = [results stringForColumnIndex:5].integerValue;
-                NSInteger flags = [results stringForColumnIndex:6].integerValue;
-                NSInteger nextSibling = [results stringForColumnIndex:7].integerValue;
-                NSInteger firstChild = [results stringForColumnIndex:8].integerValue;
-                
-                Folder * folder = [[Folder alloc] initWithId:newItemId parentId:newParentId name:name type:type];
-                folder.nextSiblingId = nextSibling;
-                folder.firstChildId = firstChild;
-                if (folder.type != VNAFolderTypeRSS && folder.type != VNAFolderTypeOpenReader) {
-                    unreadCount = 0;
-                }
-                folder.unreadCount = unreadCount;
-                folder.lastUpdate = lastUpdate;
-                [folder setFlag:flags];
-                if (unreadCount > 0) {
-                    countOfUnread += unreadCount;
-                }
-                self.foldersDict[@(newItemId)] = folder;
-                
-                // Remember the trash folder
-                if (folder.type == VNAFolderTypeTrash) {
-                    self.trashFolder = folder;
-                }
-                
-                // Remember the search folder
-                if (folder.type == VNAFolderTypeSearch) {
-                    self.searchFolder = folder;
-                }
-            }
-            [results close];
-		
-        	// Load all RSS folders and add them to the list.
-			results = [db executeQuery:@"SELECT folder_id, feed_url, username, last_update_string, description, home_page, bloglines_id FROM rss_folders"];
-			while ([results next]) {
-				NSInteger folderId = [results stringForColumnIndex:0].integerValue;
-				NSString * url = [results stringForColumnIndex:1];
-				NSString * username = [results stringForColumnIndex:2];
-				NSString * lastUpdateString = [results stringForColumnIndex:3];
-				NSString * descriptiontext = [results stringForColumnIndex:4];
-				NSString * linktext = [results stringForColumnIndex:5];
-				NSString * remoteId = [results stringForColumnIndex:6];
-				
-				Folder * folder = [self folderFromID:folderId];
-				folder.feedDescription = descriptiontext;
-				folder.homePage = linktext;
-				folder.feedURL = url;
-				folder.lastUpdateString = lastUpdateString;
-				folder.username = username;
-				folder.remoteId = remoteId;
-			}
-			[results close];
-		}];
-
-        _countOfUnread = countOfUnread;
+        }];
 
-		// Fix the childUnreadCount for every parent
-		for (Folder * folder in [self.foldersDict objectEnumerator]) {
-			if (folder.unreadCount > 0 && folder.parentId != VNAFolderTypeRoot) {
-				Folder * parentFolder = [self folderFromID:folder.parentId];
-				while (parentFolder != nil) {
-					parentFolder.childUnreadCount = parentFolder.childUnreadCount + folder.unreadCount;
-					parentFolder = [self folderFromID:parentFolder.parentId];
-				}
-			}
-		}
-		// Done
-		self.initializedfoldersDict = YES;
+        if (folders) {
+            [self cacheFolders:folders];
+        }
 	}
 }
 
+/* createFolderChangesTable
+ * Records the folders whose unread count the triggers on the messages table
+ * change from now on, for -applyFolderCountChanges. Temporary tables and
+ * triggers only exist on this connection.
+ */
+-(void)createFolderChangesTableOnDatabase:(FMDatabase *)db
+{
+    [db executeStatements:@"CREATE TEMP TABLE IF NOT EXISTS folder_changes (folder_id INTEGER PRIMARY KEY); "
+        @"CREATE TEMP TRIGGER IF NOT EXISTS folder_changes_update AFTER UPDATE OF unread_count ON main.folders "
+        @"WHEN old.unread_count IS NOT new.unread_count BEGIN "
+        @"INSERT OR IGNORE INTO folder_changes VALUES (new.folder_id); END"];
+}
+
+/* foldersFromDatabase
+ * Reads the folders together with the metadata of their feeds, ordered by
+ * their IDs. Returns nil if the folders could not be read.
+ */
+-(NSArray<Folder *> *)foldersFromDatabase:(FMDatabase *)db
+{
+    FMResultSet * results = [db executeQuery:@"SELECT folder_id, parent_id, foldername, unread_count, last_update,"
+        @" type, flags, next_sibling, first_child FROM folders ORDER BY folder_id"];
+    if (!results) {
+        NSLog(@"%s: executeQuery error: %@", __FUNCTION__, [db lastErrorMessage]);
+        return nil;
+    }
+
+    NSMutableArray<Folder *> * folders = [NSMutableArray array];
+    NSMutableDictionary<NSNumber *, Folder *> * foldersById = [NSMutableDictionary dictionary];
+    while ([results next]) {
+        NSInteger newItemId = [results longForColumnIndex:0];
+        NSInteger newParentId = [results longForColumnIndex:1];
+        NSString * name = [results stringForColumnIndex:2];
+        if (name == nil) { // Paranoid check because of https://github.com/ViennaRSS/vienna-rss/issues/877
+            name = [Database untitledFeedFolderName];
+        }
+        NSInteger unreadCount = [results longForColumnIndex:3];
+        NSDate * lastUpdate = [NSDate dateWithTimeIntervalSince1970:[results doubleForColumnIndex:4]];
+        NSInteger type = [results longForColumnIndex:5];
+        NSInteger flags = [results longForColumnIndex:6];
+        NSInteger nextSibling = [results longForColumnIndex:7];
+        NSInteger firstChild = [results longForColumnIndex:8];
+
+        Folder * folder = [[Folder alloc] initWithId:newItemId parentId:newParentId name:name type:type];
+        folder.nextSiblingId = nextSibling;
+        folder.firstChildId = firstChild;
+        if (folder.type != VNAFolderTypeRSS && folder.type != VNAFolderTypeOpenReader) {
+            unreadCount = 0;
+        }
+        folder.unreadCount = unreadCount;
+        folder.lastUpdate = lastUpdate;
+        [folder setFlag:flags];
+        [folders addObject:folder];
+        foldersById[@(newItemId)] = folder;
+    }
+    [results close];
+
+    // Add the metadata of the RSS folders.
+    results = [db executeQuery:@"SELECT folder_id, feed_url, username, last_update_string, description, home_page, bloglines_id, etag, content_size FROM rss_folders"];
+    while ([results next]) {
+        Folder * folder = foldersById[@([results longForColumnIndex:0])];
+        folder.feedURL = [results stringForColumnIndex:1];
+        folder.username = [results stringForColumnIndex:2];
+        folder.lastUpdateString = [results stringForColumnIndex:3];
+        folder.feedDescription = [results stringForColumnIndex:4];
+        folder.homePage = [results stringForColumnIndex:5];
+        folder.remoteId = [results stringForColumnIndex:6];
+        folder.entityTag = [results stringForColumnIndex:7];
+        folder.contentSize = [results unsignedLongLongIntForColumnIndex:8];
+    }
+    [results close];
+    return [folders copy];
+}
+
+/* cacheFolders
+ * Replaces the folders array with the specified folders, remembers the trash
+ * and search folders and adds up the unread counts.
+ */
+-(void)cacheFolders:(NSArray<Folder *> *)folders
+{
+    [self removeAllFoldersFromCache];
+
+    // Keep running count of total unread articles
+    NSInteger countOfUnread = 0;
+    for (Folder * folder in folders) {
+        [self addFolderToCache:folder];
+        if (folder.unreadCount > 0) {
+            countOfUnread += folder.unreadCount;
+        }
+
+        // Remember the trash folder
+        if (folder.type == VNAFolderTypeTrash) {
+            self.trashFolder = folder;
+        }
+
+        // Remember the search folder
+        if (folder.type == VNAFolderTypeSearch) {
+            self.searchFolder = folder;
+        }
+    }
+    _countOfUnread = countOfUnread;
+
+    // Fix the childUnreadCount for every parent
+    for (Folder * folder in folders) {
+        if (folder.unreadCount > 0 && folder.parentId != VNAFolderTypeRoot) {
+            Folder * parentFolder = [self folderFromID:folder.parentId];
+            while (parentFolder != nil) {
+                parentFolder.childUnreadCount = parentFolder.childUnreadCount + folder.unreadCount;
+                parentFolder = [self folderFromID:parentFolder.parentId];
+            }
+        }
+    }
+    // Done
+    self.initializedfoldersDict = YES;
+}
+
 /* arrayOfFolders
  * Returns an NSArray of all folders with the specified parent. It does not include the
  * parent folder nor does it include any folders within groups under that parent. Specifically
@@ -2078,15 +3042,8 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 		[self initFolderArray];
 	}
 
-	NSMutableArray * newArray = [NSMutableArray array];
-	if (newArray != nil) {
-		for (Folder * folder in [self.foldersDict objectEnumerator]) {
-			if (folder.parentId == parentId) {
-				[newArray addObject:folder];
-			}
-		}
-	}
-	return [newArray copy];
+	NSArray * childFolders = self.foldersByParentId[@(parentId)];
+	return childFolders != nil ? [childFolders copy] : @[];
 }
 
 /* arrayOfSubFolders
@@ -2095,16 +3052,12 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 -(NSArray *)arrayOfSubFolders:(Folder *)folder {
 	NSMutableArray * newArray = [NSMutableArray arrayWithObject:folder];
 	if (newArray != nil) {
-		NSInteger parentId = folder.itemId;
-		
-		for (Folder * item in [self.foldersDict objectEnumerator]) {
-			if (item.parentId == parentId) {
-                if (item.type == VNAFolderTypeGroup) {
-					[newArray addObjectsFromArray:[self arrayOfSubFolders:item]];
-                } else {
-					[newArray addObject:item];
-                }
-			}
+		for (Folder * item in self.foldersByParentId[@(folder.itemId)]) {
+            if (item.type == VNAFolderTypeGroup) {
+				[newArray addObjectsFromArray:[self arrayOfSubFolders:item]];
+            } else {
+				[newArray addObject:item];
+            }
 		}
 	}
 	return [newArray sortedArrayUsingSelector:@selector(folderIDCompare:)];
@@ -2133,26 +3086,19 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 	// Prime the folder cache
 	[self initFolderArray];
 
-    __block NSInteger unread_count = 0;
 	NSMutableArray * myCache = [NSMutableArray array];
 
-    FMDatabaseQueue *queue = self.databaseQueue;
-    [queue inDatabase:^(FMDatabase *db) {
+    [self inReaderDatabase:^(FMDatabase *db) {
         FMResultSet * results = [db executeQueryWithFormat:@"SELECT message_id, read_flag, marked_flag, deleted_flag, title, link, revised_flag FROM messages WHERE folder_id=%ld", (long)folderId];
         while ([results next]) {
             NSString * guid = [results stringForColumnIndex:0];
-            BOOL read_flag = [results stringForColumnIndex:1].integerValue;
-            BOOL marked_flag = [results stringForColumnIndex:2].integerValue;
-            BOOL deleted_flag = [results stringForColumnIndex:3].integerValue;
+            BOOL read_flag = [results boolForColumnIndex:1];
+            BOOL marked_flag = [results boolForColumnIndex:2];
+            BOOL deleted_flag = [results boolForColumnIndex:3];
             NSString * title = [results stringForColumnIndex:4];
             NSString * link = [results stringForColumnIndex:5];
-            BOOL revised_flag = [results stringForColumnIndex:6].integerValue;
+            BOOL revised_flag = [results boolForColumnIndex:6];
 
-            // Keep our own track of unread articles
-            if (!read_flag) {
-                ++unread_count;
-            }
-            
             Article * article = [[Article alloc] initWithGUID:guid];
             article.read = read_flag;
             article.flagged = marked_flag;
@@ -2165,17 +3111,6 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         }
         [results close];
     }];
-    
-    // This is a good time to do a quick check to ensure that our
-    // own count of unread is in sync with the folders count and fix
-    // them if not.
-    Folder * folder = [self folderFromID:folderId];
-    if (unread_count != folder.unreadCount) {
-        NSLog(@"Fixing unread count for %@ (%ld on folder versus %ld in articles)", folder.name, (long)folder.unreadCount, (long)unread_count);
-        NSInteger diff = (unread_count - folder.unreadCount);
-        [self setFolderUnreadCount:folder adjustment:diff];
-        [folder setNonPersistedFlag:VNAFolderFlagBuggySync];
-    }
 
     return [myCache copy];
 }
@@ -2187,7 +3122,6 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 -(NSString *)sqlScopeForFolder:(Folder *)folder flags:(VNAQueryScope)scopeFlags field:(NSString *)field
 {
 	NSString * operatorString = (scopeFlags & VNAQueryScopeInclusive) ? @"=" : @"<>";
-	NSString * conditionString = (scopeFlags & VNAQueryScopeInclusive) ? @" or " : @" and ";
 	BOOL subScope = (scopeFlags & VNAQueryScopeSubFolders) ? YES : NO; // Avoid problems casting into BOOL.
 	NSInteger folderId;
 
@@ -2208,30 +3142,11 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
     if (!subScope) {
 		return [NSString stringWithFormat:@"%@%@%ld", field, operatorString, (long)folderId];
     }
-	// For under/not-under operators, we're creating a SQL statement of the format
-	// (folder_id = <value1> || folder_id = <value2>...). It is possible to try and simplify
-	// the string by looking for ranges but I suspect that given the spread of IDs this may
-	// well be false optimisation.
-	//
-	NSArray * childFolders = [self arrayOfSubFolders:folder];
-	NSMutableString * sqlString = [[NSMutableString alloc] init];
-	NSInteger count = childFolders.count;
-	NSInteger index;
-	
-    if (count > 1) {
-		[sqlString appendString:@"("];
-    }
-	for (index = 0; index < count; ++index) {
-		Folder * folder = childFolders[index];
-		if (index > 0) {
-			[sqlString appendString:conditionString];
-		}
-		[sqlString appendFormat:@"%@%@%ld", field, operatorString, (long)folder.itemId];
-	}
-	if (count > 1) {
-		[sqlString appendString:@")"];
-	}
-	return sqlString;
+	// For under/not-under operators, we select the folder and its descendants
+	// from the folder_tree table, which the index on its primary key turns
+	// into a single join however many feeds a group contains.
+	return [NSString stringWithFormat:@"%@ %@ (SELECT folder_id FROM folder_tree WHERE ancestor_id=%ld)",
+			field, (scopeFlags & VNAQueryScopeInclusive) ? @"IN" : @"NOT IN", (long)folderId];
 }
 
 /* criteriaForFolder
@@ -2271,6 +3186,136 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 	return tree;
 }
 
+/* sqlScopeForSmartFolderMembers
+ * Create a SQL 'where' clause, with its arguments, that scopes to the stored
+ * members of the specified smart folder. The members are computed from the
+ * criteria when the folder is read, and afterwards only the articles that
+ * changed in a column the criteria refer to are checked again. They are
+ * computed anew if the resolved SQL of the criteria changes, either because
+ * the criteria were edited or because they refer to a relative date or to
+ * folders that were added or renamed. Returns
+ * nil if the members are not stored, in which case the criteria must be
+ * evaluated directly.
+ */
+-(VNACriteriaSQL *)sqlScopeForSmartFolderMembers:(NSInteger)folderId
+{
+	if (self.readOnly) {
+		return nil;
+	}
+
+	// The SQL of all smart folders is generated before entering the queue,
+	// because generating it may itself read from the database.
+	NSMutableDictionary<NSNumber *, VNACriteriaSQL *> * criteriaSQL = [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSNumber *, NSSet<NSString *> *> * criteriaFields = [NSMutableDictionary dictionary];
+	[self.smartfoldersDict enumerateKeysAndObjectsUsingBlock:^(NSNumber * key, CriteriaTree * tree, BOOL * stop) {
+		criteriaSQL[key] = [tree compiledSQLForDatabase:self];
+		criteriaFields[key] = [tree sqlFieldsForDatabase:self];
+	}];
+	VNACriteriaSQL * compiledSQL = criteriaSQL[@(folderId)];
+	if (compiledSQL == nil) {
+		return nil;
+	}
+	NSString * folderSQL = compiledSQL.resolvedSQL;
+
+	__block BOOL success = NO;
+	__block BOOL stored = NO;
+	[self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+		success = [self applySmartFolderChangesWithCriteriaSQL:criteriaSQL fields:criteriaFields database:db];
+		stored = [self.smartFolderMemberSQL[@(folderId)] isEqualToString:folderSQL];
+
+		// The members are only computed once the SQL was the same for two
+		// reads in a row. Criteria with a date relative to the current time
+		// produce new SQL every time and are not worth storing.
+		if (success && !stored && [self.smartFolderCandidateSQL[@(folderId)] isEqualToString:folderSQL]) {
+			NSString * statement = [NSString stringWithFormat:@"INSERT INTO smart_folder_members (folder_id, id) SELECT ?, id FROM messages WHERE (%@)", compiledSQL.sql];
+			NSArray * arguments = [@[@(folderId)] arrayByAddingObjectsFromArray:compiledSQL.arguments];
+			success = [db executeUpdate:@"DELETE FROM smart_folder_members WHERE folder_id=?", @(folderId)] &&
+				[db executeUpdate:statement withArgumentsInArray:arguments] &&
+				[db executeUpdate:@"UPDATE smart_folders SET member_sql=? WHERE folder_id=?", folderSQL, @(folderId)];
+			stored = success;
+		}
+
+		if (!success) {
+			NSLog(@"%s: failed to update the members of smart folder %ld: %@", __FUNCTION__, (long)folderId, db.lastErrorMessage);
+			*rollback = YES;
+		} else if (stored) {
+			self.smartFolderMemberSQL[@(folderId)] = folderSQL;
+			[self.smartFolderCandidateSQL removeObjectForKey:@(folderId)];
+		} else {
+			self.smartFolderCandidateSQL[@(folderId)] = folderSQL;
+		}
+	}];
+
+	// Forget what the rolled back transaction brought up to date.
+	if (!success) {
+		[self.databaseQueue inDatabase:^(FMDatabase *db) {
+			[self.smartFolderMemberSQL removeAllObjects];
+			FMResultSet * results = [db executeQuery:@"SELECT folder_id, member_sql FROM smart_folders WHERE member_sql IS NOT NULL"];
+			while ([results next]) {
+				self.smartFolderMemberSQL[@([results longForColumnIndex:0])] = [results stringForColumnIndex:1];
+			}
+			[results close];
+		}];
+		return nil;
+	}
+	if (!stored) {
+		return nil;
+	}
+	return [[VNACriteriaSQL alloc] initWithSql:@"rowid IN (SELECT id FROM smart_folder_members WHERE folder_id=?)"
+									 arguments:@[@(folderId)]];
+}
+
+/* applySmartFolderChangesWithCriteriaSQL
+ * Brings the stored members of smart folders up to date with the articles that
+ * the triggers recorded in the smart_folder_changes table, and empties it. A
+ * smart folder only checks the articles again whose changed columns its
+ * criteria refer to. The members of a folder whose SQL no longer matches the
+ * SQL they were computed with are dropped instead. This must be called on the
+ * database queue within a transaction.
+ */
+-(BOOL)applySmartFolderChangesWithCriteriaSQL:(NSDictionary<NSNumber *, VNACriteriaSQL *> *)criteriaSQL fields:(NSDictionary<NSNumber *, NSSet<NSString *> *> *)criteriaFields database:(FMDatabase *)db
+{
+	NSInteger countOfChanges = [db longForQuery:@"SELECT COUNT(*) FROM smart_folder_changes"];
+	if (countOfChanges == 0) {
+		return YES;
+	}
+	if (countOfChanges > VNASmartFolderChangeLimit) {
+		[self.smartFolderMemberSQL removeAllObjects];
+		return [db executeStatements:@"UPDATE smart_folders SET member_sql=NULL; "
+			@"DELETE FROM smart_folder_members; DELETE FROM smart_folder_changes"];
+	}
+
+	for (NSNumber * folderId in self.smartFolderMemberSQL.allKeys) {
+		VNACriteriaSQL * folderSQL = criteriaSQL[folderId];
+		if (![folderSQL.resolvedSQL isEqualToString:self.smartFolderMemberSQL[folderId]]) {
+			[self.smartFolderMemberSQL removeObjectForKey:folderId];
+			if (![db executeUpdate:@"DELETE FROM smart_folder_members WHERE folder_id=?", folderId] ||
+				![db executeUpdate:@"UPDATE smart_folders SET member_sql=NULL WHERE folder_id=?", folderId]) {
+				return NO;
+			}
+			continue;
+		}
+
+		// Inserted and deleted articles are recorded with the field '*'.
+		NSArray * fields = [@[@"*"] arrayByAddingObjectsFromArray:criteriaFields[folderId].allObjects];
+		NSMutableArray * placeholders = [NSMutableArray arrayWithCapacity:fields.count];
+		for (NSUInteger index = 0; index < fields.count; ++index) {
+			[placeholders addObject:@"?"];
+		}
+		NSString * changedArticles = [NSString stringWithFormat:@"SELECT id FROM smart_folder_changes WHERE field IN (%@)",
+									  [placeholders componentsJoinedByString:@", "]];
+		NSArray * arguments = [@[folderId] arrayByAddingObjectsFromArray:fields];
+		NSString * deleteStatement = [NSString stringWithFormat:@"DELETE FROM smart_folder_members WHERE folder_id=? AND id IN (%@)", changedArticles];
+		NSString * insertStatement = [NSString stringWithFormat:@"INSERT INTO smart_folder_members (folder_id, id) SELECT ?, id FROM messages WHERE id IN (%@) AND (%@)",
+									  changedArticles, folderSQL.sql];
+		if (![db executeUpdate:deleteStatement withArgumentsInArray:arguments] ||
+			![db executeUpdate:insertStatement withArgumentsInArray:[arguments arrayByAddingObjectsFromArray:folderSQL.arguments]]) {
+			return NO;
+		}
+	}
+	return [db executeUpdate:@"DELETE FROM smart_folder_changes"];
+}
+
 /* arrayOfUnreadArticlesRefs
  * Retrieves an array of ArticleReference objects that represent all unread
  * articles in the specified folder.
@@ -2298,20 +3343,38 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 
 /* arrayOfArticles
  * Retrieves an array containing all articles (including text) for the
- * specified folder. If folderId is zero, all folders are searched. The
- * filterString option constrains the array to all those articles that
- * contain the specified filter.
+ * specified folder. The text remains compressed until it is accessed. If
+ * folderId is zero, all folders are searched. The filterString option
+ * constrains the array to all those articles that contain the specified
+ * filter.
  */
 -(NSArray *)arrayOfArticles:(NSInteger)folderId filterString:(NSString *)filterString
+{
+	return [self arrayOfArticles:folderId filterString:filterString sortColumn:nil ascending:YES position:NULL limit:0];
+}
+
+/* arrayOfArticles
+ * Retrieves a page of at most limit articles for the specified folder in the
+ * order of sortColumn, an SQL expression over the messages table. The order is
+ * made total by the row id of the articles. On input, position holds the sort
+ * value and the row id of the last article of the previous page, or nil for
+ * the first page. On output, it holds those of the last row of this page.
+ * Seeking to the position instead of skipping rows with OFFSET keeps the cost
+ * of a page independent of how far the list was scrolled. If sortColumn is
+ * nil, all articles are retrieved in no particular order.
+ */
+-(NSArray *)arrayOfArticles:(NSInteger)folderId
+               filterString:(NSString *)filterString
+                 sortColumn:(NSString *)sortColumn
+                  ascending:(BOOL)ascending
+                   position:(NSArray **)position
+                      limit:(NSUInteger)limit
 {
 	NSMutableArray * newArray = [NSMutableArray array];
-	NSString * filterClause = @"";
+	NSMutableArray * conditions = [NSMutableArray array];
+	NSMutableArray * arguments = [NSMutableArray array];
 	NSString * queryString;
 	Folder * folder = nil;
-	__block NSInteger unread_count = 0;
-
-	queryString=@"SELECT message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender,"
-		@" link, createddate, date, text, revised_flag, hasenclosure_flag, enclosure FROM messages";
 
 	// If folderId is zero then we're searching the entire database
 	// otherwise we need to construct a criteria tree for this folder
@@ -2320,29 +3383,64 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
         if (folder == nil) {
 			return nil;
         }
-		CriteriaTree * tree = [self criteriaForFolder:folderId];
-        queryString = [NSString stringWithFormat:@"%@ WHERE (%@)", queryString, [tree toSQLForDatabase:self]];
+		VNACriteriaSQL * scope = nil;
+		if (folder.type == VNAFolderTypeSmart) {
+			scope = [self sqlScopeForSmartFolderMembers:folderId];
+		}
+		if (scope == nil) {
+			CriteriaTree * tree = [self criteriaForFolder:folderId];
+			scope = [tree compiledSQLForDatabase:self];
+		}
+		[conditions addObject:[NSString stringWithFormat:@"(%@)", scope.sql]];
+		[arguments addObjectsFromArray:scope.arguments];
 	}
 
-	// prepare filter if needed
+	// prepare filter if needed, using the full-text index when possible
 	if ([filterString isNotEqualTo:@""]) {
-		if (folderId == 0) {
-			filterClause = @"WHERE (title LIKE '%' || ? || '%' OR text LIKE '%' || ? || '%')";
+		NSString * fullTextQuery = nil;
+		if (self.fullTextSearchAvailable) {
+			fullTextQuery = [self fullTextQueryForString:filterString column:nil];
+		}
+		if (fullTextQuery) {
+			[conditions addObject:@"(rowid IN (SELECT rowid FROM messages_fts WHERE messages_fts MATCH ?))"];
+			[arguments addObject:fullTextQuery];
 		} else {
-			filterClause = @"AND (title LIKE '%' || ? || '%' OR text LIKE '%' || ? || '%')";
+			[conditions addObject:@"(title LIKE '%' || ? || '%' OR rowid IN (SELECT id FROM message_bodies WHERE vna_inflate(body) LIKE '%' || ? || '%'))"];
+			[arguments addObjectsFromArray:@[filterString, filterString]];
 		}
-		queryString = [NSString stringWithFormat:@"%@ %@", queryString, filterClause];
 	}
 
-	// Time to run the query
-    FMDatabaseQueue *queue = self.databaseQueue;
-    [queue inDatabase:^(FMDatabase *db) {
-		FMResultSet * results;
-		if ([filterString isEqualTo:@""]) {
-			results = [db executeQuery:queryString];
-		} else {
-			results = [db executeQuery:queryString, filterString, filterString];
+	NSString * whereClause = @"";
+	if (conditions.count > 0) {
+		whereClause = [@" WHERE " stringByAppendingString:[conditions componentsJoinedByString:@" AND "]];
+	}
+
+	queryString=@"SELECT message_id, folder_id, parent_id, read_flag, marked_flag, deleted_flag, title, sender,"
+		@" link, createddate, date, (SELECT body FROM message_bodies WHERE message_bodies.id = messages.id),"
+		@" revised_flag, hasenclosure_flag, enclosure";
+
+	if (sortColumn != nil) {
+		// The page is selected by its row ids first, so that the bodies are
+		// only read for the rows of the page.
+		NSString * direction = ascending ? @"ASC" : @"DESC";
+		NSString * order = [NSString stringWithFormat:@"ORDER BY %@ %@, id %@", sortColumn, direction, direction];
+		NSString * pageClause = whereClause;
+		if (position != NULL && *position != nil) {
+			NSString * seekCondition = [NSString stringWithFormat:@"(%@, id) %@ (?, ?)", sortColumn, ascending ? @">" : @"<"];
+			pageClause = conditions.count > 0 ? [NSString stringWithFormat:@"%@ AND %@", whereClause, seekCondition]
+											  : [@" WHERE " stringByAppendingString:seekCondition];
+			[arguments addObjectsFromArray:*position];
 		}
+		queryString = [NSString stringWithFormat:@"%@, id, %@ FROM messages WHERE id IN (SELECT id FROM messages%@ %@ LIMIT %lu) %@",
+					   queryString, sortColumn, pageClause, order, (unsigned long)limit, order];
+	} else {
+		queryString = [NSString stringWithFormat:@"%@ FROM messages%@", queryString, whereClause];
+	}
+
+	// Time to run the query
+	__block NSArray * lastPosition = nil;
+    [self inReaderDatabase:^(FMDatabase *db) {
+		FMResultSet * results = [db executeQuery:queryString withArgumentsInArray:arguments];
 		while ([results next]) {
 			NSString * guid = [results stringForColumnIndex:0];
 			Article * article = [[Article alloc] initWithGUID:guid];
@@ -2354,10 +3452,9 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 			article.title = [results stringForColumnIndex:6];
 			article.author = [results stringForColumnIndex:7];
 			article.link = [results stringForColumnIndex:8];
-			article.publicationDate = [NSDate dateWithTimeIntervalSince1970:[results stringForColumnIndex:9].doubleValue];
-			article.lastUpdate = [NSDate dateWithTimeIntervalSince1970:[results stringForColumnIndex:10].doubleValue];
-			NSString * text = [results stringForColumnIndex:11];
-			article.body = text;
+			article.publicationDate = [NSDate dateWithTimeIntervalSince1970:[results doubleForColumnIndex:9]];
+			article.lastUpdate = [NSDate dateWithTimeIntervalSince1970:[results doubleForColumnIndex:10]];
+			article.compressedBody = [results dataForColumnIndex:11];
 			article.revised = [results intForColumnIndex:12];
 			article.hasEnclosure = [results intForColumnIndex:13];
 			article.enclosure = [results stringForColumnIndex:14];
@@ -2367,28 +3464,17 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 			if (folder == nil || !article.isDeleted || folder.type == VNAFolderTypeTrash) {
 				[newArray addObject:article];
 			}
-			
-			// Keep our own track of unread articles
-			if (!article.isRead) {
-				++unread_count;
+
+			if (sortColumn != nil) {
+				lastPosition = @[[results objectForColumnIndex:16], @([results longForColumnIndex:15])];
 			}
-			
 		}
 		[results close];
 	}];
-    
-    // This is a good time to do a quick check to ensure that our
-    // own count of unread is in sync with the folders count and fix
-    // them if not.
-    if (folder && [filterString isEqualTo:@""] && (folder.type == VNAFolderTypeRSS || folder.type == VNAFolderTypeOpenReader)) {
-        if (unread_count != folder.unreadCount) {
-            NSLog(@"Fixing unread count for %@ (%ld on folder versus %ld in articles)", folder.name, (long)folder.unreadCount, (long)unread_count);
-            NSInteger diff = (unread_count - folder.unreadCount);
-            [self setFolderUnreadCount:folder adjustment:diff];
-            [folder setNonPersistedFlag:VNAFolderFlagBuggySync];
-        }
-    }
 
+	if (position != NULL && lastPosition != nil) {
+		*position = lastPosition;
+	}
 	return [newArray copy];
 }
 
@@ -2422,8 +3508,7 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 			    // update the existing cache of articles and update the unread count
 			    [folder markArticlesInCacheRead];
 			}
-            // set the unread count to 0
-            [self setFolderUnreadCount:folder adjustment:-folder.unreadCount];
+            [self applyFolderCountChanges];
 			result = YES;
 		}
 	}
@@ -2437,99 +3522,136 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 {
     Folder *folder = [self folderFromID:folderId];
     if (folder != nil) {
-        // Mark an individual article read
+        // Mark an individual article read. The unread count of the folder
+        // only changes if the flag of the article does.
         FMDatabaseQueue *queue = self.databaseQueue;
         __block BOOL success;
         [queue inDatabase:^(FMDatabase *db) {
-            FMResultSet *results = [db executeQuery:@"SELECT read_flag FROM messages WHERE folder_id=? AND message_id=?",
-                                                    @(folderId), guid];
-            if ([results next]) {
-                BOOL status = [results boolForColumn:@"read_flag"];
-                if (status != isRead) {
-                    success = [db executeUpdate:@"UPDATE messages SET read_flag=? WHERE folder_id=? AND message_id=?",
-                                                @(isRead), @(folderId), guid];
-                } else {
-                    success = NO;
-                }
-            } else {
-                success = NO;
-            }
-            [results close];
+            success = [db executeUpdate:@"UPDATE messages SET read_flag=? WHERE folder_id=? AND message_id=? AND read_flag IS NOT ?",
+                                        @(isRead), @(folderId), guid, @(isRead)];
+            success = success && db.changes > 0;
         }];
         if (success) {
-            NSInteger adjustment = (isRead ? -1 : 1);
-            [self setFolderUnreadCount:folder adjustment:adjustment];
+            [self applyFolderCountChanges];
         }
     }
 }
 
 /* markUnreadArticlesFromFolder
- * Marks as unread a set of articles.
+ * Marks as unread the articles of the folder whose guid is in guidArray and
+ * marks the other articles of the folder read. Returns the guids of the
+ * articles whose read flag changed.
  */
--(void)markUnreadArticlesFromFolder:(Folder *)folder guidArray:(NSArray *)guidArray
+-(NSArray<NSString *> *)markUnreadArticlesFromFolder:(Folder *)folder guidArray:(NSArray<NSString *> *)guidArray
 {
-    FMDatabaseQueue *queue = self.databaseQueue;
-    NSInteger folderId = folder.itemId;
-	if (guidArray.count>0) {
-		NSString * guidList = [guidArray componentsJoinedByString:@"','"];
-        [queue inTransaction:^(FMDatabase *db, BOOL *rollback) {
-			NSString * statement1 = [NSString stringWithFormat:@"UPDATE messages SET read_flag=1 WHERE folder_id=%ld AND read_flag=0 AND message_id NOT IN ('%@')", (long)folderId, guidList];
-			[db executeUpdate:statement1];
-			NSString * statement2 = [NSString stringWithFormat:@"UPDATE messages SET read_flag=0 WHERE folder_id=%ld AND read_flag=1 AND message_id IN ('%@')", (long)folderId, guidList];
-			[db executeUpdate:statement2];
-        }];
-	} else {
-        [queue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"UPDATE messages SET read_flag=1 WHERE folder_id=? AND read_flag=0", @(folderId)];
-        }];
-	}
-	NSInteger adjustment = guidArray.count-folder.unreadCount;
-	[self setFolderUnreadCount:folder adjustment:adjustment];
+	NSArray<NSString *> * changedGuids = [self reconcileFlag:@"read_flag" ofFolder:folder.itemId withGuids:guidArray listedValue:NO];
+	[self applyFolderCountChanges];
+	return changedGuids;
 }
 
 /* markStarredArticlesFromFolder
- * Marks starred a set of articles.
+ * Marks starred the articles of the folder whose guid is in guidArray and
+ * clears the flag of the other articles of the folder. Returns the guids of
+ * the articles whose flag changed.
  */
--(void)markStarredArticlesFromFolder:(Folder *)folder guidArray:(NSArray *)guidArray
+-(NSArray<NSString *> *)markStarredArticlesFromFolder:(Folder *)folder guidArray:(NSArray<NSString *> *)guidArray
 {
-    FMDatabaseQueue *queue = self.databaseQueue;
-    NSInteger folderId = folder.itemId;
-	if (guidArray.count>0) {
-		NSString * guidList = [guidArray componentsJoinedByString:@"','"];
-		[queue inTransaction:^(FMDatabase *db, BOOL *rollback) {
-			NSString * statement1 = [NSString stringWithFormat:@"UPDATE messages SET marked_flag=1 WHERE folder_id=%ld AND marked_flag=0 AND message_id IN ('%@')", (long)folderId, guidList];
-			[db executeUpdate:statement1];
-			NSString * statement2 = [NSString stringWithFormat:@"UPDATE messages SET marked_flag=0 WHERE folder_id=%ld AND marked_flag=1 AND message_id NOT IN ('%@')", (long)folderId, guidList];
-			[db executeUpdate:statement2];
-        }];
-	} else {
-        [queue inDatabase:^(FMDatabase *db) {
-            [db executeUpdate:@"UPDATE messages SET marked_flag=0 WHERE folder_id=? AND marked_flag=1", @(folderId)];
-        }];
-	}
+	return [self reconcileFlag:@"marked_flag" ofFolder:folder.itemId withGuids:guidArray listedValue:YES];
 }
 
-/* setFolderUnreadCount
- * Adjusts the unread count on the specified folder by the given delta. The same delta is
- * also applied to the childUnreadCount of all ancestor folders.
+/* reconcileFlag
+ * Sets the flag column of the articles of the folder to listedValue if their
+ * guid is in guidArray, and to the opposite otherwise. The guids are loaded
+ * into a temporary table first, so that the articles to change are found with
+ * a join instead of statements that spell out every guid. Returns the guids
+ * of the articles whose flag changed, in a single transaction with the update.
  */
--(void)setFolderUnreadCount:(Folder *)folder adjustment:(NSInteger)adjustment
+-(NSArray<NSString *> *)reconcileFlag:(NSString *)flagColumn ofFolder:(NSInteger)folderId withGuids:(NSArray<NSString *> *)guidArray listedValue:(BOOL)listedValue
 {
-	self.countOfUnread += adjustment;
-	NSInteger newCount = folder.unreadCount + adjustment;
-	folder.unreadCount = newCount;
-    FMDatabaseQueue *queue = self.databaseQueue;
-    [queue inDatabase:^(FMDatabase *db) {
-        [db executeUpdate:@"UPDATE folders SET unread_count=? WHERE folder_id=?", @(newCount), @(folder.itemId)];
-        [[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
-    }];
+	NSMutableArray<NSString *> * changedGuids = [NSMutableArray array];
+	if (self.readOnly) {
+		return changedGuids;
+	}
+
+	NSString * newValue = @"((message_id IN (SELECT guid FROM temp.sync_guids)) = ?)";
+	NSString * changedCondition = [NSString stringWithFormat:@"folder_id=? AND %@ IS NOT %@", flagColumn, newValue];
+	[self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+		// The INSERT into the temporary table runs once per guid, so it is
+		// prepared once. It is released at the end of the transaction.
+		db.shouldCacheStatements = YES;
+		// Temporary tables only exist on this connection.
+		BOOL success = [db executeStatements:@"CREATE TEMP TABLE IF NOT EXISTS sync_guids (guid TEXT PRIMARY KEY) WITHOUT ROWID; "
+						@"DELETE FROM temp.sync_guids"];
+		for (NSString * guid in guidArray) {
+			success = success && [db executeUpdate:@"INSERT OR IGNORE INTO temp.sync_guids (guid) VALUES (?)", guid];
+		}
 
-	// Update childUnreadCount for parents.
-	Folder * tmpFolder = [self folderFromID:folder.parentId];
-	while (tmpFolder != nil) {
-		tmpFolder.childUnreadCount = tmpFolder.childUnreadCount + adjustment;
-		tmpFolder = [self folderFromID:tmpFolder.parentId];
+		FMResultSet * results = nil;
+		if (success) {
+			results = [db executeQuery:[NSString stringWithFormat:@"SELECT message_id FROM messages WHERE %@", changedCondition],
+					   @(folderId), @(listedValue)];
+			success = results != nil;
+		}
+		while ([results next]) {
+			[changedGuids addObject:[results stringForColumnIndex:0]];
+		}
+		[results close];
+
+		if (success && changedGuids.count > 0) {
+			NSString * statement = [NSString stringWithFormat:@"UPDATE messages SET %@=%@ WHERE %@", flagColumn, newValue, changedCondition];
+			success = [db executeUpdate:statement, @(listedValue), @(folderId), @(listedValue)];
+		}
+		success = success && [db executeUpdate:@"DELETE FROM temp.sync_guids"];
+
+		if (!success) {
+			NSLog(@"%s: failed to update the %@ column of folder %ld: %@", __FUNCTION__, flagColumn, (long)folderId, db.lastErrorMessage);
+			[changedGuids removeAllObjects];
+			*rollback = YES;
+		}
+		db.shouldCacheStatements = NO;
+	}];
+	return [changedGuids copy];
+}
+
+/* applyFolderCountChanges
+ * Applies the unread counts that the triggers on the messages table changed
+ * since the last call to the folders in memory. The counts are read from the
+ * change feed of the database queue and the new count of a folder is also
+ * reflected in the childUnreadCount of its ancestors. This runs on the queue
+ * so that concurrent callers apply the changes in the order they were made.
+ */
+-(void)applyFolderCountChanges
+{
+	// The change feed is created together with the folders in memory.
+	if (!self.initializedfoldersDict) {
+		return;
 	}
+
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        FMResultSet * results = [db executeQuery:@"SELECT folder_id, unread_count FROM temp.folder_changes JOIN folders USING (folder_id)"];
+        while ([results next]) {
+            Folder * folder = [self folderFromID:[results longForColumnIndex:0]];
+            if (folder == nil || (folder.type != VNAFolderTypeRSS && folder.type != VNAFolderTypeOpenReader)) {
+                continue;
+            }
+            NSInteger adjustment = [results longForColumnIndex:1] - folder.unreadCount;
+            if (adjustment == 0) {
+                continue;
+            }
+            folder.unreadCount = folder.unreadCount + adjustment;
+            self.countOfUnread += adjustment;
+
+            // Update childUnreadCount for parents.
+            Folder * tmpFolder = [self folderFromID:folder.parentId];
+            while (tmpFolder != nil) {
+                tmpFolder.childUnreadCount = tmpFolder.childUnreadCount + adjustment;
+                tmpFolder = [self folderFromID:tmpFolder.parentId];
+            }
+            [[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
+        }
+        [results close];
+        [db executeUpdate:@"DELETE FROM temp.folder_changes"];
+    }];
 }
 
 /* markArticleFlagged
@@ -2576,9 +3698,8 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 -(BOOL)isTrashEmpty
 {
 	__block BOOL result;
-    FMDatabaseQueue *queue = self.databaseQueue;
-	[queue inDatabase:^(FMDatabase *db) {
-        FMResultSet * results = [db executeQuery:@"SELECT deleted_flag FROM messages WHERE deleted_flag=1"];
+	[self inReaderDatabase:^(FMDatabase *db) {
+        FMResultSet * results = [db executeQuery:@"SELECT folder_id FROM folders WHERE deleted_count > 0"];
         if ([results next]) {
             result= NO;
         } else {
@@ -2593,11 +3714,10 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 /* guidHistoryForFolderId
  * Returns an array of all article guids ever downloaded for the specified folder.
  */
--(NSArray *)guidHistoryForFolderId:(NSInteger)folderId
+-(NSSet<NSString *> *)guidHistoryForFolderId:(NSInteger)folderId
 {
-	NSMutableArray * articleGuids = [NSMutableArray array];
-    FMDatabaseQueue *queue = self.databaseQueue;
-    [queue inDatabase:^(FMDatabase *db) {
+	NSMutableSet * articleGuids = [NSMutableSet set];
+    [self inReaderDatabase:^(FMDatabase *db) {
 		FMResultSet * results = [db executeQuery:@"SELECT message_id FROM rss_guids WHERE folder_id=?", @(folderId)];
 		while ([results next]) {
 			NSString * guid = [results stringForColumn:@"message_id"];
@@ -2611,6 +3731,100 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 	return [articleGuids copy];
 }
 
+/* markGuids
+ * Records that the feed of the folder lists the guids. Only the guids that
+ * were last listed more than a day ago are written, so that most refreshes
+ * only read the index.
+ */
+-(void)markGuids:(NSArray<NSString *> *)guids seenInFolder:(NSInteger)folderId
+{
+    if (guids.count == 0) {
+        return;
+    }
+
+    NSTimeInterval now = [NSDate date].timeIntervalSince1970;
+    [self.databaseQueue inTransaction:^(FMDatabase *db, BOOL *rollback) {
+        // One UPDATE per guid, prepared for this call only.
+        db.shouldCacheStatements = YES;
+        for (NSString *guid in guids) {
+            [db executeUpdate:@"UPDATE rss_guids SET last_seen=? "
+                               "WHERE folder_id=? AND message_id=? AND last_seen < ?",
+                              @(now), @(folderId), guid, @(now - 24 * 60 * 60)];
+        }
+        db.shouldCacheStatements = NO;
+    }];
+}
+
+/* pruneGuidHistoryOfFolder
+ * Forgets at most limit guids of the folder that were last listed longer
+ * than horizon before the most recent guid. Measuring from the most recent
+ * guid instead of from now keeps the history of feeds that fail to refresh.
+ */
+-(NSInteger)pruneGuidHistoryOfFolder:(NSInteger)folderId
+                          unseenFor:(NSTimeInterval)horizon
+                              limit:(NSUInteger)limit
+{
+    __block NSInteger countOfPruned = 0;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        BOOL success = [db executeUpdate:@"DELETE FROM rss_guids WHERE rowid IN "
+                                          "(SELECT rowid FROM rss_guids WHERE folder_id=? "
+                                          "AND last_seen < (SELECT MAX(last_seen) FROM rss_guids WHERE folder_id=?) - ? "
+                                          "AND NOT EXISTS (SELECT 1 FROM messages "
+                                          "WHERE messages.folder_id=rss_guids.folder_id "
+                                          "AND messages.message_id=rss_guids.message_id) "
+                                          "LIMIT ?)",
+                                         @(folderId), @(folderId), @(horizon), @(limit)];
+        if (!success) {
+            NSLog(@"error = %@", db.lastErrorMessage);
+            countOfPruned = -1;
+            return;
+        }
+        countOfPruned = db.changes;
+    }];
+    return countOfPruned;
+}
+
+/* retentionPolicyForFolder
+ * Returns the retention policy of the folder, or nil if the folder follows
+ * the default policy.
+ */
+-(VNARetentionPolicy *)retentionPolicyForFolder:(NSInteger)folderId
+{
+    __block VNARetentionPolicy *policy = nil;
+    [self inReaderDatabase:^(FMDatabase *db) {
+        FMResultSet *results = [db executeQuery:@"SELECT max_age, max_count, guid_horizon "
+                                                 "FROM retention_policies WHERE folder_id=?",
+                                                @(folderId)];
+        if ([results next]) {
+            policy = [[VNARetentionPolicy alloc] initWithMaximumAge:(NSUInteger)[results longForColumnIndex:0]
+                                                       maximumCount:(NSUInteger)[results longForColumnIndex:1]
+                                                 guidHistoryHorizon:(NSUInteger)[results longForColumnIndex:2]];
+        }
+        [results close];
+    }];
+    return policy;
+}
+
+/* setRetentionPolicy
+ * Stores the retention policy of the folder. A nil policy makes the folder
+ * follow the default policy again.
+ */
+-(BOOL)setRetentionPolicy:(VNARetentionPolicy *)policy forFolder:(NSInteger)folderId
+{
+    __block BOOL success;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        if (policy == nil) {
+            success = [db executeUpdate:@"DELETE FROM retention_policies WHERE folder_id=?", @(folderId)];
+        } else {
+            success = [db executeUpdate:@"INSERT OR REPLACE INTO retention_policies "
+                                         "(folder_id, max_age, max_count, guid_horizon) VALUES (?, ?, ?, ?)",
+                                        @(folderId), @(policy.maximumAge), @(policy.maximumCount),
+                                        @(policy.guidHistoryHorizon)];
+        }
+    }];
+    return success;
+}
+
 /*!
  *  Get the path to the database file
  *
@@ -2650,15 +3864,117 @@ NSNotificationName const VNADatabaseDidDeleteFolderNotification = @"Database Did
 -(void)close
 {
 	[[NSNotificationCenter defaultCenter] removeObserver:self];
-	[self.foldersDict removeAllObjects];
+	[self removeAllFoldersFromCache];
 	self.smartfoldersDict = nil;
 	self.trashFolder = nil;
 	self.searchFolder = nil;
 	self.initializedfoldersDict = NO;
 	self.countOfUnread = 0;
+	self.fullTextSearchAvailability = nil;
+    [self.readerPool releaseAllDatabases];
+    self.readerPool = nil;
     [self.databaseQueue close];
 }
 
+/* folderSnapshotPath
+ * Returns the path of the folder snapshot, next to the database.
+ */
+-(NSString *)folderSnapshotPath
+{
+    return [self.path stringByAppendingPathExtension:@"folders"];
+}
+
+/* generation
+ * Returns the generation of the database or -1 if it has none.
+ */
+-(NSInteger)generation
+{
+    __block NSInteger generation = -1;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        FMResultSet * results = [db executeQuery:@"SELECT generation FROM info"];
+        if ([results next]) {
+            generation = [results longForColumnIndex:0];
+        }
+        [results close];
+    }];
+    return generation;
+}
+
+/* advanceGeneration
+ * Increments the generation of the database, so that no snapshot taken
+ * before is used again, and returns the new generation or -1 on failure.
+ */
+-(NSInteger)advanceGeneration
+{
+    __block NSInteger generation = -1;
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        if ([db executeUpdate:@"UPDATE info SET generation = generation + 1"]) {
+            generation = [db longForQuery:@"SELECT generation FROM info"];
+        }
+    }];
+    return generation;
+}
+
+/* loadFolderSnapshot
+ * Caches the folders of the snapshot written when the database was last
+ * closed, if it is still valid. An invalid snapshot is removed.
+ */
+-(BOOL)loadFolderSnapshot
+{
+    NSString * snapshotPath = self.folderSnapshotPath;
+    VNAFolderSnapshot * snapshot = [VNAFolderSnapshot snapshotWithContentsOfURL:[NSURL fileURLWithPath:snapshotPath]];
+    if (!snapshot) {
+        return NO;
+    }
+    if (![snapshot matchesDatabaseAtPath:self.path] ||
+        self.databaseVersion != VNACurrentDatabaseVersion ||
+        snapshot.generation != self.generation) {
+        os_log_info(VNA_LOG, "Ignoring an outdated folder snapshot");
+        [[NSFileManager defaultManager] removeItemAtPath:snapshotPath error:NULL];
+        return NO;
+    }
+
+    [self.databaseQueue inDatabase:^(FMDatabase *db) {
+        [self createFolderChangesTableOnDatabase:db];
+    }];
+    [self cacheFolders:snapshot.folders];
+    self.folderSnapshot = snapshot;
+    [self advanceGeneration];
+    return YES;
+}
+
+/* saveFolderSnapshotAndClose
+ * Closes the database and writes a snapshot of the folders for the next
+ * launch, unless the integrity check of the database failed.
+ */
+-(void)saveFolderSnapshotAndClose
+{
+    dispatch_group_t group = self.backgroundCheckGroup;
+    if (group) {
+        dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    }
+
+    NSString * databasePath = self.path;
+    VNAFolderSnapshot * snapshot = nil;
+    if (self.initializedfoldersDict && !self.integrityCheckFailed) {
+        NSInteger generation = [self advanceGeneration];
+        if (generation >= 0) {
+            snapshot = [[VNAFolderSnapshot alloc] initWithFolders:self.foldersDict.allValues
+                                                       generation:generation];
+        }
+    }
+    [self close];
+
+    NSString * snapshotPath = [databasePath stringByAppendingPathExtension:@"folders"];
+    [[NSFileManager defaultManager] removeItemAtPath:snapshotPath error:NULL];
+    if (snapshot) {
+        NSError * error = nil;
+        if (![snapshot writeToURL:[NSURL fileURLWithPath:snapshotPath] databasePath:databasePath error:&error]) {
+            NSLog(@"Failed to write the folder snapshot: %@", error);
+        }
+    }
+}
+
 /* dealloc
  * Clean up and release resources.
  */
@@ -0,0 +1,85 @@
+//
+//  DatabaseBackup.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+#import "Database.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Takes snapshots of the database with the online backup of SQLite. The
+/// pages are copied in small steps on a background queue, so that the
+/// database remains usable while a snapshot is taken. Only the newest
+/// snapshots are kept, and each snapshot is checked before it replaces an
+/// older one.
+@interface VNADatabaseBackup : NSObject
+
+- (instancetype)initWithDatabase:(Database *)database NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The directory of the snapshots. The default is a "Backups" directory next
+/// to the database file.
+@property (copy) NSURL *directoryURL;
+
+/// The number of pages that a step copies. The default is 1024.
+@property NSInteger pagesPerStep;
+
+/// The pause between two steps. The default is 0.01 seconds.
+@property NSTimeInterval pauseBetweenSteps;
+
+/// The number of snapshots that are kept. The default is 3.
+@property NSUInteger maximumCountOfSnapshots;
+
+/// The time that must pass after the newest snapshot before another snapshot
+/// is taken by `-scheduleSnapshot`. The default is 0, which takes a snapshot
+/// every time.
+@property NSTimeInterval minimumInterval;
+
+/// The snapshots in the directory, the newest first.
+@property (readonly) NSArray<NSURL *> *snapshotURLs;
+
+/// Takes a snapshot on a background queue, unless a snapshot is already
+/// being taken or the newest snapshot is more recent than the minimum
+/// interval.
+- (void)scheduleSnapshot;
+
+/// Stops the snapshot that is being taken after the current step and waits
+/// until it has stopped.
+- (void)cancel;
+
+/// Takes a snapshot, checks its integrity and deletes the snapshots that are
+/// no longer kept. This blocks the calling thread until the snapshot is
+/// taken.
+/// @return The URL of the snapshot or `nil` if it could not be taken.
+- (nullable NSURL *)takeSnapshotWithError:(NSError **)error;
+
+/// Copies the database to a file in steps. An existing file is replaced when
+/// the copy is complete. The integrity of the copy is not checked.
+- (BOOL)copyDatabaseToURL:(NSURL *)url error:(NSError **)error;
+
+/// Replaces a database file with a snapshot after checking the integrity of
+/// the snapshot. The database must not be open.
++ (BOOL)restoreSnapshotAtURL:(NSURL *)snapshotURL
+            toDatabaseAtPath:(NSString *)path
+                       error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
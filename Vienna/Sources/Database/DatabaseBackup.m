@@ -0,0 +1,308 @@
+//
+//  DatabaseBackup.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "DatabaseBackup.h"
+
+@import os.log;
+@import SQLite3;
+
+#define VNA_LOG os_log_create("--", "DatabaseBackup")
+
+static NSString * const VNADatabaseBackupErrorDomain = @"VNADatabaseBackupErrorDomain";
+
+/* VNACheckIntegrity
+ * Runs the integrity check of SQLite, which reports "ok" if it finds no
+ * problems.
+ */
+static int VNACheckIntegrity(sqlite3 *connection)
+{
+    sqlite3_stmt *statement = NULL;
+    int result = sqlite3_prepare_v2(connection, "PRAGMA integrity_check", -1, &statement, NULL);
+    if (result == SQLITE_OK) {
+        result = sqlite3_step(statement);
+        if (result == SQLITE_ROW) {
+            const char *message = (const char *)sqlite3_column_text(statement, 0);
+            result = (message != NULL && strcmp(message, "ok") == 0) ? SQLITE_OK : SQLITE_CORRUPT;
+        }
+    }
+    sqlite3_finalize(statement);
+    return result;
+}
+
+static NSError *VNABackupError(int result)
+{
+    return [NSError errorWithDomain:VNADatabaseBackupErrorDomain
+                               code:result
+                           userInfo:@{NSLocalizedDescriptionKey: @(sqlite3_errstr(result))}];
+}
+
+@interface VNADatabaseBackup ()
+
+@property (nonatomic) Database *database;
+@property (nonatomic) dispatch_queue_t queue;
+@property (atomic, getter=isSnapshotPending) BOOL snapshotPending;
+@property (atomic, getter=isCancelled) BOOL cancelled;
+@property (nonatomic, readonly) NSString *snapshotBaseName;
+@property (nonatomic, readonly) BOOL snapshotDue;
+
+@end
+
+@implementation VNADatabaseBackup
+
+- (instancetype)initWithDatabase:(Database *)database
+{
+    self = [super init];
+    if (self) {
+        _database = database;
+        _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.databaseBackup", DISPATCH_QUEUE_SERIAL);
+        NSString *databaseFolder = database.path.stringByDeletingLastPathComponent;
+        _directoryURL = [NSURL fileURLWithPath:[databaseFolder stringByAppendingPathComponent:@"Backups"]
+                                   isDirectory:YES];
+        _pagesPerStep = 1024;
+        _pauseBetweenSteps = 0.01;
+        _maximumCountOfSnapshots = 3;
+        _minimumInterval = 0.0;
+    }
+    return self;
+}
+
+- (NSArray<NSURL *> *)snapshotURLs
+{
+    NSArray<NSURL *> *contents = [NSFileManager.defaultManager contentsOfDirectoryAtURL:self.directoryURL
+                                                              includingPropertiesForKeys:nil
+                                                                                 options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                                   error:NULL];
+    NSString *prefix = [self.snapshotBaseName stringByAppendingString:@"-"];
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(NSURL *url, NSDictionary *bindings) {
+        return [url.pathExtension isEqualToString:@"db"] && [url.lastPathComponent hasPrefix:prefix];
+    }];
+    // The names end with the time of the snapshot, so they sort by age.
+    NSSortDescriptor *newestFirst = [NSSortDescriptor sortDescriptorWithKey:@"lastPathComponent" ascending:NO];
+    return [[contents filteredArrayUsingPredicate:predicate] sortedArrayUsingDescriptors:@[newestFirst]];
+}
+
+- (void)scheduleSnapshot
+{
+    if (self.snapshotPending) {
+        return;
+    }
+    self.snapshotPending = YES;
+    self.cancelled = NO;
+    dispatch_async(self.queue, ^{
+        if (self.snapshotDue) {
+            NSError *error = nil;
+            if (![self takeSnapshotWithError:&error]) {
+                os_log_error(VNA_LOG, "Could not back up the database. Reason: %{public}@",
+                             error.localizedDescription);
+            }
+        }
+        self.snapshotPending = NO;
+    });
+}
+
+- (void)cancel
+{
+    self.cancelled = YES;
+    // Wait for the snapshot to stop, so that the database can be closed.
+    dispatch_sync(self.queue, ^{});
+}
+
+- (NSURL *)takeSnapshotWithError:(NSError **)error
+{
+    if (![NSFileManager.defaultManager createDirectoryAtURL:self.directoryURL
+                                withIntermediateDirectories:YES
+                                                 attributes:nil
+                                                      error:error]) {
+        return nil;
+    }
+    // Copies that were interrupted, e.g. when Vienna quit, are of no use.
+    NSArray<NSURL *> *contents = [NSFileManager.defaultManager contentsOfDirectoryAtURL:self.directoryURL
+                                                              includingPropertiesForKeys:nil
+                                                                                 options:0
+                                                                                   error:NULL];
+    for (NSURL *url in contents) {
+        if ([url.pathExtension isEqualToString:@"partial"]) {
+            [NSFileManager.defaultManager removeItemAtURL:url error:NULL];
+        }
+    }
+
+    NSDateFormatter *formatter = [NSDateFormatter new];
+    formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+    formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+    formatter.dateFormat = @"yyyyMMdd'T'HHmmssSSS";
+    NSString *fileName = [NSString stringWithFormat:@"%@-%@.db",
+                          self.snapshotBaseName, [formatter stringFromDate:[NSDate date]]];
+    NSURL *snapshotURL = [self.directoryURL URLByAppendingPathComponent:fileName];
+    if (![self copyDatabaseToURL:snapshotURL checkingIntegrity:YES error:error]) {
+        return nil;
+    }
+
+    NSArray<NSURL *> *snapshotURLs = self.snapshotURLs;
+    for (NSUInteger index = self.maximumCountOfSnapshots; index < snapshotURLs.count; index++) {
+        [NSFileManager.defaultManager removeItemAtURL:snapshotURLs[index] error:NULL];
+    }
+    return snapshotURL;
+}
+
+- (BOOL)copyDatabaseToURL:(NSURL *)url error:(NSError **)error
+{
+    return [self copyDatabaseToURL:url checkingIntegrity:NO error:error];
+}
+
++ (BOOL)restoreSnapshotAtURL:(NSURL *)snapshotURL
+            toDatabaseAtPath:(NSString *)path
+                       error:(NSError **)error
+{
+    // A damaged snapshot must not replace the database.
+    sqlite3 *snapshot = NULL;
+    int result = sqlite3_open_v2(snapshotURL.fileSystemRepresentation, &snapshot, SQLITE_OPEN_READONLY, NULL);
+    if (result == SQLITE_OK) {
+        result = VNACheckIntegrity(snapshot);
+    }
+    sqlite3_close(snapshot);
+    if (result != SQLITE_OK) {
+        if (error) {
+            *error = VNABackupError(result);
+        }
+        return NO;
+    }
+
+    // Copy the snapshot next to the database first, so that the database is
+    // replaced at once.
+    NSFileManager *fileManager = NSFileManager.defaultManager;
+    NSString *restoringPath = [path stringByAppendingPathExtension:@"restoring"];
+    [fileManager removeItemAtPath:restoringPath error:NULL];
+    if (![fileManager copyItemAtPath:snapshotURL.path toPath:restoringPath error:error]) {
+        return NO;
+    }
+    if (rename(restoringPath.fileSystemRepresentation, path.fileSystemRepresentation) != 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+        [fileManager removeItemAtPath:restoringPath error:NULL];
+        return NO;
+    }
+
+    // The write-ahead log belongs to the replaced database and would damage
+    // the snapshot if it were applied to it.
+    [fileManager removeItemAtPath:[path stringByAppendingString:@"-wal"] error:NULL];
+    [fileManager removeItemAtPath:[path stringByAppendingString:@"-shm"] error:NULL];
+    return YES;
+}
+
+/* snapshotBaseName
+ * Returns the name of the database file without its extension, with which the
+ * names of the snapshots begin.
+ */
+- (NSString *)snapshotBaseName
+{
+    return self.database.path.lastPathComponent.stringByDeletingPathExtension;
+}
+
+/* snapshotDue
+ * Returns whether the newest snapshot is older than the minimum interval.
+ */
+- (BOOL)snapshotDue
+{
+    NSURL *newestSnapshotURL = self.snapshotURLs.firstObject;
+    if (newestSnapshotURL == nil || self.minimumInterval <= 0.0) {
+        return YES;
+    }
+    NSDate *date = nil;
+    [newestSnapshotURL getResourceValue:&date forKey:NSURLContentModificationDateKey error:NULL];
+    return date == nil || -date.timeIntervalSinceNow >= self.minimumInterval;
+}
+
+/* copyDatabaseToURL
+ * Copies the database into a partial file, which replaces the file at the
+ * URL once the copy is complete and, if requested, has passed the integrity
+ * check.
+ */
+- (BOOL)copyDatabaseToURL:(NSURL *)url checkingIntegrity:(BOOL)checkingIntegrity error:(NSError **)error
+{
+    NSURL *partialURL = [url URLByAppendingPathExtension:@"partial"];
+    [NSFileManager.defaultManager removeItemAtURL:partialURL error:NULL];
+
+    sqlite3 *destination = NULL;
+    int result = sqlite3_open_v2(partialURL.fileSystemRepresentation, &destination,
+                                 SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+    if (result == SQLITE_OK) {
+        result = [self copyDatabaseToConnection:destination];
+    }
+    if (result == SQLITE_OK) {
+        // The copy takes over the write-ahead logging of the database. Without
+        // it, the copy is a single file, even when it is opened.
+        result = sqlite3_exec(destination, "PRAGMA journal_mode = DELETE", NULL, NULL, NULL);
+    }
+    if (result == SQLITE_OK && checkingIntegrity) {
+        result = VNACheckIntegrity(destination);
+    }
+    sqlite3_close(destination);
+
+    if (result == SQLITE_OK &&
+        rename(partialURL.fileSystemRepresentation, url.fileSystemRepresentation) == 0) {
+        return YES;
+    }
+    if (error) {
+        *error = result == SQLITE_OK ? [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil]
+                                     : VNABackupError(result);
+    }
+    [NSFileManager.defaultManager removeItemAtURL:partialURL error:NULL];
+    return NO;
+}
+
+/* copyDatabaseToConnection
+ * Copies the pages of the database in steps. Each step runs on the queue of
+ * the database, so that the writer connection is not used from two threads,
+ * and other work can use the database between the steps. The writer is the
+ * only connection that changes the database, and the backup takes over its
+ * changes as they happen, so the copy never has to start over.
+ */
+- (int)copyDatabaseToConnection:(sqlite3 *)destination
+{
+    __block sqlite3_backup *backup = NULL;
+    [self.database inWriterConnection:^(struct sqlite3 *connection) {
+        backup = sqlite3_backup_init(destination, "main", connection, "main");
+    }];
+    if (backup == NULL) {
+        return sqlite3_errcode(destination);
+    }
+
+    __block int result = SQLITE_OK;
+    int pagesPerStep = (int)self.pagesPerStep;
+    while (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+        if (self.cancelled) {
+            result = SQLITE_INTERRUPT;
+            break;
+        }
+        [self.database inWriterConnection:^(struct sqlite3 *connection) {
+            result = sqlite3_backup_step(backup, pagesPerStep);
+        }];
+        if (result != SQLITE_DONE && self.pauseBetweenSteps > 0.0) {
+            [NSThread sleepForTimeInterval:self.pauseBetweenSteps];
+        }
+    }
+
+    [self.database inWriterConnection:^(struct sqlite3 *connection) {
+        sqlite3_backup_finish(backup);
+    }];
+    return result == SQLITE_DONE ? SQLITE_OK : result;
+}
+
+@end
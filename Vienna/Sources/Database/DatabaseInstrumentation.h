@@ -0,0 +1,73 @@
+//
+//  DatabaseInstrumentation.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+@import Foundation;
+
+@class FMDatabase;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Records the cost of the statements that run on the connections it is
+/// attached to. Statements are grouped by their SQL with the literals
+/// replaced by parameters, and each group counts its executions, the rows
+/// they returned and the time they took. The blocks that use a connection
+/// are attributed to the first statement they run, with the time they
+/// waited for the connection and the time they held it.
+///
+/// Recording adds a callback to every statement and every returned row, so
+/// it is meant for diagnostics only.
+@interface VNADatabaseInstrumentation : NSObject
+
+/// The time at which the recording started or was last reset.
+@property (readonly) NSDate *startDate;
+
+/// Starts recording the statements of the connection. The connection keeps
+/// the instrumentation alive until it is closed.
+- (void)attachToDatabase:(FMDatabase *)database;
+
+/// Stops recording the statements of the connection.
++ (void)detachFromDatabase:(FMDatabase *)database;
+
+/// Runs a block that uses a connection which was requested at the given
+/// time, in nanoseconds of `CLOCK_UPTIME_RAW`.
+- (void)recordBlockRequestedAt:(uint64_t)requestTime
+                    usingBlock:(NS_NOESCAPE void (^)(void))block;
+
+/// The statistics of each statement, the most expensive first. Times are in
+/// milliseconds.
+@property (readonly) NSArray<NSDictionary<NSString *, id> *> *statementStatistics;
+
+/// Returns the statistics as a JSON object with stable keys, so that the
+/// exports of different versions can be compared.
+- (nullable NSData *)JSONDataWithError:(NSError **)error;
+
+/// Writes the JSON export to a file.
+- (BOOL)writeJSONToURL:(NSURL *)url error:(NSError **)error;
+
+/// Discards the statistics recorded so far.
+- (void)reset;
+
+/// Returns the SQL with its literals replaced by parameters, lists of
+/// parameters reduced to one and whitespace collapsed.
++ (NSString *)normalizedSQL:(NSString *)sql;
+
+@end
+
+NS_ASSUME_NONNULL_END
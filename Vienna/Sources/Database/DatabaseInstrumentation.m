@@ -0,0 +1,362 @@
+//
+//  DatabaseInstrumentation.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+#import "DatabaseInstrumentation.h"
+
+@import FMDB;
+@import ObjectiveC.runtime;
+@import os.lock;
+@import SQLite3;
+
+// The number of most recent times from which percentiles are computed. It
+// sizes arrays, so it must be a constant expression.
+enum { VNALatencySampleCount = 1024 };
+
+// The key of the blocks that did not run any statement
+static NSString * const VNABlockWithoutStatementKey = @"(no statement)";
+
+static char VNAInstrumentationAssociationKey;
+
+#pragma mark - Latency distribution
+
+/* VNALatencyDistribution
+ * Accumulates durations in nanoseconds and keeps the most recent ones for
+ * percentiles.
+ */
+@interface VNALatencyDistribution : NSObject {
+    uint64_t _samples[VNALatencySampleCount];
+}
+
+@property (nonatomic) uint64_t count;
+@property (nonatomic) uint64_t totalTime;
+@property (nonatomic) uint64_t maximumTime;
+
+- (void)addTime:(uint64_t)time;
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation;
+
+@end
+
+@implementation VNALatencyDistribution
+
+- (void)addTime:(uint64_t)time
+{
+    _samples[self.count % VNALatencySampleCount] = time;
+    self.count++;
+    self.totalTime += time;
+    self.maximumTime = MAX(self.maximumTime, time);
+}
+
+static int VNACompareTimes(const void *first, const void *second)
+{
+    uint64_t firstTime = *(const uint64_t *)first;
+    uint64_t secondTime = *(const uint64_t *)second;
+    return firstTime < secondTime ? -1 : (firstTime > secondTime ? 1 : 0);
+}
+
+- (uint64_t)percentile:(double)fraction
+{
+    NSUInteger sampleCount = (NSUInteger)MIN(self.count, VNALatencySampleCount);
+    if (sampleCount == 0) {
+        return 0;
+    }
+    uint64_t sortedSamples[VNALatencySampleCount];
+    memcpy(sortedSamples, _samples, sampleCount * sizeof(uint64_t));
+    qsort(sortedSamples, sampleCount, sizeof(uint64_t), VNACompareTimes);
+    NSUInteger index = (NSUInteger)ceil(fraction * sampleCount) - 1;
+    return sortedSamples[MIN(index, sampleCount - 1)];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)dictionaryRepresentation
+{
+    double mean = self.count > 0 ? (double)self.totalTime / self.count : 0.0;
+    return @{
+        @"total": @(self.totalTime / 1e6),
+        @"mean": @(mean / 1e6),
+        @"p99": @([self percentile:0.99] / 1e6),
+        @"max": @(self.maximumTime / 1e6),
+    };
+}
+
+@end
+
+#pragma mark - Statement statistics
+
+@interface VNAStatementStatistics : NSObject
+
+@property (nonatomic, copy) NSString *sql;
+@property (nonatomic) uint64_t countOfRows;
+@property (nonatomic) VNALatencyDistribution *executionTime;
+@property (nonatomic) VNALatencyDistribution *waitTime;
+@property (nonatomic) VNALatencyDistribution *holdTime;
+
+@end
+
+@implementation VNAStatementStatistics
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _executionTime = [VNALatencyDistribution new];
+        _waitTime = [VNALatencyDistribution new];
+        _holdTime = [VNALatencyDistribution new];
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, id> *)dictionaryRepresentation
+{
+    return @{
+        @"sql": self.sql,
+        @"executions": @(self.executionTime.count),
+        @"rows": @(self.countOfRows),
+        @"executionTime": self.executionTime.dictionaryRepresentation,
+        @"blocks": @(self.waitTime.count),
+        @"waitTime": self.waitTime.dictionaryRepresentation,
+        @"holdTime": self.holdTime.dictionaryRepresentation,
+    };
+}
+
+@end
+
+#pragma mark - Blocks
+
+/* VNAInstrumentedBlock
+ * A block that uses a connection, and the first statement that it runs.
+ */
+@interface VNAInstrumentedBlock : NSObject
+
+@property (nonatomic, unsafe_unretained) VNADatabaseInstrumentation *instrumentation;
+@property (nonatomic, copy) NSString *firstStatement;
+
+@end
+
+@implementation VNAInstrumentedBlock
+
+@end
+
+// The block that runs on the current thread. Statements run on the thread
+// of the block that uses their connection.
+static _Thread_local void *VNACurrentBlock;
+
+#pragma mark - Instrumentation
+
+@interface VNADatabaseInstrumentation () {
+    os_unfair_lock _lock;
+    CFMutableDictionaryRef _rowCounts;
+}
+
+@property (readwrite) NSDate *startDate;
+@property (nonatomic) NSMutableDictionary<NSString *, VNAStatementStatistics *> *statistics;
+@property (nonatomic) NSCache<NSString *, NSString *> *normalizedSQLCache;
+
+- (void)countRowOfStatement:(sqlite3_stmt *)statement;
+- (void)recordStatement:(sqlite3_stmt *)statement duration:(uint64_t)duration;
+
+@end
+
+static int VNAInstrumentationTrace(unsigned int type, void *context, void *p, void *x)
+{
+    VNADatabaseInstrumentation *instrumentation = (__bridge VNADatabaseInstrumentation *)context;
+    if (type == SQLITE_TRACE_ROW) {
+        [instrumentation countRowOfStatement:p];
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        [instrumentation recordStatement:p duration:(uint64_t)*(sqlite3_int64 *)x];
+    }
+    return 0;
+}
+
+@implementation VNADatabaseInstrumentation
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _rowCounts = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+        _startDate = [NSDate date];
+        _statistics = [NSMutableDictionary dictionary];
+        _normalizedSQLCache = [NSCache new];
+        _normalizedSQLCache.countLimit = 1000;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    CFRelease(_rowCounts);
+}
+
+- (void)attachToDatabase:(FMDatabase *)database
+{
+    objc_setAssociatedObject(database, &VNAInstrumentationAssociationKey, self, OBJC_ASSOCIATION_RETAIN);
+    sqlite3_trace_v2(database.sqliteHandle, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW,
+                     VNAInstrumentationTrace, (__bridge void *)self);
+}
+
++ (void)detachFromDatabase:(FMDatabase *)database
+{
+    sqlite3_trace_v2(database.sqliteHandle, 0, NULL, NULL);
+    objc_setAssociatedObject(database, &VNAInstrumentationAssociationKey, nil, OBJC_ASSOCIATION_RETAIN);
+}
+
+- (void)recordBlockRequestedAt:(uint64_t)requestTime
+                    usingBlock:(NS_NOESCAPE void (^)(void))block
+{
+    VNAInstrumentedBlock *instrumentedBlock = [VNAInstrumentedBlock new];
+    instrumentedBlock.instrumentation = self;
+    void *previousBlock = VNACurrentBlock;
+    VNACurrentBlock = (__bridge void *)instrumentedBlock;
+
+    uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    block();
+    uint64_t endTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    VNACurrentBlock = previousBlock;
+
+    os_unfair_lock_lock(&_lock);
+    VNAStatementStatistics *statistics = [self statisticsForSQL:instrumentedBlock.firstStatement ?: VNABlockWithoutStatementKey];
+    [statistics.waitTime addTime:startTime - requestTime];
+    [statistics.holdTime addTime:endTime - startTime];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)countRowOfStatement:(sqlite3_stmt *)statement
+{
+    os_unfair_lock_lock(&_lock);
+    uintptr_t countOfRows = (uintptr_t)CFDictionaryGetValue(_rowCounts, statement);
+    CFDictionarySetValue(_rowCounts, statement, (const void *)(countOfRows + 1));
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)recordStatement:(sqlite3_stmt *)statement duration:(uint64_t)duration
+{
+    const char *sql = sqlite3_sql(statement);
+    NSString *rawSQL = sql != NULL ? @(sql) : @"";
+    NSString *normalizedSQL = [self.normalizedSQLCache objectForKey:rawSQL];
+    if (normalizedSQL == nil) {
+        normalizedSQL = [VNADatabaseInstrumentation normalizedSQL:rawSQL];
+        [self.normalizedSQLCache setObject:normalizedSQL forKey:rawSQL];
+    }
+
+    // Transactions begin with the same statement, which therefore does not
+    // identify the block.
+    VNAInstrumentedBlock *block = (__bridge VNAInstrumentedBlock *)VNACurrentBlock;
+    if (block.instrumentation == self && block.firstStatement == nil &&
+        ![normalizedSQL.uppercaseString hasPrefix:@"BEGIN"]) {
+        block.firstStatement = normalizedSQL;
+    }
+
+    os_unfair_lock_lock(&_lock);
+    uintptr_t countOfRows = (uintptr_t)CFDictionaryGetValue(_rowCounts, statement);
+    CFDictionaryRemoveValue(_rowCounts, statement);
+    VNAStatementStatistics *statistics = [self statisticsForSQL:normalizedSQL];
+    statistics.countOfRows += countOfRows;
+    [statistics.executionTime addTime:duration];
+    os_unfair_lock_unlock(&_lock);
+}
+
+/* statisticsForSQL
+ * Returns the statistics of the statement, which are created if needed. The
+ * lock must be held.
+ */
+- (VNAStatementStatistics *)statisticsForSQL:(NSString *)sql
+{
+    VNAStatementStatistics *statistics = self.statistics[sql];
+    if (statistics == nil) {
+        statistics = [VNAStatementStatistics new];
+        statistics.sql = sql;
+        self.statistics[sql] = statistics;
+    }
+    return statistics;
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)statementStatistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<VNAStatementStatistics *> *statistics =
+        [self.statistics.allValues sortedArrayUsingComparator:^NSComparisonResult(VNAStatementStatistics *first, VNAStatementStatistics *second) {
+            uint64_t firstTime = first.executionTime.totalTime + first.holdTime.totalTime;
+            uint64_t secondTime = second.executionTime.totalTime + second.holdTime.totalTime;
+            if (firstTime != secondTime) {
+                return firstTime > secondTime ? NSOrderedAscending : NSOrderedDescending;
+            }
+            return [first.sql compare:second.sql];
+        }];
+    NSMutableArray<NSDictionary<NSString *, id> *> *representations = [NSMutableArray array];
+    for (VNAStatementStatistics *statementStatistics in statistics) {
+        [representations addObject:statementStatistics.dictionaryRepresentation];
+    }
+    os_unfair_lock_unlock(&_lock);
+    return representations;
+}
+
+- (NSData *)JSONDataWithError:(NSError **)error
+{
+    NSISO8601DateFormatter *formatter = [NSISO8601DateFormatter new];
+    NSDictionary *export = @{
+        @"startDate": [formatter stringFromDate:self.startDate],
+        @"duration": @(-self.startDate.timeIntervalSinceNow),
+        @"statements": self.statementStatistics,
+    };
+    return [NSJSONSerialization dataWithJSONObject:export
+                                           options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
+                                             error:error];
+}
+
+- (BOOL)writeJSONToURL:(NSURL *)url error:(NSError **)error
+{
+    NSData *data = [self JSONDataWithError:error];
+    return data != nil && [data writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+- (void)reset
+{
+    os_unfair_lock_lock(&_lock);
+    [self.statistics removeAllObjects];
+    self.startDate = [NSDate date];
+    os_unfair_lock_unlock(&_lock);
+}
+
++ (NSString *)normalizedSQL:(NSString *)sql
+{
+    static NSArray<NSArray *> *replacements;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // String literals go first, because they may contain digits.
+        replacements = @[
+            @[[NSRegularExpression regularExpressionWithPattern:@"'(?:[^']|'')*'" options:0 error:NULL], @"?"],
+            @[[NSRegularExpression regularExpressionWithPattern:@"\\b\\d+(?:\\.\\d+)?\\b" options:0 error:NULL], @"?"],
+            @[[NSRegularExpression regularExpressionWithPattern:@"\\s+" options:0 error:NULL], @" "],
+            @[[NSRegularExpression regularExpressionWithPattern:@"\\?(?: ?, ?\\?)+" options:0 error:NULL], @"?"],
+        ];
+    });
+
+    NSString *normalizedSQL = sql;
+    for (NSArray *replacement in replacements) {
+        NSRegularExpression *expression = replacement[0];
+        normalizedSQL = [expression stringByReplacingMatchesInString:normalizedSQL
+                                                             options:0
+                                                               range:NSMakeRange(0, normalizedSQL.length)
+                                                        withTemplate:replacement[1]];
+    }
+    return [normalizedSQL stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+}
+
+@end
@@ -0,0 +1,68 @@
+//
+//  DatabaseMaintenance.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+#import "Database.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Returns free pages to the file system and refreshes the statistics of the
+/// query planner in small steps while the application is idle, instead of
+/// compacting the whole database at once. Between the steps, other work can
+/// use the database.
+@interface VNADatabaseMaintenance : NSObject
+
+- (instancetype)initWithDatabase:(Database *)database NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The time for which a step may hold the database. The number of pages that
+/// a step releases is adapted to the time that the previous steps took. The
+/// default is 0.1 seconds.
+@property NSTimeInterval writeBudget;
+
+/// The pause between two steps. The default is 0.5 seconds.
+@property NSTimeInterval pauseBetweenSteps;
+
+/// Returns whether the application is idle. It is called on a background
+/// queue before every step. Without it, the application is always idle.
+@property (nullable, copy) BOOL (^idleCondition)(void);
+
+/// The use of the pages of the database file after the last maintenance.
+@property (readonly) VNADatabaseStorageStatistics statistics;
+
+/// The fraction of the pages of the database file that are free.
+@property (readonly) double fragmentation;
+
+/// Runs the maintenance on a background queue at the given interval.
+- (void)scheduleWithInterval:(NSTimeInterval)interval;
+
+/// Stops the scheduled maintenance after the current step.
+- (void)cancel;
+
+/// Runs the maintenance steps one after the other, as long as the application
+/// is idle. This blocks the calling thread until the maintenance stops.
+/// @return `YES` if all steps ran, `NO` if the application was not idle or
+///   the maintenance was cancelled.
+- (BOOL)runSteps;
+
+@end
+
+NS_ASSUME_NONNULL_END
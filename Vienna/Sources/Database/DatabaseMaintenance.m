@@ -0,0 +1,151 @@
+//
+//  DatabaseMaintenance.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "DatabaseMaintenance.h"
+
+#import "Vienna-Swift.h"
+
+// The bounds of the number of pages that a step releases
+static NSInteger const VNAMinimumPagesPerStep = 8;
+static NSInteger const VNAMaximumPagesPerStep = 65536;
+
+@interface VNADatabaseMaintenance ()
+
+@property (nonatomic) Database *database;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) VNADispatchTimer *timer;
+@property (nonatomic) NSInteger pagesPerStep;
+@property (nonatomic) NSUInteger countOfSteps;
+@property (atomic, getter=isCancelled) BOOL cancelled;
+@property (readwrite) VNADatabaseStorageStatistics statistics;
+
+@end
+
+@implementation VNADatabaseMaintenance
+
+- (instancetype)initWithDatabase:(Database *)database
+{
+    self = [super init];
+    if (self) {
+        _database = database;
+        _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.databaseMaintenance", DISPATCH_QUEUE_SERIAL);
+        _writeBudget = 0.1;
+        _pauseBetweenSteps = 0.5;
+        _pagesPerStep = 128;
+        _statistics = database.storageStatistics;
+    }
+    return self;
+}
+
+- (double)fragmentation
+{
+    VNADatabaseStorageStatistics statistics = self.statistics;
+    if (statistics.pageCount == 0) {
+        return 0.0;
+    }
+    return (double)statistics.freePageCount / (double)statistics.pageCount;
+}
+
+- (void)scheduleWithInterval:(NSTimeInterval)interval
+{
+    self.cancelled = NO;
+    __weak typeof(self) weakSelf = self;
+    self.timer = [[VNADispatchTimer alloc] initWithInterval:interval
+                                            fireImmediately:NO
+                                              dispatchQueue:self.queue
+                                               eventHandler:^{
+        [weakSelf runSteps];
+    }];
+}
+
+- (void)cancel
+{
+    self.cancelled = YES;
+    self.timer = nil;
+}
+
+- (BOOL)runSteps
+{
+    self.countOfSteps = 0;
+
+    // Release the free pages in steps that fit into the budget.
+    if (self.database.incrementalVacuumEnabled) {
+        NSInteger freePageCount = self.database.storageStatistics.freePageCount;
+        while (freePageCount > 0) {
+            if (![self waitForNextStep]) {
+                return NO;
+            }
+            NSInteger pageCount = MIN(self.pagesPerStep, freePageCount);
+            NSDate *start = [NSDate date];
+            freePageCount = [self.database incrementalVacuum:pageCount];
+            [self adaptPagesPerStepToDuration:-start.timeIntervalSinceNow ofPageCount:pageCount];
+        }
+    }
+
+    // Analyze the tables that have no statistics, e.g. because a migration
+    // created them. Each table is a step.
+    for (NSString *table in self.database.tablesWithoutStatistics) {
+        if (![self waitForNextStep]) {
+            return NO;
+        }
+        [self.database analyzeTable:table];
+    }
+
+    // Bring the statistics of the other tables up to date if needed.
+    if (![self waitForNextStep]) {
+        return NO;
+    }
+    [self.database optimizeDatabase];
+
+    self.statistics = self.database.storageStatistics;
+    return YES;
+}
+
+/* waitForNextStep
+ * Pauses after the previous step, so that others get the database, and
+ * returns whether the next step may run.
+ */
+- (BOOL)waitForNextStep
+{
+    if (self.countOfSteps > 0) {
+        [NSThread sleepForTimeInterval:self.pauseBetweenSteps];
+    }
+    if (self.cancelled || (self.idleCondition && !self.idleCondition())) {
+        self.statistics = self.database.storageStatistics;
+        return NO;
+    }
+    self.countOfSteps += 1;
+    return YES;
+}
+
+/* adaptPagesPerStepToDuration
+ * Sets the number of pages of the next step to what the last step could have
+ * released in four fifths of the budget, leaving room for slower disks.
+ */
+- (void)adaptPagesPerStepToDuration:(NSTimeInterval)duration ofPageCount:(NSInteger)pageCount
+{
+    if (duration <= 0.0) {
+        self.pagesPerStep = MIN(self.pagesPerStep * 2, VNAMaximumPagesPerStep);
+        return;
+    }
+    NSInteger pagesPerStep = (NSInteger)(pageCount * self.writeBudget * 0.8 / duration);
+    self.pagesPerStep = MAX(VNAMinimumPagesPerStep, MIN(pagesPerStep, VNAMaximumPagesPerStep));
+}
+
+@end
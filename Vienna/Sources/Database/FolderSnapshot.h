@@ -0,0 +1,63 @@
+//
+//  FolderSnapshot.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+@class Folder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A compact copy of the folder tree with the unread counts and the metadata
+/// of the feeds. It is written when Vienna quits and stands in for the
+/// folders at the next launch, until they are loaded from the database. It
+/// is only valid for the database file and the generation of the database
+/// that it was taken from.
+@interface VNAFolderSnapshot : NSObject
+
+- (instancetype)initWithFolders:(NSArray<Folder *> *)folders
+                     generation:(NSInteger)generation NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Reads a snapshot from a file.
+/// @return The snapshot or `nil` if the file does not exist or does not hold
+///   a snapshot.
++ (nullable instancetype)snapshotWithContentsOfURL:(NSURL *)url;
+
+/// The generation of the database when the snapshot was taken.
+@property (readonly) NSInteger generation;
+
+/// New folders with the values of the snapshot.
+@property (readonly) NSArray<Folder *> *folders;
+
+/// Returns whether both snapshots hold the same folders with the same values.
+- (BOOL)hasSameFoldersAsSnapshot:(VNAFolderSnapshot *)snapshot;
+
+/// Returns whether the database file has the size and the modification date
+/// that it had when the snapshot was written, and has no pending changes in
+/// its write-ahead log.
+- (BOOL)matchesDatabaseAtPath:(NSString *)path;
+
+/// Writes the snapshot to a file, together with the size and the modification
+/// date of the database file, which must be closed.
+- (BOOL)writeToURL:(NSURL *)url databasePath:(NSString *)path error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
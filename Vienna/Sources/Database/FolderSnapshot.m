@@ -0,0 +1,199 @@
+//
+//  FolderSnapshot.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "FolderSnapshot.h"
+
+#import "Folder.h"
+
+// The format of the snapshot file, which is increased whenever the records
+// change, so that a snapshot of an older format is not read.
+static NSInteger const VNAFolderSnapshotFormat = 1;
+
+/* VNAStringOfRecord
+ * Returns the string of a key of a folder record, or nil if the folder has
+ * no value for the key.
+ */
+static NSString *VNAStringOfRecord(NSDictionary<NSString *, id> *record, NSString *key)
+{
+    id value = record[key];
+    return [value isKindOfClass:[NSString class]] ? value : nil;
+}
+
+/* VNAAttributesOfDatabase
+ * Returns the size and the modification date of the database file, which
+ * change with any change to the database once it is closed.
+ */
+static NSDictionary<NSString *, id> *VNAAttributesOfDatabase(NSString *path)
+{
+    NSDictionary *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:path error:NULL];
+    if (attributes == nil || attributes.fileModificationDate == nil) {
+        return nil;
+    }
+    return @{
+        @"size": @(attributes.fileSize),
+        @"modified": @(attributes.fileModificationDate.timeIntervalSinceReferenceDate),
+    };
+}
+
+@interface VNAFolderSnapshot ()
+
+@property (readwrite) NSInteger generation;
+@property (nonatomic) NSArray<NSDictionary<NSString *, id> *> *records;
+@property (nonatomic) NSDictionary<NSString *, id> *databaseAttributes;
+
+@end
+
+@implementation VNAFolderSnapshot
+
+- (instancetype)initWithFolders:(NSArray<Folder *> *)folders generation:(NSInteger)generation
+{
+    self = [super init];
+    if (self) {
+        _generation = generation;
+        NSMutableArray<NSDictionary<NSString *, id> *> *records = [NSMutableArray arrayWithCapacity:folders.count];
+        NSArray<Folder *> *sortedFolders = [folders sortedArrayUsingSelector:@selector(folderIDCompare:)];
+        for (Folder *folder in sortedFolders) {
+            NSMutableDictionary<NSString *, id> *record = [NSMutableDictionary dictionary];
+            record[@"id"] = @(folder.itemId);
+            record[@"parent"] = @(folder.parentId);
+            record[@"name"] = folder.name;
+            record[@"type"] = @(folder.type);
+            record[@"flags"] = @(folder.flags);
+            record[@"next"] = @(folder.nextSiblingId);
+            record[@"child"] = @(folder.firstChildId);
+            record[@"unread"] = @(folder.unreadCount);
+            record[@"updated"] = @(folder.lastUpdate.timeIntervalSince1970);
+            record[@"url"] = folder.feedURL;
+            record[@"remote"] = folder.remoteId;
+            record[@"description"] = folder.feedDescription;
+            record[@"home"] = folder.homePage;
+            record[@"updateString"] = folder.lastUpdateString;
+            record[@"etag"] = folder.entityTag;
+            record[@"size"] = @(folder.contentSize);
+            record[@"user"] = folder.username;
+            [records addObject:[record copy]];
+        }
+        _records = [records copy];
+    }
+    return self;
+}
+
++ (instancetype)snapshotWithContentsOfURL:(NSURL *)url
+{
+    NSData *data = [NSData dataWithContentsOfURL:url];
+    if (data == nil) {
+        return nil;
+    }
+    NSDictionary *plist = [NSPropertyListSerialization propertyListWithData:data
+                                                                    options:NSPropertyListImmutable
+                                                                     format:NULL
+                                                                      error:NULL];
+    if (![plist isKindOfClass:[NSDictionary class]] ||
+        ![plist[@"format"] isEqual:@(VNAFolderSnapshotFormat)] ||
+        ![plist[@"generation"] isKindOfClass:[NSNumber class]] ||
+        ![plist[@"folders"] isKindOfClass:[NSArray class]] ||
+        ![plist[@"database"] isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    NSArray<NSString *> *numberKeys = @[@"id", @"parent", @"type", @"flags", @"next", @"child", @"unread", @"updated"];
+    for (NSDictionary *record in plist[@"folders"]) {
+        if (![record isKindOfClass:[NSDictionary class]] ||
+            ![record[@"name"] isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+        for (NSString *key in numberKeys) {
+            if (![record[key] isKindOfClass:[NSNumber class]]) {
+                return nil;
+            }
+        }
+    }
+
+    VNAFolderSnapshot *snapshot = [[self alloc] initWithFolders:@[] generation:[plist[@"generation"] integerValue]];
+    snapshot.records = plist[@"folders"];
+    snapshot.databaseAttributes = plist[@"database"];
+    return snapshot;
+}
+
+- (NSArray<Folder *> *)folders
+{
+    NSMutableArray<Folder *> *folders = [NSMutableArray arrayWithCapacity:self.records.count];
+    for (NSDictionary<NSString *, id> *record in self.records) {
+        Folder *folder = [[Folder alloc] initWithId:[record[@"id"] integerValue]
+                                           parentId:[record[@"parent"] integerValue]
+                                               name:record[@"name"]
+                                               type:[record[@"type"] integerValue]];
+        [folder setFlag:[record[@"flags"] integerValue]];
+        folder.nextSiblingId = [record[@"next"] integerValue];
+        folder.firstChildId = [record[@"child"] integerValue];
+        folder.unreadCount = [record[@"unread"] integerValue];
+        folder.lastUpdate = [NSDate dateWithTimeIntervalSince1970:[record[@"updated"] doubleValue]];
+        folder.feedURL = VNAStringOfRecord(record, @"url");
+        folder.remoteId = VNAStringOfRecord(record, @"remote");
+        folder.feedDescription = VNAStringOfRecord(record, @"description");
+        folder.homePage = VNAStringOfRecord(record, @"home");
+        folder.lastUpdateString = VNAStringOfRecord(record, @"updateString");
+        folder.entityTag = VNAStringOfRecord(record, @"etag");
+        folder.contentSize = [record[@"size"] unsignedLongLongValue];
+        folder.username = VNAStringOfRecord(record, @"user");
+        [folders addObject:folder];
+    }
+    return [folders copy];
+}
+
+- (BOOL)hasSameFoldersAsSnapshot:(VNAFolderSnapshot *)snapshot
+{
+    return [self.records isEqualToArray:snapshot.records];
+}
+
+- (BOOL)matchesDatabaseAtPath:(NSString *)path
+{
+    NSDictionary<NSString *, id> *attributes = VNAAttributesOfDatabase(path);
+    if (attributes == nil || ![attributes isEqualToDictionary:self.databaseAttributes]) {
+        return NO;
+    }
+    // Changes that were not checkpointed when Vienna quit are not part of
+    // the snapshot.
+    NSString *logPath = [path stringByAppendingString:@"-wal"];
+    NSDictionary *logAttributes = [NSFileManager.defaultManager attributesOfItemAtPath:logPath error:NULL];
+    return logAttributes == nil || logAttributes.fileSize == 0;
+}
+
+- (BOOL)writeToURL:(NSURL *)url databasePath:(NSString *)path error:(NSError **)error
+{
+    NSDictionary<NSString *, id> *attributes = VNAAttributesOfDatabase(path);
+    if (attributes == nil) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoSuchFileError userInfo:@{NSFilePathErrorKey: path}];
+        }
+        return NO;
+    }
+    NSDictionary *plist = @{
+        @"format": @(VNAFolderSnapshotFormat),
+        @"generation": @(self.generation),
+        @"database": attributes,
+        @"folders": self.records,
+    };
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:plist
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:error];
+    return data != nil && [data writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+@end
@@ -0,0 +1,36 @@
+//
+//  InstrumentedDatabaseQueue.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+@import FMDB;
+
+@class VNADatabaseInstrumentation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A database queue that reports to an instrumentation how long its blocks
+/// wait for the connection and how long they hold it. Without an
+/// instrumentation, it behaves like its superclass.
+@interface VNAInstrumentedDatabaseQueue : FMDatabaseQueue
+
+@property (nullable) VNADatabaseInstrumentation *instrumentation;
+
+@end
+
+NS_ASSUME_NONNULL_END
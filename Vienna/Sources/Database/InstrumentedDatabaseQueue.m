@@ -0,0 +1,80 @@
+//
+//  InstrumentedDatabaseQueue.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+#import "InstrumentedDatabaseQueue.h"
+
+#import "DatabaseInstrumentation.h"
+
+@implementation VNAInstrumentedDatabaseQueue
+
+- (void)inDatabase:(NS_NOESCAPE void (^)(FMDatabase *db))block
+{
+    VNADatabaseInstrumentation *instrumentation = self.instrumentation;
+    if (instrumentation == nil) {
+        [super inDatabase:block];
+        return;
+    }
+
+    uint64_t requestTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    [super inDatabase:^(FMDatabase *db) {
+        [instrumentation recordBlockRequestedAt:requestTime usingBlock:^{
+            block(db);
+        }];
+    }];
+}
+
+- (void)inTransaction:(NS_NOESCAPE void (^)(FMDatabase *db, BOOL *rollback))block
+{
+    if (self.instrumentation == nil) {
+        [super inTransaction:block];
+        return;
+    }
+    [self inInstrumentedTransaction:block];
+}
+
+- (void)inExclusiveTransaction:(NS_NOESCAPE void (^)(FMDatabase *db, BOOL *rollback))block
+{
+    if (self.instrumentation == nil) {
+        [super inExclusiveTransaction:block];
+        return;
+    }
+    [self inInstrumentedTransaction:block];
+}
+
+/* inInstrumentedTransaction
+ * Runs an exclusive transaction like the superclass does, but inside of a
+ * block of -inDatabase:, so that the time the block holds the connection
+ * includes the commit.
+ */
+- (void)inInstrumentedTransaction:(NS_NOESCAPE void (^)(FMDatabase *db, BOOL *rollback))block
+{
+    [self inDatabase:^(FMDatabase *db) {
+        BOOL shouldRollback = NO;
+        [db beginTransaction];
+        block(db, &shouldRollback);
+        if (shouldRollback) {
+            [db rollback];
+        } else {
+            [db commit];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  RetentionEngine.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+@import Foundation;
+
+#import "Database.h"
+
+@class Folder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The stages of the retention engine, for progress reports.
+typedef NS_ENUM(NSInteger, VNARetentionStage) {
+    /// Read and unflagged articles are moved to the trash. The units are
+    /// folders.
+    VNARetentionStageExpiry,
+    /// Articles in the trash are deleted. The units are articles.
+    VNARetentionStagePurge,
+    /// Guids that feeds no longer list are forgotten. The units are folders.
+    VNARetentionStageGuidHistory
+};
+
+/// How long the articles of a folder and the guids of its feed are kept.
+/// A value of 0 means no limit.
+@interface VNARetentionPolicy : NSObject
+
+/// A policy that keeps everything.
+@property (class, readonly) VNARetentionPolicy *unlimitedPolicy NS_SWIFT_NAME(unlimited);
+
+- (instancetype)initWithMaximumAge:(NSUInteger)maximumAge
+                      maximumCount:(NSUInteger)maximumCount
+                guidHistoryHorizon:(NSUInteger)guidHistoryHorizon NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The age after which read articles expire, encoded like the
+/// autoExpireDuration preference: 1000 per month plus the number of days.
+@property (readonly) NSUInteger maximumAge;
+
+/// The number of most recent articles beyond which read articles expire.
+@property (readonly) NSUInteger maximumCount;
+
+/// The number of days for which the guids that a feed no longer lists are
+/// kept, so that the articles are not added again.
+@property (readonly) NSUInteger guidHistoryHorizon;
+
+/// The date before which read articles expire, or `nil` if they do not
+/// expire by age.
+@property (readonly, nullable) NSDate *expiryDate;
+
+@end
+
+/// Applies the retention policies of the folders in batches, so that each
+/// transaction holds the database briefly however many articles expire.
+/// Only the caches of the folders that lose articles are emptied.
+@interface VNARetentionEngine : NSObject
+
+- (instancetype)initWithDatabase:(Database *)database
+                   defaultPolicy:(VNARetentionPolicy *)defaultPolicy NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The policy of the folders that have no policy of their own.
+@property (readonly) VNARetentionPolicy *defaultPolicy;
+
+/// The maximum number of rows that a transaction changes. The default is
+/// 500.
+@property NSUInteger batchSize;
+
+/// Called after each unit of work. Setting `stop` to `YES` ends the stage
+/// after the current batch.
+@property (nullable, copy) void (^progressHandler)(VNARetentionStage stage, NSUInteger completedCount, NSUInteger totalCount, BOOL *stop);
+
+/// Returns the policy that applies to the folder.
+- (VNARetentionPolicy *)policyForFolder:(Folder *)folder;
+
+/// Moves to the trash the read and unflagged articles that are older than
+/// the maximum age or beyond the maximum count of their folder.
+/// @return The number of articles moved to the trash.
+- (NSInteger)expireArticles;
+
+/// Permanently deletes the articles in the trash.
+/// @return The number of deleted articles.
+- (NSInteger)purgeDeletedArticles;
+
+/// Forgets the guids that the feeds have not listed within the horizon of
+/// their folder, unless their articles are still in the database.
+/// @return The number of forgotten guids.
+- (NSInteger)pruneGuidHistory;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,220 @@
+//
+//  RetentionEngine.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+#import "RetentionEngine.h"
+
+#import "Constants.h"
+#import "Folder.h"
+#import "NSNotificationAdditions.h"
+
+@implementation VNARetentionPolicy
+
++ (VNARetentionPolicy *)unlimitedPolicy
+{
+    return [[VNARetentionPolicy alloc] initWithMaximumAge:0
+                                             maximumCount:0
+                                       guidHistoryHorizon:0];
+}
+
+- (instancetype)initWithMaximumAge:(NSUInteger)maximumAge
+                      maximumCount:(NSUInteger)maximumCount
+                guidHistoryHorizon:(NSUInteger)guidHistoryHorizon
+{
+    self = [super init];
+    if (self) {
+        _maximumAge = maximumAge;
+        _maximumCount = maximumCount;
+        _guidHistoryHorizon = guidHistoryHorizon;
+    }
+    return self;
+}
+
+- (NSDate *)expiryDate
+{
+    if (self.maximumAge == 0) {
+        return nil;
+    }
+    NSCalendar *calendar = [NSCalendar currentCalendar];
+    NSDate *date = [calendar dateByAddingUnit:NSCalendarUnitMonth
+                                        value:-(NSInteger)(self.maximumAge / 1000)
+                                       toDate:[NSDate date]
+                                      options:0];
+    return [calendar dateByAddingUnit:NSCalendarUnitDay
+                                value:-(NSInteger)(self.maximumAge % 1000)
+                               toDate:date
+                              options:0];
+}
+
+@end
+
+@interface VNARetentionEngine ()
+
+@property (nonatomic) Database *database;
+
+@end
+
+@implementation VNARetentionEngine
+
+- (instancetype)initWithDatabase:(Database *)database
+                   defaultPolicy:(VNARetentionPolicy *)defaultPolicy
+{
+    self = [super init];
+    if (self) {
+        _database = database;
+        _defaultPolicy = defaultPolicy;
+        _batchSize = 500;
+    }
+    return self;
+}
+
+- (VNARetentionPolicy *)policyForFolder:(Folder *)folder
+{
+    return [self.database retentionPolicyForFolder:folder.itemId] ?: self.defaultPolicy;
+}
+
+- (NSInteger)expireArticles
+{
+    NSArray<Folder *> *folders = self.subscriptionFolders;
+    NSInteger countOfExpired = 0;
+    NSUInteger completedCount = 0;
+    for (Folder *folder in folders) {
+        VNARetentionPolicy *policy = [self policyForFolder:folder];
+        NSDate *expiryDate = policy.expiryDate;
+        NSInteger countOfFolderExpired = 0;
+        NSInteger count;
+        do {
+            count = [self.database expireArticlesOfFolder:folder.itemId
+                                               beforeDate:expiryDate
+                                            keepingNewest:policy.maximumCount
+                                                    limit:self.batchSize];
+            countOfFolderExpired += MAX(count, 0);
+        } while (count == (NSInteger)self.batchSize);
+
+        // The cached articles of the folder are no longer up to date.
+        if (countOfFolderExpired > 0) {
+            [folder clearCache];
+            countOfExpired += countOfFolderExpired;
+        }
+
+        completedCount++;
+        if (![self continueStage:VNARetentionStageExpiry
+                  completedCount:completedCount
+                      totalCount:folders.count]) {
+            break;
+        }
+    }
+    return countOfExpired;
+}
+
+- (NSInteger)purgeDeletedArticles
+{
+    NSUInteger totalCount = (NSUInteger)MAX(self.database.countOfDeletedArticles, 0);
+    NSMutableIndexSet *folderIds = [NSMutableIndexSet indexSet];
+    NSUInteger completedCount = 0;
+    NSInteger count;
+    do {
+        count = [self.database purgeDeletedArticlesWithLimit:self.batchSize
+                                                   folderIds:folderIds];
+        if (count <= 0) {
+            break;
+        }
+        completedCount += (NSUInteger)count;
+        // Articles may have been moved to the trash in the meantime.
+        totalCount = MAX(totalCount, completedCount);
+        if (![self continueStage:VNARetentionStagePurge
+                  completedCount:completedCount
+                      totalCount:totalCount]) {
+            break;
+        }
+    } while (count == (NSInteger)self.batchSize);
+
+    [folderIds enumerateIndexesUsingBlock:^(NSUInteger folderId, BOOL *stop) {
+        [[self.database folderFromID:(NSInteger)folderId] clearCache];
+    }];
+    if (completedCount > 0) {
+        [[NSNotificationCenter defaultCenter] vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated
+                                                                                object:@(self.database.trashFolderId)];
+    }
+    return (NSInteger)completedCount;
+}
+
+- (NSInteger)pruneGuidHistory
+{
+    NSArray<Folder *> *folders = self.subscriptionFolders;
+    NSInteger countOfPruned = 0;
+    NSUInteger completedCount = 0;
+    for (Folder *folder in folders) {
+        NSUInteger horizon = [self policyForFolder:folder].guidHistoryHorizon;
+        if (horizon > 0) {
+            NSInteger countOfFolderPruned = 0;
+            NSInteger count;
+            do {
+                count = [self.database pruneGuidHistoryOfFolder:folder.itemId
+                                                      unseenFor:horizon * 24 * 60 * 60
+                                                          limit:self.batchSize];
+                countOfFolderPruned += MAX(count, 0);
+            } while (count == (NSInteger)self.batchSize);
+
+            // The folder must not consider the forgotten guids as known.
+            if (countOfFolderPruned > 0) {
+                [folder resetGuidHistory];
+                countOfPruned += countOfFolderPruned;
+            }
+        }
+
+        completedCount++;
+        if (![self continueStage:VNARetentionStageGuidHistory
+                  completedCount:completedCount
+                      totalCount:folders.count]) {
+            break;
+        }
+    }
+    return countOfPruned;
+}
+
+/* subscriptionFolders
+ * Returns the folders that hold articles.
+ */
+- (NSArray<Folder *> *)subscriptionFolders
+{
+    NSMutableArray<Folder *> *folders = [NSMutableArray array];
+    for (Folder *folder in self.database.arrayOfAllFolders) {
+        if (folder.isSubscriptionFolder) {
+            [folders addObject:folder];
+        }
+    }
+    return folders;
+}
+
+/* continueStage
+ * Reports the progress of the stage and returns whether it should go on.
+ */
+- (BOOL)continueStage:(VNARetentionStage)stage
+       completedCount:(NSUInteger)completedCount
+           totalCount:(NSUInteger)totalCount
+{
+    BOOL stop = NO;
+    if (self.progressHandler != nil) {
+        self.progressHandler(stage, completedCount, totalCount, &stop);
+    }
+    return !stop;
+}
+
+@end
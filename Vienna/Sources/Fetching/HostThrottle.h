@@ -0,0 +1,68 @@
+//
+//  HostThrottle.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Admits operations to an operation queue so that no host receives more than
+/// a few requests at a time, or requests in quick succession. Hosts take turns,
+/// so that the operations for one host do not hold up those for other hosts
+/// while the queue has room for more.
+@interface VNAHostThrottle : NSObject
+
+- (instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The queue that runs the operations.
+@property (readonly, nonatomic) NSOperationQueue *operationQueue;
+
+/// The number of operations per host that are admitted at the same time.
+/// The default is 2.
+@property (nonatomic) NSUInteger maximumConcurrentOperationsPerHost;
+
+/// The shortest time between the admission of two operations for the same
+/// host. The default is 0.25 seconds.
+@property (nonatomic) NSTimeInterval minimumIntervalPerHost;
+
+/// Adds an operation to the queue. It does not start until it is admitted.
+/// The operation is cancelled right away if the host is held back.
+/// @param host The host of the request that the operation sends, or `nil`
+///   if the operation is not throttled, e.g. for file URLs.
+- (void)addOperation:(NSOperation *)operation
+             forHost:(nullable NSString *)host NS_SWIFT_NAME(addOperation(_:forHost:));
+
+/// Holds back the host of a response that asks the client to slow down
+/// (HTTP 429 or 503) until the time in its Retry-After header field. The
+/// operations for the host that have not been admitted yet are cancelled.
+/// Other responses are ignored.
+- (void)backOffForResponse:(NSURLResponse *)response;
+
+/// The date until which the operations for a host are held back, if any.
+- (nullable NSDate *)retryDateOfHost:(NSString *)host;
+
+/// Returns the time that a response asks the client to wait, or 0 if it does
+/// not ask to wait.
+/// See: RFC 9110, s 10.2.3
++ (NSTimeInterval)retryIntervalOfResponse:(NSHTTPURLResponse *)response;
+
+@end
+
+NS_ASSUME_NONNULL_END
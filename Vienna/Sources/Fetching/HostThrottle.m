@@ -0,0 +1,382 @@
+//
+//  HostThrottle.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "HostThrottle.h"
+
+@import os.log;
+
+#define VNA_LOG os_log_create("--", "HostThrottle")
+
+// How long a host is held back if it responds with HTTP 429 but does not
+// say for how long.
+static NSTimeInterval const VNAHostThrottleDefaultRetryInterval = 60.0;
+
+// Hosts are never held back longer than this, whatever they ask for.
+static NSTimeInterval const VNAHostThrottleMaximumRetryInterval = 60.0 * 60.0;
+
+/* VNAHostThrottleEntry
+ * An operation and the operation that it depends on until it is admitted.
+ */
+@interface VNAHostThrottleEntry : NSObject
+
+@property (nonatomic) NSOperation *operation;
+@property (nonatomic) NSOperation *gate;
+@property (nonatomic, getter=isAdmitted) BOOL admitted;
+
+@end
+
+@implementation VNAHostThrottleEntry
+
+@end
+
+/* VNAHostThrottleHost
+ * The operations for one host in the order in which they were added.
+ */
+@interface VNAHostThrottleHost : NSObject
+
+@property (nonatomic) NSString *name;
+@property (nonatomic) NSMutableArray<VNAHostThrottleEntry *> *pendingEntries;
+@property (nonatomic) NSUInteger countOfAdmittedOperations;
+@property (nonatomic) NSDate *nextAdmissionDate;
+@property (nullable, nonatomic) NSDate *retryDate;
+
+@end
+
+@implementation VNAHostThrottleHost
+
+@end
+
+@implementation VNAHostThrottle {
+    dispatch_queue_t _queue;
+    NSOperationQueue *_finishQueue;
+    NSMutableDictionary<NSString *, VNAHostThrottleHost *> *_hosts;
+    NSMutableArray<VNAHostThrottleHost *> *_hostOrder;
+    NSUInteger _nextHostIndex;
+    NSUInteger _countOfAdmittedOperations;
+    NSUInteger _maximumConcurrentOperationsPerHost;
+    NSTimeInterval _minimumIntervalPerHost;
+    BOOL _admissionScheduled;
+}
+
+/* initWithOperationQueue
+ * Initialise the throttle for the given queue.
+ */
+-(instancetype)initWithOperationQueue:(NSOperationQueue *)operationQueue
+{
+    self = [super init];
+    if (self) {
+        _operationQueue = operationQueue;
+        _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.host-throttle", DISPATCH_QUEUE_SERIAL);
+        _finishQueue = [[NSOperationQueue alloc] init];
+        _finishQueue.name = @"VNAHostThrottle queue";
+        _hosts = [[NSMutableDictionary alloc] init];
+        _hostOrder = [[NSMutableArray alloc] init];
+        _maximumConcurrentOperationsPerHost = 2;
+        _minimumIntervalPerHost = 0.25;
+    }
+    return self;
+}
+
+// MARK: Limits
+
+-(NSUInteger)maximumConcurrentOperationsPerHost
+{
+    __block NSUInteger count;
+    dispatch_sync(_queue, ^{
+        count = self->_maximumConcurrentOperationsPerHost;
+    });
+    return count;
+}
+
+-(void)setMaximumConcurrentOperationsPerHost:(NSUInteger)count
+{
+    dispatch_async(_queue, ^{
+        self->_maximumConcurrentOperationsPerHost = MAX(count, 1);
+        [self admitOperations];
+    });
+}
+
+-(NSTimeInterval)minimumIntervalPerHost
+{
+    __block NSTimeInterval interval;
+    dispatch_sync(_queue, ^{
+        interval = self->_minimumIntervalPerHost;
+    });
+    return interval;
+}
+
+-(void)setMinimumIntervalPerHost:(NSTimeInterval)interval
+{
+    dispatch_async(_queue, ^{
+        self->_minimumIntervalPerHost = MAX(interval, 0);
+    });
+}
+
+// MARK: Operations
+
+/* addOperation
+ * The operation is added to the queue right away, so that it can be found
+ * and cancelled there, but it depends on a gate operation that is only run
+ * when the operation is admitted. A second operation that depends on it
+ * frees its place when it finishes. The operations for a host that is held
+ * back are cancelled instead of waiting in the queue.
+ */
+-(void)addOperation:(NSOperation *)operation forHost:(NSString *)host
+{
+    if (host.length == 0) {
+        [self.operationQueue addOperation:operation];
+        return;
+    }
+
+    VNAHostThrottleEntry *entry = [[VNAHostThrottleEntry alloc] init];
+    entry.operation = operation;
+    entry.gate = [NSBlockOperation blockOperationWithBlock:^{}];
+    [operation addDependency:entry.gate];
+
+    NSString *hostName = host.lowercaseString;
+    dispatch_sync(_queue, ^{
+        VNAHostThrottleHost *throttleHost = [self hostNamed:hostName];
+        if (throttleHost.retryDate.timeIntervalSinceNow > 0) {
+            [operation cancel];
+        }
+        [throttleHost.pendingEntries addObject:entry];
+    });
+
+    __weak typeof(self) weakSelf = self;
+    NSOperation *finishOperation = [NSBlockOperation blockOperationWithBlock:^{
+        [weakSelf entryDidFinish:entry hostName:hostName];
+    }];
+    [finishOperation addDependency:operation];
+    [_finishQueue addOperation:finishOperation];
+    [self.operationQueue addOperation:operation];
+
+    dispatch_async(_queue, ^{
+        [self admitOperations];
+    });
+}
+
+-(void)entryDidFinish:(VNAHostThrottleEntry *)entry hostName:(NSString *)hostName
+{
+    dispatch_async(_queue, ^{
+        VNAHostThrottleHost *throttleHost = self->_hosts[hostName];
+        if (entry.isAdmitted) {
+            throttleHost.countOfAdmittedOperations -= 1;
+            self->_countOfAdmittedOperations -= 1;
+        } else {
+            // The operation was cancelled before it was admitted.
+            [throttleHost.pendingEntries removeObjectIdenticalTo:entry];
+        }
+        [self removeHostIfIdle:throttleHost];
+        [self admitOperations];
+    });
+}
+
+/* admitOperations
+ * Admits one operation per host in turn, until every host has reached its
+ * limit, the queue is full or nothing is left. Must be called on the queue.
+ */
+-(void)admitOperations
+{
+    NSDate *now = [NSDate date];
+    NSDate *nextAdmissionDate = nil;
+    NSInteger maximumCount = self.operationQueue.maxConcurrentOperationCount;
+    BOOL hasAdmitted = YES;
+
+    while (hasAdmitted) {
+        hasAdmitted = NO;
+        NSUInteger countOfHosts = _hostOrder.count;
+        for (NSUInteger i = 0; i < countOfHosts; i++) {
+            if (maximumCount > 0 && _countOfAdmittedOperations >= (NSUInteger)maximumCount) {
+                return;
+            }
+            NSUInteger index = (_nextHostIndex + i) % countOfHosts;
+            VNAHostThrottleHost *throttleHost = _hostOrder[index];
+            [self discardCancelledEntriesOfHost:throttleHost];
+            if (throttleHost.pendingEntries.count == 0 ||
+                throttleHost.countOfAdmittedOperations >= _maximumConcurrentOperationsPerHost) {
+                continue;
+            }
+            if ([throttleHost.nextAdmissionDate compare:now] == NSOrderedDescending) {
+                if (!nextAdmissionDate || [throttleHost.nextAdmissionDate compare:nextAdmissionDate] == NSOrderedAscending) {
+                    nextAdmissionDate = throttleHost.nextAdmissionDate;
+                }
+                continue;
+            }
+
+            VNAHostThrottleEntry *entry = throttleHost.pendingEntries.firstObject;
+            [throttleHost.pendingEntries removeObjectAtIndex:0];
+            entry.admitted = YES;
+            throttleHost.countOfAdmittedOperations += 1;
+            throttleHost.nextAdmissionDate = [now dateByAddingTimeInterval:_minimumIntervalPerHost];
+            _countOfAdmittedOperations += 1;
+            [entry.gate start];
+
+            // The next pass starts with the host after this one.
+            _nextHostIndex = (index + 1) % countOfHosts;
+            hasAdmitted = YES;
+            break;
+        }
+    }
+
+    if (nextAdmissionDate && !_admissionScheduled) {
+        _admissionScheduled = YES;
+        NSTimeInterval delay = MAX(0, nextAdmissionDate.timeIntervalSinceNow);
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+            self->_admissionScheduled = NO;
+            [self admitOperations];
+        });
+    }
+}
+
+/* discardCancelledEntriesOfHost
+ * Cancelled operations do not wait for their turn. They finish without
+ * sending a request as soon as their gate is out of the way.
+ */
+-(void)discardCancelledEntriesOfHost:(VNAHostThrottleHost *)throttleHost
+{
+    NSIndexSet *indexes = [throttleHost.pendingEntries indexesOfObjectsPassingTest:^BOOL(VNAHostThrottleEntry *entry, NSUInteger index, BOOL *stop) {
+        return entry.operation.isCancelled;
+    }];
+    if (indexes.count == 0) {
+        return;
+    }
+    for (VNAHostThrottleEntry *entry in [throttleHost.pendingEntries objectsAtIndexes:indexes]) {
+        [entry.gate start];
+    }
+    [throttleHost.pendingEntries removeObjectsAtIndexes:indexes];
+}
+
+-(VNAHostThrottleHost *)hostNamed:(NSString *)hostName
+{
+    VNAHostThrottleHost *throttleHost = _hosts[hostName];
+    if (!throttleHost) {
+        throttleHost = [[VNAHostThrottleHost alloc] init];
+        throttleHost.name = hostName;
+        throttleHost.pendingEntries = [[NSMutableArray alloc] init];
+        throttleHost.nextAdmissionDate = [NSDate distantPast];
+        _hosts[hostName] = throttleHost;
+        [_hostOrder addObject:throttleHost];
+    }
+    return throttleHost;
+}
+
+/* removeHostIfIdle
+ * Forgets a host that has nothing to do, unless it is held back.
+ */
+-(void)removeHostIfIdle:(VNAHostThrottleHost *)throttleHost
+{
+    if (!throttleHost || throttleHost.pendingEntries.count > 0 || throttleHost.countOfAdmittedOperations > 0 ||
+        throttleHost.nextAdmissionDate.timeIntervalSinceNow > 0 || throttleHost.retryDate.timeIntervalSinceNow > 0) {
+        return;
+    }
+    NSUInteger index = [_hostOrder indexOfObjectIdenticalTo:throttleHost];
+    if (index != NSNotFound) {
+        [_hostOrder removeObjectAtIndex:index];
+        if (index < _nextHostIndex) {
+            _nextHostIndex -= 1;
+        }
+    }
+    [_hosts removeObjectForKey:throttleHost.name];
+}
+
+// MARK: Retry-After
+
+/* backOffForResponse
+ * The operations for the host that are still waiting for their turn are
+ * cancelled, so that they do not keep the queue busy until the host may be
+ * asked again. Those that are already running finish as usual.
+ */
+-(void)backOffForResponse:(NSURLResponse *)response
+{
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return;
+    }
+    NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+    NSString *hostName = httpResponse.URL.host.lowercaseString;
+    if (hostName.length == 0 || (httpResponse.statusCode != 429 && httpResponse.statusCode != 503)) {
+        return;
+    }
+    NSTimeInterval interval = [VNAHostThrottle retryIntervalOfResponse:httpResponse];
+    if (interval <= 0) {
+        if (httpResponse.statusCode != 429) {
+            return;
+        }
+        interval = VNAHostThrottleDefaultRetryInterval;
+    }
+    interval = MIN(interval, VNAHostThrottleMaximumRetryInterval);
+
+    os_log_info(VNA_LOG, "Holding back requests to %{public}@ for %.0f seconds", hostName, interval);
+    dispatch_async(_queue, ^{
+        VNAHostThrottleHost *throttleHost = [self hostNamed:hostName];
+        NSDate *retryDate = [NSDate dateWithTimeIntervalSinceNow:interval];
+        if (!throttleHost.retryDate || [retryDate compare:throttleHost.retryDate] == NSOrderedDescending) {
+            throttleHost.retryDate = retryDate;
+        }
+        for (VNAHostThrottleEntry *entry in throttleHost.pendingEntries) {
+            [entry.operation cancel];
+        }
+        [self admitOperations];
+    });
+}
+
+-(NSDate *)retryDateOfHost:(NSString *)host
+{
+    __block NSDate *retryDate;
+    dispatch_sync(_queue, ^{
+        NSDate *hostRetryDate = self->_hosts[host.lowercaseString].retryDate;
+        if (hostRetryDate.timeIntervalSinceNow > 0) {
+            retryDate = hostRetryDate;
+        }
+    });
+    return retryDate;
+}
+
+/* retryIntervalOfResponse
+ * Retry-After is either a number of seconds or an HTTP date.
+ */
++(NSTimeInterval)retryIntervalOfResponse:(NSHTTPURLResponse *)response
+{
+    NSString *retryAfter = [[response valueForHTTPHeaderField:@"Retry-After"]
+                            stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+    if (retryAfter.length == 0) {
+        return 0;
+    }
+    NSCharacterSet *nonDigits = NSCharacterSet.decimalDigitCharacterSet.invertedSet;
+    if ([retryAfter rangeOfCharacterFromSet:nonDigits].location == NSNotFound) {
+        return retryAfter.doubleValue;
+    }
+
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    NSDate *retryDate = [formatter dateFromString:retryAfter];
+    if (!retryDate) {
+        return 0;
+    }
+    NSString *dateString = [response valueForHTTPHeaderField:@"Date"];
+    NSDate *date = dateString ? [formatter dateFromString:dateString] : nil;
+    return MAX(0, [retryDate timeIntervalSinceDate:date ?: [NSDate date]]);
+}
+
+@end
@@ -652,14 +652,7 @@ typedef NS_ENUM (NSInteger, OpenReaderStatus) {
             // Here's where we add the articles to the database
             if (articleArray.count > 0) {
                 [refreshedFolder resetArticleStatuses];
-                NSArray *guidHistory = [dbManager guidHistoryForFolderId:refreshedFolder.itemId];
-
-                for (Article *article in articleArray) {
-                    if ([refreshedFolder createArticle:article guidHistory:guidHistory])
-                    {
-                        newArticlesFromFeed++;
-                    }
-                }
+                newArticlesFromFeed = [refreshedFolder createArticles:articleArray];
 
                 // Set the last update date for this folder.
                 [dbManager setLastUpdate:[NSDate date] forFolder:refreshedFolder.itemId];
@@ -748,14 +741,13 @@ typedef NS_ENUM (NSInteger, OpenReaderStatus) {
                     }
 
                     [guidArray addObject:guid];
-                    // now, mark relevant articles unread
-                    [refreshedFolder articleFromGuid:guid].read = NO;
                 }
 
-                [[Database sharedManager] markUnreadArticlesFromFolder:refreshedFolder guidArray:guidArray];
-                // reset starred statuses in cache : we will receive in -StarredRequestDone: the updated list
-                for (Article *article in refreshedFolder.articles) {
-                    article.flagged = NO;
+                // only the articles whose status changed in the database are updated in the cache
+                NSSet *unreadGuids = [NSSet setWithArray:guidArray];
+                NSArray *changedGuids = [[Database sharedManager] markUnreadArticlesFromFolder:refreshedFolder guidArray:guidArray];
+                for (NSString *guid in changedGuids) {
+                    [refreshedFolder articleFromGuid:guid].read = ![unreadGuids containsObject:guid];
                 }
             } @catch (NSException *exception) {
                 [aItem appendDetail:[NSString stringWithFormat:@"%@ %@", NSLocalizedString(@"Error", nil), exception]];
@@ -807,10 +799,13 @@ typedef NS_ENUM (NSInteger, OpenReaderStatus) {
                         guid = [NSString stringWithFormat:@"tag:google.com,2005:reader/item/%016qx", (long long)shortId];
                     }
                     [guidArray addObject:guid];
-                    [refreshedFolder articleFromGuid:guid].flagged = YES;
                 }
 
-                [[Database sharedManager] markStarredArticlesFromFolder:refreshedFolder guidArray:guidArray];
+                NSSet *starredGuids = [NSSet setWithArray:guidArray];
+                NSArray *changedGuids = [[Database sharedManager] markStarredArticlesFromFolder:refreshedFolder guidArray:guidArray];
+                for (NSString *guid in changedGuids) {
+                    [refreshedFolder articleFromGuid:guid].flagged = [starredGuids containsObject:guid];
+                }
             } @catch (NSException *exception) {
                 [aItem appendDetail:[NSString stringWithFormat:@"%@ %@", NSLocalizedString(@"Error", nil), exception]];
                 dispatch_async(dispatch_get_main_queue(), ^{
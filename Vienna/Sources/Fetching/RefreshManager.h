@@ -20,15 +20,32 @@
 
 @import Foundation;
 
+@class Database;
 @class Folder;
+@class VNARefreshScheduler;
 
 @interface RefreshManager : NSObject <NSURLSessionTaskDelegate>
 
 @property (class, readonly, nonatomic) RefreshManager *sharedManager;
 
+// Stores the feeds in the given database. The shared manager uses the shared
+// database and the default session configuration.
+-(instancetype)initWithDatabase:(Database *)database
+           sessionConfiguration:(NSURLSessionConfiguration *)configuration NS_DESIGNATED_INITIALIZER;
+
 @property (readonly, copy) NSString *statusMessage;
 @property (nonatomic, getter=isConnecting, readonly) BOOL connecting;
 @property (nonatomic, readonly) NSUInteger countOfNewArticles;
+// Conditional requests of the last refresh: the feeds that were not modified
+// (HTTP 304), the feeds that were downloaded (HTTP 200 or 226) and the size of
+// the last download of the feeds that were not modified, which is stored with
+// the feeds
+@property (nonatomic, readonly) NSUInteger countOfUnmodifiedFeeds;
+@property (nonatomic, readonly) NSUInteger countOfDownloadedFeeds;
+@property (nonatomic, readonly) unsigned long long countOfBytesSaved;
+// Told about the outcome of every feed refresh, so that it can schedule the
+// next one
+@property (weak, nonatomic) VNARefreshScheduler *scheduler;
 
 -(void)refreshFolderIconCacheForSubscriptions:(NSArray *)foldersArray;
 -(void)refreshSubscriptions:(NSArray *)foldersArray ignoringSubscriptionStatus:(BOOL)ignoreSubStatus;
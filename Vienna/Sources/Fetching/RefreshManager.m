@@ -39,6 +39,9 @@
 #import "XMLFeed.h"
 #import "XMLFeedParser.h"
 #import "HelperFunctions.h"
+#import "HostThrottle.h"
+#import "RefreshPipeline.h"
+#import "RefreshScheduler.h"
 
 typedef NS_ENUM (NSInteger, Redirect301Status) {
     HTTP301Unknown = 0,
@@ -57,6 +60,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 @property (nonatomic) Redirect301Status redirect301Status;
 @property (nonatomic) NSMutableArray * redirect301WaitQueue;
 @property (nonatomic, readonly) NSURLSession * urlSession;
+@property (nonatomic, readonly) Database * database;
 
 -(BOOL)isRefreshingFolder:(Folder *)folder ofType:(RefreshTypes)type;
 -(void)getCredentialsForFolder;
@@ -65,17 +69,28 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 -(void)pumpSubscriptionRefresh:(Folder *)folder shouldForceRefresh:(BOOL)force;
 -(void)pumpFolderIconRefresh:(Folder *)folder;
 -(void)refreshFeed:(Folder *)folder fromURL:(NSURL *)url withLog:(ActivityItem *)aItem shouldForceRefresh:(BOOL)force;
+-(void)folderRefreshDeferred:(NSMutableURLRequest *)request untilDate:(NSDate *)retryDate;
 -(NSString *)getRedirectURL:(NSData *)data;
+-(NSOperation *)addConnection:(NSURLRequest *)urlRequest
+                    throttled:(BOOL)throttled
+            completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler;
 
 @end
 
 @implementation RefreshManager {
     NSUInteger countOfNewArticles;
+    NSUInteger countOfUnmodifiedFeeds;
+    NSUInteger countOfDownloadedFeeds;
+    unsigned long long countOfBytesSaved;
     NSMutableArray *authQueue;
     FeedCredentials *credentialsController;
     BOOL hasStarted;
     NSString *statusMessageDuringRefresh;
     NSOperationQueue *networkQueue;
+    VNAHostThrottle *hostThrottle;
+    VNARefreshPipeline *refreshPipeline;
+    BOOL isConnectionsQueueSuspended;
+    BOOL isRefreshPipelineBacklogged;
     dispatch_queue_t _queue;
 }
 
@@ -83,18 +98,37 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
  * Initialise the class.
  */
 -(instancetype)init
+{
+    return [self initWithDatabase:[Database sharedManager]
+             sessionConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]];
+}
+
+/* initWithDatabase
+ * Initialise the class with the database that stores the feeds and the
+ * configuration of the session that downloads them.
+ */
+-(instancetype)initWithDatabase:(Database *)database sessionConfiguration:(NSURLSessionConfiguration *)configuration
 {
     if ((self = [super init]) != nil) {
+        _database = database;
         countOfNewArticles = 0;
         authQueue = [[NSMutableArray alloc] init];
         statusMessageDuringRefresh = nil;
         networkQueue = [[NSOperationQueue alloc] init];
         networkQueue.name = @"VNAHTTPSession queue";
         networkQueue.maxConcurrentOperationCount = [[Preferences standardPreferences] integerForKey:MAPref_ConcurrentDownloads];
-        NSURLSessionConfiguration * config = [NSURLSessionConfiguration defaultSessionConfiguration];
+        // Requests to the same host take turns with those to other hosts, so
+        // that feeds on a busy host neither flood it nor hold up the others.
+        NSInteger downloadsPerHost = [[Preferences standardPreferences] integerForKey:MAPref_ConcurrentDownloadsPerHost];
+        hostThrottle = [[VNAHostThrottle alloc] initWithOperationQueue:networkQueue];
+        hostThrottle.maximumConcurrentOperationsPerHost = (NSUInteger)MAX(downloadsPerHost, 1);
+        hostThrottle.minimumIntervalPerHost = [[Preferences standardPreferences] integerForKey:MAPref_HostRequestInterval] / 1000.0;
+        NSURLSessionConfiguration * config = [configuration copy];
         config.timeoutIntervalForResource = 300;
         config.HTTPAdditionalHeaders = @{@"User-Agent": userAgent()};
-        config.HTTPMaximumConnectionsPerHost = 6;
+        // The host throttle limits the feed requests per host. The requests
+        // to a sync server are not throttled and need more connections.
+        config.HTTPMaximumConnectionsPerHost = MAX(downloadsPerHost, 6);
         config.HTTPShouldUsePipelining = YES;
         _urlSession = [NSURLSession sessionWithConfiguration:config delegate:self delegateQueue:[NSOperationQueue mainQueue]];
 
@@ -105,11 +139,21 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
         [nc addObserver:self selector:@selector(handleWillDeleteFolder:) name:VNADatabaseWillDeleteFolderNotification object:nil];
         [nc addObserver:self selector:@selector(handleChangeConcurrentDownloads:) name:MA_Notify_ConcurrentDownloadsChange object:nil];
         _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.refresh", NULL);
+        // Downloaded feeds are parsed on several cores at once. Only the
+        // database updates run one at a time, on _queue.
+        refreshPipeline = [[VNARefreshPipeline alloc] initWithCommitQueue:_queue];
+        __weak typeof(self) weakSelf = self;
+        refreshPipeline.backlogHandler = ^(BOOL isBacklogged) {
+            [weakSelf setRefreshPipelineBacklogged:isBacklogged];
+        };
+        refreshPipeline.drainHandler = ^{
+            [weakSelf finishConnectionQueue];
+        };
         _redirect301WaitQueue = [[NSMutableArray alloc] init];
         hasStarted = NO;
     }
     return self;
-} // init
+} // initWithDatabase
 
 /* sharedManager
  * Returns the single instance of the refresh manager.
@@ -140,7 +184,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
  */
 -(void)handleWillDeleteFolder:(NSNotification *)nc
 {
-    Folder * folder = [[Database sharedManager] folderFromID:[nc.object integerValue]];
+    Folder * folder = [self.database folderFromID:[nc.object integerValue]];
     if (folder != nil) {
         for (TRVSURLSessionOperation *theRequest in networkQueue.operations) {
             NSMutableURLRequest *urlRequest = (NSMutableURLRequest *)(theRequest.task.originalRequest);
@@ -178,7 +222,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 -(void)handleGotAuthenticationForFolder:(NSNotification *)nc
 {
     Folder * folder = (Folder *)nc.object;
-    [[Database sharedManager] clearFlag:VNAFolderFlagNeedCredentials forFolder:folder.itemId];
+    [self.database clearFlag:VNAFolderFlagNeedCredentials forFolder:folder.itemId];
     [authQueue removeObject:folder];
     [self refreshSubscriptions:@[folder] ignoringSubscriptionStatus:YES];
 
@@ -206,7 +250,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     for (Folder * folder in foldersArray) {
         VNAFolderType folderType = folder.type;
         if (folderType == VNAFolderTypeGroup) {
-            [self forceRefreshSubscriptionForFolders:[[Database sharedManager] arrayOfFolders:folder.itemId]];
+            [self forceRefreshSubscriptionForFolders:[self.database arrayOfFolders:folder.itemId]];
         } else if (folderType == VNAFolderTypeRSS || folderType == VNAFolderTypeOpenReader) {
             if (![self isRefreshingFolder:folder ofType:MA_Refresh_Feed] &&
                 ![self isRefreshingFolder:folder ofType:MA_Refresh_OpenReaderFeed])
@@ -226,7 +270,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 
     for (Folder * folder in foldersArray) {
         if (folder.isGroupFolder) {
-            [self refreshSubscriptions:[[Database sharedManager] arrayOfFolders:folder.itemId] ignoringSubscriptionStatus:NO];
+            [self refreshSubscriptions:[self.database arrayOfFolders:folder.itemId] ignoringSubscriptionStatus:NO];
         } else if (folder.isRSSFolder) {
             if ((!folder.isUnsubscribed || ignoreSubStatus) && ![self isRefreshingFolder:folder ofType:MA_Refresh_Feed]) {
                 [self pumpSubscriptionRefresh:folder shouldForceRefresh:NO];
@@ -266,7 +310,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 
     for (Folder * folder in foldersArray) {
         if (folder.type == VNAFolderTypeGroup) {
-            [self refreshFolderIconCacheForSubscriptions:[[Database sharedManager] arrayOfFolders:folder.itemId]];
+            [self refreshFolderIconCacheForSubscriptions:[self.database arrayOfFolders:folder.itemId]];
         } else if (folder.type == VNAFolderTypeRSS || folder.type == VNAFolderTypeOpenReader) {
             [self refreshFavIconForFolder:folder];
         }
@@ -287,7 +331,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     if ((folder.type == VNAFolderTypeRSS || folder.type == VNAFolderTypeOpenReader) &&
         (folder.homePage == nil || folder.homePage.vna_isBlank))
     {
-        [[Database sharedManager] clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
+        [self.database clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
         return;
     }
 
@@ -329,6 +373,27 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     return countOfNewArticles;
 }
 
+/* countOfUnmodifiedFeeds
+ */
+-(NSUInteger)countOfUnmodifiedFeeds
+{
+    return countOfUnmodifiedFeeds;
+}
+
+/* countOfDownloadedFeeds
+ */
+-(NSUInteger)countOfDownloadedFeeds
+{
+    return countOfDownloadedFeeds;
+}
+
+/* countOfBytesSaved
+ */
+-(unsigned long long)countOfBytesSaved
+{
+    return countOfBytesSaved;
+}
+
 /* getCredentialsForFolder
  * Initiate the UI to request the credentials for the specified folder.
  */
@@ -398,7 +463,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
             if (error) {
                 [aItem appendDetail:[NSString stringWithFormat:@"%@ %@",
                                      NSLocalizedString(@"Error retrieving RSS Icon:", nil), error.localizedDescription ]];
-                [[Database sharedManager] clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
+                [weakSelf.database clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
             } else {
                 [weakSelf setFolderUpdatingFlag:folder flag:NO];
                 if (((NSHTTPURLResponse *)response).statusCode == 404) {
@@ -426,7 +491,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
                                                                                      nil), ((NSHTTPURLResponse *)response).statusCode]];
                 }
 
-                [[Database sharedManager] clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
+                [weakSelf.database clearFlag:VNAFolderFlagCheckForImage forFolder:folder.itemId];
             }
     }];
 } // pumpFolderIconRefresh
@@ -497,8 +562,18 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     if (folder.type == VNAFolderTypeRSS) {
         myRequest = [NSMutableURLRequest requestWithURL:url];
         NSString * theLastUpdateString = folder.lastUpdateString;
-        if (![theLastUpdateString isEqualToString:@""] && !force) {
-            [myRequest setValue:theLastUpdateString forHTTPHeaderField:@"If-Modified-Since"];
+        NSString * theEntityTag = folder.entityTag;
+        if ((theLastUpdateString.length > 0 || theEntityTag.length > 0) && !force) {
+            // Both validators are sent. A server evaluates If-None-Match
+            // first and ignores If-Modified-Since if it is present, which
+            // helps with feeds whose Last-Modified changes at every request.
+            // See: RFC 9110, s 13.2.2
+            if (theEntityTag.length > 0) {
+                [myRequest setValue:theEntityTag forHTTPHeaderField:@"If-None-Match"];
+            }
+            if (theLastUpdateString.length > 0) {
+                [myRequest setValue:theLastUpdateString forHTTPHeaderField:@"If-Modified-Since"];
+            }
             [myRequest setValue:@"feed" forHTTPHeaderField:@"A-IM"];
         } else if (force) {
             // Override the cache policy of the NSURLSession instance to ensure
@@ -516,20 +591,47 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 		}
 
 
-        __weak typeof(self)weakSelf = self;
-        [self addConnection:myRequest completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
-                if (error) {
-                    [weakSelf folderRefreshFailed:myRequest error:error];
-                } else {
-                    [weakSelf folderRefreshCompleted:myRequest response:response data:data];
+        // A host that asked to be left alone is not sent the request. The
+        // feed goes back to the scheduler until the host may be asked again.
+        NSDate *retryDate = [hostThrottle retryDateOfHost:url.host];
+        if (retryDate) {
+            [self folderRefreshDeferred:myRequest untilDate:retryDate];
+        } else {
+            __weak typeof(self)weakSelf = self;
+            VNAHostThrottle *throttle = hostThrottle;
+            NSOperation *op = [self addConnection:myRequest throttled:YES completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+                    if (error.code == NSURLErrorCancelled && [throttle retryDateOfHost:url.host]) {
+                        // Handled when the operation finishes.
+                        return;
+                    }
+                    if (error) {
+                        [weakSelf folderRefreshFailed:myRequest error:error];
+                    } else {
+                        [weakSelf folderRefreshCompleted:myRequest response:response data:data];
+                    }
+                    }];
+            // The throttle cancels the requests that wait for a host when
+            // it asks to be left alone.
+            NSOperation *deferOperation = [NSBlockOperation blockOperationWithBlock:^{
+                NSDate *hostRetryDate = [throttle retryDateOfHost:url.host];
+                if (op.isCancelled && hostRetryDate) {
+                    [weakSelf folderRefreshDeferred:myRequest untilDate:hostRetryDate];
                 }
-                }];
+            }];
+            [deferOperation addDependency:op];
+            [[NSOperationQueue mainQueue] addOperation:deferOperation];
+        }
     } else {     // Open Reader feed
         [[OpenReader sharedManager] refreshFeed:folder withLog:(ActivityItem *)aItem shouldIgnoreArticleLimit:force];
     }
     if (!hasStarted) {
         hasStarted = YES;
         countOfNewArticles = 0;
+        dispatch_async(_queue, ^{
+            self->countOfUnmodifiedFeeds = 0;
+            self->countOfDownloadedFeeds = 0;
+            self->countOfBytesSaved = 0;
+        });
         [[OpenReader sharedManager] resetCountOfNewArticles];
         [[NSNotificationCenter defaultCenter] postNotificationName:MA_Notify_RefreshStatus object:nil];
     }
@@ -557,6 +659,9 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     }
     ActivityItem *aItem = (ActivityItem *)((NSDictionary *)[request vna_userInfo])[@"log"];
     [self setFolderErrorFlag:folder flag:YES];
+    if (error.code != NSURLErrorCancelled) {
+        [self.scheduler feedDidFailToRefresh:folder.itemId];
+    }
     [aItem appendDetail:[NSString stringWithFormat:@"%@ %@", NSLocalizedString(@"Error retrieving RSS feed:", nil),
                          error.localizedDescription ]];
     [aItem setStatus:NSLocalizedString(@"Error", nil)];
@@ -565,93 +670,149 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     [nc vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
 } // folderRefreshFailed
 
+/* folderRefreshDeferred
+ * Called when a feed was not refreshed because its host asked to be left
+ * alone for a while. This is not an error.
+ */
+-(void)folderRefreshDeferred:(NSMutableURLRequest *)request untilDate:(NSDate *)retryDate
+{
+    Folder * folder = ((NSDictionary *)[request vna_userInfo])[@"folder"];
+    ActivityItem *aItem = (ActivityItem *)((NSDictionary *)[request vna_userInfo])[@"log"];
+    os_log_debug(VNA_LOG, "Refresh of %@ deferred until %@", request.URL, retryDate);
+    [self.scheduler deferRefreshOfFeed:folder.itemId untilDate:retryDate];
+    [aItem appendDetail:NSLocalizedString(@"The server asked to be contacted later", nil)];
+    [aItem setStatus:NSLocalizedString(@"Postponed", nil)];
+    [self setFolderUpdatingFlag:folder flag:NO];
+    NSNotificationCenter *nc = NSNotificationCenter.defaultCenter;
+    [nc vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
+} // folderRefreshDeferred
+
 /* folderRefreshCompleted
- * Called when a folder refresh completed.
+ * Called when a folder refresh completed. The feed is parsed on a worker of
+ * the refresh pipeline, then stored on _queue. The responses for the same
+ * folder are stored in the order in which they arrived.
  */
 -(void)folderRefreshCompleted:(NSMutableURLRequest *)connector response:(NSURLResponse *)response data:(NSData *)receivedData
 {
-    dispatch_async(_queue, ^() {
-        // TODO : refactor code to separate feed refresh code and UI
-
-        Folder * folder = (Folder *)((NSDictionary *)[connector vna_userInfo])[@"folder"];
-        ActivityItem *connectorItem = ((NSDictionary *)[connector vna_userInfo])[@"log"];
-        NSURL * url = connector.URL;
-        NSInteger folderId = folder.itemId;
-        Database *dbManager = [Database sharedManager];
-        NSInteger responseStatusCode;
-        NSString * lastModifiedString;
-
-        // hack for handling file:// URLs
-        if (url.fileURL) {
-            NSFileManager *fileManager = [NSFileManager defaultManager];
-            NSString * filePath = [url.path stringByRemovingPercentEncoding];
-            BOOL isDirectory = NO;
-            if ([fileManager fileExistsAtPath:filePath isDirectory:&isDirectory] && !isDirectory) {
-                responseStatusCode = 200;
-                lastModifiedString = [[fileManager attributesOfItemAtPath:filePath error:nil] fileModificationDate].description;
-            } else {
-                responseStatusCode = 404;
-            }
+    Folder * folder = (Folder *)((NSDictionary *)[connector vna_userInfo])[@"folder"];
+    NSURL * url = connector.URL;
+    NSString * mimeType = response.MIMEType;
+    NSInteger responseStatusCode = url.fileURL ? 200 : ((NSHTTPURLResponse *)response).statusCode;
+    BOOL hasFeedData = (responseStatusCode == 200 || responseStatusCode == 226) && receivedData.length > 0;
+
+    [refreshPipeline addTaskForKey:@(folder.itemId)
+                           process:^id {
+        return hasFeedData ? [self parseFeedData:receivedData forFolder:folder url:url mimeType:mimeType] : nil;
+    }
+                            commit:^(NSDictionary *parsedFeed) {
+        [self commitFolderRefresh:connector response:response data:receivedData parsedFeed:parsedFeed];
+    }];
+} // folderRefreshCompleted
+
+/* commitFolderRefresh
+ * Stores the result of a folder refresh. This runs on _queue.
+ */
+-(void)commitFolderRefresh:(NSMutableURLRequest *)connector
+                  response:(NSURLResponse *)response
+                      data:(NSData *)receivedData
+                parsedFeed:(NSDictionary *)parsedFeed
+{
+    // TODO : refactor code to separate feed refresh code and UI
+
+    Folder * folder = (Folder *)((NSDictionary *)[connector vna_userInfo])[@"folder"];
+    ActivityItem *connectorItem = ((NSDictionary *)[connector vna_userInfo])[@"log"];
+    NSURL * url = connector.URL;
+    NSInteger folderId = folder.itemId;
+    Database *dbManager = self.database;
+    NSInteger responseStatusCode;
+    NSString * lastModifiedString;
+    NSString * entityTag;
+    NSHTTPURLResponse *httpURLResponse = nil;
+
+    // hack for handling file:// URLs
+    if (url.fileURL) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        NSString * filePath = [url.path stringByRemovingPercentEncoding];
+        BOOL isDirectory = NO;
+        if ([fileManager fileExistsAtPath:filePath isDirectory:&isDirectory] && !isDirectory) {
+            responseStatusCode = 200;
+            lastModifiedString = [[fileManager attributesOfItemAtPath:filePath error:nil] fileModificationDate].description;
         } else {
-            NSHTTPURLResponse *httpURLResponse = (NSHTTPURLResponse *)response;
-            responseStatusCode = httpURLResponse.statusCode;
-
-            // Store the "Last-Modified" HTTP header field if present, but only
-            // if the response does not contain the "no-store" directive in the
-            // "Cache-Control" HTTP header field.
-            // See: RFC 9111, s 5.2.2.5
-            NSString *cacheControlHeaderField =
-                [httpURLResponse valueForHTTPHeaderField:@"Cache-Control"];
-            NSRange noStoreDirectiveRange =
-                [cacheControlHeaderField rangeOfString:@"no-store"
-                                               options:NSCaseInsensitiveSearch];
-            if (noStoreDirectiveRange.length == 0) {
-                lastModifiedString =
-                    [httpURLResponse valueForHTTPHeaderField:@"Last-Modified"];
-            }
+            responseStatusCode = 404;
         }
-
-        if (responseStatusCode == 304) {
-            // No modification from last check
-            [self setFolderErrorFlag:folder flag:NO];
-            [connectorItem appendDetail:NSLocalizedString(@"Got HTTP status 304 - No news from last check", nil)];
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [connectorItem setStatus:NSLocalizedString(@"No new articles available", nil)];
-            });
-            [self setFolderUpdatingFlag:folder flag:NO];
-            NSNotificationCenter *nc = NSNotificationCenter.defaultCenter;
-            [nc vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
-            return;
-        } else if (responseStatusCode == 410) {
-            // We got HTTP 410 which means the feed has been intentionally removed so unsubscribe the feed.
-            [dbManager setFlag:VNAFolderFlagUnsubscribed forFolder:folderId];
-
-        } else if (responseStatusCode == 200 || responseStatusCode == 226) {
-            if (receivedData != nil) {
-                [self finalizeFolderRefresh:@{
-                     @"folder": folder,
-                     @"log": connectorItem,
-                     @"url": url,
-                     @"data": receivedData,
-                     @"mimeType": SafeString(response.MIMEType),
-                     @"lastModifiedString": SafeString(lastModifiedString),
-                 }];
-            }
-        } else { //other HTTP response codes like 404, 403...
-            [connectorItem appendDetail:[NSString stringWithFormat:NSLocalizedString(@"HTTP code %ld reported from server", nil),
-                                         responseStatusCode]];
-            [connectorItem appendDetail:[NSHTTPURLResponse localizedStringForStatusCode:responseStatusCode]];
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [connectorItem setStatus:NSLocalizedString(@"Error", nil)];
-            });
-            [self setFolderErrorFlag:folder flag:YES];
+    } else {
+        httpURLResponse = (NSHTTPURLResponse *)response;
+        responseStatusCode = httpURLResponse.statusCode;
+
+        // Store the "Last-Modified" and "ETag" HTTP header fields if
+        // present, but only if the response does not contain the
+        // "no-store" directive in the "Cache-Control" HTTP header field.
+        // See: RFC 9111, s 5.2.2.5
+        NSString *cacheControlHeaderField =
+            [httpURLResponse valueForHTTPHeaderField:@"Cache-Control"];
+        NSRange noStoreDirectiveRange =
+            [cacheControlHeaderField rangeOfString:@"no-store"
+                                           options:NSCaseInsensitiveSearch];
+        if (noStoreDirectiveRange.length == 0) {
+            lastModifiedString =
+                [httpURLResponse valueForHTTPHeaderField:@"Last-Modified"];
+            entityTag = [httpURLResponse valueForHTTPHeaderField:@"ETag"];
         }
+    }
 
+    if (responseStatusCode == 304) {
+        // No modification from last check. A 304 response may carry a
+        // new entity tag for the stored response.
+        // See: RFC 9111, s 4.3.4
+        if (entityTag.length > 0) {
+            [dbManager setEntityTag:entityTag forFolder:folderId];
+        }
+        self->countOfUnmodifiedFeeds += 1;
+        self->countOfBytesSaved += folder.contentSize;
+        [self.scheduler feedDidRefresh:folderId response:httpURLResponse timeToLive:-1];
+        [self setFolderErrorFlag:folder flag:NO];
+        [connectorItem appendDetail:NSLocalizedString(@"Got HTTP status 304 - No news from last check", nil)];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [connectorItem setStatus:NSLocalizedString(@"No new articles available", nil)];
+        });
         [self setFolderUpdatingFlag:folder flag:NO];
         NSNotificationCenter *nc = NSNotificationCenter.defaultCenter;
         [nc vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
-    });     //block for dispatch_async on _queue
-} // folderRefreshCompleted
+        return;
+    } else if (responseStatusCode == 410) {
+        // We got HTTP 410 which means the feed has been intentionally removed so unsubscribe the feed.
+        [dbManager setFlag:VNAFolderFlagUnsubscribed forFolder:folderId];
+
+    } else if (responseStatusCode == 200 || responseStatusCode == 226) {
+        self->countOfDownloadedFeeds += 1;
+        if (receivedData != nil) {
+            [dbManager setContentSize:receivedData.length forFolder:folderId];
+            [self finalizeFolderRefresh:@{
+                 @"folder": folder,
+                 @"log": connectorItem,
+                 @"url": url,
+                 @"data": receivedData,
+                 @"lastModifiedString": SafeString(lastModifiedString),
+                 @"entityTag": SafeString(entityTag),
+                 @"response": httpURLResponse ?: [NSNull null],
+                 @"parsedFeed": parsedFeed ?: @{},
+             }];
+        }
+    } else { //other HTTP response codes like 404, 403...
+        [connectorItem appendDetail:[NSString stringWithFormat:NSLocalizedString(@"HTTP code %ld reported from server", nil),
+                                     responseStatusCode]];
+        [connectorItem appendDetail:[NSHTTPURLResponse localizedStringForStatusCode:responseStatusCode]];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [connectorItem setStatus:NSLocalizedString(@"Error", nil)];
+        });
+        [self setFolderErrorFlag:folder flag:YES];
+        [self.scheduler feedDidFailToRefresh:folderId];
+    }
+
+    [self setFolderUpdatingFlag:folder flag:NO];
+    NSNotificationCenter *nc = NSNotificationCenter.defaultCenter;
+    [nc vna_postNotificationOnMainThreadWithName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
+} // commitFolderRefresh
 
 - (void)refreshImageForFolderIfNeeded:(Folder *)folder {
     if ((folder.flags & VNAFolderFlagCheckForImage)) {
@@ -705,6 +866,102 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     return articleGuid;
 }
 
+/* parseFeedData
+ * Parses the data of a feed and converts its items to articles. This runs on
+ * a worker of the refresh pipeline, at the same time as other feeds are
+ * parsed, so it must not change the folder or the database.
+ */
+-(NSDictionary *)parseFeedData:(NSData *)receivedData forFolder:(Folder *)folder url:(NSURL *)url mimeType:(NSString *)mimeType
+{
+    NSInteger folderId = folder.itemId;
+
+    // An HTML redirect is followed instead of parsed, unless it loops.
+    NSString * redirectURL = [self getRedirectURL:receivedData];
+    if (redirectURL != nil && ![redirectURL isEqualToString:url.absoluteString]) {
+        return @{@"redirectURL": redirectURL};
+    }
+
+    id<VNAFeed> newFeed;
+    NSError *error;
+    if ([mimeType containsString:@"application/feed+json"] ||
+        [mimeType containsString:@"application/json"]) {
+        VNAJSONFeedParser *parser = [[VNAJSONFeedParser alloc] init];
+        newFeed = [parser feedWithJSONData:receivedData error:&error];
+    } else {
+        VNAXMLFeedParser *parser = [[VNAXMLFeedParser alloc] init];
+        newFeed = [parser feedWithXMLData:receivedData error:&error];
+    }
+    if (!newFeed) {
+        NSMutableDictionary *parsedFeed = [NSMutableDictionary dictionary];
+        parsedFeed[@"redirectURL"] = redirectURL;
+        parsedFeed[@"error"] = error;
+        return parsedFeed;
+    }
+
+    NSString * feedLink = newFeed.homePageURL;
+
+    // Synthesize feed link if it is missing
+    if (feedLink == nil || feedLink.vna_isBlank) {
+        feedLink = folder.feedURL.vna_baseURL;
+    }
+    if (feedLink != nil && ![feedLink hasPrefix:@"http:"] && ![feedLink hasPrefix:@"https:"]) {
+        feedLink = [NSURL URLWithString:feedLink relativeToURL:url].absoluteString;
+    }
+
+    // We'll be collecting articles into this array
+    NSMutableArray *articleArray = [NSMutableArray array];
+    NSMutableArray *articleGuidArray = [NSMutableArray array];
+
+    // Parse off items.
+
+    for (id<VNAFeedItem> newsItem in newFeed.items) {
+
+        NSString * articleGuid = [self getOrCalculateArticleGuid:newsItem folderId:folderId articles:articleArray articleGuidArray:articleGuidArray];
+        [articleGuidArray addObject:articleGuid];
+
+        Article * article = [[Article alloc] initWithGUID:articleGuid];
+        article.folderId = folderId;
+        article.author = newsItem.authors;
+        article.body = newsItem.content;
+        if (!newsItem.title || newsItem.title.vna_isBlank) {
+            NSString *newTitle = newsItem.content.vna_titleTextFromHTML.vna_stringByUnescapingExtendedCharacters;
+            if (newTitle.vna_isBlank) {
+                article.title = NSLocalizedString(@"(No title)", @"Fallback for feed items without a title");
+            } else {
+                article.title = newTitle;
+            }
+        } else {
+            article.title = newsItem.title;
+        }
+        NSString * articleLink = newsItem.url;
+        if (![articleLink hasPrefix:@"http:"] && ![articleLink hasPrefix:@"https:"]) {
+            articleLink = [NSURL URLWithString:articleLink relativeToURL:url].absoluteString;
+        }
+        if (articleLink == nil) {
+            articleLink = feedLink;
+        }
+        article.link = articleLink;
+        article.publicationDate = newsItem.publicationDate;
+        article.lastUpdate = newsItem.modificationDate;
+        NSString * enclosureLink = newsItem.enclosure;
+        if ([enclosureLink isNotEqualTo:@""] && ![enclosureLink hasPrefix:@"http:"] && ![enclosureLink hasPrefix:@"https:"]) {
+            enclosureLink = [NSURL URLWithString:enclosureLink relativeToURL:url].absoluteString;
+        }
+        article.enclosure = enclosureLink;
+        if ([enclosureLink isNotEqualTo:@""]) {
+            [article setHasEnclosure:YES];
+        }
+        [articleArray addObject:article];
+    }
+
+    NSMutableDictionary *parsedFeed = [NSMutableDictionary dictionary];
+    parsedFeed[@"redirectURL"] = redirectURL;
+    parsedFeed[@"feed"] = newFeed;
+    parsedFeed[@"feedLink"] = feedLink;
+    parsedFeed[@"articles"] = articleArray;
+    return parsedFeed;
+}
+
 -(void)finalizeFolderRefresh:(NSDictionary *)parameters
 {
     if (!parameters) {
@@ -712,15 +969,18 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     }
     Folder * folder = (Folder *)parameters[@"folder"];
     NSInteger folderId = folder.itemId;
-    Database * dbManager = [Database sharedManager];
+    Database * dbManager = self.database;
     ActivityItem *connectorItem = parameters[@"log"];
     NSURL * url = parameters[@"url"];
     NSData * receivedData = parameters[@"data"];
     NSString * lastModifiedString = parameters[@"lastModifiedString"];
+    NSString * entityTag = parameters[@"entityTag"];
+    NSHTTPURLResponse *response = [parameters[@"response"] isKindOfClass:[NSHTTPURLResponse class]] ? parameters[@"response"] : nil;
+    NSDictionary * parsedFeed = parameters[@"parsedFeed"];
 
     // Check whether this is an HTML redirect. If so, create a new connection using
     // the redirect.
-    NSString * redirectURL = [self getRedirectURL:receivedData];
+    NSString * redirectURL = parsedFeed[@"redirectURL"];
     if (redirectURL != nil) {
         if ([redirectURL isEqualToString:url.absoluteString]) {
             // To prevent an infinite loop, don't redirect to the same URL.
@@ -757,17 +1017,8 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
         [receivedData writeToFile:feedSourcePath options:NSDataWritingAtomic error:NULL];
     }
 
-    id<VNAFeed> newFeed;
-    NSError *error;
-    NSString *mimeType = parameters[@"mimeType"];
-    if ([mimeType containsString:@"application/feed+json"] ||
-        [mimeType containsString:@"application/json"]) {
-        VNAJSONFeedParser *parser = [[VNAJSONFeedParser alloc] init];
-        newFeed = [parser feedWithJSONData:receivedData error:&error];
-    } else {
-        VNAXMLFeedParser *parser = [[VNAXMLFeedParser alloc] init];
-        newFeed = [parser feedWithXMLData:receivedData error:&error];
-    }
+    id<VNAFeed> newFeed = parsedFeed[@"feed"];
+    NSError *error = parsedFeed[@"error"];
     if (!newFeed) {
         NSString *errorDebugDescription = error.userInfo[NSDebugDescriptionErrorKey];
         if (errorDebugDescription) {
@@ -775,6 +1026,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
         }
         // Mark the feed as failed
         [self setFolderErrorFlag:folder flag:YES];
+        [self.scheduler feedDidFailToRefresh:folderId];
         [connectorItem appendDetail:error.localizedDescription];
         dispatch_async(dispatch_get_main_queue(), ^{
             [connectorItem setStatus:NSLocalizedString(@"Error parsing data in feed", nil)];
@@ -792,15 +1044,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     // Extract the latest title and description
     NSString * feedTitle = newFeed.title;
     NSString * feedDescription = newFeed.feedDescription;
-    NSString * feedLink = newFeed.homePageURL;
-
-    // Synthesize feed link if it is missing
-    if (feedLink == nil || feedLink.vna_isBlank) {
-        feedLink = folder.feedURL.vna_baseURL;
-    }
-    if (feedLink != nil && ![feedLink hasPrefix:@"http:"] && ![feedLink hasPrefix:@"https:"]) {
-        feedLink = [NSURL URLWithString:feedLink relativeToURL:url].absoluteString;
-    }
+    NSString * feedLink = parsedFeed[@"feedLink"];
 
     if (feedTitle != nil  && !feedTitle.vna_isBlank && [folder.name hasPrefix:[Database untitledFeedFolderName]]) {
         // If there's an existing feed with this title, make ours unique
@@ -825,72 +1069,23 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     // lastModifiedString may be empty, but it should be recorded anyway to
     // overwrite a previous value.
     [dbManager setLastUpdateString:lastModifiedString forFolder:folderId];
+    [dbManager setEntityTag:entityTag forFolder:folderId];
 
     if (newFeed.items.count == 0) {
         // Mark the feed as empty
         dispatch_async(dispatch_get_main_queue(), ^{
             [connectorItem setStatus:NSLocalizedString(@"No articles in feed", nil)];
         });
+        [self.scheduler feedDidRefresh:folderId response:response timeToLive:newFeed.timeToLive];
         return;
     }
 
-    // We'll be collecting articles into this array
-    NSMutableArray *articleArray = [NSMutableArray array];
-    NSMutableArray *articleGuidArray = [NSMutableArray array];
-
-    // Parse off items.
-
-    for (id<VNAFeedItem> newsItem in newFeed.items) {
-
-        NSString * articleGuid = [self getOrCalculateArticleGuid:newsItem folderId:folderId articles:articleArray articleGuidArray:articleGuidArray];
-        [articleGuidArray addObject:articleGuid];
-
-        Article * article = [[Article alloc] initWithGUID:articleGuid];
-        article.folderId = folderId;
-        article.author = newsItem.authors;
-        article.body = newsItem.content;
-        if (!newsItem.title || newsItem.title.vna_isBlank) {
-            NSString *newTitle = newsItem.content.vna_titleTextFromHTML.vna_stringByUnescapingExtendedCharacters;
-            if (newTitle.vna_isBlank) {
-                article.title = NSLocalizedString(@"(No title)", @"Fallback for feed items without a title");
-            } else {
-                article.title = newTitle;
-            }
-        } else {
-            article.title = newsItem.title;
-        }
-        NSString * articleLink = newsItem.url;
-        if (![articleLink hasPrefix:@"http:"] && ![articleLink hasPrefix:@"https:"]) {
-            articleLink = [NSURL URLWithString:articleLink relativeToURL:url].absoluteString;
-        }
-        if (articleLink == nil) {
-            articleLink = feedLink;
-        }
-        article.link = articleLink;
-        article.publicationDate = newsItem.publicationDate;
-        article.lastUpdate = newsItem.modificationDate;
-        NSString * enclosureLink = newsItem.enclosure;
-        if ([enclosureLink isNotEqualTo:@""] && ![enclosureLink hasPrefix:@"http:"] && ![enclosureLink hasPrefix:@"https:"]) {
-            enclosureLink = [NSURL URLWithString:enclosureLink relativeToURL:url].absoluteString;
-        }
-        article.enclosure = enclosureLink;
-        if ([enclosureLink isNotEqualTo:@""]) {
-            [article setHasEnclosure:YES];
-        }
-        [articleArray addObject:article];
-    }
-
+    NSArray *articleArray = parsedFeed[@"articles"];
 
     // Here's where we add the articles to the database
     if (articleArray.count > 0u) {
         [folder resetArticleStatuses];
-        NSArray *guidHistory = [dbManager guidHistoryForFolderId:folderId];
-        for (Article * article in articleArray) {
-            if ([folder createArticle:article guidHistory:guidHistory])
-            {
-                ++newArticlesFromFeed;
-            }
-        }
+        newArticlesFromFeed = [folder createArticles:articleArray];
     }
 
     if (newArticlesFromFeed > 0u) {
@@ -900,6 +1095,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     // Mark the feed as succeeded
     [self setFolderErrorFlag:folder flag:NO];
     [folder clearNonPersistedFlag:VNAFolderFlagBuggySync];
+    [self.scheduler feedDidRefresh:folderId response:response timeToLive:newFeed.timeToLive];
 
     // Send status to the activity log
     if (newArticlesFromFeed == 0) {
@@ -1132,7 +1328,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
         NSString * theNewURLString = theConnector.currentRequest.URL.absoluteString;
         NSMutableURLRequest * originalRequest = (NSMutableURLRequest *)theConnector.originalRequest;
         Folder * theFolder = (Folder *)((NSDictionary *)[originalRequest vna_userInfo])[@"folder"];
-        [[Database sharedManager] setFeedURL:theNewURLString forFolder:theFolder.itemId];
+        [self.database setFeedURL:theNewURLString forFolder:theFolder.itemId];
         ActivityItem *connectorItem = ((NSDictionary *)[originalRequest vna_userInfo])[@"log"];
         [connectorItem appendDetail:[NSString stringWithFormat:NSLocalizedString(@"Feed URL updated to %@",
                                                                                  nil), theNewURLString]];
@@ -1155,8 +1351,32 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 -(NSOperation *)addConnection:(NSURLRequest *)urlRequest completionHandler:(void (^)(NSData *data, NSURLResponse *response,
                                                                                             NSError *error))completionHandler
 {
+    return [self addConnection:urlRequest throttled:NO completionHandler:completionHandler];
+} // addConnection
+
+/* addConnection:throttled:
+ * Only the feeds that are fetched from their own hosts are throttled. The
+ * requests to a sync server, which fetch many feeds at once, are not held
+ * to the limits for a single host.
+ */
+-(NSOperation *)addConnection:(NSURLRequest *)urlRequest
+                    throttled:(BOOL)throttled
+            completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler
+{
+    // A host that asks to slow down is held back before the operation
+    // finishes and makes room for the next request to it.
+    VNAHostThrottle *throttle = throttled ? hostThrottle : nil;
     TRVSURLSessionOperation *op =
-        [[TRVSURLSessionOperation alloc] initWithSession:self.urlSession request:urlRequest completionHandler:completionHandler];
+        [[TRVSURLSessionOperation alloc] initWithSession:self.urlSession
+                                                 request:urlRequest
+                                       completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+            if (response) {
+                [throttle backOffForResponse:response];
+            }
+            if (completionHandler) {
+                completionHandler(data, response, error);
+            }
+        }];
     NSOperation *completionOperation = [NSBlockOperation blockOperationWithBlock:^{
                                                          if (self->networkQueue.operationCount == 0) {
                                                             [self performSelector:@selector(finishConnectionQueue) withObject:nil afterDelay:0.1];
@@ -1166,9 +1386,13 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
     [completionOperation addDependency:op];
     [[NSOperationQueue mainQueue] addOperation:completionOperation];
 
-    [networkQueue addOperation:op];
+    if (throttled) {
+        [hostThrottle addOperation:op forHost:urlRequest.URL.host];
+    } else {
+        [networkQueue addOperation:op];
+    }
     return op;
-} // addConnection
+} // addConnection:throttled:
 
 /* suspendConnectionsQueue
  * suspend the connections queue that we manage.
@@ -1176,6 +1400,7 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
  */
 -(void)suspendConnectionsQueue
 {
+    isConnectionsQueueSuspended = YES;
     [networkQueue setSuspended:YES];
 }
 
@@ -1185,7 +1410,21 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
  */
 -(void)resumeConnectionsQueue
 {
-    [networkQueue setSuspended:NO];
+    isConnectionsQueueSuspended = NO;
+    [networkQueue setSuspended:isRefreshPipelineBacklogged];
+}
+
+/* setRefreshPipelineBacklogged
+ * Holds back the downloads while the downloaded feeds wait to be parsed,
+ * so that their data does not pile up in memory.
+ */
+-(void)setRefreshPipelineBacklogged:(BOOL)isBacklogged
+{
+    if (isBacklogged) {
+        os_log_debug(VNA_LOG, "Suspending downloads until the downloaded feeds are processed");
+    }
+    isRefreshPipelineBacklogged = isBacklogged;
+    [networkQueue setSuspended:isConnectionsQueueSuspended || isRefreshPipelineBacklogged];
 }
 
 -(BOOL)isConnecting
@@ -1205,16 +1444,24 @@ typedef NS_ENUM (NSInteger, Redirect301Status) {
 
 /* finishConnectionQueue
  * this is run on the main thread
- * at the exhaustion of the network queue
+ * at the exhaustion of the network queue, and again when the refresh
+ * pipeline has stored the last downloaded feed. The refresh is only
+ * completed when both are done.
  */
 -(void)finishConnectionQueue
 {
-    if (hasStarted && networkQueue.operationCount == 0) {
+    if (hasStarted && networkQueue.operationCount == 0 && refreshPipeline.countOfPendingTasks == 0) {
         NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
         [nc postNotificationName:MA_Notify_RefreshStatus object:nil];
         statusMessageDuringRefresh = NSLocalizedString(@"Refresh completed", nil);
         hasStarted = NO;
-        os_log_info(VNA_LOG, "Finished refreshing");
+        dispatch_async(_queue, ^{
+            os_log_info(VNA_LOG, "Finished refreshing: %lu feeds not modified, %lu feeds downloaded, %{public}@ saved",
+                        (unsigned long)self->countOfUnmodifiedFeeds,
+                        (unsigned long)self->countOfDownloadedFeeds,
+                        [NSByteCountFormatter stringFromByteCount:(long long)self->countOfBytesSaved
+                                                       countStyle:NSByteCountFormatterCountStyleFile]);
+        });
     } else {
         statusMessageDuringRefresh = @"";
     }
@@ -0,0 +1,71 @@
+//
+//  RefreshPipeline.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Runs the work that follows the download of a feed in two stages. The
+/// process stage, e.g. parsing, runs for several tasks at a time on a pool of
+/// workers. The commit stage, e.g. writing to the database, runs on a serial
+/// queue, one task at a time. The tasks that have the same key are committed
+/// in the order in which they were added, whichever finishes processing first.
+@interface VNARefreshPipeline : NSObject
+
+- (instancetype)initWithCommitQueue:(dispatch_queue_t)commitQueue NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The serial queue that runs the commit stage.
+@property (readonly, nonatomic) dispatch_queue_t commitQueue;
+
+/// The number of tasks that are processed at the same time. The default is
+/// the number of active processors.
+@property (nonatomic) NSUInteger maximumConcurrentTasks;
+
+/// The number of tasks that are added but not committed yet, above which the
+/// pipeline is backlogged. The default is twice the number of active
+/// processors.
+@property (nonatomic) NSUInteger maximumPendingTasks;
+
+/// Called on the main queue with `YES` when the pipeline is backlogged, and
+/// with `NO` when half of its pending tasks have been committed since. The
+/// owner should stop adding tasks in the meantime, e.g. by suspending its
+/// downloads, so that the data waiting to be processed stays bounded.
+@property (nullable, copy) void (^backlogHandler)(BOOL isBacklogged);
+
+/// Called on the main queue when the last pending task has been committed.
+@property (nullable, copy) void (^drainHandler)(void);
+
+/// The number of tasks that are added but not committed yet.
+@property (readonly) NSUInteger countOfPendingTasks;
+
+/// Adds a task.
+/// @param key The key of the tasks that are committed in order, e.g. the
+///   identifier of a feed.
+/// @param processBlock The block that runs on a worker. Its result is passed
+///   to the commit block.
+/// @param commitBlock The block that runs on the commit queue.
+- (void)addTaskForKey:(id<NSCopying>)key
+              process:(id _Nullable (^)(void))processBlock
+               commit:(void (^)(id _Nullable result))commitBlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,210 @@
+//
+//  RefreshPipeline.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "RefreshPipeline.h"
+
+/* VNARefreshPipelineTask
+ * A task whose result is kept until the tasks that were added before it with
+ * the same key are committed.
+ */
+@interface VNARefreshPipelineTask : NSObject
+
+@property (copy, nonatomic) void (^commitBlock)(id _Nullable result);
+@property (nullable, nonatomic) id result;
+@property (nonatomic, getter=isProcessed) BOOL processed;
+
+@end
+
+@implementation VNARefreshPipelineTask
+
+@end
+
+@implementation VNARefreshPipeline {
+    dispatch_queue_t _queue;
+    NSOperationQueue *_workerQueue;
+    NSMutableDictionary<id<NSCopying>, NSMutableArray<VNARefreshPipelineTask *> *> *_tasks;
+    NSUInteger _countOfPendingTasks;
+    NSUInteger _maximumPendingTasks;
+    BOOL _backlogged;
+}
+
+/* initWithCommitQueue
+ * Initialise the pipeline with the serial queue of the commit stage.
+ */
+-(instancetype)initWithCommitQueue:(dispatch_queue_t)commitQueue
+{
+    self = [super init];
+    if (self) {
+        NSUInteger countOfProcessors = MAX(NSProcessInfo.processInfo.activeProcessorCount, 1);
+        _commitQueue = commitQueue;
+        _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.refresh-pipeline", DISPATCH_QUEUE_SERIAL);
+        _workerQueue = [[NSOperationQueue alloc] init];
+        _workerQueue.name = @"VNARefreshPipeline queue";
+        _workerQueue.maxConcurrentOperationCount = (NSInteger)countOfProcessors;
+        _workerQueue.qualityOfService = NSQualityOfServiceUtility;
+        _tasks = [[NSMutableDictionary alloc] init];
+        _maximumPendingTasks = 2 * countOfProcessors;
+    }
+    return self;
+}
+
+// MARK: Limits
+
+-(NSUInteger)maximumConcurrentTasks
+{
+    return (NSUInteger)_workerQueue.maxConcurrentOperationCount;
+}
+
+-(void)setMaximumConcurrentTasks:(NSUInteger)maximumConcurrentTasks
+{
+    _workerQueue.maxConcurrentOperationCount = (NSInteger)MAX(maximumConcurrentTasks, 1);
+}
+
+-(NSUInteger)maximumPendingTasks
+{
+    __block NSUInteger count;
+    dispatch_sync(_queue, ^{
+        count = self->_maximumPendingTasks;
+    });
+    return count;
+}
+
+-(void)setMaximumPendingTasks:(NSUInteger)maximumPendingTasks
+{
+    dispatch_async(_queue, ^{
+        self->_maximumPendingTasks = MAX(maximumPendingTasks, 1);
+        [self updateBacklog];
+    });
+}
+
+-(NSUInteger)countOfPendingTasks
+{
+    __block NSUInteger count;
+    dispatch_sync(_queue, ^{
+        count = self->_countOfPendingTasks;
+    });
+    return count;
+}
+
+// MARK: Tasks
+
+-(void)addTaskForKey:(id<NSCopying>)key
+             process:(id _Nullable (^)(void))processBlock
+              commit:(void (^)(id _Nullable result))commitBlock
+{
+    VNARefreshPipelineTask *task = [[VNARefreshPipelineTask alloc] init];
+    task.commitBlock = commitBlock;
+
+    // The task is queued under its key before it can be processed, so that
+    // the order of the tasks with the same key is the order of this call.
+    dispatch_sync(_queue, ^{
+        NSMutableArray<VNARefreshPipelineTask *> *tasks = self->_tasks[key];
+        if (!tasks) {
+            tasks = [[NSMutableArray alloc] init];
+            self->_tasks[key] = tasks;
+        }
+        [tasks addObject:task];
+        self->_countOfPendingTasks += 1;
+        [self updateBacklog];
+    });
+
+    [_workerQueue addOperationWithBlock:^{
+        id result;
+        @autoreleasepool {
+            result = processBlock();
+        }
+        dispatch_sync(self->_queue, ^{
+            task.result = result;
+            task.processed = YES;
+        });
+        dispatch_async(self.commitQueue, ^{
+            [self commitTasksForKey:key];
+        });
+    }];
+}
+
+/* commitTasksForKey
+ * Commits the processed tasks at the head of the tasks for a key. A task
+ * that is processed before the ones added ahead of it waits for them; it is
+ * committed when the last of them is.
+ */
+-(void)commitTasksForKey:(id<NSCopying>)key
+{
+    while (YES) {
+        __block VNARefreshPipelineTask *task = nil;
+        dispatch_sync(_queue, ^{
+            NSMutableArray<VNARefreshPipelineTask *> *tasks = self->_tasks[key];
+            if (tasks.firstObject.isProcessed) {
+                task = tasks.firstObject;
+                [tasks removeObjectAtIndex:0];
+                if (tasks.count == 0) {
+                    [self->_tasks removeObjectForKey:key];
+                }
+            }
+        });
+        if (!task) {
+            return;
+        }
+
+        @autoreleasepool {
+            task.commitBlock(task.result);
+        }
+
+        __block BOOL drained;
+        dispatch_sync(_queue, ^{
+            self->_countOfPendingTasks -= 1;
+            drained = self->_countOfPendingTasks == 0;
+            [self updateBacklog];
+        });
+        void (^drainHandler)(void) = self.drainHandler;
+        if (drained && drainHandler) {
+            dispatch_async(dispatch_get_main_queue(), drainHandler);
+        }
+    }
+}
+
+/* updateBacklog
+ * Tells the owner when the pipeline becomes backlogged, and when it has
+ * caught up again. The pending tasks have to drop to half of the limit
+ * before the pipeline takes more, so that the owner does not toggle at
+ * every task. Runs on the private queue, which keeps the calls to the
+ * handler in order.
+ */
+-(void)updateBacklog
+{
+    BOOL backlogged;
+    if (_backlogged) {
+        backlogged = _countOfPendingTasks > _maximumPendingTasks / 2;
+    } else {
+        backlogged = _countOfPendingTasks >= _maximumPendingTasks;
+    }
+    if (backlogged == _backlogged) {
+        return;
+    }
+    _backlogged = backlogged;
+
+    void (^backlogHandler)(BOOL) = self.backlogHandler;
+    if (backlogHandler) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            backlogHandler(backlogged);
+        });
+    }
+}
+
+@end
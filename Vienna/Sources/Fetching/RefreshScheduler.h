@@ -0,0 +1,101 @@
+//
+//  RefreshScheduler.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+@class Database;
+@class Folder;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Schedules the refresh of every feed on its own. The interval of a feed
+/// follows how often it publishes articles, how long the server and the feed
+/// allow it to be cached, and how many of its last refreshes failed. Feeds
+/// are handed to the refresh handler as they become due, instead of all
+/// feeds at once.
+@interface VNARefreshScheduler : NSObject
+
+- (instancetype)initWithDatabase:(Database *)database
+                    baseInterval:(NSTimeInterval)baseInterval NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The shortest interval between two refreshes of a feed. Feeds that publish
+/// more often than this are refreshed at this interval.
+@property (nonatomic) NSTimeInterval baseInterval;
+
+/// The longest interval between two refreshes of a feed. The default is one
+/// day. It is never shorter than the base interval.
+@property (nonatomic) NSTimeInterval maximumInterval;
+
+/// Refreshes the feeds that are due. It is called on the main queue and
+/// returns `NO` if the feeds could not be refreshed, e.g. because the network
+/// is not reachable, in which case they are handed over again a minute later.
+@property (nullable, copy) BOOL (^refreshHandler)(NSArray<Folder *> *folders);
+
+/// Schedules feeds that were not refreshed in this session. Their first
+/// refreshes are spread over their intervals.
+- (void)scheduleFeeds:(NSArray<Folder *> *)folders;
+
+/// Stops handing over feeds.
+- (void)cancel;
+
+/// Reschedules a feed after a successful refresh.
+/// @param folderId The feed that was refreshed.
+/// @param response The response, whose caching headers may delay the next
+///   refresh.
+/// @param timeToLive The time to live that the feed declared, 0 if it did
+///   not declare one, or a negative value if the feed was not downloaded.
+- (void)feedDidRefresh:(NSInteger)folderId
+              response:(nullable NSHTTPURLResponse *)response
+            timeToLive:(NSTimeInterval)timeToLive;
+
+/// Reschedules a feed after a failed refresh. The interval grows with every
+/// failure in a row.
+- (void)feedDidFailToRefresh:(NSInteger)folderId;
+
+/// Reschedules a feed that was not refreshed because its host asked to be
+/// left alone for a while. It does not count as a failure.
+/// @param folderId The feed that was not refreshed.
+/// @param retryDate The time when the host may be asked again.
+- (void)deferRefreshOfFeed:(NSInteger)folderId untilDate:(NSDate *)retryDate;
+
+/// The time when a feed is due next, or `nil` if it is not scheduled.
+- (nullable NSDate *)dueDateOfFeed:(NSInteger)folderId;
+
+/// Returns how long a response is fresh according to its Cache-Control or
+/// Expires header fields, or 0 if it must be revalidated.
+/// See: RFC 9111, s 4.2.1
++ (NSTimeInterval)freshnessLifetimeOfResponse:(NSHTTPURLResponse *)response;
+
+/// Returns the interval until the next refresh of a feed.
+/// @param publicationInterval The average interval between the articles of
+///   the feed. Feeds are refreshed twice in that interval.
+/// @param freshnessLifetime How long the last response is fresh.
+/// @param timeToLive The time to live that the feed declared.
+/// @param countOfFailures The number of failed refreshes in a row. Each one
+///   doubles the interval.
+- (NSTimeInterval)refreshIntervalWithPublicationInterval:(NSTimeInterval)publicationInterval
+                                       freshnessLifetime:(NSTimeInterval)freshnessLifetime
+                                              timeToLive:(NSTimeInterval)timeToLive
+                                         countOfFailures:(NSUInteger)countOfFailures;
+
+@end
+
+NS_ASSUME_NONNULL_END
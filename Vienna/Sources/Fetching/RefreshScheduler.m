@@ -0,0 +1,426 @@
+//
+//  RefreshScheduler.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "RefreshScheduler.h"
+
+@import os.log;
+
+#import "Database.h"
+#import "Folder.h"
+
+#define VNA_LOG os_log_create("--", "RefreshScheduler")
+
+// Feeds that could not be handed over are tried again after this delay.
+static NSTimeInterval const VNARefreshRetryInterval = 60.0;
+
+// The interval stops growing after this many failures in a row.
+static NSUInteger const VNARefreshMaximumBackoffExponent = 6;
+
+// Intervals are varied by up to this fraction so that feeds which were
+// scheduled together drift apart.
+static double const VNARefreshJitter = 0.05;
+
+/* VNARefreshEntry
+ * The schedule of one feed.
+ */
+@interface VNARefreshEntry : NSObject
+
+@property (nonatomic) NSInteger folderId;
+@property (nonatomic) NSDate *dueDate;
+@property (nonatomic) NSUInteger countOfFailures;
+@property (nonatomic) NSTimeInterval freshnessLifetime;
+@property (nonatomic) NSTimeInterval timeToLive;
+@property (nonatomic) NSTimeInterval publicationInterval;
+
+@end
+
+@implementation VNARefreshEntry
+
+@end
+
+@implementation VNARefreshScheduler {
+    Database *_database;
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    NSMutableArray<VNARefreshEntry *> *_entries;
+    NSMutableDictionary<NSNumber *, VNARefreshEntry *> *_entriesByFolderId;
+    NSTimeInterval _baseInterval;
+    NSTimeInterval _maximumInterval;
+}
+
+/* initWithDatabase
+ * Initialise the scheduler with an empty schedule.
+ */
+-(instancetype)initWithDatabase:(Database *)database baseInterval:(NSTimeInterval)baseInterval
+{
+    self = [super init];
+    if (self) {
+        _database = database;
+        _baseInterval = baseInterval;
+        _maximumInterval = MAX(24 * 60 * 60, baseInterval);
+        _entries = [[NSMutableArray alloc] init];
+        _entriesByFolderId = [[NSMutableDictionary alloc] init];
+        _queue = dispatch_queue_create("uk.co.opencommunity.vienna2.refresh-scheduler", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    if (_timer) {
+        dispatch_source_cancel(_timer);
+    }
+}
+
+// MARK: Intervals
+
+-(NSTimeInterval)baseInterval
+{
+    __block NSTimeInterval interval;
+    dispatch_sync(_queue, ^{
+        interval = self->_baseInterval;
+    });
+    return interval;
+}
+
+/* setBaseInterval
+ * Changes the base interval and moves every feed to its new due date.
+ */
+-(void)setBaseInterval:(NSTimeInterval)baseInterval
+{
+    dispatch_async(_queue, ^{
+        if (self->_baseInterval == baseInterval) {
+            return;
+        }
+        // The part of the old interval of a feed that has already passed
+        // counts towards the new one.
+        NSArray<VNARefreshEntry *> *entries = self->_entries.copy;
+        NSMutableArray<NSNumber *> *elapsedIntervals = [NSMutableArray arrayWithCapacity:entries.count];
+        for (VNARefreshEntry *entry in entries) {
+            NSTimeInterval oldInterval = [self intervalOfEntry:entry];
+            [elapsedIntervals addObject:@(MAX(0, oldInterval - entry.dueDate.timeIntervalSinceNow))];
+        }
+        self->_baseInterval = baseInterval;
+        self->_maximumInterval = MAX(self->_maximumInterval, baseInterval);
+        [entries enumerateObjectsUsingBlock:^(VNARefreshEntry *entry, NSUInteger index, BOOL *stop) {
+            NSTimeInterval interval = [self intervalOfEntry:entry];
+            NSTimeInterval elapsed = elapsedIntervals[index].doubleValue;
+            [self enqueueEntry:entry
+                       dueDate:[NSDate dateWithTimeIntervalSinceNow:MAX(0, interval - elapsed)]];
+        }];
+        [self armTimer];
+    });
+}
+
+-(NSTimeInterval)maximumInterval
+{
+    __block NSTimeInterval interval;
+    dispatch_sync(_queue, ^{
+        interval = self->_maximumInterval;
+    });
+    return interval;
+}
+
+-(void)setMaximumInterval:(NSTimeInterval)maximumInterval
+{
+    dispatch_async(_queue, ^{
+        self->_maximumInterval = MAX(maximumInterval, self->_baseInterval);
+    });
+}
+
+/* refreshIntervalWithPublicationInterval
+ * A feed is refreshed twice per publication interval, but not before its
+ * response or its declared time to live expires. Failures double the interval.
+ */
+-(NSTimeInterval)refreshIntervalWithPublicationInterval:(NSTimeInterval)publicationInterval
+                                      freshnessLifetime:(NSTimeInterval)freshnessLifetime
+                                             timeToLive:(NSTimeInterval)timeToLive
+                                        countOfFailures:(NSUInteger)countOfFailures
+{
+    NSTimeInterval baseInterval = _baseInterval;
+    NSTimeInterval maximumInterval = MAX(_maximumInterval, baseInterval);
+
+    NSTimeInterval interval = MAX(baseInterval, publicationInterval / 2);
+    interval = MAX(interval, MAX(freshnessLifetime, timeToLive));
+    interval = MIN(interval, maximumInterval);
+
+    NSUInteger exponent = MIN(countOfFailures, VNARefreshMaximumBackoffExponent);
+    interval = MIN(interval * (double)(1 << exponent), maximumInterval);
+    return interval;
+}
+
+-(NSTimeInterval)intervalOfEntry:(VNARefreshEntry *)entry
+{
+    return [self refreshIntervalWithPublicationInterval:entry.publicationInterval
+                                      freshnessLifetime:entry.freshnessLifetime
+                                             timeToLive:entry.timeToLive
+                                        countOfFailures:entry.countOfFailures];
+}
+
+/* freshnessLifetimeOfResponse
+ * Cache-Control takes precedence over Expires.
+ */
++(NSTimeInterval)freshnessLifetimeOfResponse:(NSHTTPURLResponse *)response
+{
+    NSString *cacheControl = [response valueForHTTPHeaderField:@"Cache-Control"];
+    if (cacheControl != nil) {
+        NSTimeInterval maxAge = -1;
+        for (NSString *component in [cacheControl componentsSeparatedByString:@","]) {
+            NSString *directive = [component stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet].lowercaseString;
+            if ([directive isEqualToString:@"no-cache"] || [directive isEqualToString:@"no-store"]) {
+                return 0;
+            }
+            if ([directive hasPrefix:@"max-age="]) {
+                maxAge = MAX(0, [directive substringFromIndex:8].doubleValue);
+            }
+        }
+        if (maxAge >= 0) {
+            return maxAge;
+        }
+    }
+
+    NSString *expires = [response valueForHTTPHeaderField:@"Expires"];
+    if (expires == nil) {
+        return 0;
+    }
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    NSDate *expiryDate = [formatter dateFromString:expires];
+    if (expiryDate == nil) {
+        // Invalid dates, such as "0", mean that the response has expired.
+        return 0;
+    }
+    NSString *dateString = [response valueForHTTPHeaderField:@"Date"];
+    NSDate *date = dateString != nil ? [formatter dateFromString:dateString] : nil;
+    return MAX(0, [expiryDate timeIntervalSinceDate:date ?: [NSDate date]]);
+}
+
+// MARK: Scheduling
+
+/* scheduleFeeds
+ * Spreads the first refreshes of new feeds over their intervals, so that
+ * they do not all become due at the same time.
+ */
+-(void)scheduleFeeds:(NSArray<Folder *> *)folders
+{
+    NSMutableArray<NSNumber *> *folderIds = [NSMutableArray arrayWithCapacity:folders.count];
+    for (Folder *folder in folders) {
+        if (folder.type == VNAFolderTypeRSS || folder.type == VNAFolderTypeOpenReader) {
+            [folderIds addObject:@(folder.itemId)];
+        }
+    }
+
+    dispatch_async(_queue, ^{
+        for (NSNumber *folderId in folderIds) {
+            if (self->_entriesByFolderId[folderId] != nil) {
+                continue;
+            }
+            VNARefreshEntry *entry = [[VNARefreshEntry alloc] init];
+            entry.folderId = folderId.integerValue;
+            entry.publicationInterval = [self->_database publicationIntervalOfFolder:entry.folderId];
+            NSTimeInterval interval = [self intervalOfEntry:entry];
+            NSTimeInterval delay = interval * ((double)arc4random_uniform(1000) / 1000.0);
+            self->_entriesByFolderId[folderId] = entry;
+            [self enqueueEntry:entry dueDate:[NSDate dateWithTimeIntervalSinceNow:delay]];
+        }
+        [self armTimer];
+    });
+}
+
+-(void)cancel
+{
+    dispatch_async(_queue, ^{
+        [self->_entries removeAllObjects];
+        [self->_entriesByFolderId removeAllObjects];
+        if (self->_timer) {
+            dispatch_source_cancel(self->_timer);
+            self->_timer = nil;
+        }
+    });
+}
+
+-(void)feedDidRefresh:(NSInteger)folderId
+             response:(NSHTTPURLResponse *)response
+           timeToLive:(NSTimeInterval)timeToLive
+{
+    NSTimeInterval freshnessLifetime = response != nil ? [VNARefreshScheduler freshnessLifetimeOfResponse:response] : 0;
+    dispatch_async(_queue, ^{
+        VNARefreshEntry *entry = self->_entriesByFolderId[@(folderId)];
+        if (entry == nil) {
+            return;
+        }
+        entry.countOfFailures = 0;
+        entry.freshnessLifetime = freshnessLifetime;
+        if (timeToLive >= 0) {
+            // Only feeds that were downloaded can have new articles.
+            entry.timeToLive = timeToLive;
+            entry.publicationInterval = [self->_database publicationIntervalOfFolder:folderId];
+        }
+        [self rescheduleEntry:entry];
+    });
+}
+
+-(void)feedDidFailToRefresh:(NSInteger)folderId
+{
+    dispatch_async(_queue, ^{
+        VNARefreshEntry *entry = self->_entriesByFolderId[@(folderId)];
+        if (entry == nil) {
+            return;
+        }
+        entry.countOfFailures += 1;
+        [self rescheduleEntry:entry];
+    });
+}
+
+-(void)deferRefreshOfFeed:(NSInteger)folderId untilDate:(NSDate *)retryDate
+{
+    dispatch_async(_queue, ^{
+        VNARefreshEntry *entry = self->_entriesByFolderId[@(folderId)];
+        if (entry == nil) {
+            return;
+        }
+        [self enqueueEntry:entry dueDate:[retryDate laterDate:[NSDate date]]];
+        [self armTimer];
+    });
+}
+
+-(NSDate *)dueDateOfFeed:(NSInteger)folderId
+{
+    __block NSDate *dueDate;
+    dispatch_sync(_queue, ^{
+        dueDate = self->_entriesByFolderId[@(folderId)].dueDate;
+    });
+    return dueDate;
+}
+
+/* rescheduleEntry
+ * Moves a feed to the end of its interval from now, with some jitter.
+ */
+-(void)rescheduleEntry:(VNARefreshEntry *)entry
+{
+    NSTimeInterval interval = [self intervalOfEntry:entry];
+    double jitter = VNARefreshJitter * (((double)arc4random_uniform(2001) / 1000.0) - 1.0);
+    [self enqueueEntry:entry dueDate:[NSDate dateWithTimeIntervalSinceNow:interval * (1.0 + jitter)]];
+    [self armTimer];
+}
+
+/* enqueueEntry
+ * Keeps the entries sorted by due date. Must be called on the queue.
+ */
+-(void)enqueueEntry:(VNARefreshEntry *)entry dueDate:(NSDate *)dueDate
+{
+    NSUInteger index = [_entries indexOfObjectIdenticalTo:entry];
+    if (index != NSNotFound) {
+        [_entries removeObjectAtIndex:index];
+    }
+    entry.dueDate = dueDate;
+    index = [_entries indexOfObject:entry
+                      inSortedRange:NSMakeRange(0, _entries.count)
+                            options:NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+                    usingComparator:^NSComparisonResult(VNARefreshEntry *entry1, VNARefreshEntry *entry2) {
+        return [entry1.dueDate compare:entry2.dueDate];
+    }];
+    [_entries insertObject:entry atIndex:index];
+}
+
+/* armTimer
+ * Sets the timer to fire when the earliest feed is due. A wall clock timer
+ * is used so that feeds become due after the computer wakes from sleep.
+ */
+-(void)armTimer
+{
+    if (_entries.count == 0) {
+        if (_timer) {
+            dispatch_source_cancel(_timer);
+            _timer = nil;
+        }
+        return;
+    }
+    if (!_timer) {
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf handOverDueFeeds];
+        });
+        dispatch_resume(_timer);
+    }
+    NSTimeInterval delay = MAX(0, _entries.firstObject.dueDate.timeIntervalSinceNow);
+    dispatch_time_t start = dispatch_walltime(NULL, (int64_t)(delay * NSEC_PER_SEC));
+    dispatch_source_set_timer(_timer, start, DISPATCH_TIME_FOREVER, NSEC_PER_SEC);
+}
+
+/* handOverDueFeeds
+ * Hands the feeds that are due to the refresh handler. They are rescheduled
+ * provisionally in case their refreshes never report back; the refresh
+ * manager reschedules them when they finish.
+ */
+-(void)handOverDueFeeds
+{
+    NSDate *now = [NSDate date];
+    NSMutableArray<NSNumber *> *dueFolderIds = [NSMutableArray array];
+    while (_entries.count > 0 && [_entries.firstObject.dueDate compare:now] != NSOrderedDescending) {
+        VNARefreshEntry *entry = _entries.firstObject;
+        [dueFolderIds addObject:@(entry.folderId)];
+        [self enqueueEntry:entry dueDate:[now dateByAddingTimeInterval:[self intervalOfEntry:entry]]];
+    }
+    [self armTimer];
+    if (dueFolderIds.count == 0) {
+        return;
+    }
+
+    os_log_debug(VNA_LOG, "%lu feeds are due", (unsigned long)dueFolderIds.count);
+    dispatch_async(dispatch_get_main_queue(), ^{
+        BOOL (^refreshHandler)(NSArray<Folder *> *) = self.refreshHandler;
+        if (refreshHandler == nil) {
+            return;
+        }
+        NSMutableArray<Folder *> *folders = [NSMutableArray arrayWithCapacity:dueFolderIds.count];
+        for (NSNumber *folderId in dueFolderIds) {
+            Folder *folder = [self->_database folderFromID:folderId.integerValue];
+            if (folder != nil && !folder.isUnsubscribed) {
+                [folders addObject:folder];
+            }
+        }
+        if (folders.count > 0 && !refreshHandler(folders)) {
+            [self retryFolderIds:dueFolderIds];
+        }
+    });
+}
+
+-(void)retryFolderIds:(NSArray<NSNumber *> *)folderIds
+{
+    dispatch_async(_queue, ^{
+        NSDate *dueDate = [NSDate dateWithTimeIntervalSinceNow:VNARefreshRetryInterval];
+        for (NSNumber *folderId in folderIds) {
+            VNARefreshEntry *entry = self->_entriesByFolderId[folderId];
+            if (entry != nil) {
+                [self enqueueEntry:entry dueDate:dueDate];
+            }
+        }
+        [self armTimer];
+    });
+}
+
+@end
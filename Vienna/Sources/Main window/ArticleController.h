@@ -64,6 +64,7 @@
 -(void)reloadArrayOfArticles;
 -(void)displayFolder:(NSInteger)newFolderId;
 -(void)refilterArrayOfArticles;
+-(void)loadArticlesForRow:(NSInteger)row;
 @property (readonly, nonatomic) NSString *sortColumnIdentifier;
 @property (nonatomic, readonly) BOOL sortIsAscending;
 -(void)ensureSelectedArticle;
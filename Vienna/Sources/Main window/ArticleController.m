@@ -28,6 +28,7 @@
 #import "Constants.h"
 #import "Database.h"
 #import "ArticleRef.h"
+#import "ArticlePageSource.h"
 #import "OpenReader.h"
 #import "ArticleListView.h"
 #import "UnifiedDisplayView.h"
@@ -43,6 +44,12 @@
 
 static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserverContext;
 
+// The number of articles that are loaded at once from folders that may
+// contain any number of them, and how close to the end of the loaded
+// articles the list may be scrolled before the next page is loaded.
+static NSUInteger const VNAArticlePageSize = 500;
+static NSInteger const VNAArticlePrefetchDistance = 100;
+
 @interface ArticleController ()
 
 @property (weak, nonatomic) VNAFilterBarViewController *filterBarViewController;
@@ -69,6 +76,9 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
     Article *articleToPreserve;
     NSString *guidOfArticleToSelect;
     BOOL firstUnreadArticleRequired;
+    VNAArticlePageSource *pageSource;
+    BOOL isLoadingPage;
+    void (^pendingPageSearch)(void);
 }
 
 @synthesize mainArticleView, currentArrayOfArticles, folderArrayOfArticles, articleSortSpecifiers, backtrackArray;
@@ -351,6 +361,17 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 -(void)sortArticles
 {
     Preferences *preferences = Preferences.standardPreferences;
+
+    // Articles that are loaded in pages are already in the order of the
+    // primary sort descriptor. Sorting the loaded ones again could mix them
+    // with the next pages.
+    if (pageSource != nil) {
+        if (![pageSource.sortDescriptor isEqual:preferences.articleSortDescriptors.firstObject]) {
+            [self reloadArrayOfArticles];
+        }
+        return;
+    }
+
     @try {
         NSArray *sortDescriptors = preferences.articleSortDescriptors;
         NSArray *sortedArrayOfArticles  = [currentArrayOfArticles sortedArrayUsingDescriptors:sortDescriptors];
@@ -383,7 +404,7 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 		// Get the first folder with unread articles.
 		NSInteger firstFolderWithUnread = self.foldersTree.firstFolderWithUnread;
 		if (firstFolderWithUnread == currentFolderId) {
-            [self->mainArticleView selectFirstUnreadInFolder];
+            [self selectFirstUnreadWithCompletionHandler:nil];
 		} else {
 			// Seed in order to select the first unread article.
 			firstUnreadArticleRequired = YES;
@@ -408,20 +429,98 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 	// If there are any unread articles then select the nexst one
 	if ([Database sharedManager].countOfUnread > 0) {
 		// Search other articles in the same folder, starting from current position
-        if (!mainArticleView.viewNextUnreadInFolder) {
+        [self selectNextUnreadWithCompletionHandler:^(BOOL found) {
+            if (found) {
+                return;
+            }
 			// If nothing found and smart folder, search if we have other fresh articles from same folder
-			Folder * currentFolder = [[Database sharedManager] folderFromID:currentFolderId];
+			Folder * currentFolder = [[Database sharedManager] folderFromID:self->currentFolderId];
 			if (currentFolder.type == VNAFolderTypeSmart || currentFolder.type == VNAFolderTypeTrash || currentFolder.type == VNAFolderTypeSearch) {
-                if (!mainArticleView.selectFirstUnreadInFolder) {
-					[self displayNextFolderWithUnread];
-				}
+                [self selectFirstUnreadWithCompletionHandler:^(BOOL foundFirst) {
+                    if (!foundFirst) {
+                        [self displayNextFolderWithUnread];
+                    }
+                }];
 			} else {
 				[self displayNextFolderWithUnread];
 			}
-		}
+        }];
 	}
 }
 
+/* selectNextUnreadWithCompletionHandler
+ * Selects the next unread article after the current one. In a folder that
+ * is loaded in pages, the pages that follow are loaded until one of them
+ * has an unread article. The handler is told whether one was found.
+ */
+-(void)selectNextUnreadWithCompletionHandler:(void (^)(BOOL found))completionHandler
+{
+    BOOL found = mainArticleView.viewNextUnreadInFolder;
+    if (found || pageSource == nil || pageSource.exhausted) {
+        completionHandler(found);
+        return;
+    }
+    [self loadPagesUntilArticlePassingTest:[self visibleUnreadArticleTest] completionHandler:^{
+        [self selectNextUnreadWithCompletionHandler:completionHandler];
+    }];
+}
+
+/* selectFirstUnreadWithCompletionHandler
+ * Selects the first unread article of the folder. In a folder that is
+ * loaded in pages, the pages that follow are loaded if none of the loaded
+ * articles is unread. The handler is told whether one was found.
+ */
+-(void)selectFirstUnreadWithCompletionHandler:(void (^)(BOOL found))completionHandler
+{
+    if (mainArticleView.selectFirstUnreadInFolder) {
+        if (completionHandler) {
+            completionHandler(YES);
+        }
+        return;
+    }
+    if (pageSource == nil || pageSource.exhausted) {
+        if (completionHandler) {
+            completionHandler(NO);
+        }
+        return;
+    }
+    [self loadPagesUntilArticlePassingTest:[self visibleUnreadArticleTest] completionHandler:^{
+        [self selectFirstUnreadWithCompletionHandler:completionHandler];
+    }];
+}
+
+/* scrollToArticleWithGuid
+ * Selects an article of the current folder. In a folder that is loaded in
+ * pages, the pages that follow are loaded until the article is.
+ */
+-(void)scrollToArticleWithGuid:(NSString *)guid
+{
+    BOOL (^test)(Article *) = ^BOOL(Article *article) {
+        return [article.guid isEqualToString:guid];
+    };
+    NSUInteger index = [folderArrayOfArticles indexOfObjectPassingTest:^BOOL(Article *article, NSUInteger idx, BOOL *stop) {
+        return test(article);
+    }];
+    if (index != NSNotFound) {
+        [mainArticleView scrollToArticle:guid];
+        return;
+    }
+    [self loadPagesUntilArticlePassingTest:test completionHandler:^{
+        [self->mainArticleView scrollToArticle:guid];
+    }];
+}
+
+/* visibleUnreadArticleTest
+ * Returns a test for the unread articles that pass the current filter.
+ */
+-(BOOL (^)(Article *))visibleUnreadArticleTest
+{
+    NSInteger filterMode = Preferences.standardPreferences.filterMode;
+    return ^BOOL(Article *article) {
+        return !article.isRead && [self filterArticle:article usingMode:filterMode];
+    };
+}
+
 /* displayNextFolderWithUnread
  * Instructs the current article view to display the next folder with unread articles
  * in the database.
@@ -466,7 +565,7 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 	// If we're in the right folder, select the article
 	if (folderId == currentFolderId) {
 		if (guid != nil) {
-			[mainArticleView scrollToArticle:guid];
+			[self scrollToArticleWithGuid:guid];
 		}
 	} else {
 		// We seed guidOfArticleToSelect so that
@@ -485,16 +584,40 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 {
     Folder *folder = [[Database sharedManager] folderFromID:currentFolderId];
     NSString *filterString = self.filterString;
+
+    // Group, smart and search folders can contain all articles of the
+    // database, so they are loaded in pages as the list is scrolled. The
+    // articles of feeds are cached by their folders instead.
+    VNAArticlePageSource *source = nil;
+    if (folder != nil && !folder.isSubscriptionFolder) {
+        NSSortDescriptor *sortDescriptor = Preferences.standardPreferences.articleSortDescriptors.firstObject;
+        source = [[VNAArticlePageSource alloc] initWithDatabase:[Database sharedManager]
+                                                       folderId:folder.itemId
+                                                   filterString:filterString
+                                                 sortDescriptor:sortDescriptor
+                                                       pageSize:VNAArticlePageSize];
+    }
+    pageSource = source;
+    isLoadingPage = source != nil;
+    pendingPageSearch = nil;
+
     [folder setNonPersistedFlag:VNAFolderFlagUpdating];
     [[NSNotificationCenter defaultCenter] postNotificationName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
     __block NSArray * articles;
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
         NSInteger requestedFolderId = self->currentFolderId;
-        articles = [folder articlesWithFilter:filterString];
+        if (source != nil) {
+            articles = [source nextPage];
+        } else {
+            articles = [folder articlesWithFilter:filterString];
+        }
         dispatch_sync(dispatch_get_main_queue(), ^{
             [folder clearNonPersistedFlag:VNAFolderFlagUpdating];
             [[NSNotificationCenter defaultCenter] postNotificationName:MA_Notify_FoldersUpdated object:@(folder.itemId)];
-            if (self->currentFolderId == requestedFolderId) {
+            if (self->pageSource == source) {
+                self->isLoadingPage = NO;
+            }
+            if (self->currentFolderId == requestedFolderId && self->pageSource == source) {
                 self.folderArrayOfArticles = articles;
                 [self finishReloadArrayOfArticles];
             }
@@ -517,11 +640,16 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
 
     [self->mainArticleView refreshFolder:VNARefreshReapplyFilter];
 
+    // The first page may not contain any article that passes the filter.
+    if (self->currentArrayOfArticles.count == 0) {
+        [self loadArticlesForRow:0];
+    }
+
     if (self->guidOfArticleToSelect != nil) {
-        [self->mainArticleView scrollToArticle:self->guidOfArticleToSelect];
+        [self scrollToArticleWithGuid:self->guidOfArticleToSelect];
         self->guidOfArticleToSelect = nil;
     } else if (self->firstUnreadArticleRequired) {
-        [self->mainArticleView selectFirstUnreadInFolder];
+        [self selectFirstUnreadWithCompletionHandler:nil];
         self->firstUnreadArticleRequired = NO;
     }
 
@@ -537,6 +665,117 @@ static void *VNAArticleControllerObserverContext = &VNAArticleControllerObserver
     }
 } // finishReloadArrayOfArticles
 
+/* loadArticlesForRow
+ * Called by the article views for every row that they display. If the row is
+ * close to the end of the articles that have been loaded in pages so far, the
+ * next page is loaded and appended to the list.
+ */
+-(void)loadArticlesForRow:(NSInteger)row
+{
+    VNAArticlePageSource *source = pageSource;
+    if (source == nil || source.exhausted || isLoadingPage ||
+        row < (NSInteger)currentArrayOfArticles.count - VNAArticlePrefetchDistance) {
+        return;
+    }
+
+    isLoadingPage = YES;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSArray<Article *> *page = [source nextPage];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (self->pageSource != source) {
+                return;
+            }
+            self->isLoadingPage = NO;
+
+            // No further row is displayed if none of the page was visible.
+            if ([self appendPage:page] == 0) {
+                [self loadArticlesForRow:self->currentArrayOfArticles.count];
+            }
+            [self runPendingPageSearch];
+        });
+    });
+}
+
+/* loadPagesUntilArticlePassingTest
+ * Loads the pages that follow, until one of them has an article that passes
+ * the test or all of them are loaded, and appends them to the list. The
+ * completion handler is called on the main queue, unless the folder is
+ * reloaded in the meantime.
+ */
+-(void)loadPagesUntilArticlePassingTest:(BOOL (^)(Article *article))test completionHandler:(void (^)(void))completionHandler
+{
+    VNAArticlePageSource *source = pageSource;
+    if (source == nil || source.exhausted) {
+        completionHandler();
+        return;
+    }
+    if (isLoadingPage) {
+        // Continue when the page that is being loaded is appended.
+        pendingPageSearch = ^{
+            [self loadPagesUntilArticlePassingTest:test completionHandler:completionHandler];
+        };
+        return;
+    }
+
+    isLoadingPage = YES;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSMutableArray<Article *> *pages = [NSMutableArray array];
+        BOOL found = NO;
+        while (!found && !source.exhausted) {
+            NSArray<Article *> *page = [source nextPage];
+            [pages addObjectsFromArray:page];
+            found = [page indexOfObjectPassingTest:^BOOL(Article *article, NSUInteger index, BOOL *stop) {
+                return test(article);
+            }] != NSNotFound;
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (self->pageSource != source) {
+                return;
+            }
+            self->isLoadingPage = NO;
+            [self appendPage:pages];
+            completionHandler();
+            [self runPendingPageSearch];
+        });
+    });
+}
+
+/* runPendingPageSearch
+ * Runs the page search that waited for the page that was being loaded.
+ */
+-(void)runPendingPageSearch
+{
+    void (^pageSearch)(void) = pendingPageSearch;
+    if (pageSearch == nil || isLoadingPage) {
+        return;
+    }
+    pendingPageSearch = nil;
+    pageSearch();
+}
+
+/* appendPage
+ * Appends loaded articles to the list and returns how many of them pass the
+ * current filter.
+ */
+-(NSUInteger)appendPage:(NSArray<Article *> *)page
+{
+    // The preserved article is already part of the list, whether it
+    // was loaded before or not.
+    Article *preservedArticle = articleToPreserve;
+    NSInteger filterMode = Preferences.standardPreferences.filterMode;
+    NSIndexSet *visibleIndexes = [page indexesOfObjectsPassingTest:^BOOL(Article *article, NSUInteger index, BOOL *stop) {
+        if (preservedArticle != nil && article.folderId == preservedArticle.folderId &&
+            [article.guid isEqualToString:preservedArticle.guid]) {
+            return NO;
+        }
+        return [self filterArticle:article usingMode:filterMode];
+    }];
+    self.folderArrayOfArticles = [folderArrayOfArticles arrayByAddingObjectsFromArray:page];
+    self.currentArrayOfArticles = [currentArrayOfArticles arrayByAddingObjectsFromArray:[page objectsAtIndexes:visibleIndexes]];
+    [mainArticleView refreshFolder:VNARefreshRedrawList];
+    return visibleIndexes.count;
+}
+
 /* refilterArrayOfArticles
  * Reapply the current filter to the article array.
  */
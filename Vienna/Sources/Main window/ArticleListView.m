@@ -1093,6 +1093,7 @@ static void *VNAArticleListViewObserverContext = &VNAArticleListViewObserverCont
 		return nil;
 	}
 	theArticle = allArticles[rowIndex];
+	[self.articleController loadArticlesForRow:rowIndex];
 	NSString * identifier = aTableColumn.identifier;
 	if ([identifier isEqualToString:MA_Field_Read]) {
 		if (theArticle.isRead) {
@@ -59,6 +59,7 @@ static void *VNAFoldersTreeObserverContext = &VNAFoldersTreeObserverContext;
 -(void)handleFolderNameChange:(NSNotification *)nc;
 -(void)handleFolderUpdate:(NSNotification *)nc;
 -(void)handleFolderDeleted:(NSNotification *)nc;
+-(void)handleFoldersReloaded:(NSNotification *)nc;
 -(void)handleShowFolderImagesChange:(NSNotification *)nc;
 -(void)reloadFolderItem:(id)node reloadChildren:(BOOL)flag;
 -(void)expandToParent:(TreeNode *)node;
@@ -115,6 +116,7 @@ static void *VNAFoldersTreeObserverContext = &VNAFoldersTreeObserverContext;
 	[nc addObserver:self selector:@selector(handleFolderNameChange:) name:MA_Notify_FolderNameChanged object:nil];
 	[nc addObserver:self selector:@selector(handleFolderAdded:) name:MA_Notify_FolderAdded object:nil];
 	[nc addObserver:self selector:@selector(handleFolderDeleted:) name:VNADatabaseDidDeleteFolderNotification object:nil];
+	[nc addObserver:self selector:@selector(handleFoldersReloaded:) name:VNADatabaseDidReloadFoldersNotification object:nil];
 	[nc addObserver:self selector:@selector(handleShowFolderImagesChange:) name:MA_Notify_ShowFolderImages object:nil];
 	[nc addObserver:self selector:@selector(handleAutoSortFoldersTreeChange:) name:MA_Notify_AutoSortFoldersTreeChange object:nil];
     [nc addObserver:self selector:@selector(handleOpenReaderFolderChange:) name:MA_Notify_OpenReaderFolderChange object:nil];
@@ -638,6 +640,21 @@ static void *VNAFoldersTreeObserverContext = &VNAFoldersTreeObserverContext;
 	[self selectFolder:selectedFolderId];
 }
 
+/* handleFoldersReloaded
+ * Rebuilds the tree when the database replaced the folders of the snapshot
+ * that stood in for them at launch.
+ */
+-(void)handleFoldersReloaded:(NSNotification *)nc
+{
+	NSInteger selectedFolderId = self.actualSelection;
+
+	self.blockSelectionHandler = YES;
+	[self reloadDatabase:self.archiveState];
+	self.blockSelectionHandler = NO;
+
+	[self selectFolder:selectedFolderId];
+}
+
 /* handleShowFolderImagesChange
  * Respond to the notification sent when the option to show folder images is changed.
  */
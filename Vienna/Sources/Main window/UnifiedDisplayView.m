@@ -503,6 +503,7 @@ static void *VNAUnifiedDisplayViewObserverContext = &VNAUnifiedDisplayViewObserv
 
 	Article * theArticle = allArticles[row];
 	NSInteger articleFolderId = theArticle.folderId;
+	[self.articleController loadArticlesForRow:row];
 
 	cellView.articleController = self.articleController;
 	cellView.folderId = articleFolderId;
@@ -60,6 +60,9 @@ typedef NS_ENUM(NSInteger, ArticleStatus) {
 @property (nonatomic, copy) NSString *guid;
 @property (nullable, nonatomic, copy) NSString *author;
 @property (nullable, nonatomic, copy) NSString *body;
+/// The body as it is stored in the database. It is only decompressed when
+/// the body is accessed. Setting the body discards the compressed body.
+@property (nullable, nonatomic, copy) NSData *compressedBody;
 @property (nullable, nonatomic, copy) NSString *title;
 @property (nullable, nonatomic, copy) NSString *link;
 @property (readonly, nullable, nonatomic) NSString *summary;
@@ -22,6 +22,7 @@
 
 #import "Database.h"
 #import "Folder.h"
+#import "NSData+Compression.h"
 #import "StringExtensions.h"
 
 // The names here are internal field names, not for localisation.
@@ -101,6 +102,18 @@ NSString * const MA_Field_HasEnclosure = @"HasEnclosure";
 {
     articleData[MA_Field_Text] = [newText copy];
     [articleData removeObjectForKey:MA_Field_Summary];
+    _compressedBody = nil;
+}
+
+/* setCompressedBody
+ * Replaces the body with its compressed form, which is decompressed by the
+ * body accessor when it is first needed.
+ */
+-(void)setCompressedBody:(NSData *)compressedBody
+{
+    _compressedBody = [compressedBody copy];
+    [articleData removeObjectForKey:MA_Field_Text];
+    [articleData removeObjectForKey:MA_Field_Summary];
 }
 
 /* setEnclosure
@@ -159,7 +172,7 @@ NSString * const MA_Field_HasEnclosure = @"HasEnclosure";
 {
     NSString * summary = articleData[MA_Field_Summary];
     if (summary == nil) {
-        summary = [articleData[MA_Field_Text] vna_summaryTextFromHTML];
+        summary = [self.body vna_summaryTextFromHTML];
         if (summary == nil) {
             summary = @"";
         }
@@ -169,7 +182,16 @@ NSString * const MA_Field_HasEnclosure = @"HasEnclosure";
 }
 -(NSDate *)lastUpdate			{ return articleData[MA_Field_LastUpdate]; }
 -(NSDate *)publicationDate		{ return articleData[MA_Field_PublicationDate]; }
--(NSString *)body				{ return articleData[MA_Field_Text]; }
+-(NSString *)body
+{
+    NSString * body = articleData[MA_Field_Text];
+    if (body == nil && _compressedBody != nil) {
+        body = _compressedBody.vna_decompressedString;
+        articleData[MA_Field_Text] = body;
+        _compressedBody = nil;
+    }
+    return body;
+}
 -(NSString *)enclosure			{ return articleData[MA_Field_Enclosure]; }
 
 /* containingFolder
@@ -85,6 +85,8 @@ typedef NS_OPTIONS(NSUInteger, VNAFolderFlag) {
 @property (nonatomic, copy) NSString *feedURL;
 @property (nonatomic) NSDate *lastUpdate;
 @property (nonatomic, copy) NSString *lastUpdateString;
+@property (nonatomic, copy) NSString *entityTag;
+@property (nonatomic) unsigned long long contentSize;
 @property (nonatomic, copy) NSString *username;
 @property (nonatomic, copy) NSString *password;
 @property (readonly, nonatomic) NSArray<Article *> *articles;
@@ -121,7 +123,8 @@ typedef NS_OPTIONS(NSUInteger, VNAFolderFlag) {
 -(NSUInteger)indexOfArticle:(Article *)article;
 -(Article *)articleFromGuid:(NSString *)guid;
 -(NSInteger)retrieveKnownStatusForGuid:(NSString *)guid;
--(BOOL)createArticle:(Article *)article guidHistory:(NSArray *)guidHistory;
+-(NSInteger)createArticles:(NSArray<Article *> *)articles;
+-(void)resetGuidHistory;
 -(void)removeArticleFromCache:(NSString *)guid;
 -(void)markArticlesInCacheRead;
 -(void)resetArticleStatuses;
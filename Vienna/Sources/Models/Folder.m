@@ -39,6 +39,7 @@
 @property (nonatomic) BOOL hasPassword;
 @property (nonatomic) NSCache * cachedArticles;
 @property (nonatomic) NSMutableArray * cachedGuids;
+@property (nonatomic) NSMutableSet<NSString *> * guidHistory;
 @property (nonatomic) NSMutableDictionary * attributes;
 
 @end
@@ -74,6 +75,7 @@
 		_attributes = [NSMutableDictionary dictionary];
 		self.name = newName;
 		self.lastUpdateString = @"";
+		self.entityTag = @"";
 		self.username = @"";
 		_lastUpdate = [NSDate distantPast];
 		self.remoteId = @"0";
@@ -292,6 +294,41 @@
 	[self.attributes setValue:[newLastUpdateString copy] forKey:@"LastUpdateString"];
 }
 
+/* entityTag
+ * Return the entity tag of the feed.
+ */
+-(NSString *)entityTag
+{
+	return [self.attributes valueForKey:@"EntityTag"];
+}
+
+/* setEntityTag
+ * Set the entity tag. This is the ETag string of the last response of the
+ * site, which is passed with If-None-Match when requesting data from the
+ * same site.
+ */
+-(void)setEntityTag:(NSString *)newEntityTag
+{
+	[self.attributes setValue:[newEntityTag copy] forKey:@"EntityTag"];
+}
+
+/* contentSize
+ * Return the size of the last download of the feed.
+ */
+-(unsigned long long)contentSize
+{
+	return [[self.attributes valueForKey:@"ContentSize"] unsignedLongLongValue];
+}
+
+/* setContentSize
+ * Set the size of the last download of the feed. This is the size of the
+ * data that a response with HTTP status 304 does not send again.
+ */
+-(void)setContentSize:(unsigned long long)newContentSize
+{
+	[self.attributes setValue:@(newContentSize) forKey:@"ContentSize"];
+}
+
 /* feedURL
  * Return the URL of the subscription.
  */
@@ -472,82 +509,124 @@
     }
 }
 
-/* createArticle
- * Adds or updates an article in the folder.
- * Returns YES if the article was added as new,
- *         NO otherwise (it is an update of an existing article
- *            or we couldn't add it for some reason).
- * Status information is updated in the article to mark
- * if it is new or updated (from the point of view of the user).
- */
--(BOOL)createArticle:(Article *)article guidHistory:(NSArray *)guidHistory
-{
-    NSString * articleGuid = article.guid;
-    // Does this article already exist?
-    // We're going to ignore here the problem of feeds re-using guids, which is very naughty! Bad feed!
-    Article * existingArticle;
-    if ([guidHistory containsObject:articleGuid]) {    
-        if ([[Preferences standardPreferences] boolForKey:MAPref_CheckForUpdatedArticles]) {
-            // rebuild the cache to be sure
-            self.isCached = NO;
-            [self ensureCache];
-            existingArticle = [self.cachedArticles objectForKey:articleGuid];
-            if (existingArticle == nil) {
-                return NO; // Article was present, but has been deleted and removed from database, so ignore
-            }
-        } else {
-            return NO;
-        }
-    } else {
-        existingArticle = nil;
+/* guidHistory
+ * Returns the guids of all articles ever added to the folder. The set is
+ * loaded from the database on first use and kept up to date as articles
+ * are added, so that refreshes do not reload it.
+ */
+-(NSMutableSet<NSString *> *)guidHistory
+{
+    if (_guidHistory == nil) {
+        _guidHistory = [[[Database sharedManager] guidHistoryForFolderId:self.itemId] mutableCopy];
     }
+    return _guidHistory;
+}
 
+/* resetGuidHistory
+ * Discards the guid history, so that it is loaded again from the database
+ * when it is next needed, e.g. after guids were forgotten.
+ */
+-(void)resetGuidHistory
+{
     @synchronized(self) {
+        _guidHistory = nil;
+    }
+}
 
-        // Unread count adjustment factor
-        NSInteger adjustment = 0;
-
-        if (existingArticle == nil) {
-            // add the article as new
-            BOOL success = [[Database sharedManager] addArticle:article toFolder:self.itemId];
-            if (success) {
-                article.status = ArticleStatusNew;
-                latestFetchCount++;
-                // add to the cache
-                NSString * guid = article.guid;
-                [self.cachedArticles setObject:article forKey:guid];
-                [self.cachedGuids addObject:guid];
-                if(!article.isRead) {
-                    adjustment = 1;
-                }
-            } else {
-                return NO;
+/* createArticles
+ * Adds or updates articles in the folder, with one database transaction
+ * for the new articles, one for the updated articles and a single
+ * adjustment of the unread count.
+ * Returns the number of articles that were added as new and unread, or
+ * that were read and have been updated.
+ * Status information is updated in the articles to mark
+ * if they are new or updated (from the point of view of the user).
+ */
+-(NSInteger)createArticles:(NSArray<Article *> *)articles
+{
+    @synchronized(self) {
+
+        NSMutableSet<NSString *> * knownGuids = self.guidHistory;
+        BOOL checkForUpdatedArticles = [[Preferences standardPreferences] boolForKey:MAPref_CheckForUpdatedArticles];
+        BOOL isCacheRebuilt = NO;
+
+        NSMutableArray<Article *> * newArticles = [NSMutableArray array];
+        NSMutableArray<Article *> * existingArticles = [NSMutableArray array];
+        NSMutableArray<Article *> * articleUpdates = [NSMutableArray array];
+        NSMutableSet * batchGuids = [NSMutableSet set];
+        NSMutableArray<NSString *> * listedGuids = [NSMutableArray array];
+
+        for (Article * article in articles) {
+            NSString * articleGuid = article.guid;
+            // A feed may list the same article more than once: keep the first one
+            if ([batchGuids containsObject:articleGuid]) {
+                continue;
             }
-        } else if (existingArticle.isDeleted) {
-            return NO;
-        } else {
-            // we have to verify if we need to update the existing article
-            BOOL success = [[Database sharedManager] updateArticle:existingArticle ofFolder:self.itemId withArticle:article];
-            if (success) {
-                article.status = ArticleStatusUpdated;
-                latestFetchCount++;
-                // Update folder unread count if necessary
-                if (existingArticle.isRead) {
-                    adjustment = 1;
-                    existingArticle.read = NO;
+            [batchGuids addObject:articleGuid];
+
+            // Does this article already exist?
+            // We're going to ignore here the problem of feeds re-using guids, which is very naughty! Bad feed!
+            if ([knownGuids containsObject:articleGuid]) {
+                // Keep the guid in the history while the feed lists it
+                [listedGuids addObject:articleGuid];
+                if (!checkForUpdatedArticles) {
+                    continue;
+                }
+                if (!isCacheRebuilt) {
+                    // rebuild the cache to be sure
+                    self.isCached = NO;
+                    [self ensureCache];
+                    isCacheRebuilt = YES;
                 }
+                Article * existingArticle = [self.cachedArticles objectForKey:articleGuid];
+                // Ignore articles that were deleted, or removed from the database
+                if (existingArticle == nil || existingArticle.isDeleted) {
+                    continue;
+                }
+                [existingArticles addObject:existingArticle];
+                [articleUpdates addObject:article];
             } else {
-                return NO;
+                [newArticles addObject:article];
             }
         }
 
-        // Fix unread count on parent folders and Database manager
-        if (adjustment != 0) {
-            [[Database sharedManager] setFolderUnreadCount:self adjustment:adjustment];
-            return YES;
-        } else {
-            return NO;
-        }
+        // Unread count adjustment factor
+        __block NSInteger adjustment = 0;
+        Database * database = [Database sharedManager];
+        [database markGuids:listedGuids seenInFolder:self.itemId];
+
+        // add the new articles
+        NSIndexSet * addedIndexes = [database addArticles:newArticles toFolder:self.itemId];
+        [addedIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            Article * article = newArticles[index];
+            article.status = ArticleStatusNew;
+            self->latestFetchCount++;
+            // add to the cache
+            NSString * guid = article.guid;
+            [self.cachedArticles setObject:article forKey:guid];
+            [self.cachedGuids addObject:guid];
+            [knownGuids addObject:guid];
+            if (!article.isRead) {
+                adjustment++;
+            }
+        }];
+
+        // we have to verify if we need to update the existing articles
+        NSIndexSet * updatedIndexes = [database updateArticles:existingArticles ofFolder:self.itemId withArticles:articleUpdates];
+        [updatedIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            articleUpdates[index].status = ArticleStatusUpdated;
+            self->latestFetchCount++;
+            // Update folder unread count if necessary
+            Article * existingArticle = existingArticles[index];
+            if (existingArticle.isRead) {
+                adjustment++;
+                existingArticle.read = NO;
+            }
+        }];
+
+        // The database has already applied the new unread count to this
+        // folder, its parents and the Database manager.
+        return adjustment;
 
     } // synchronized
 }
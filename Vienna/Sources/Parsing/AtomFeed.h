@@ -26,7 +26,9 @@ NS_ASSUME_NONNULL_BEGIN
 NS_SWIFT_NAME(AtomFeed)
 @interface VNAAtomFeed : VNAXMLFeed
 
-- (nullable instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
+/// Creates a feed for the `<feed>` element. Its entries are passed to
+/// `-readElement:inContainer:` afterwards.
+- (instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
     NS_DESIGNATED_INITIALIZER;
 
 - (instancetype)init NS_UNAVAILABLE;
@@ -25,6 +25,11 @@
 @interface VNAAtomFeed ()
 
 @property (copy, nonatomic) NSString *atomPrefix;
+@property (nullable, copy, nonatomic) NSString *linkBase;
+@property (nullable, nonatomic) NSURL *linkBaseURL;
+@property (copy, nonatomic) NSString *defaultAuthor;
+@property (nullable, nonatomic) NSMutableArray<VNAXMLFeedItem *> *feedItems;
+@property (nonatomic) BOOL success;
 
 @end
 
@@ -32,314 +37,315 @@
 
 // MARK: Initialization
 
-- (nullable instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
+- (instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
 {
     self = [super init];
     if (self) {
-        BOOL success = [self initAtomFeed:rootElement];
-        return success ? self : nil;
+        [self identifyNamespacesPrefixes:rootElement];
+
+        // Look for feed attributes we need to process
+        _linkBase = [NSString vna_stringByCleaningURLString:[rootElement attributeForName:@"xml:base"].stringValue];
+        _linkBaseURL = (_linkBase != nil) ? [NSURL URLWithString:_linkBase] : nil;
+        _defaultAuthor = @"";
+        _feedItems = [NSMutableArray array];
     }
     return self;
 }
 
-/* initAtomFeed
- * Prime the feed with header and items from an Atom feed
+// MARK: Reading
+
+/* readElement
+ * Reads a header element or an entry of an Atom feed. Entries are converted
+ * to feed items as soon as they are read.
  */
-- (BOOL)initAtomFeed:(NSXMLElement *)atomElement
+- (void)readElement:(NSXMLElement *)element inContainer:(BOOL)inContainer
 {
-    BOOL success = NO;
+    BOOL isAtomElement = [element.prefix isEqualToString:self.atomPrefix];
+    NSString *elementTag = element.localName;
+
+    // Parse title
+    if (isAtomElement && [elementTag isEqualToString:@"title"]) {
+        self.title = element.stringValue.vna_stringByUnescapingExtendedCharacters.vna_summaryTextFromHTML;
+        self.success = YES;
+        return;
+    }
 
-    [self identifyNamespacesPrefixes:atomElement];
+    // Parse description]
+    if (isAtomElement && [elementTag isEqualToString:@"subtitle"]) {
+        self.feedDescription = element.stringValue;
+        return;
+    }
 
-    // Look for feed attributes we need to process
-    NSString *linkBase = [NSString vna_stringByCleaningURLString:[atomElement attributeForName:@"xml:base"].stringValue];
-    if (linkBase == nil) {
-        linkBase = [NSString vna_stringByCleaningURLString:self.homePageURL];
+    // Parse description
+    if (isAtomElement && [elementTag isEqualToString:@"tagline"]) {
+        self.feedDescription = element.stringValue;
+        return;
     }
-    NSURL *linkBaseURL = (linkBase != nil) ? [NSURL URLWithString:linkBase] : nil;
 
-    // Iterate through the atom items
-    NSString *defaultAuthor = @"";
+    // Parse link
+    if (isAtomElement && [elementTag isEqualToString:@"link"]) {
+        if ([element attributeForName:@"rel"].stringValue == nil ||
+            [[element attributeForName:@"rel"].stringValue isEqualToString:@"alternate"]) {
+            NSString *theLink = [NSString vna_stringByCleaningURLString:[element attributeForName:@"href"].stringValue];
+            if (theLink != nil) {
+                if ((self.linkBaseURL != nil) && ![theLink hasPrefix:@"http://"] && ![theLink hasPrefix:@"https://"]) {
+                    NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:self.linkBaseURL];
+                    self.homePageURL = theLinkURL ? theLinkURL.absoluteString : theLink;
+                } else {
+                    self.homePageURL = theLink;
+                }
+            }
+        }
 
-    NSMutableArray *items = [NSMutableArray array];
+        if (self.linkBase == nil) {
+            self.linkBase = [NSString vna_stringByCleaningURLString:self.homePageURL];
+        }
 
-    for (NSXMLElement *atomChildElement in atomElement.children) {
-        BOOL isAtomElement = [atomChildElement.prefix isEqualToString:self.atomPrefix];
-        NSString *elementTag = atomChildElement.localName;
+        self.success = YES;
+        return;
+    }
 
-        // Parse title
-        if (isAtomElement && [elementTag isEqualToString:@"title"]) {
-            self.title = atomChildElement.stringValue.vna_stringByUnescapingExtendedCharacters.vna_summaryTextFromHTML;
-            success = YES;
-            continue;
+    // Parse author at the feed level. This is the default for any entry
+    // that doesn't have an explicit author.
+    if (isAtomElement && [elementTag isEqualToString:@"author"]) {
+        NSXMLElement *nameElement = [element elementsForName:@"name"].firstObject;
+        if (nameElement != nil) {
+            self.defaultAuthor = [nameElement.stringValue vna_trimmed];
         }
+        self.success = YES;
+        return;
+    }
 
-        // Parse description]
-        if (isAtomElement && [elementTag isEqualToString:@"subtitle"]) {
-            self.feedDescription = atomChildElement.stringValue;
-            continue;
-        }
+    // Parse the date when this feed was last updated
+    if (isAtomElement && ([elementTag isEqualToString:@"updated"] || [elementTag isEqualToString:@"modified"])) {
+        NSString *dateString = element.stringValue;
+        self.modificationDate = [self dateWithXMLString:dateString];
+        self.success = YES;
+        return;
+    }
 
-        // Parse description
-        if (isAtomElement && [elementTag isEqualToString:@"tagline"]) {
-            self.feedDescription = atomChildElement.stringValue;
-            continue;
+    // Parse a single item to construct a FeedItem object which is appended to
+    // the items array we maintain.
+    if (isAtomElement && [elementTag isEqualToString:@"entry"]) {
+        [self.feedItems addObject:[self feedItemWithElement:element]];
+        self.success = YES;
+    }
+}
+
+- (BOOL)finishReading
+{
+    self.items = self.feedItems;
+    self.feedItems = nil;
+    return self.success;
+}
+
+/* feedItemWithElement
+ * Creates a feed item from an <entry> element.
+ */
+- (VNAXMLFeedItem *)feedItemWithElement:(NSXMLElement *)element
+{
+    VNAXMLFeedItem *newFeedItem = [VNAXMLFeedItem new];
+    NSMutableString *articleBody = nil;
+
+    // Look for the xml:base attribute, and use absolute url or stack relative url
+    NSString *entryBase = [NSString vna_stringByCleaningURLString:[element attributeForName:@"xml:base"].stringValue];
+
+    NSURL *entryBaseURL = [entryBase isEqualToString:@""] ? nil : [NSURL URLWithString:entryBase];
+    if ((entryBaseURL != nil) && (self.linkBaseURL != nil) && (entryBaseURL.scheme == nil)) {
+        entryBaseURL = [NSURL URLWithString:entryBase relativeToURL:self.linkBaseURL];
+        if (entryBaseURL != nil) {
+            entryBase = entryBaseURL.absoluteString;
         }
+    }
 
-        // Parse link
-        if (isAtomElement && [elementTag isEqualToString:@"link"]) {
-            if ([atomChildElement attributeForName:@"rel"].stringValue == nil ||
-                [[atomChildElement attributeForName:@"rel"].stringValue isEqualToString:@"alternate"]) {
-                NSString *theLink = [NSString vna_stringByCleaningURLString:[atomChildElement attributeForName:@"href"].stringValue];
-                if (theLink != nil) {
-                    if ((linkBaseURL != nil) && ![theLink hasPrefix:@"http://"] && ![theLink hasPrefix:@"https://"]) {
-                        NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:linkBaseURL];
-                        self.homePageURL = theLinkURL ? theLinkURL.absoluteString : theLink;
-                    } else {
-                        self.homePageURL = theLink;
-                    }
-                }
-            }
+    for (NSXMLElement *itemChildElement in element.children) {
+        BOOL isArticleElementAtomType = [itemChildElement.prefix isEqualToString:self.atomPrefix];
 
-            if (linkBase == nil) {
-                linkBase = [NSString vna_stringByCleaningURLString:self.homePageURL];
-            }
+        NSString *articleItemTag = itemChildElement.localName;
 
-            success = YES;
+        // Parse item title
+        if (isArticleElementAtomType && [articleItemTag isEqualToString:@"title"]) {
+            newFeedItem.title = (itemChildElement.stringValue).vna_summaryTextFromHTML;
             continue;
         }
 
-        // Parse author at the feed level. This is the default for any entry
-        // that doesn't have an explicit author.
-        if (isAtomElement && [elementTag isEqualToString:@"author"]) {
-            NSXMLElement *nameElement = [atomChildElement elementsForName:@"name"].firstObject;
-            if (nameElement != nil) {
-                defaultAuthor = [nameElement.stringValue vna_trimmed];
+        // Parse item description
+        if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"content"]
+                                         // not in specifications, added for flexibility
+                                         || [articleItemTag isEqualToString:@"description"])) {
+            NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
+            if ([type isEqualToString:@"xhtml"]) {
+                articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
+            } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
+                       [type rangeOfString:@"text"
+                                   options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
+                               .location != NSNotFound) {
+                // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
+                articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
+            } else {
+                articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
             }
-            success = YES;
             continue;
         }
 
-        // Parse the date when this feed was last updated
-        if (isAtomElement && ([elementTag isEqualToString:@"updated"] || [elementTag isEqualToString:@"modified"])) {
-            NSString *dateString = atomChildElement.stringValue;
-            self.modificationDate = [self dateWithXMLString:dateString];
-            success = YES;
+        // Parse item description
+        if (isArticleElementAtomType && [articleItemTag isEqualToString:@"summary"] && articleBody == nil) {
+            NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
+            if ([type isEqualToString:@"xhtml"]) {
+                articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
+            } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
+                       [type rangeOfString:@"text"
+                                   options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
+                               .location != NSNotFound) {
+                // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
+                articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
+            } else {
+                articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
+            }
             continue;
         }
 
-        // Parse a single item to construct a FeedItem object which is appended to
-        // the items array we maintain.
-        if (isAtomElement && [elementTag isEqualToString:@"entry"]) {
-            VNAXMLFeedItem *newFeedItem = [VNAXMLFeedItem new];
-            NSMutableString *articleBody = nil;
-
-            // Look for the xml:base attribute, and use absolute url or stack relative url
-            NSString *entryBase = [NSString vna_stringByCleaningURLString:[atomChildElement attributeForName:@"xml:base"].stringValue];
-
-            NSURL *entryBaseURL = [entryBase isEqualToString:@""] ? nil : [NSURL URLWithString:entryBase];
-            if ((entryBaseURL != nil) && (linkBaseURL != nil) && (entryBaseURL.scheme == nil)) {
-                entryBaseURL = [NSURL URLWithString:entryBase relativeToURL:linkBaseURL];
-                if (entryBaseURL != nil) {
-                    entryBase = entryBaseURL.absoluteString;
-                }
+        // Parse item author
+        if (isArticleElementAtomType && [articleItemTag isEqualToString:@"author"]) {
+            NSString *authorName = ([itemChildElement elementsForName:@"name"].firstObject).stringValue;
+            authorName = [authorName vna_trimmed];
+            if (!authorName) {
+                authorName = ([itemChildElement elementsForName:@"email"].firstObject).stringValue;
             }
-
-            for (NSXMLElement *itemChildElement in atomChildElement.children) {
-                BOOL isArticleElementAtomType = [itemChildElement.prefix isEqualToString:self.atomPrefix];
-
-                NSString *articleItemTag = itemChildElement.localName;
-
-                // Parse item title
-                if (isArticleElementAtomType && [articleItemTag isEqualToString:@"title"]) {
-                    newFeedItem.title = (itemChildElement.stringValue).vna_summaryTextFromHTML;
-                    continue;
-                }
-
-                // Parse item description
-                if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"content"]
-                                                 // not in specifications, added for flexibility
-                                                 || [articleItemTag isEqualToString:@"description"])) {
-                    NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
-                    if ([type isEqualToString:@"xhtml"]) {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
-                    } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
-                               [type rangeOfString:@"text"
-                                           options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
-                                       .location != NSNotFound) {
-                        // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
-                        articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
-                    } else {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
-                    }
-                    continue;
+            // the author is in the feed's entry
+            if (authorName) {
+                // if we currently have a string set as the author then append the new author name
+                // else we currently don't have an author set, so set it to the first author
+                NSStringCompareOptions opts = (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch);
+                NSRange range = [newFeedItem.authors rangeOfString:authorName
+                                                           options:opts];
+                if (newFeedItem.authors.length > 0 && range.location != NSNotFound) {
+                    newFeedItem.authors = [NSString stringWithFormat:NSLocalizedString(@"%@, %@", @"{existing authors}, {new author name}"), newFeedItem.authors, authorName];
+                } else {
+                    newFeedItem.authors = authorName;
                 }
+            }
+            continue;
+        }
 
-                // Parse item description
-                if (isArticleElementAtomType && [articleItemTag isEqualToString:@"summary"] && articleBody == nil) {
-                    NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
-                    if ([type isEqualToString:@"xhtml"]) {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
-                    } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
-                               [type rangeOfString:@"text"
-                                           options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
-                                       .location != NSNotFound) {
-                        // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
-                        articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
+        // Parse item link
+        if (isArticleElementAtomType && [articleItemTag isEqualToString:@"link"]) {
+            if ([[itemChildElement attributeForName:@"rel"].stringValue isEqualToString:@"enclosure"] ||
+                [[itemChildElement attributeForName:@"rel"].stringValue hasPrefix:@"http://opds-spec.org/acquisition"]) {
+                NSString *theLink = ([itemChildElement attributeForName:@"href"].stringValue).vna_stringByUnescapingExtendedCharacters;
+                if (theLink != nil) {
+                    if ((entryBaseURL != nil) && ([NSURL URLWithString:theLink].scheme == nil)) {
+                        NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:entryBaseURL];
+                        newFeedItem.enclosure = (theLinkURL != nil) ? theLinkURL.absoluteString : theLink;
                     } else {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
+                        newFeedItem.enclosure = theLink;
                     }
-                    continue;
                 }
-
-                // Parse item author
-                if (isArticleElementAtomType && [articleItemTag isEqualToString:@"author"]) {
-                    NSString *authorName = ([itemChildElement elementsForName:@"name"].firstObject).stringValue;
-                    authorName = [authorName vna_trimmed];
-                    if (!authorName) {
-                        authorName = ([itemChildElement elementsForName:@"email"].firstObject).stringValue;
-                    }
-                    // the author is in the feed's entry
-                    if (authorName) {
-                        // if we currently have a string set as the author then append the new author name
-                        // else we currently don't have an author set, so set it to the first author
-                        NSStringCompareOptions opts = (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch);
-                        NSRange range = [newFeedItem.authors rangeOfString:authorName
-                                                                   options:opts];
-                        if (newFeedItem.authors.length > 0 && range.location != NSNotFound) {
-                            newFeedItem.authors = [NSString stringWithFormat:NSLocalizedString(@"%@, %@", @"{existing authors}, {new author name}"), newFeedItem.authors, authorName];
+            } else {
+                if ([itemChildElement attributeForName:@"rel"].stringValue == nil ||
+                    [[itemChildElement attributeForName:@"rel"].stringValue isEqualToString:@"alternate"]) {
+                    NSString *theLink = ([itemChildElement attributeForName:@"href"].stringValue).vna_stringByUnescapingExtendedCharacters;
+                    if (theLink != nil) {
+                        if ((entryBaseURL != nil) && ([NSURL URLWithString:theLink].scheme == nil)) {
+                            NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:entryBaseURL];
+                            newFeedItem.url = (theLinkURL != nil) ? theLinkURL.absoluteString : theLink;
                         } else {
-                            newFeedItem.authors = authorName;
-                        }
-                    }
-                    continue;
-                }
-
-                // Parse item link
-                if (isArticleElementAtomType && [articleItemTag isEqualToString:@"link"]) {
-                    if ([[itemChildElement attributeForName:@"rel"].stringValue isEqualToString:@"enclosure"] ||
-                        [[itemChildElement attributeForName:@"rel"].stringValue hasPrefix:@"http://opds-spec.org/acquisition"]) {
-                        NSString *theLink = ([itemChildElement attributeForName:@"href"].stringValue).vna_stringByUnescapingExtendedCharacters;
-                        if (theLink != nil) {
-                            if ((entryBaseURL != nil) && ([NSURL URLWithString:theLink].scheme == nil)) {
-                                NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:entryBaseURL];
-                                newFeedItem.enclosure = (theLinkURL != nil) ? theLinkURL.absoluteString : theLink;
-                            } else {
-                                newFeedItem.enclosure = theLink;
-                            }
+                            newFeedItem.url = theLink;
                         }
-                    } else {
-                        if ([itemChildElement attributeForName:@"rel"].stringValue == nil ||
-                            [[itemChildElement attributeForName:@"rel"].stringValue isEqualToString:@"alternate"]) {
-                            NSString *theLink = ([itemChildElement attributeForName:@"href"].stringValue).vna_stringByUnescapingExtendedCharacters;
-                            if (theLink != nil) {
-                                if ((entryBaseURL != nil) && ([NSURL URLWithString:theLink].scheme == nil)) {
-                                    NSURL *theLinkURL = [NSURL URLWithString:theLink relativeToURL:entryBaseURL];
-                                    newFeedItem.url = (theLinkURL != nil) ? theLinkURL.absoluteString : theLink;
-                                } else {
-                                    newFeedItem.url = theLink;
-                                }
-                            }
-                        }
-                        continue;
                     }
                 }
+                continue;
+            }
+        }
 
-                // Parse item id
-                if (isArticleElementAtomType && [articleItemTag isEqualToString:@"id"]) {
-                    newFeedItem.guid = itemChildElement.stringValue;
-                    continue;
-                }
-
-                // Parse item date
-                if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"updated"] || [articleItemTag isEqualToString:@"modified"])) {
-                    NSString *dateString = itemChildElement.stringValue;
-                    NSDate *newDate = [self dateWithXMLString:dateString];
-                    if (newFeedItem.modificationDate == nil || [newDate isGreaterThan:newFeedItem.modificationDate]) {
-                        newFeedItem.modificationDate = newDate;
-                    }
-                    continue;
-                }
-
-                // Parse item date
-                if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"published"]
-                                                 // not in specifications, added for flexibility
-                                                 || [articleItemTag isEqualToString:@"created"] || [articleItemTag isEqualToString:@"issued"] || [articleItemTag isEqualToString:@"pubDate"])) {
-                    NSString *dateString = itemChildElement.stringValue;
-                    NSDate *newDate = [self dateWithXMLString:dateString];
-                    if (newFeedItem.publicationDate == nil || [newDate isLessThan:newFeedItem.publicationDate]) {
-                        newFeedItem.publicationDate = newDate;
-                    }
-                    continue;
-                }
+        // Parse item id
+        if (isArticleElementAtomType && [articleItemTag isEqualToString:@"id"]) {
+            newFeedItem.guid = itemChildElement.stringValue;
+            continue;
+        }
 
-                // Parse associated enclosure
-                if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"content"]) {
-                    if ([itemChildElement attributeForName:@"url"].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
-                    }
-                    continue;
-                }
+        // Parse item date
+        if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"updated"] || [articleItemTag isEqualToString:@"modified"])) {
+            NSString *dateString = itemChildElement.stringValue;
+            NSDate *newDate = [self dateWithXMLString:dateString];
+            if (newFeedItem.modificationDate == nil || [newDate isGreaterThan:newFeedItem.modificationDate]) {
+                newFeedItem.modificationDate = newDate;
+            }
+            continue;
+        }
 
-                // Parse associated enclosure
-                if ([itemChildElement.prefix isEqualToString:self.encPrefix] && [articleItemTag isEqualToString:@"enclosure"]) {
-                    if ([itemChildElement attributeForName:@"url"].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
-                    }
-                    NSString *resourceString = [NSString stringWithFormat:@"%@:resource", self.rdfPrefix];
-                    if ([itemChildElement attributeForName:resourceString].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:resourceString].stringValue;
-                    }
-                    continue;
-                }
+        // Parse item date
+        if (isArticleElementAtomType && ([articleItemTag isEqualToString:@"published"]
+                                         // not in specifications, added for flexibility
+                                         || [articleItemTag isEqualToString:@"created"] || [articleItemTag isEqualToString:@"issued"] || [articleItemTag isEqualToString:@"pubDate"])) {
+            NSString *dateString = itemChildElement.stringValue;
+            NSDate *newDate = [self dateWithXMLString:dateString];
+            if (newFeedItem.publicationDate == nil || [newDate isLessThan:newFeedItem.publicationDate]) {
+                newFeedItem.publicationDate = newDate;
+            }
+            continue;
+        }
 
-                // Parse media group
-                if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"group"]) {
-                    if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
-                        // group's first enclosure
-                        NSString *enclosureString = [NSString stringWithFormat:@"%@:content", self.mediaPrefix];
-                        newFeedItem.enclosure =
-                            ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
-                    }
-                    if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
-                        // use first thumbnail as a workaround for enclosure
-                        NSString *enclosureString = [NSString stringWithFormat:@"%@:thumbnail", self.mediaPrefix];
-                        newFeedItem.enclosure =
-                            ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
-                    }
-                    if (!articleBody || [articleBody isEqualToString:@""]) {
-                        // use enclosure description as a workaround for feed description
-                        NSString *descriptionString = [NSString stringWithFormat:@"%@:description", self.mediaPrefix];
-                        articleBody =
-                            [([itemChildElement elementsForName:descriptionString].firstObject).stringValue mutableCopy];
-                    }
-                    continue;
-                }
+        // Parse associated enclosure
+        if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"content"]) {
+            if ([itemChildElement attributeForName:@"url"].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
             }
+            continue;
+        }
 
-            // if we didn't find an author, set it to the default one
-            if ([newFeedItem.authors isEqualToString:@""]) {
-                newFeedItem.authors = defaultAuthor;
+        // Parse associated enclosure
+        if ([itemChildElement.prefix isEqualToString:self.encPrefix] && [articleItemTag isEqualToString:@"enclosure"]) {
+            if ([itemChildElement attributeForName:@"url"].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
+            }
+            NSString *resourceString = [NSString stringWithFormat:@"%@:resource", self.rdfPrefix];
+            if ([itemChildElement attributeForName:resourceString].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:resourceString].stringValue;
             }
+            continue;
+        }
 
-            if ([entryBase isEqualToString:@""]) {
-                entryBase = newFeedItem.url ? newFeedItem.url : linkBase;
+        // Parse media group
+        if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"group"]) {
+            if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
+                // group's first enclosure
+                NSString *enclosureString = [NSString stringWithFormat:@"%@:content", self.mediaPrefix];
+                newFeedItem.enclosure =
+                    ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
+            }
+            if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
+                // use first thumbnail as a workaround for enclosure
+                NSString *enclosureString = [NSString stringWithFormat:@"%@:thumbnail", self.mediaPrefix];
+                newFeedItem.enclosure =
+                    ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
+            }
+            if (!articleBody || [articleBody isEqualToString:@""]) {
+                // use enclosure description as a workaround for feed description
+                NSString *descriptionString = [NSString stringWithFormat:@"%@:description", self.mediaPrefix];
+                articleBody =
+                    [([itemChildElement elementsForName:descriptionString].firstObject).stringValue mutableCopy];
             }
+            continue;
+        }
+    }
 
-            // Do relative IMG, IFRAME and A tags fixup
-            [articleBody vna_fixupRelativeImgTags:entryBase];
-            [articleBody vna_fixupRelativeIframeTags:entryBase];
-            [articleBody vna_fixupRelativeAnchorTags:entryBase];
-            newFeedItem.content = SafeString(articleBody);
+    // if we didn't find an author, set it to the default one
+    if ([newFeedItem.authors isEqualToString:@""]) {
+        newFeedItem.authors = self.defaultAuthor;
+    }
 
-            [items addObject:newFeedItem];
-            success = YES;
-        }
+    if ([entryBase isEqualToString:@""]) {
+        entryBase = newFeedItem.url ? newFeedItem.url : self.linkBase;
     }
 
-    self.items = items;
+    // Do relative IMG, IFRAME and A tags fixup
+    [articleBody vna_fixupRelativeImgTags:entryBase];
+    [articleBody vna_fixupRelativeIframeTags:entryBase];
+    [articleBody vna_fixupRelativeAnchorTags:entryBase];
+    newFeedItem.content = SafeString(articleBody);
 
-    return success;
+    return newFeedItem;
 }
 
 // MARK: Overrides
@@ -32,6 +32,10 @@ NS_SWIFT_NAME(Feed)
 @property (nullable, nonatomic) NSDate *modificationDate;
 @property (copy, nonatomic) NSArray<id<VNAFeedItem>> *items;
 
+/// The number of seconds for which the feed may be cached before it is
+/// fetched again, or 0 if the feed does not say.
+@property (nonatomic) NSTimeInterval timeToLive;
+
 @end
 
 NS_ASSUME_NONNULL_END
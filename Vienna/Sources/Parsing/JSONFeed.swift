@@ -37,6 +37,9 @@ class JSONFeed: NSObject, Feed, Decodable {
     // The `items` key is required (but the array may be empty).
     var items: [any FeedItem]
 
+    // JSON Feed has no key for this.
+    var timeToLive: TimeInterval = 0
+
     // MARK: Decodable
 
     enum CodingKeys: String, CodingKey {
@@ -26,8 +26,10 @@ NS_ASSUME_NONNULL_BEGIN
 NS_SWIFT_NAME(RSSFeed)
 @interface VNARSSFeed : VNAXMLFeed
 
-- (nullable instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
-                                          isRDF:(BOOL)isRDF
+/// Creates a feed for a root element without children, which are read
+/// afterwards with `-readElement:inContainer:`.
+- (instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
+                                 isRDF:(BOOL)isRDF
     NS_DESIGNATED_INITIALIZER;
 
 - (instancetype)init NS_UNAVAILABLE;
@@ -25,10 +25,18 @@
 @interface VNARSSFeed ()
 
 @property (nonatomic) NSMutableArray *orderArray;
+@property (nonatomic, getter=isRDF) BOOL rdf;
+@property (nonatomic) BOOL hasChannel;
+@property (nonatomic) NSMutableArray<VNAXMLFeedItem *> *channelItems;
+@property (nonatomic) NSMutableArray<VNAXMLFeedItem *> *rootItems;
+@property (nonatomic) NSHashTable<VNAXMLFeedItem *> *itemsWithoutLink;
+@property (nonatomic) NSTimeInterval updatePeriod;
+@property (nonatomic) NSInteger updateFrequency;
 
 @property (copy, nonatomic) NSString *rssPrefix;
 @property (copy, nonatomic) NSString *dcPrefix;
 @property (copy, nonatomic) NSString *contentPrefix;
+@property (copy, nonatomic) NSString *syPrefix;
 
 @end
 
@@ -36,121 +44,168 @@
 
 // MARK: Initialization
 
-- (nullable instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
-                                          isRDF:(BOOL)isRDF
+- (instancetype)initWithXMLRootElement:(NSXMLElement *)rootElement
+                                 isRDF:(BOOL)isRDF
 {
     self = [super init];
     if (self) {
-        BOOL success = [self initRSSFeed:rootElement isRDF:isRDF];
-        return success ? self : nil;
+        _rdf = isRDF;
+        _channelItems = [NSMutableArray array];
+        _rootItems = [NSMutableArray array];
+        _itemsWithoutLink = [NSHashTable weakObjectsHashTable];
+        [self identifyNamespacesPrefixes:rootElement];
     }
     return self;
 }
 
-/* initRSSFeed
- * Prime the feed with header and items from an RSS feed
+// MARK: Reading
+
+- (NSString *)containerElementName
+{
+    if ([self.rssPrefix isEqualToString:@""]) {
+        return @"channel";
+    }
+    return [NSString stringWithFormat:@"%@:channel", self.rssPrefix];
+}
+
+/* readElement
+ * Items are read from the <channel> element, or from the root element of RDF
+ * feeds. Previous versions of RSS allowed <item> elements under the <rss>
+ * element instead of the <channel> element; those are only used if no items
+ * were found under the <channel> element.
  */
-- (BOOL)initRSSFeed:(NSXMLElement *)rssElement isRDF:(BOOL)isRDF
+- (void)readElement:(NSXMLElement *)element inContainer:(BOOL)inContainer
 {
-    BOOL success = NO;
-
-    [self identifyNamespacesPrefixes:rssElement];
-    NSXMLElement *channelElement = [self channelElementFromRSSElement:rssElement];
-    success = [self initRSSFeedHeaderWithElement:channelElement];
-    if (success) {
-        if (isRDF) {
-            [self initRSSFeedItems:rssElement];
+    if ([element.prefix isEqualToString:self.rssPrefix] && [element.localName isEqualToString:@"item"]) {
+        NSString *itemIdentifier = nil;
+        VNAXMLFeedItem *feedItem = [self feedItemWithElement:element identifier:&itemIdentifier];
+        NSMutableArray<VNAXMLFeedItem *> *items = inContainer ? self.channelItems : self.rootItems;
+
+        // Add this item in the proper location in the array
+        NSUInteger index = self.orderArray && itemIdentifier ? [self.orderArray indexOfObject:itemIdentifier] : NSNotFound;
+        if (index == NSNotFound || index >= items.count) {
+            [items addObject:feedItem];
         } else {
-            [self initRSSFeedItems:channelElement];
-
-            // Previous versions of RSS allowed <item> elements under the <rss>
-            // element instead of the <channel> element. If no items were found
-            // under the <channel> element then traverse the <rss> element too.
-            if (self.items.count == 0) {
-                [self initRSSFeedItems:rssElement];
-            }
+            [items insertObject:feedItem atIndex:index];
         }
+    } else if (inContainer) {
+        self.hasChannel = [self readChannelElement:element] || self.hasChannel;
     }
-    return success;
 }
 
-/**
- *  Get the root of the RSS feed's channel.
- *
- *  @param rssElement The rss element of the feed
- *
- *  @return the channel element
+/* finishReading
+ * The <link> element of the channel may follow the items, so the items
+ * without a link of their own get that of the feed, and the relative URLs
+ * of their content are resolved, only once the whole feed is read.
  */
-- (NSXMLElement *)channelElementFromRSSElement:(NSXMLElement *)rssElement
+- (BOOL)finishReading
 {
-    NSXMLElement *channelElement;
+    if (self.updatePeriod > 0 && self.timeToLive == 0) {
+        self.timeToLive = self.updatePeriod / MAX(self.updateFrequency, 1);
+    }
 
-    if ([self.rssPrefix isEqualToString:@""]) {
-        channelElement = [rssElement elementsForName:@"channel"].firstObject;
+    if (self.isRDF || self.channelItems.count == 0) {
+        self.items = self.rootItems;
     } else {
-        channelElement = [rssElement elementsForName:[NSString stringWithFormat:@"%@:channel", self.rssPrefix]].firstObject;
+        self.items = self.channelItems;
+    }
+    self.channelItems = nil;
+    self.rootItems = nil;
+
+    for (VNAXMLFeedItem *feedItem in self.items) {
+        // If no link, set it to the feed link if there is one
+        if (self.homePageURL && [self.itemsWithoutLink containsObject:feedItem]) {
+            feedItem.url = self.homePageURL;
+        }
+
+        // Do relative IMG, IFRAME and A tags fixup
+        NSMutableString *articleBody = [feedItem.content mutableCopy];
+        [articleBody vna_fixupRelativeImgTags:feedItem.url];
+        [articleBody vna_fixupRelativeIframeTags:feedItem.url];
+        [articleBody vna_fixupRelativeAnchorTags:feedItem.url];
+        feedItem.content = articleBody;
     }
-    return channelElement;
+    self.itemsWithoutLink = nil;
+    return self.hasChannel;
 }
 
 /**
- *  Parse an RSS feed's header items
+ *  Parse one of an RSS feed's header items
  *
- *  @param channelElement the element containing header items.
- *  This is typically a channel element for RSS feeds
+ *  @param element a child element of the channel element
  *
- *  @return YES on success
+ *  @return YES if the element identifies the feed
  */
-- (BOOL)initRSSFeedHeaderWithElement:(NSXMLElement *)channelElement
+- (BOOL)readChannelElement:(NSXMLElement *)element
 {
-    BOOL success = NO;
+    NSString *channelItemTag = element.localName;
+    BOOL isRSSElement = [element.prefix isEqualToString:self.rssPrefix];
 
-    // Iterate through the channel items
-    for (NSXMLElement *element in channelElement.children) {
-        NSString *channelItemTag = element.localName;
-        BOOL isRSSElement = [element.prefix isEqualToString:self.rssPrefix];
+    // Parse title
+    if (isRSSElement && [channelItemTag isEqualToString:@"title"]) {
+        self.title = element.stringValue.vna_stringByUnescapingExtendedCharacters;
+        return YES;
+    }
+    // Parse items group which dictates the sequence of the articles.
+    if (isRSSElement && [channelItemTag isEqualToString:@"items"]) {
+        NSXMLElement *seqElement = [element elementsForName:[NSString stringWithFormat:@"%@:Seq", self.rdfPrefix]].firstObject;
 
-        // Parse title
-        if (isRSSElement && [channelItemTag isEqualToString:@"title"]) {
-            self.title = element.stringValue.vna_stringByUnescapingExtendedCharacters;
-            success = YES;
-            continue;
+        if (seqElement != nil) {
+            [self parseSequence:seqElement];
         }
-        // Parse items group which dictates the sequence of the articles.
-        if (isRSSElement && [channelItemTag isEqualToString:@"items"]) {
-            NSXMLElement *seqElement = [element elementsForName:[NSString stringWithFormat:@"%@:Seq", self.rdfPrefix]].firstObject;
+        return NO;
+    }
 
-            if (seqElement != nil) {
-                [self parseSequence:seqElement];
-            }
-        }
+    // Parse description
+    if (isRSSElement && [channelItemTag isEqualToString:@"description"]) {
+        self.feedDescription = element.stringValue;
+        return YES;
+    }
 
-        // Parse description
-        if (isRSSElement && [channelItemTag isEqualToString:@"description"]) {
-            self.feedDescription = element.stringValue;
-            success = YES;
-            continue;
-        }
+    // Parse link
+    if (isRSSElement && [channelItemTag isEqualToString:@"link"]) {
+        self.homePageURL = (element.stringValue).vna_stringByUnescapingExtendedCharacters;
+        return YES;
+    }
 
-        // Parse link
-        if (isRSSElement && [channelItemTag isEqualToString:@"link"]) {
-            self.homePageURL = (element.stringValue).vna_stringByUnescapingExtendedCharacters;
-            success = YES;
-            continue;
-        }
+    // Parse the date when this feed was last updated
+    if ((isRSSElement && [channelItemTag isEqualToString:@"lastBuildDate"]) ||
+        (isRSSElement && [channelItemTag isEqualToString:@"pubDate"]) ||
+        ([element.prefix isEqualToString:self.dcPrefix] && [channelItemTag isEqualToString:@"date"])) {
+        NSString *dateString = element.stringValue;
+        //publication date will be set to the current date in a later step, so we don´t set it here
+        self.modificationDate = [self dateWithXMLString:dateString];
+        return YES;
+    }
 
-        // Parse the date when this feed was last updated
-        if ((isRSSElement && [channelItemTag isEqualToString:@"lastBuildDate"]) ||
-            (isRSSElement && [channelItemTag isEqualToString:@"pubDate"]) ||
-            ([element.prefix isEqualToString:self.dcPrefix] && [channelItemTag isEqualToString:@"date"])) {
-            NSString *dateString = element.stringValue;
-            //publication date will be set to the current date in a later step, so we don´t set it here
-            self.modificationDate = [self dateWithXMLString:dateString];
-            success = YES;
-            continue;
+    // Parse the number of minutes that the feed may be cached
+    if (isRSSElement && [channelItemTag isEqualToString:@"ttl"]) {
+        NSInteger minutes = element.stringValue.integerValue;
+        if (minutes > 0) {
+            self.timeToLive = minutes * 60.0;
         }
+        return NO;
+    }
+
+    // Parse the update period of the syndication module, which is
+    // divided by the update frequency when the feed is complete
+    if ([element.prefix isEqualToString:self.syPrefix] && [channelItemTag isEqualToString:@"updatePeriod"]) {
+        NSDictionary<NSString *, NSNumber *> *periods = @{
+            @"hourly": @(3600.0),
+            @"daily": @(86400.0),
+            @"weekly": @(7 * 86400.0),
+            @"monthly": @(30 * 86400.0),
+            @"yearly": @(365 * 86400.0),
+        };
+        NSString *period = [element.stringValue stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+        self.updatePeriod = periods[period.lowercaseString].doubleValue;
+        return NO;
     }
-    return success;
+    if ([element.prefix isEqualToString:self.syPrefix] && [channelItemTag isEqualToString:@"updateFrequency"]) {
+        self.updateFrequency = element.stringValue.integerValue;
+        return NO;
+    }
+    return NO;
 }
 
 /**
@@ -175,191 +230,180 @@
     }
 }
 
-- (void)initRSSFeedItems:(NSXMLElement *)startElement
+/**
+ *  Parse a single item to construct a FeedItem object.
+ *
+ *  @param element the item element
+ *  @param identifier set to the rdf:about attribute of the item, if any
+ *
+ *  @return the feed item
+ */
+- (VNAXMLFeedItem *)feedItemWithElement:(NSXMLElement *)element identifier:(NSString **)identifier
 {
-    NSMutableArray *items = [NSMutableArray array];
-
-    for (NSXMLElement *element in startElement.children) {
-        // Parse a single item to construct a FeedItem object which is appended to
-        // the items array we maintain.
-        if ([element.prefix isEqualToString:self.rssPrefix] && [element.localName isEqualToString:@"item"]) {
-            VNAXMLFeedItem *newFeedItem = [VNAXMLFeedItem new];
-            NSMutableString *articleBody = nil;
-            BOOL hasDetailedContent = NO;
-            BOOL hasLink = NO;
-
-            // Check for rdf:about so we can identify this item in the orderArray.
-            NSString *itemIdentifier = [element attributeForName:[NSString stringWithFormat:@"%@:about", self.rdfPrefix]].stringValue;
-
-            for (NSXMLElement *itemChildElement in element.children) {
-                BOOL isRSSElement = [itemChildElement.prefix isEqualToString:self.rssPrefix];
-                NSString *articleItemTag = itemChildElement.localName;
-
-                // Parse item title
-                if (isRSSElement && [articleItemTag isEqualToString:@"title"]) {
-                    newFeedItem.title = (itemChildElement.stringValue).vna_summaryTextFromHTML;
-                    continue;
-                }
+    VNAXMLFeedItem *newFeedItem = [VNAXMLFeedItem new];
+    NSMutableString *articleBody = nil;
+    BOOL hasDetailedContent = NO;
+    BOOL hasLink = NO;
 
-                // Parse item description
-                if (isRSSElement && ([articleItemTag isEqualToString:@"description"]
-                                     // not in specifications, added for flexibility
-                                     || [articleItemTag isEqualToString:@"content"])
-                    && !hasDetailedContent) {
-                    NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
-                    if ([type isEqualToString:@"xhtml"]) {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
-                    } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
-                               [type rangeOfString:@"text"
-                                           options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
-                                       .location != NSNotFound) {
-                        // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
-                        articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
-                    } else {
-                        articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
-                    }
-                    continue;
-                }
+    // Check for rdf:about so we can identify this item in the orderArray.
+    NSString *itemIdentifier = [element attributeForName:[NSString stringWithFormat:@"%@:about", self.rdfPrefix]].stringValue;
 
-                // Parse GUID. The GUID may optionally have a permaLink attribute
-                // in which case this is also the article link unless overridden by
-                // an explicit link tag.
-                if (isRSSElement && [articleItemTag isEqualToString:@"guid"]) {
-                    NSString *permaLink = [itemChildElement
-                                              attributeForName:@"isPermaLink"]
-                                              .stringValue;
-
-                    if (permaLink && [permaLink isEqualToString:@"true"] && !hasLink) {
-                        newFeedItem.url = itemChildElement.stringValue;
-                    }
-                    newFeedItem.guid = itemChildElement.stringValue;
-                    continue;
-                }
+    for (NSXMLElement *itemChildElement in element.children) {
+        BOOL isRSSElement = [itemChildElement.prefix isEqualToString:self.rssPrefix];
+        NSString *articleItemTag = itemChildElement.localName;
 
-                // Parse detailed item description. This overrides the existing
-                // description for this item, provided it is not an empty string.
-                if ([itemChildElement.prefix isEqualToString:self.contentPrefix] &&
-                    [articleItemTag isEqualToString:@"encoded"] &&
-                    !itemChildElement.stringValue.vna_isBlank) {
-                    articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
-                    hasDetailedContent = YES;
-                    continue;
-                }
+        // Parse item title
+        if (isRSSElement && [articleItemTag isEqualToString:@"title"]) {
+            newFeedItem.title = (itemChildElement.stringValue).vna_summaryTextFromHTML;
+            continue;
+        }
 
-                // Parse item author
-                if ((isRSSElement && [articleItemTag isEqualToString:@"author"]) || ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"creator"])) {
-                    NSString *authorName = [itemChildElement.stringValue vna_trimmed];
-
-                    // the author is in the feed's entry
-                    if (authorName) {
-                        // if we currently have a string set as the author then append the new author name
-                        // else we currently don't have an author set, so set it to the first author
-                        if (newFeedItem.authors.length > 0 &&
-                            [newFeedItem.authors rangeOfString:authorName
-                                                       options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)]
-                                    .location != NSNotFound) {
-                            newFeedItem.authors = [NSString stringWithFormat:NSLocalizedString(@"%@, %@", @"{existing authors}, {new author name}"), newFeedItem.authors, authorName];
-                        } else {
-                            newFeedItem.authors = authorName;
-                        }
-                    }
-                    continue;
-                }
+        // Parse item description
+        if (isRSSElement && ([articleItemTag isEqualToString:@"description"]
+                             // not in specifications, added for flexibility
+                             || [articleItemTag isEqualToString:@"content"])
+            && !hasDetailedContent) {
+            NSString *type = [itemChildElement attributeForName:@"type"].stringValue;
+            if ([type isEqualToString:@"xhtml"]) {
+                articleBody = [NSMutableString stringWithString:itemChildElement.XMLString];
+            } else if (type != nil && ![type isEqualToString:@"text/xml"] && ![type isEqualToString:@"text/html"] &&
+                       [type rangeOfString:@"text"
+                                   options:NSRegularExpressionSearch | NSCaseInsensitiveSearch]
+                               .location != NSNotFound) {
+                // 'type' attribute is 'text*' and not 'text/xml' nor 'text/html'
+                articleBody = [[NSString vna_stringByConvertingHTMLEntities:itemChildElement.stringValue] mutableCopy];
+            } else {
+                articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
+            }
+            continue;
+        }
 
-                // Parse item date
-                if ((isRSSElement && ([articleItemTag isEqualToString:@"pubDate"] ||
-                                      // not in specifications, added for flexibility
-                                      [articleItemTag isEqualToString:@"published"] || [articleItemTag isEqualToString:@"created"] || [articleItemTag isEqualToString:@"issued"]))
-                    || ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"date"])) {
-                    NSDate *newDate = [self dateWithXMLString:itemChildElement.stringValue];
-                    if (newFeedItem.publicationDate == nil || [newDate isLessThan:newFeedItem.publicationDate]) {
-                        newFeedItem.publicationDate = newDate;
-                    }
-                    continue;
-                }
+        // Parse GUID. The GUID may optionally have a permaLink attribute
+        // in which case this is also the article link unless overridden by
+        // an explicit link tag.
+        if (isRSSElement && [articleItemTag isEqualToString:@"guid"]) {
+            NSString *permaLink = [itemChildElement
+                                      attributeForName:@"isPermaLink"]
+                                      .stringValue;
 
-                // Parse item modification date
-                if ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"modified"]) {
-                    NSDate *newDate = [self dateWithXMLString:itemChildElement.stringValue];
-                    if (newFeedItem.modificationDate == nil || [newDate isGreaterThan:newFeedItem.modificationDate]) {
-                        newFeedItem.modificationDate = newDate;
-                    }
-                    continue;
-                }
+            if (permaLink && [permaLink isEqualToString:@"true"] && !hasLink) {
+                newFeedItem.url = itemChildElement.stringValue;
+            }
+            newFeedItem.guid = itemChildElement.stringValue;
+            continue;
+        }
 
-                // Parse item link
-                if (isRSSElement && [articleItemTag isEqualToString:@"link"]) {
-                    newFeedItem.url = (itemChildElement.stringValue).vna_stringByUnescapingExtendedCharacters;
-                    hasLink = YES;
-                    continue;
-                }
+        // Parse detailed item description. This overrides the existing
+        // description for this item, provided it is not an empty string.
+        if ([itemChildElement.prefix isEqualToString:self.contentPrefix] &&
+            [articleItemTag isEqualToString:@"encoded"] &&
+            !itemChildElement.stringValue.vna_isBlank) {
+            articleBody = [NSMutableString stringWithString:itemChildElement.stringValue];
+            hasDetailedContent = YES;
+            continue;
+        }
 
-                // Parse associated enclosure
-                if ((isRSSElement && [articleItemTag isEqualToString:@"enclosure"]) || ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"content"])) {
-                    if ([itemChildElement attributeForName:@"url"].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
-                    }
-                    continue;
-                }
-                if ([itemChildElement.prefix isEqualToString:self.encPrefix] && [articleItemTag isEqualToString:@"enclosure"]) {
-                    if ([itemChildElement attributeForName:@"url"].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
-                    }
-                    NSString *resourceString = [NSString stringWithFormat:@"%@:resource", self.rdfPrefix];
-                    if ([itemChildElement attributeForName:resourceString].stringValue) {
-                        newFeedItem.enclosure = [itemChildElement attributeForName:resourceString].stringValue;
-                    }
-                    continue;
+        // Parse item author
+        if ((isRSSElement && [articleItemTag isEqualToString:@"author"]) || ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"creator"])) {
+            NSString *authorName = [itemChildElement.stringValue vna_trimmed];
+
+            // the author is in the feed's entry
+            if (authorName) {
+                // if we currently have a string set as the author then append the new author name
+                // else we currently don't have an author set, so set it to the first author
+                if (newFeedItem.authors.length > 0 &&
+                    [newFeedItem.authors rangeOfString:authorName
+                                               options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)]
+                            .location != NSNotFound) {
+                    newFeedItem.authors = [NSString stringWithFormat:NSLocalizedString(@"%@, %@", @"{existing authors}, {new author name}"), newFeedItem.authors, authorName];
+                } else {
+                    newFeedItem.authors = authorName;
                 }
+            }
+            continue;
+        }
 
-                // Parse media group
-                if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"group"]) {
-                    if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
-                        // group's first enclosure
-                        NSString *enclosureString = [NSString stringWithFormat:@"%@:content", self.mediaPrefix];
-                        newFeedItem.enclosure =
-                            ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
-                    }
-                    if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
-                        // use first thumbnail as a workaround for enclosure
-                        NSString *enclosureString = [NSString stringWithFormat:@"%@:thumbnail", self.mediaPrefix];
-                        newFeedItem.enclosure =
-                            ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
-                    }
-                    if (!articleBody || [articleBody isEqualToString:@""]) {
-                        // use enclosure description as a workaround for feed description
-                        NSString *descriptionString = [NSString stringWithFormat:@"%@:description", self.mediaPrefix];
-                        articleBody =
-                            [([itemChildElement elementsForName:descriptionString].firstObject).stringValue mutableCopy];
-                    }
-                    continue;
-                }
+        // Parse item date
+        if ((isRSSElement && ([articleItemTag isEqualToString:@"pubDate"] ||
+                              // not in specifications, added for flexibility
+                              [articleItemTag isEqualToString:@"published"] || [articleItemTag isEqualToString:@"created"] || [articleItemTag isEqualToString:@"issued"]))
+            || ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"date"])) {
+            NSDate *newDate = [self dateWithXMLString:itemChildElement.stringValue];
+            if (newFeedItem.publicationDate == nil || [newDate isLessThan:newFeedItem.publicationDate]) {
+                newFeedItem.publicationDate = newDate;
             }
+            continue;
+        }
 
-            // If no link, set it to the feed link if there is one
-            if (!hasLink && self.homePageURL) {
-                newFeedItem.url = self.homePageURL;
+        // Parse item modification date
+        if ([itemChildElement.prefix isEqualToString:self.dcPrefix] && [articleItemTag isEqualToString:@"modified"]) {
+            NSDate *newDate = [self dateWithXMLString:itemChildElement.stringValue];
+            if (newFeedItem.modificationDate == nil || [newDate isGreaterThan:newFeedItem.modificationDate]) {
+                newFeedItem.modificationDate = newDate;
             }
+            continue;
+        }
 
-            // Do relative IMG, IFRAME and A tags fixup
-            [articleBody vna_fixupRelativeImgTags:newFeedItem.url];
-            [articleBody vna_fixupRelativeIframeTags:newFeedItem.url];
-            [articleBody vna_fixupRelativeAnchorTags:newFeedItem.url];
-            newFeedItem.content = SafeString(articleBody);
+        // Parse item link
+        if (isRSSElement && [articleItemTag isEqualToString:@"link"]) {
+            newFeedItem.url = (itemChildElement.stringValue).vna_stringByUnescapingExtendedCharacters;
+            hasLink = YES;
+            continue;
+        }
 
-            // Add this item in the proper location in the array
-            NSUInteger index = self.orderArray && itemIdentifier ? [self.orderArray indexOfObject:itemIdentifier] : NSNotFound;
-            if (index == NSNotFound || index >= items.count) {
-                [items addObject:newFeedItem];
-            } else {
-                [items insertObject:newFeedItem atIndex:index];
+        // Parse associated enclosure
+        if ((isRSSElement && [articleItemTag isEqualToString:@"enclosure"]) || ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"content"])) {
+            if ([itemChildElement attributeForName:@"url"].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
+            }
+            continue;
+        }
+        if ([itemChildElement.prefix isEqualToString:self.encPrefix] && [articleItemTag isEqualToString:@"enclosure"]) {
+            if ([itemChildElement attributeForName:@"url"].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:@"url"].stringValue;
+            }
+            NSString *resourceString = [NSString stringWithFormat:@"%@:resource", self.rdfPrefix];
+            if ([itemChildElement attributeForName:resourceString].stringValue) {
+                newFeedItem.enclosure = [itemChildElement attributeForName:resourceString].stringValue;
+            }
+            continue;
+        }
+
+        // Parse media group
+        if ([itemChildElement.prefix isEqualToString:self.mediaPrefix] && [articleItemTag isEqualToString:@"group"]) {
+            if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
+                // group's first enclosure
+                NSString *enclosureString = [NSString stringWithFormat:@"%@:content", self.mediaPrefix];
+                newFeedItem.enclosure =
+                    ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
+            }
+            if (!newFeedItem.enclosure || [newFeedItem.enclosure isEqualToString:@""]) {
+                // use first thumbnail as a workaround for enclosure
+                NSString *enclosureString = [NSString stringWithFormat:@"%@:thumbnail", self.mediaPrefix];
+                newFeedItem.enclosure =
+                    ([[itemChildElement elementsForName:enclosureString].firstObject attributeForName:@"url"]).stringValue;
+            }
+            if (!articleBody || [articleBody isEqualToString:@""]) {
+                // use enclosure description as a workaround for feed description
+                NSString *descriptionString = [NSString stringWithFormat:@"%@:description", self.mediaPrefix];
+                articleBody =
+                    [([itemChildElement elementsForName:descriptionString].firstObject).stringValue mutableCopy];
             }
+            continue;
         }
     }
 
-    self.items = items;
+    // The link of the feed and the relative URLs are resolved in
+    // finishReading, when the whole channel is known.
+    if (!hasLink) {
+        [self.itemsWithoutLink addObject:newFeedItem];
+    }
+    newFeedItem.content = SafeString(articleBody);
 
-    return;
+    if (identifier) {
+        *identifier = itemIdentifier;
+    }
+    return newFeedItem;
 }
 
 // MARK: Overrides
@@ -385,6 +429,11 @@
     if (!self.contentPrefix) {
         self.contentPrefix = @"content";
     }
+
+    self.syPrefix = [element resolvePrefixForNamespaceURI:@"http://purl.org/rss/1.0/modules/syndication/"];
+    if (!self.syPrefix) {
+        self.syPrefix = @"sy";
+    }
 }
 
 @end
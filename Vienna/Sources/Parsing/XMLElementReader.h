@@ -0,0 +1,74 @@
+//
+//  XMLElementReader.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+@class VNAXMLElementReader;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol VNAXMLElementReaderDelegate <NSObject>
+
+/// Called when the root element starts. The element has its attributes and
+/// namespaces, but no children. The delegate can set the container element
+/// name of the reader here, or abort the reader if the document is not of
+/// interest.
+- (void)elementReader:(VNAXMLElementReader *)reader
+    didStartRootElement:(NSXMLElement *)rootElement;
+
+/// Called when a child element of the root element, or of the container
+/// element, ends. The element is complete and detached from the document;
+/// the reader does not keep a reference to it.
+- (void)elementReader:(VNAXMLElementReader *)reader
+       didReadElement:(NSXMLElement *)element
+          inContainer:(BOOL)inContainer;
+
+@end
+
+/// Reads an XML document with the SAX2 interface of libxml2 and hands over its
+/// top-level elements one at a time, instead of building the whole document.
+/// The memory used is bounded by the largest element rather than by the size
+/// of the document.
+///
+/// Malformed documents are read as far as possible: errors are recovered from,
+/// undefined HTML entities such as `&nbsp;` are replaced by their characters,
+/// and bytes that are not valid in the declared encoding are read as Latin 1.
+@interface VNAXMLElementReader : NSObject
+
+- (instancetype)initWithDelegate:(id<VNAXMLElementReaderDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (readonly, weak, nonatomic) id<VNAXMLElementReaderDelegate> delegate;
+
+/// The qualified name of a child element of the root element whose own
+/// children are handed over individually, e.g. the channel element of an
+/// RSS feed.
+@property (nullable, copy, nonatomic) NSString *containerElementName;
+
+/// Reads a document. Returns `NO` if it has no root element.
+- (BOOL)readData:(NSData *)data error:(NSError **)error;
+
+/// Stops reading the document. Elements that have not been handed over yet
+/// are discarded.
+- (void)abortReading;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,436 @@
+//
+//  XMLElementReader.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "XMLElementReader.h"
+
+@import libxml2;
+@import os.log;
+
+#define VNA_LOG os_log_create("--", "XMLElementReader")
+
+// The size of the chunks that are pushed to the parser.
+static NSUInteger const VNAXMLElementReaderChunkSize = 64 * 1024;
+
+static NSString *VNAStringFromXMLChar(const xmlChar *string)
+{
+    return string ? @((const char *)string) : nil;
+}
+
+static NSString *VNAQualifiedName(const xmlChar *localname, const xmlChar *prefix)
+{
+    NSString *name = VNAStringFromXMLChar(localname) ?: @"";
+    if (prefix) {
+        return [NSString stringWithFormat:@"%s:%@", (const char *)prefix, name];
+    }
+    return name;
+}
+
+/* VNACreateEntity
+ * Creates an entity that is marked as predefined, so that libxml2 inserts
+ * its content as text rather than reporting an undefined entity. Once it has
+ * reported an error, libxml2 drops every entity reference that follows.
+ */
+static xmlEntityPtr VNACreateEntity(const xmlChar *name, const char *content)
+{
+    xmlEntityPtr entity = calloc(1, sizeof(xmlEntity));
+    if (!entity) {
+        return NULL;
+    }
+    entity->type = XML_ENTITY_DECL;
+    entity->etype = XML_INTERNAL_PREDEFINED_ENTITY;
+    entity->name = xmlStrdup(name);
+    entity->content = xmlStrdup((const xmlChar *)content);
+    entity->orig = xmlStrdup((const xmlChar *)content);
+    entity->length = (int)strlen(content);
+    return entity;
+}
+
+static void VNAFreeEntity(xmlEntityPtr entity)
+{
+    xmlFree((xmlChar *)entity->name);
+    xmlFree(entity->content);
+    xmlFree(entity->orig);
+    free(entity);
+}
+
+/* VNAHTMLEntity
+ * Returns an entity for an HTML character entity reference, which is not
+ * defined in XML. Feeds use them a lot, e.g. &nbsp; in titles. The entities
+ * are created once and kept for the whole session; there are only a few
+ * hundred of them.
+ */
+static xmlEntityPtr VNAHTMLEntity(const xmlChar *name)
+{
+    static NSMutableDictionary<NSString *, NSValue *> *entities;
+    static os_unfair_lock lock = OS_UNFAIR_LOCK_INIT;
+
+    NSString *key = VNAStringFromXMLChar(name);
+    if (!key) {
+        return NULL;
+    }
+
+    os_unfair_lock_lock(&lock);
+    if (!entities) {
+        entities = [[NSMutableDictionary alloc] init];
+    }
+    xmlEntityPtr entity = entities[key].pointerValue;
+    if (!entity) {
+        const htmlEntityDesc *description = htmlEntityLookup(name);
+        if (description) {
+            NSString *character = [[NSString alloc] initWithBytes:&description->value
+                                                           length:sizeof(description->value)
+                                                         encoding:NSUTF32LittleEndianStringEncoding];
+            const char *content = character.UTF8String;
+            entity = content ? VNACreateEntity(name, content) : NULL;
+            if (entity) {
+                entities[key] = [NSValue valueWithPointer:entity];
+            }
+        }
+    }
+    os_unfair_lock_unlock(&lock);
+    return entity;
+}
+
+@interface VNAXMLElementReader ()
+
+- (void)startElementWithName:(NSString *)name
+                        URI:(NSString *)URI
+                 namespaces:(const xmlChar **)namespaces
+                      count:(int)countOfNamespaces
+                 attributes:(const xmlChar **)attributes
+                      count:(int)countOfAttributes;
+- (void)endElement;
+- (void)appendCharacters:(const xmlChar *)characters length:(int)length;
+- (xmlEntityPtr)unknownEntityWithName:(const xmlChar *)name;
+- (void)handleError:(const xmlError *)error;
+
+@end
+
+// MARK: SAX2 callbacks
+
+static void VNAStartElement(void *context, const xmlChar *localname, const xmlChar *prefix, const xmlChar *URI,
+                            int nb_namespaces, const xmlChar **namespaces,
+                            int nb_attributes, int nb_defaulted, const xmlChar **attributes)
+{
+    VNAXMLElementReader *reader = (__bridge VNAXMLElementReader *)context;
+    [reader startElementWithName:VNAQualifiedName(localname, prefix)
+                             URI:VNAStringFromXMLChar(URI)
+                      namespaces:namespaces
+                           count:nb_namespaces
+                      attributes:attributes
+                           count:nb_attributes];
+}
+
+static void VNAEndElement(void *context, const xmlChar *localname, const xmlChar *prefix, const xmlChar *URI)
+{
+    VNAXMLElementReader *reader = (__bridge VNAXMLElementReader *)context;
+    [reader endElement];
+}
+
+static void VNACharacters(void *context, const xmlChar *characters, int length)
+{
+    VNAXMLElementReader *reader = (__bridge VNAXMLElementReader *)context;
+    [reader appendCharacters:characters length:length];
+}
+
+static xmlEntityPtr VNAGetEntity(void *context, const xmlChar *name)
+{
+    xmlEntityPtr entity = xmlGetPredefinedEntity(name) ?: VNAHTMLEntity(name);
+    if (!entity) {
+        VNAXMLElementReader *reader = (__bridge VNAXMLElementReader *)context;
+        entity = [reader unknownEntityWithName:name];
+    }
+    return entity;
+}
+
+static void VNAStructuredError(void *context, const xmlError *error)
+{
+    VNAXMLElementReader *reader = (__bridge VNAXMLElementReader *)context;
+    [reader handleError:error];
+}
+
+@implementation VNAXMLElementReader {
+    xmlParserCtxtPtr _context;
+    NSMutableArray<NSXMLElement *> *_elementStack;
+    NSMutableData *_text;
+    NSMutableDictionary<NSString *, NSValue *> *_unknownEntities;
+    NSUInteger _depth;
+    BOOL _hasRootElement;
+    BOOL _isInContainer;
+    BOOL _isCollectingInContainer;
+    BOOL _aborted;
+    int _lastErrorCode;
+}
+
+- (instancetype)initWithDelegate:(id<VNAXMLElementReaderDelegate>)delegate
+{
+    self = [super init];
+    if (self) {
+        _delegate = delegate;
+        _elementStack = [[NSMutableArray alloc] init];
+        _text = [[NSMutableData alloc] init];
+        _unknownEntities = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+/* readData
+ * Pushes the data to the parser in chunks, so that libxml2 does not need
+ * its own copy of the document.
+ */
+- (BOOL)readData:(NSData *)data error:(NSError **)error
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        xmlInitParser();
+    });
+
+    const char *bytes = data.bytes;
+    NSUInteger length = data.length;
+
+    // Whitespace before the XML declaration is a fatal error for libxml2,
+    // but it is common enough to be ignored.
+    NSUInteger offset = 0;
+    while (offset < length && isspace((unsigned char)bytes[offset])) {
+        offset += 1;
+    }
+    if (offset == length) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSXMLParserErrorDomain
+                                         code:NSXMLParserEmptyDocumentError
+                                     userInfo:nil];
+        }
+        return NO;
+    }
+
+    xmlSAXHandler handler;
+    memset(&handler, 0, sizeof(handler));
+    handler.initialized = XML_SAX2_MAGIC;
+    handler.startElementNs = VNAStartElement;
+    handler.endElementNs = VNAEndElement;
+    handler.characters = VNACharacters;
+    handler.cdataBlock = VNACharacters;
+    handler.getEntity = VNAGetEntity;
+    handler.serror = (xmlStructuredErrorFunc)VNAStructuredError;
+
+    // The first bytes are used to detect the encoding.
+    int countOfFirstBytes = (int)MIN(4, length - offset);
+    _context = xmlCreatePushParserCtxt(&handler, (__bridge void *)self, bytes + offset, countOfFirstBytes, NULL);
+    if (!_context) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSXMLParserErrorDomain
+                                         code:NSXMLParserInternalError
+                                     userInfo:nil];
+        }
+        return NO;
+    }
+    // External entities and DTDs are never loaded, the default of libxml2.
+    xmlCtxtUseOptions(_context, XML_PARSE_RECOVER | XML_PARSE_NONET | XML_PARSE_HUGE);
+
+    _depth = 0;
+    _hasRootElement = NO;
+    _isInContainer = NO;
+    _aborted = NO;
+    _lastErrorCode = 0;
+    [_elementStack removeAllObjects];
+    _text.length = 0;
+
+    offset += countOfFirstBytes;
+    while (offset < length && !_aborted) {
+        NSUInteger chunkLength = MIN(VNAXMLElementReaderChunkSize, length - offset);
+        xmlParseChunk(_context, bytes + offset, (int)chunkLength, 0);
+        offset += chunkLength;
+    }
+    if (!_aborted) {
+        xmlParseChunk(_context, NULL, 0, 1);
+    }
+
+    xmlFreeParserCtxt(_context);
+    _context = NULL;
+    [_elementStack removeAllObjects];
+    _text.length = 0;
+    for (NSValue *value in _unknownEntities.objectEnumerator) {
+        VNAFreeEntity(value.pointerValue);
+    }
+    [_unknownEntities removeAllObjects];
+
+    if (!_hasRootElement) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSXMLParserErrorDomain
+                                         code:_lastErrorCode ?: NSXMLParserEmptyDocumentError
+                                     userInfo:nil];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+- (void)abortReading
+{
+    _aborted = YES;
+    if (_context) {
+        xmlStopParser(_context);
+    }
+}
+
+// MARK: Building elements
+
+- (void)startElementWithName:(NSString *)name
+                        URI:(NSString *)URI
+                 namespaces:(const xmlChar **)namespaces
+                      count:(int)countOfNamespaces
+                 attributes:(const xmlChar **)attributes
+                      count:(int)countOfAttributes
+{
+    if (_aborted) {
+        return;
+    }
+
+    NSUInteger depth = _depth;
+    _depth += 1;
+
+    BOOL isRoot = depth == 0;
+    BOOL isContainer = depth == 1 && !_isInContainer && [name isEqualToString:self.containerElementName];
+    BOOL isCollected = _elementStack.count > 0 || depth == 1 || (depth == 2 && _isInContainer);
+    if (!isRoot && (isContainer || !isCollected)) {
+        if (isContainer) {
+            _isInContainer = YES;
+        }
+        return;
+    }
+
+    [self flushText];
+
+    NSXMLElement *element = [[NSXMLElement alloc] initWithName:name URI:URI];
+    for (int i = 0; i < countOfNamespaces; i++) {
+        NSString *prefix = VNAStringFromXMLChar(namespaces[i * 2]) ?: @"";
+        NSString *namespaceURI = VNAStringFromXMLChar(namespaces[i * 2 + 1]) ?: @"";
+        [element addNamespace:[NSXMLNode namespaceWithName:prefix stringValue:namespaceURI]];
+    }
+    // Attributes come as localname, prefix, URI, start and end of the value.
+    for (int i = 0; i < countOfAttributes; i++) {
+        const xmlChar **attribute = attributes + i * 5;
+        NSString *attributeName = VNAQualifiedName(attribute[0], attribute[1]);
+        NSString *value = [[NSString alloc] initWithBytes:attribute[3]
+                                                   length:(NSUInteger)(attribute[4] - attribute[3])
+                                                 encoding:NSUTF8StringEncoding] ?: @"";
+        NSXMLNode *node = attribute[2]
+            ? [NSXMLNode attributeWithName:attributeName URI:VNAStringFromXMLChar(attribute[2]) stringValue:value]
+            : [NSXMLNode attributeWithName:attributeName stringValue:value];
+        [element addAttribute:node];
+    }
+
+    if (isRoot) {
+        _hasRootElement = YES;
+        [self.delegate elementReader:self didStartRootElement:element];
+        return;
+    }
+
+    if (_elementStack.count == 0) {
+        _isCollectingInContainer = _isInContainer;
+    } else {
+        [_elementStack.lastObject addChild:element];
+    }
+    [_elementStack addObject:element];
+}
+
+- (void)endElement
+{
+    if (_aborted || _depth == 0) {
+        return;
+    }
+    _depth -= 1;
+
+    if (_elementStack.count == 0) {
+        if (_depth == 1 && _isInContainer) {
+            _isInContainer = NO;
+        }
+        return;
+    }
+
+    [self flushText];
+    NSXMLElement *element = _elementStack.lastObject;
+    [_elementStack removeLastObject];
+    if (_elementStack.count == 0) {
+        @autoreleasepool {
+            [self.delegate elementReader:self didReadElement:element inContainer:_isCollectingInContainer];
+        }
+    }
+}
+
+- (void)appendCharacters:(const xmlChar *)characters length:(int)length
+{
+    if (_aborted || _elementStack.count == 0 || length <= 0) {
+        return;
+    }
+    [_text appendBytes:characters length:(NSUInteger)length];
+}
+
+/* flushText
+ * Adds the characters read so far as a text node of the current element.
+ * They are collected as bytes, because libxml2 reports long texts in many
+ * small pieces.
+ */
+- (void)flushText
+{
+    if (_text.length == 0) {
+        return;
+    }
+    NSString *text = [[NSString alloc] initWithData:_text encoding:NSUTF8StringEncoding];
+    if (text && _elementStack.count > 0) {
+        [_elementStack.lastObject addChild:[NSXMLNode textWithStringValue:text]];
+    }
+    _text.length = 0;
+}
+
+/* unknownEntityWithName
+ * Returns an entity for a reference that is neither defined in XML nor in
+ * HTML, e.g. one that is declared in a DTD that is not loaded. The
+ * reference is kept as it is written. The entities are only kept until the document
+ * is read, since any name may occur.
+ */
+- (xmlEntityPtr)unknownEntityWithName:(const xmlChar *)name
+{
+    NSString *key = VNAStringFromXMLChar(name);
+    if (!key) {
+        return NULL;
+    }
+    xmlEntityPtr entity = _unknownEntities[key].pointerValue;
+    if (!entity) {
+        NSString *reference = [NSString stringWithFormat:@"&%@;", key];
+        entity = VNACreateEntity(name, reference.UTF8String);
+        if (entity) {
+            _unknownEntities[key] = [NSValue valueWithPointer:entity];
+        }
+    }
+    return entity;
+}
+
+- (void)handleError:(const xmlError *)error
+{
+    if (!error) {
+        return;
+    }
+    if (error->level == XML_ERR_FATAL || error->level == XML_ERR_ERROR) {
+        _lastErrorCode = error->code;
+    }
+    os_log_debug(VNA_LOG, "Line %d: %{public}s", error->line, error->message ?: "");
+}
+
+@end
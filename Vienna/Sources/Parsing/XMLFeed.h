@@ -33,6 +33,21 @@ NS_SWIFT_NAME(XMLFeed)
 @property (nullable, copy, nonatomic) NSString *homePageURL;
 @property (nonatomic) NSDate *modificationDate;
 @property (copy, nonatomic) NSArray<id<VNAFeedItem>> *items;
+@property (nonatomic) NSTimeInterval timeToLive;
+
+// MARK: Reading
+
+/// The qualified name of the element whose children are read in addition to
+/// the children of the root element, e.g. the channel element of RSS feeds.
+@property (nullable, readonly, nonatomic) NSString *containerElementName;
+
+/// Reads a child element of the root element, or of the container element.
+/// Called once for every element, in document order.
+- (void)readElement:(NSXMLElement *)element inContainer:(BOOL)inContainer;
+
+/// Called when all elements have been read. Returns `NO` if the document is
+/// not a feed.
+- (BOOL)finishReading;
 
 // MARK: Prefix handling
 
@@ -21,6 +21,23 @@
 
 @implementation VNAXMLFeed
 
+// MARK: Reading
+
+- (nullable NSString *)containerElementName
+{
+    return nil;
+}
+
+- (void)readElement:(NSXMLElement *)element inContainer:(BOOL)inContainer
+{
+    // Implemented by subclasses
+}
+
+- (BOOL)finishReading
+{
+    return YES;
+}
+
 // MARK: Public methods
 
 - (void)identifyNamespacesPrefixes:(NSXMLElement *)element
@@ -21,78 +21,71 @@
 
 #import "AtomFeed.h"
 #import "RSSFeed.h"
+#import "XMLElementReader.h"
+
+@interface VNAXMLFeedParser () <VNAXMLElementReaderDelegate>
+
+@property (nullable, nonatomic) VNAXMLFeed *feed;
+
+@end
 
 @implementation VNAXMLFeedParser
 
+/* feedWithXMLData
+ * Reads the feed element by element, so that each item is converted as soon
+ * as it is complete and the document is never held in memory as a whole.
+ */
 - (VNAXMLFeed *)feedWithXMLData:(NSData *)xmlData error:(NSError **)error
 {
-    NSXMLDocument *xmlDocument = nil;
-    NSError *xmlDocumentError = nil;
+    VNAXMLElementReader *reader = [[VNAXMLElementReader alloc] initWithDelegate:self];
+    NSError *readerError = nil;
+    BOOL success = [reader readData:xmlData error:&readerError];
 
-    @try {
-        xmlDocument = [[NSXMLDocument alloc] initWithData:xmlData
-                                                  options:NSXMLNodeLoadExternalEntitiesNever
-                                                    error:&xmlDocumentError];
-        if (!xmlDocument && xmlDocumentError) {
-            if ([xmlDocumentError.domain isEqualToString:NSXMLParserErrorDomain]) {
-                // handle here cases identified to cause
-                // application crashes caused by
-                // NSXMLDocument's -initWithData:options:error
-                // when option NSXMLDocumentTidyXML is enabled
-                switch (xmlDocumentError.code) {
-                case NSXMLParserEmptyDocumentError:
-                    if (error) {
-                        *error = xmlDocumentError;
-                    }
-                    return nil;
-                }
-            }
+    VNAXMLFeed *feed = self.feed;
+    self.feed = nil;
 
-            // recover some cases like text encoding errors, non standard tags...
-            xmlDocument = [[NSXMLDocument alloc] initWithData:xmlData
-                                                      options:NSXMLDocumentTidyXML | NSXMLDocumentTidyHTML |
-                                                      NSXMLNodeLoadExternalEntitiesNever
-                                                        error:&xmlDocumentError];
-        }
-    } @catch (NSException * __unused) {
-        if (error) {
-            if (xmlDocumentError) {
-                *error = xmlDocumentError;
-            } else {
-                *error = [NSError errorWithDomain:NSXMLParserErrorDomain
-                                             code:NSXMLParserInternalError
-                                         userInfo:nil];
-            }
-        }
-        xmlDocument = nil;
-        return nil;
-    }
-
-    VNAXMLFeed *feed = nil;
-
-    if (xmlDocument) {
-        NSXMLElement *rootElement = xmlDocument.rootElement;
-        if ([rootElement.name isEqualToString:@"rss"]) {
-            feed = [[VNARSSFeed alloc] initWithXMLRootElement:rootElement
-                                                        isRDF:NO];
-        } else if ([rootElement.name isEqualToString:@"rdf:RDF"]) {
-            feed = [[VNARSSFeed alloc] initWithXMLRootElement:rootElement
-                                                        isRDF:YES];
-        } else if ([rootElement.name isEqualToString:@"feed"]) {
-            feed = [[VNAAtomFeed alloc] initWithXMLRootElement:rootElement];
-        }
+    if (success && feed && [feed finishReading]) {
+        return feed;
     }
 
-    if (feed) {
-        return feed;
-    } else {
-        if (error) {
+    if (error) {
+        if (readerError.code == NSXMLParserEmptyDocumentError) {
+            *error = readerError;
+        } else {
             *error = [NSError errorWithDomain:NSXMLParserErrorDomain
                                          code:NSXMLParserUnknownEncodingError
                                      userInfo:nil];
         }
-        return nil;
     }
+    return nil;
+}
+
+// MARK: VNAXMLElementReaderDelegate
+
+- (void)elementReader:(VNAXMLElementReader *)reader
+    didStartRootElement:(NSXMLElement *)rootElement
+{
+    if ([rootElement.name isEqualToString:@"rss"]) {
+        self.feed = [[VNARSSFeed alloc] initWithXMLRootElement:rootElement
+                                                         isRDF:NO];
+    } else if ([rootElement.name isEqualToString:@"rdf:RDF"]) {
+        self.feed = [[VNARSSFeed alloc] initWithXMLRootElement:rootElement
+                                                         isRDF:YES];
+    } else if ([rootElement.name isEqualToString:@"feed"]) {
+        self.feed = [[VNAAtomFeed alloc] initWithXMLRootElement:rootElement];
+    } else {
+        // Not a feed, e.g. an HTML page
+        [reader abortReading];
+        return;
+    }
+    reader.containerElementName = self.feed.containerElementName;
+}
+
+- (void)elementReader:(VNAXMLElementReader *)reader
+       didReadElement:(NSXMLElement *)element
+          inContainer:(BOOL)inContainer
+{
+    [self.feed readElement:element inContainer:inContainer];
 }
 
 @end
@@ -257,6 +257,13 @@ static NSString * const MA_FeedSourcesFolder_Name = @"Sources";
                                                                                error:NULL];
 
     defaultValues[MAPref_ConcurrentDownloads] = @(MA_Default_ConcurrentDownloads);
+    defaultValues[MAPref_ConcurrentDownloadsPerHost] = @(MA_Default_ConcurrentDownloadsPerHost);
+    defaultValues[MAPref_HostRequestInterval] = @(MA_Default_HostRequestInterval);
+    defaultValues[MAPref_DatabaseMaintenanceBudget] = @(MA_Default_DatabaseMaintenanceBudget);
+    defaultValues[MAPref_GuidHistoryHorizon] = @(MA_Default_GuidHistoryHorizon);
+    defaultValues[MAPref_DatabaseInstrumentation] = boolNo;
+    defaultValues[MAPref_DatabaseBackupCount] = @(MA_Default_DatabaseBackupCount);
+    defaultValues[MAPref_DatabaseBackupInterval] = @(MA_Default_DatabaseBackupInterval);
     defaultValues[MAPref_SyncOpenReader] = boolNo;
     defaultValues[MAPref_PreferOpenReaderWhenSubscribing] = boolNo;
     defaultValues[MAPref_SyncingAppId] = @"1000001359";
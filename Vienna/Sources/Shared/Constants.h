@@ -112,6 +112,13 @@ extern NSString * const MAPref_FeedListSizeMode;
 extern NSString * const MAPref_ShowFeedsWithUnreadItemsInBold;
 extern NSString * const MAPref_MenuEnableActionImages;
 extern NSString * const MAPref_ShowUnreadCounts;
+extern NSString * const MAPref_DatabaseMaintenanceBudget;
+extern NSString * const MAPref_GuidHistoryHorizon;
+extern NSString * const MAPref_DatabaseInstrumentation;
+extern NSString * const MAPref_DatabaseBackupCount;
+extern NSString * const MAPref_DatabaseBackupInterval;
+extern NSString * const MAPref_ConcurrentDownloadsPerHost;
+extern NSString * const MAPref_HostRequestInterval;
 
 extern NSInteger const MA_Default_BackTrackQueueSize;
 extern float const MA_Default_Read_Interval;
@@ -119,6 +126,12 @@ extern NSInteger const MA_Default_MinimumFontSize;
 extern NSInteger const MA_Default_AutoExpireDuration;
 extern NSInteger const MA_Default_Check_Frequency;
 extern NSInteger const MA_Default_ConcurrentDownloads;
+extern NSInteger const MA_Default_DatabaseMaintenanceBudget;
+extern NSInteger const MA_Default_GuidHistoryHorizon;
+extern NSInteger const MA_Default_DatabaseBackupCount;
+extern NSInteger const MA_Default_DatabaseBackupInterval;
+extern NSInteger const MA_Default_ConcurrentDownloadsPerHost;
+extern NSInteger const MA_Default_HostRequestInterval;
 
 extern NSPasteboardType const VNAPasteboardTypeRSSItem;
 extern NSPasteboardType const VNAPasteboardTypeFolderList;
@@ -109,6 +109,13 @@ NSString * const MAPref_AlwaysAcceptBetas = @"AlwayAcceptBetas";
 NSString * const MAPref_UserAgentName = @"UserAgentName";
 NSString * const MAPref_MenuEnableActionImages = @"NSMenuEnableActionImages";
 NSString * const MAPref_ShowUnreadCounts = @"ShowUnreadCounts";
+NSString * const MAPref_DatabaseMaintenanceBudget = @"DatabaseMaintenanceBudget";
+NSString * const MAPref_GuidHistoryHorizon = @"GuidHistoryHorizon";
+NSString * const MAPref_DatabaseInstrumentation = @"DatabaseInstrumentation";
+NSString * const MAPref_DatabaseBackupCount = @"DatabaseBackupCount";
+NSString * const MAPref_DatabaseBackupInterval = @"DatabaseBackupInterval";
+NSString * const MAPref_ConcurrentDownloadsPerHost = @"ConcurrentDownloadsPerHost";
+NSString * const MAPref_HostRequestInterval = @"HostRequestInterval";
 
 NSInteger const MA_Default_BackTrackQueueSize = 20;
 NSInteger const MA_Default_MinimumFontSize = 9;
@@ -116,6 +123,16 @@ float const MA_Default_Read_Interval = 0.5;
 NSInteger const MA_Default_AutoExpireDuration = 0;
 NSInteger const MA_Default_Check_Frequency = 10800;
 NSInteger const MA_Default_ConcurrentDownloads = 10;
+// In milliseconds
+NSInteger const MA_Default_DatabaseMaintenanceBudget = 100;
+// In days
+NSInteger const MA_Default_GuidHistoryHorizon = 180;
+NSInteger const MA_Default_DatabaseBackupCount = 3;
+// In minutes
+NSInteger const MA_Default_DatabaseBackupInterval = 60;
+NSInteger const MA_Default_ConcurrentDownloadsPerHost = 2;
+// In milliseconds
+NSInteger const MA_Default_HostRequestInterval = 250;
 
 // Constants for External Weblog Editor Interface according to http://ranchero.com/netnewswire/developers/externalinterface.php
 // We are not using all of them yet, but they might become useful in the future.
@@ -0,0 +1,41 @@
+//
+//  NSData+Compression.h
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface NSData (Compression)
+
+/// Compresses the UTF-8 representation of a string with zlib. An empty string
+/// is compressed to empty data.
+/// @param string The string to compress.
+/// @return The compressed data, or `nil` if the string could not be
+///   compressed.
++ (nullable NSData *)vna_compressedDataWithString:(NSString *)string
+    NS_SWIFT_NAME(compressedData(with:));
+
+/// The string that was compressed with `vna_compressedDataWithString:`, or
+/// `nil` if the data cannot be decompressed.
+@property (readonly, nullable, nonatomic) NSString *vna_decompressedString
+    NS_SWIFT_NAME(decompressedString);
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,67 @@
+//
+//  NSData+Compression.m
+//  Vienna
+//
+//  Copyright 2026
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  https://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "NSData+Compression.h"
+
+@import os.log;
+
+#define VNA_LOG os_log_create("--", "Compression")
+
+@implementation NSData (Compression)
+
+// The data is stored in the database, so the algorithm must never change.
+// zlib compresses article HTML better than LZ4 or LZFSE, and decompression
+// is fast enough to be done whenever an article is displayed.
++ (NSData *)vna_compressedDataWithString:(NSString *)string
+{
+    NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding];
+    if (data.length == 0) {
+        return [NSData data];
+    }
+
+    NSError *error = nil;
+    NSData *compressedData =
+        [data compressedDataUsingAlgorithm:NSDataCompressionAlgorithmZlib
+                                     error:&error];
+    if (!compressedData) {
+        os_log_error(VNA_LOG, "Failed to compress data. Error: %{public}@",
+                     error.localizedDescription);
+    }
+    return compressedData;
+}
+
+- (NSString *)vna_decompressedString
+{
+    if (self.length == 0) {
+        return @"";
+    }
+
+    NSError *error = nil;
+    NSData *data =
+        [self decompressedDataUsingAlgorithm:NSDataCompressionAlgorithmZlib
+                                       error:&error];
+    if (!data) {
+        os_log_error(VNA_LOG, "Failed to decompress data. Error: %{public}@",
+                     error.localizedDescription);
+        return nil;
+    }
+    return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+@end